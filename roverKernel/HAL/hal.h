@@ -23,6 +23,17 @@
     #include "tm4c1294/hal_radar_tm4c.h"
     #include "tm4c1294/hal_ts_tm4c.h"
     #include "tm4c1294/hal_eng_tm4c.h"
+    #include "tm4c1294/hal_stor_tm4c.h"
+
+#elif defined(__BOARD_POSIX__)
+
+    #include "posix/hal_common_posix.h"
+    #include "posix/hal_mpu_posix.h"
+    #include "posix/hal_esp_posix.h"
+    #include "posix/hal_radar_posix.h"
+    #include "posix/hal_ts_posix.h"
+    #include "posix/hal_eng_posix.h"
+    #include "posix/hal_stor_posix.h"
 
 #elif __BOARD_ATMEGA328P__
 //TODO: Arduino support
@@ -0,0 +1,205 @@
+/**
+ * hal_common_posix.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran
+ */
+#include "hal_common_posix.h"
+
+#if defined(__BOARD_POSIX__)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <malloc.h>
+
+//  Number of PWM outputs that can be remembered by HAL_SetPWM()
+#define HAL_SIM_PWM_OUTS        8
+
+//  Clock of simulated board is fixed, same for all boards
+uint32_t g_ui32SysClock = HAL_SIM_CLOCK;
+
+/**
+ * Values of generic PWM outputs, as pairs of output ID and pulse width
+ */
+struct _simPWM
+{
+    uint32_t    id[HAL_SIM_PWM_OUTS];
+    uint32_t    val[HAL_SIM_PWM_OUTS];
+    uint8_t     n;
+};
+
+/**
+ * Get PWM outputs of the selected board
+ * @return pointer to PWM outputs
+ */
+static struct _simPWM* _SIMPWM()
+{
+    return (struct _simPWM*)HAL_SIM_State(HAL_SIM_PART_PWM,
+                                          sizeof(struct _simPWM), 0);
+}
+
+/**
+ *  Dummy function to be called to suppress "Unused variable" warnings
+ */
+void UNUSED (int32_t arg) { (void)arg; }
+
+/**
+ * Initialize microcontroller board clock. Simulated board has nothing to set
+ * up apart from enabling interrupts
+ */
+void HAL_BOARD_CLOCK_Init()
+{
+    //  Enable interrupt handler
+    HAL_SIM_SetIntState(true);
+}
+
+/**
+ * Software-triggered reboot of microcontroller. On the host this ends the
+ * process, so it can be restarted by whoever started it
+ */
+void HAL_BOARD_Reset()
+{
+    fflush(stdout);
+    exit(EXIT_SUCCESS);
+}
+
+/**
+ * Create context for running another kernel in the same process. Each context
+ * gets its own simulated board, with its own clock and peripherals
+ * @return handle of the context, 0 if it couldn't be created
+ */
+void* HAL_BOARD_NewContext()
+{
+    return (void*)HAL_SIM_NewBoard();
+}
+
+/**
+ * Select context on which the calling thread works from now on
+ * @param context handle returned by HAL_BOARD_NewContext(), 0 for the default
+ * context the process starts with
+ */
+void HAL_BOARD_SelectContext(void *context)
+{
+    HAL_SIM_SelectBoard((struct _simBoard*)context);
+}
+
+/**
+ * Delete context created by HAL_BOARD_NewContext()
+ * @param context handle of the context, mustn't be selected by any thread
+ */
+void HAL_BOARD_DeleteContext(void *context)
+{
+    HAL_SIM_DeleteBoard((struct _simBoard*)context);
+}
+
+/**
+ * Suppress or enable interrupts on the microcontroller
+ * @param enable New state to set
+ */
+void HAL_BOARD_InterruptEnable(bool enable)
+{
+    HAL_SIM_SetIntState(enable);
+}
+
+/**
+ * Disable interrupts on the microcontroller and return their previous state.
+ * Unlike HAL_BOARD_InterruptEnable() this can be used for nested critical
+ * sections and inside of interrupt handlers
+ * @return true if interrupts were enabled before the call, false otherwise
+ */
+bool HAL_BOARD_InterruptSuspend()
+{
+    bool enabled = HAL_SIM_GetIntState();
+
+    HAL_SIM_SetIntState(false);
+    return enabled;
+}
+
+/**
+ * Restore state of interrupts saved by HAL_BOARD_InterruptSuspend()
+ * @param enabled state of interrupts returned by HAL_BOARD_InterruptSuspend()
+ */
+void HAL_BOARD_InterruptRestore(bool enabled)
+{
+    if (enabled)
+        HAL_SIM_SetIntState(true);
+}
+
+/**
+ * Add to a variable shared with interrupts without disabling them
+ * @param ptr variable to add to
+ * @param val value to add
+ * @return value of the variable before addition
+ */
+uint32_t HAL_BOARD_AtomicAdd(volatile uint32_t *ptr, uint32_t val)
+{
+    return __sync_fetch_and_add(ptr, val);
+}
+
+/**
+ * Get amount of memory allocated on the heap. Heap belongs to the host
+ * process, so it's shared by all simulated boards
+ * @return bytes allocated on the heap
+ */
+uint32_t HAL_BOARD_HeapUsed()
+{
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC_MINOR__ >= 33))
+    return (uint32_t)mallinfo2().uordblks;
+#else
+    return (uint32_t)mallinfo().uordblks;
+#endif
+}
+
+/**
+ * Delay execution for given number of microseconds. Only the virtual clock
+ * moves, so any timer expiring in the meantime still fires
+ * @param us number of microseconds to wait
+ */
+void HAL_DelayUS(uint32_t us)
+{
+    HAL_SIM_Advance(us);
+}
+
+/**
+ * Set pulse width of a generic PWM output
+ * @param id ID of PWM output
+ * @param pwm pulse width
+ */
+void HAL_SetPWM(uint32_t id, uint32_t pwm)
+{
+    struct _simPWM *out = _SIMPWM();
+    uint8_t i;
+
+    for (i = 0; i < out->n; i++)
+        if (out->id[i] == id)
+            break;
+
+    if (i == HAL_SIM_PWM_OUTS)
+        return;
+
+    if (i == out->n)
+    {
+        out->id[i] = id;
+        out->n++;
+    }
+    out->val[i] = pwm;
+}
+
+/**
+ * Get pulse width of a generic PWM output
+ * @param id ID of PWM output
+ * @return pulse width, 0 if it was never set
+ */
+uint32_t HAL_GetPWM(uint32_t id)
+{
+    struct _simPWM *out = _SIMPWM();
+    uint8_t i;
+
+    for (i = 0; i < out->n; i++)
+        if (out->id[i] == id)
+            return out->val[i];
+
+    return 0;
+}
+
+#endif /* __BOARD_POSIX__ */
@@ -0,0 +1,52 @@
+/**
+ * hal_common_posix.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ */
+#include "hwconfig.h"
+
+#ifndef ROVERKERNEL_HAL_POSIX_HAL_COMMON_POSIX_H_
+#define ROVERKERNEL_HAL_POSIX_HAL_COMMON_POSIX_H_
+
+#include "hal_sim_posix.h"
+
+#define HAL_OK                  0
+
+//  Variable with a separate copy in every thread of the host process
+#define HAL_THREAD_LOCAL        __thread
+
+//  Returned by HAL_BOARD_HeapUsed() if board can't tell how much heap is used
+#define HAL_HEAP_UNKNOWN        0xFFFFFFFF
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/// Global clock variable
+extern uint32_t g_ui32SysClock;
+
+
+extern void         HAL_DelayUS(uint32_t us);
+extern void         HAL_BOARD_CLOCK_Init();
+extern void         HAL_BOARD_Reset();
+extern void         HAL_BOARD_InterruptEnable(bool enable);
+extern bool         HAL_BOARD_InterruptSuspend();
+extern void         HAL_BOARD_InterruptRestore(bool enabled);
+extern uint32_t     HAL_BOARD_AtomicAdd(volatile uint32_t *ptr, uint32_t val);
+extern uint32_t     HAL_BOARD_HeapUsed();
+extern void         UNUSED (int32_t arg);
+extern void*        HAL_BOARD_NewContext();
+extern void         HAL_BOARD_SelectContext(void *context);
+extern void         HAL_BOARD_DeleteContext(void *context);
+
+
+extern void         HAL_SetPWM(uint32_t id, uint32_t pwm);
+extern uint32_t     HAL_GetPWM(uint32_t id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ROVERKERNEL_HAL_POSIX_HAL_COMMON_POSIX_H_ */
@@ -0,0 +1,275 @@
+/**
+ * hal_eng_posix.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran
+ */
+#include "hal_eng_posix.h"
+
+#if defined(__BOARD_POSIX__) && defined(__HAL_USE_ENGINES__)
+
+#include "HAL/posix/hal_common_posix.h"
+
+//  Encoder ticks per second of default model when running at full speed
+#define HAL_SIM_ENG_MAXRATE     100
+
+//  H-bridge pins of each engine
+#define ED_HBR_PINL     0x03
+#define ED_HBR_PINR     0x0C
+
+///  Encoder interrupt handlers, implemented in engines library
+extern void PP0ISR(void);
+extern void PP1ISR(void);
+
+static uint32_t _SIMEngDefTickRate(uint32_t engine, uint32_t pwm,
+                                   uint32_t pwmMin, uint32_t pwmMax);
+
+///  Default model spins the wheels proportionally to PWM
+static const struct _simEngModel _engDefModel = { _SIMEngDefTickRate };
+
+/**
+ * Engines and their encoders
+ */
+struct _simEng
+{
+    const struct _simEngModel *model;
+    uint32_t    pwmMin, pwmMax;
+    uint32_t    pwm[2];
+    bool        enabled[2];
+    bool        intEnabled[2];
+    ///  Pin states of H-bridges of both engines
+    uint8_t     hBridge;
+    ///  Current period of encoder ticks (in us), 0 if encoder isn't ticking
+    uint64_t    tickUS[2];
+};
+static const struct _simEng _engInit = { .model = &_engDefModel };
+
+/**
+ * Get engines of the selected board
+ * @return pointer to the state of engines
+ */
+static struct _simEng* _SIMEng()
+{
+    return (struct _simEng*)HAL_SIM_State(HAL_SIM_PART_ENG,
+                                          sizeof(struct _simEng), &_engInit);
+}
+
+static uint32_t _SIMEngDefTickRate(uint32_t engine, uint32_t pwm,
+                                   uint32_t pwmMin, uint32_t pwmMax)
+{
+    (void)engine;
+
+    if ((pwm <= pwmMin) || (pwmMax <= pwmMin))
+        return 0;
+
+    return ((pwm - pwmMin) * HAL_SIM_ENG_MAXRATE) / (pwmMax - pwmMin);
+}
+
+/**
+ * Start, stop or retune encoder of an engine after its state has changed.
+ * Encoder ticks only if engine is powered, its H-bridge is set to turn the
+ * wheel and the model says the wheel is moving
+ * @param engine engine ID (0 or 1)
+ */
+static void _SIMEngUpdate(uint32_t engine)
+{
+    struct _simEng *eng = _SIMEng();
+    uint8_t pins = (engine == 0) ? ED_HBR_PINL : ED_HBR_PINR;
+    uint64_t tickUS = 0;
+
+    if (eng->enabled[engine] && eng->intEnabled[engine]
+        && ((eng->hBridge & pins) != 0) && (eng->model->TickRate != 0))
+    {
+        uint32_t rate = eng->model->TickRate(engine, eng->pwm[engine],
+                                             eng->pwmMin, eng->pwmMax);
+        if (rate > 0)
+            tickUS = 1000000 / rate;
+    }
+
+    ///  Leave running encoder alone if its rate hasn't changed
+    if (tickUS == eng->tickUS[engine])
+        return;
+
+    eng->tickUS[engine] = tickUS;
+
+    if (tickUS == 0)
+        HAL_SIM_TimerStop(HAL_SIM_TIMER_ENC0 + engine);
+    else
+        HAL_SIM_TimerStart(HAL_SIM_TIMER_ENC0 + engine, tickUS, tickUS,
+                           (engine == 0) ? PP0ISR : PP1ISR);
+}
+
+/**
+ * Replace model of engines
+ * @param model new model to use, 0 to use the default one
+ */
+void HAL_SIM_EngSetModel(const struct _simEngModel *model)
+{
+    struct _simEng *eng = _SIMEng();
+
+    if (model == 0)
+        eng->model = &_engDefModel;
+    else
+        eng->model = model;
+
+    _SIMEngUpdate(0);
+    _SIMEngUpdate(1);
+}
+
+/**
+ * Initialize hardware used to run engines
+ * @param pwmMin pwm value used to stop the motors
+ * @param pwmMax pwm value used to run motors at full speed
+ */
+void HAL_ENG_Init(uint32_t pwmMin, uint32_t pwmMax)
+{
+    struct _simEng *eng = _SIMEng();
+    uint8_t i;
+
+    eng->pwmMin = pwmMin;
+    eng->pwmMax = pwmMax;
+    eng->hBridge = 0;
+
+    for (i = 0; i < 2; i++)
+    {
+        eng->pwm[i] = pwmMin;
+        eng->enabled[i] = false;
+        eng->intEnabled[i] = false;
+        _SIMEngUpdate(i);
+    }
+}
+
+/**
+ * Enable/disable PWM output from the microcontroller
+ * @param engine engine ID (one of ED_X macros from engines.h library)
+ * @param enable state of PWM output
+ */
+void HAL_ENG_Enable(uint32_t engine, bool enable)
+{
+    struct _simEng *eng = _SIMEng();
+
+    if ((engine == 0) || (engine == 2))
+        eng->enabled[0] = enable;
+    if ((engine == 1) || (engine == 2))
+        eng->enabled[1] = enable;
+
+    _SIMEngUpdate(0);
+    _SIMEngUpdate(1);
+}
+
+/**
+ * Set PWM for engines provided in argument
+ * @param engine is engine ID (one of ED_X macros from engines.h library)
+ * @param pwm value to set PWM to (must be in range between 1 and max allowed)
+ * @return HAL library error code
+ */
+uint8_t HAL_ENG_SetPWM(uint32_t engine, uint32_t pwm)
+{
+    struct _simEng *eng = _SIMEng();
+
+    ///  PWM generator period is set to pwmMax + 1
+    if (pwm > (eng->pwmMax + 1))
+        return HAL_ENG_PWMOOR;
+    if (pwm < 1)
+        return HAL_ENG_PWMOOR;
+    if (engine > 2)
+        return HAL_ENG_EOOR;
+
+    if ((engine == 0) || (engine == 2))
+        eng->pwm[0] = pwm;
+    if ((engine == 1) || (engine == 2))
+        eng->pwm[1] = pwm;
+
+    _SIMEngUpdate(0);
+    _SIMEngUpdate(1);
+
+    return HAL_OK;
+}
+
+/**
+ * Get PWM of an engine
+ * @param engine is engine ID (one of ED_X macros from engines.h library)
+ * @return PWM value of engine, HAL_ENG_EOOR for invalid engine ID
+ */
+uint32_t HAL_ENG_GetPWM(uint32_t engine)
+{
+    struct _simEng *eng = _SIMEng();
+
+    if (engine > 1)
+        return HAL_ENG_EOOR;
+
+    return eng->pwm[engine];
+}
+
+/**
+ * Set H-bridge to specific state
+ * @param mask mask of channels to configure
+ * @param dir direction in which vehicle has to move
+ * @return HAL library error code
+ */
+uint8_t HAL_ENG_SetHBridge(uint32_t mask, uint8_t dir)
+{
+    struct _simEng *eng = _SIMEng();
+    uint8_t pins;
+
+    if (mask == 0)  /// Configure direction for left motor
+        pins = ED_HBR_PINL;
+    else if (mask == 1) /// Configure direction for right motor
+        pins = ED_HBR_PINR;
+    else if (mask == 2) /// Configure direction for both motors
+        pins = ED_HBR_PINL | ED_HBR_PINR;
+    else
+        return HAL_ENG_ILLM;
+
+    ///  Same as writing GPIO port, only pins selected by the mask change
+    eng->hBridge = (eng->hBridge & ~pins) | (dir & pins);
+
+    _SIMEngUpdate(0);
+    _SIMEngUpdate(1);
+
+    return HAL_OK;
+}
+
+/**
+ * Get current configuration of H-bridge
+ * @param mask of channels for which to get the state
+ * @return pin configuration of H-bridge for specific channel mask
+ */
+uint32_t HAL_ENG_GetHBridge(uint32_t mask)
+{
+    struct _simEng *eng = _SIMEng();
+
+    if (mask == 0)
+        return eng->hBridge & ED_HBR_PINL;
+    else if (mask == 1)
+        return eng->hBridge & ED_HBR_PINR;
+    else
+        return eng->hBridge & (ED_HBR_PINL | ED_HBR_PINR);
+}
+
+/**
+ * Clear interrupt, nothing to clear as encoder ticks are timer events
+ * @param engine is engine for which to clean interrupt
+ */
+void HAL_ENG_IntClear(uint32_t engine)
+{
+    UNUSED(engine);
+}
+
+/**
+ * Change the state of an interrupt
+ * @param engine for which to alter the state of interrupt
+ * @param enable new state of interrupt
+ */
+void HAL_ENG_IntEnable(uint32_t engine, bool enable)
+{
+    struct _simEng *eng = _SIMEng();
+
+    if (engine > 1)
+        return;
+
+    eng->intEnabled[engine] = enable;
+    _SIMEngUpdate(engine);
+}
+
+#endif /* __BOARD_POSIX__ && __HAL_USE_ENGINES__ */
@@ -0,0 +1,52 @@
+/**
+ * hal_eng_posix.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ *
+ ****Simulated hardware:
+ *      PWM outputs driving the engines
+ *      H-bridges of both engines, as a 4-bit port (same pin layout as PL0-PL3)
+ *      Optical encoders on the wheels, ticking on the virtual clock at the rate
+ *          given by the model of engines, for as long as engine is running
+ */
+#include "hwconfig.h"
+
+//  Compile following section only if hwconfig.h says to include this module
+#if !defined(ROVERKERNEL_HAL_POSIX_HAL_ENG_POSIX_H_) && defined(__HAL_USE_ENGINES__)
+#define ROVERKERNEL_HAL_POSIX_HAL_ENG_POSIX_H_
+
+#define HAL_ENG_PWMOOR          4   /// PWM value out of range
+#define HAL_ENG_EOOR            5   /// Engine ID out of range
+#define HAL_ENG_ILLM            6   /// Illegal mask for H-bridge configuration
+
+/**
+ * Model of engines
+ */
+struct _simEngModel
+{
+    //  Get number of encoder ticks per second of the wheel for given PWM
+    //  (pwmMin-pwmMax range given in HAL_ENG_Init()), 0 if wheel stands still
+    uint32_t (*TickRate)(uint32_t engine, uint32_t pwm, uint32_t pwmMin,
+                         uint32_t pwmMax);
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    extern void        HAL_ENG_Init(uint32_t pwmMin, uint32_t pwmMax);
+    extern void        HAL_ENG_Enable(uint32_t engine, bool enable);
+    extern uint8_t     HAL_ENG_SetPWM(uint32_t engine, uint32_t pwm);
+    extern uint32_t    HAL_ENG_GetPWM(uint32_t engine);
+    extern uint8_t     HAL_ENG_SetHBridge(uint32_t mask, uint8_t dir);
+    extern uint32_t    HAL_ENG_GetHBridge(uint32_t mask);
+    extern void        HAL_ENG_IntClear(uint32_t engine);
+    extern void        HAL_ENG_IntEnable(uint32_t engine, bool enable);
+
+    extern void        HAL_SIM_EngSetModel(const struct _simEngModel *model);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ROVERKERNEL_HAL_POSIX_HAL_ENG_POSIX_H_ */
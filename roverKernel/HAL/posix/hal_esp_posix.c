@@ -0,0 +1,376 @@
+/**
+ * hal_esp_posix.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran
+ */
+#include "hal_esp_posix.h"
+
+#if defined(__BOARD_POSIX__) && defined(__HAL_USE_ESP8266__)
+
+#include <string.h>
+#include "HAL/posix/hal_common_posix.h"
+
+//  Time (in us) default model of the chip takes to answer a command
+#define HAL_SIM_ESP_LATENCY     1000
+
+static void _SIMESPDefTransmit(char c);
+
+///  Default model answers every command (line) with OK
+static const struct _simESPModel _espDefModel = { _SIMESPDefTransmit };
+/**
+ * UART port connected to the chip, and data in transfer from the chip
+ */
+struct _simESP
+{
+    const struct _simESPModel *model;
+    void((*intHandler)(void));
+    void((*wdHandler)(void));
+    bool        enabled;
+    bool        intEnabled;
+    ///  Interrupt was raised while disabled, it's served once enabled
+    bool        intPending;
+    uint32_t    baud;
+    ///  Last timeout of watchdog timer (in ms)
+    uint32_t    wdTimeout;
+
+    ///  Rx FIFO of the UART port
+    char        fifo[HAL_SIM_ESP_FIFO];
+    uint16_t    fifoHead, fifoLen;
+    ///  Data sent by the chip which hasn't arrived to the FIFO yet
+    char        queue[HAL_SIM_ESP_QUEUE];
+    uint16_t    queueHead, queueLen;
+};
+static const struct _simESP _espInit =
+        { .model = &_espDefModel, .baud = 115200 };
+
+/**
+ * Get ESP chip of the selected board
+ * @return pointer to the state of UART port and the chip
+ */
+static struct _simESP* _SIMESP()
+{
+    return (struct _simESP*)HAL_SIM_State(HAL_SIM_PART_ESP,
+                                          sizeof(struct _simESP), &_espInit);
+}
+
+/**
+ * Raise UART interrupt, or leave it pending if UART interrupt is disabled
+ */
+static void _SIMESPRaiseInt()
+{
+    struct _simESP *esp = _SIMESP();
+
+    if (esp->intEnabled)
+        HAL_SIM_RaiseInt(esp->intHandler);
+    else
+        esp->intPending = true;
+}
+
+/**
+ * Get length of the next line waiting in the queue, including its terminator.
+ * Lines end with '\n', or with "> " when the chip waits for data to send
+ * @return number of characters in the line
+ */
+static uint16_t _SIMESPLineLen()
+{
+    struct _simESP *esp = _SIMESP();
+    uint16_t i;
+
+    for (i = 0; i < esp->queueLen; i++)
+    {
+        uint16_t pos = (esp->queueHead + i) % HAL_SIM_ESP_QUEUE;
+        char c = esp->queue[pos];
+
+        if (c == '\n')
+            return i + 1;
+        if ((c == ' ') && (i > 0) && (esp->queue[(pos + HAL_SIM_ESP_QUEUE - 1)
+                                                 % HAL_SIM_ESP_QUEUE] == '>'))
+            return i + 1;
+    }
+
+    return esp->queueLen;
+}
+
+/**
+ * Time needed to transfer given number of characters over UART port
+ * @param len number of characters
+ * @return transfer time (in us), 10 bits per character
+ */
+static uint64_t _SIMESPTransferUS(uint16_t len)
+{
+    struct _simESP *esp = _SIMESP();
+
+    return ((uint64_t)len * 10 * 1000000) / esp->baud;
+}
+
+/**
+ * Interrupt of the timer moving data from the chip into Rx FIFO. Moves one
+ * line at a time and restarts itself for as long as there is data in the queue
+ */
+static void _SIMESPRxISR()
+{
+    struct _simESP *esp = _SIMESP();
+    uint16_t len = _SIMESPLineLen();
+
+    ///  Characters that don't fit into the FIFO are lost, as on real UART
+    while (len-- > 0)
+    {
+        if (esp->fifoLen < HAL_SIM_ESP_FIFO)
+        {
+            esp->fifo[(esp->fifoHead + esp->fifoLen) % HAL_SIM_ESP_FIFO] =
+                    esp->queue[esp->queueHead];
+            esp->fifoLen++;
+        }
+        esp->queueHead = (esp->queueHead + 1) % HAL_SIM_ESP_QUEUE;
+        esp->queueLen--;
+    }
+
+    _SIMESPRaiseInt();
+
+    if (esp->queueLen > 0)
+        HAL_SIM_TimerStart(HAL_SIM_TIMER_ESPRX,
+                           _SIMESPTransferUS(_SIMESPLineLen()), 0, _SIMESPRxISR);
+}
+
+/**
+ * Default model of the chip, answers every received line with "OK"
+ * @param c character sent to the chip
+ */
+static void _SIMESPDefTransmit(char c)
+{
+    if (c == '\n')
+        HAL_SIM_ESPReceive("OK\r\n", 4, HAL_SIM_ESP_LATENCY);
+}
+
+/**
+ * Replace model of ESP8266 chip
+ * @param model new model to use, 0 to use the default one
+ */
+void HAL_SIM_ESPSetModel(const struct _simESPModel *model)
+{
+    struct _simESP *esp = _SIMESP();
+
+    if (model == 0)
+        esp->model = &_espDefModel;
+    else
+        esp->model = model;
+}
+
+/**
+ * Send data from the chip to the board. Data is transferred after the delay,
+ * at the speed of UART port
+ * @param data data sent by the chip
+ * @param len length of data
+ * @param delayUS time (in us) before data starts arriving, used only if no
+ * other data is being transferred at the moment
+ */
+void HAL_SIM_ESPReceive(const char *data, uint16_t len, uint32_t delayUS)
+{
+    struct _simESP *esp = _SIMESP();
+    uint16_t i;
+
+    for (i = 0; (i < len) && (esp->queueLen < HAL_SIM_ESP_QUEUE); i++)
+    {
+        esp->queue[(esp->queueHead + esp->queueLen) % HAL_SIM_ESP_QUEUE] =
+                data[i];
+        esp->queueLen++;
+    }
+
+    if (!HAL_SIM_TimerRunning(HAL_SIM_TIMER_ESPRX) && (esp->queueLen > 0))
+        HAL_SIM_TimerStart(HAL_SIM_TIMER_ESPRX,
+                           delayUS + _SIMESPTransferUS(_SIMESPLineLen()), 0,
+                           _SIMESPRxISR);
+}
+
+/**
+ * Check if UART port is busy sending data, never the case as characters are
+ * passed to the model right away
+ * @return false
+ */
+bool HAL_ESP_UARTBusy()
+{
+    return false;
+}
+
+/**
+ * Send single character to the chip
+ * @param c character to send
+ */
+void HAL_ESP_SendChar(char c)
+{
+    struct _simESP *esp = _SIMESP();
+
+    if (esp->enabled && (esp->model->Transmit != 0))
+        esp->model->Transmit(c);
+}
+
+/**
+ * Check if there are any characters in Rx FIFO
+ * @return true if there is data to read, false otherwise
+ */
+bool HAL_ESP_CharAvail()
+{
+    struct _simESP *esp = _SIMESP();
+
+    return (esp->fifoLen > 0);
+}
+
+/**
+ * Take single character out of Rx FIFO
+ * @return character from FIFO, 0 if FIFO is empty
+ */
+char HAL_ESP_GetChar()
+{
+    struct _simESP *esp = _SIMESP();
+    char c;
+
+    if (esp->fifoLen == 0)
+        return 0;
+
+    c = esp->fifo[esp->fifoHead];
+    esp->fifoHead = (esp->fifoHead + 1) % HAL_SIM_ESP_FIFO;
+    esp->fifoLen--;
+
+    return c;
+}
+
+/**
+ * Initialize UART port communicating with ESP8266 chip
+ * @param baud designated speed of communication
+ * @return HAL library error code
+ */
+uint32_t HAL_ESP_InitPort(uint32_t baud)
+{
+    struct _simESP *esp = _SIMESP();
+
+    if (baud > 0)
+        esp->baud = baud;
+
+    esp->fifoHead = 0;
+    esp->fifoLen = 0;
+    HAL_DelayUS(50000);    //  50ms delay after configuring
+
+    return HAL_OK;
+}
+
+/**
+ * Attach interrupt handler called when data arrives to Rx FIFO. Interrupt
+ * remains disabled until HAL_ESP_IntEnable() is called
+ */
+void HAL_ESP_RegisterIntHandler(void((*intHandler)(void)))
+{
+    struct _simESP *esp = _SIMESP();
+
+    esp->intHandler = intHandler;
+    esp->intEnabled = false;
+}
+
+/**
+ * Enable or disable ESP chip (CH_PD pin)
+ * @param enable is state of device
+ */
+void HAL_ESP_HWEnable(bool enable)
+{
+    struct _simESP *esp = _SIMESP();
+
+    ///  Chip loses all data in transfer when turned off
+    if (!enable)
+    {
+        HAL_SIM_TimerStop(HAL_SIM_TIMER_ESPRX);
+        esp->queueLen = 0;
+    }
+
+    esp->enabled = enable;
+    ///    After both actions add a delay to allow chip to settle
+    HAL_DelayUS(enable ? 2000000 : 1000000);
+}
+
+/**
+ * Check whether the chip is enabled or disabled
+ */
+bool HAL_ESP_IsHWEnabled()
+{
+    struct _simESP *esp = _SIMESP();
+
+    return esp->enabled;
+}
+
+/**
+ * Enable/disable UART interrupt, enabling it serves interrupt left pending
+ * @param enable
+ */
+void HAL_ESP_IntEnable(bool enable)
+{
+    struct _simESP *esp = _SIMESP();
+
+    esp->intEnabled = enable;
+
+    if (enable && esp->intPending)
+    {
+        esp->intPending = false;
+        HAL_SIM_RaiseInt(esp->intHandler);
+    }
+}
+
+/**
+ * Clear interrupt flags of UART port
+ * @return 0, simulated port has no other interrupt flags
+ */
+int32_t HAL_ESP_ClearInt()
+{
+    return 0;
+}
+
+/**
+ * Initialize watchdog timer for ESP module
+ * @param intHandler function to call when watchdog times out
+ */
+void HAL_ESP_InitWD(void((*intHandler)(void)))
+{
+    struct _simESP *esp = _SIMESP();
+
+    esp->wdHandler = intHandler;
+}
+
+/**
+ * On/Off control for WD timer
+ * @param enable desired state of timer (true-run/false-stop)
+ * @param ms time in millisec. after which the communication is interrupted
+ */
+void HAL_ESP_WDControl(bool enable, uint32_t ms)
+{
+    struct _simESP *esp = _SIMESP();
+
+    //  Record last value for timeout, use it when timeout argument is 0
+    if (ms != 0)
+        esp->wdTimeout = ms;
+
+    HAL_SIM_TimerStop(HAL_SIM_TIMER_ESPWD);
+
+    if (enable)
+        HAL_SIM_TimerStart(HAL_SIM_TIMER_ESPWD, (uint64_t)esp->wdTimeout * 1000,
+                           0, esp->wdHandler);
+}
+
+/**
+ * Called while busy-waiting for the reply of the chip. Virtual clock doesn't
+ * move while the caller spins, so it's moved forward here to the next timer
+ * event, which eventually brings in the reply or times out the watchdog
+ */
+void HAL_ESP_WaitReply()
+{
+    HAL_SIM_WaitEvent();
+}
+
+/**
+ * Stop WD timer and trigger the UART interrupt which handles the timeout, same
+ * as pending the UART interrupt in NVIC on the real board
+ */
+void HAL_ESP_WDClearInt()
+{
+    HAL_SIM_TimerStop(HAL_SIM_TIMER_ESPWD);
+    _SIMESPRaiseInt();
+}
+
+#endif /* __BOARD_POSIX__ && __HAL_USE_ESP8266__ */
@@ -0,0 +1,65 @@
+/**
+ * hal_esp_posix.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ *
+ ****Simulated hardware:
+ *      UART port with 1kB Rx FIFO, data from the chip arrives one line at a
+ *          time at the speed set by baud rate
+ *      CH_PD pin of the chip
+ *      Watchdog timer on the virtual clock
+ *      ESP8266 chip itself is replaced by a model, receiving every character
+ *          sent to it and answering through HAL_SIM_ESPReceive()
+ */
+#include "hwconfig.h"
+
+//  Compile following section only if hwconfig.h says to include this module
+#if !defined(ROVERKERNEL_HAL_POSIX_HAL_ESP_POSIX_H_) && defined(__HAL_USE_ESP8266__)
+#define ROVERKERNEL_HAL_POSIX_HAL_ESP_POSIX_H_
+
+//  Size of Rx FIFO of the UART port and of the queue of data yet to arrive
+#define HAL_SIM_ESP_FIFO        1024
+#define HAL_SIM_ESP_QUEUE       4096
+
+/**
+ * Model of ESP8266 chip
+ */
+struct _simESPModel
+{
+    //  Called for every character sent to the chip, chip answers by calling
+    //  HAL_SIM_ESPReceive()
+    void (*Transmit)(char c);
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+extern bool        HAL_ESP_UARTBusy();
+extern void        HAL_ESP_SendChar(char c);
+extern bool        HAL_ESP_CharAvail();
+extern char        HAL_ESP_GetChar();
+
+extern uint32_t    HAL_ESP_InitPort(uint32_t baud);
+extern void        HAL_ESP_RegisterIntHandler(void((*intHandler)(void)));
+extern void        HAL_ESP_HWEnable(bool enable);
+extern bool        HAL_ESP_IsHWEnabled();
+extern void        HAL_ESP_IntEnable(bool enable);
+extern int32_t     HAL_ESP_ClearInt();
+extern void        HAL_ESP_InitWD(void((*intHandler)(void)));
+extern void        HAL_ESP_WDControl(bool enable, uint32_t timeout);
+extern void        HAL_ESP_WDClearInt();
+extern void        HAL_ESP_WaitReply();
+
+extern void        HAL_SIM_ESPSetModel(const struct _simESPModel *model);
+extern void        HAL_SIM_ESPReceive(const char *data, uint16_t len,
+                                      uint32_t delayUS);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* ROVERKERNEL_HAL_POSIX_HAL_ESP_POSIX_H_ */
@@ -0,0 +1,304 @@
+/**
+ * hal_mpu_posix.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran
+ */
+#include "hal_mpu_posix.h"
+
+#if defined(__BOARD_POSIX__) && defined(__HAL_USE_MPU9250__)
+
+#include "HAL/posix/hal_common_posix.h"
+
+//  Bus addresses and ID registers of MPU9250 and its magnetometer
+#define HAL_SIM_MPU_ADDR        0x68
+#define HAL_SIM_MPU_WHOAMI      0x75
+#define HAL_SIM_MAG_ADDR        0x0C
+#define HAL_SIM_MAG_WHOAMI      0x00
+
+//  Registers of MPU9250 FIFO, and its size (in bytes)
+#define HAL_SIM_MPU_FIFO_EN     0x23
+#define HAL_SIM_MPU_USER_CTRL   0x6A
+#define HAL_SIM_MPU_FIFO_COUNTH 0x72
+#define HAL_SIM_MPU_FIFO_COUNTL 0x73
+#define HAL_SIM_MPU_FIFO_R_W    0x74
+#define HAL_SIM_MPU_FIFO_SIZE   512
+//  FIFO is filled at 1kHz, one sample of accelerometer and gyroscope is 12B
+#define HAL_SIM_MPU_FIFO_US     1000
+#define HAL_SIM_MPU_SAMPLE      12
+
+//  Sample pushed into FIFO: sensor at rest, 1g on Z axis at +/-2g full scale
+static const uint8_t _mpuRestSample[HAL_SIM_MPU_SAMPLE] =
+        { 0x00, 0x00, 0x00, 0x00, 0x40, 0x00,   // Accelerometer X, Y, Z
+          0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }; // Gyroscope X, Y, Z
+
+static uint8_t _SIMMPUDefRead(uint8_t address, uint8_t reg);
+static void _SIMMPUDefWrite(uint8_t address, uint8_t reg, uint8_t data);
+static bool _SIMMPUDefDataAvail(void);
+
+///  Default model is a register file, keeping whatever was written into it
+static const struct _simMPUModel _mpuDefModel =
+        { _SIMMPUDefRead, _SIMMPUDefWrite, _SIMMPUDefDataAvail };
+
+/**
+ * Sensor and its register files used by default model
+ */
+struct _simMPU
+{
+    const struct _simMPUModel *model;
+    uint8_t     mpuRegs[256];
+    uint8_t     magRegs[256];
+    bool        powered;
+    ///  FIFO: bytes in it, virtual time it was last filled up to and number
+    ///  of bytes read from it since reset
+    uint16_t    fifoCount;
+    uint64_t    fifoSince;
+    uint32_t    fifoRead;
+};
+static const struct _simMPU _mpuInit = { .model = &_mpuDefModel };
+
+/**
+ * Get MPU sensor of the selected board
+ * @return pointer to the state of the sensor
+ */
+static struct _simMPU* _SIMMPU()
+{
+    return (struct _simMPU*)HAL_SIM_State(HAL_SIM_PART_MPU,
+                                          sizeof(struct _simMPU), &_mpuInit);
+}
+
+/**
+ * Get register file of the device on given bus address
+ * @param address bus address of the device
+ * @return pointer to register file, 0 if there is no such device
+ */
+static uint8_t* _SIMMPURegs(uint8_t address)
+{
+    struct _simMPU *mpu = _SIMMPU();
+
+    if (address == HAL_SIM_MPU_ADDR)
+        return mpu->mpuRegs;
+    else if (address == HAL_SIM_MAG_ADDR)
+        return mpu->magRegs;
+
+    return 0;
+}
+
+/**
+ * Bring FIFO of MPU9250 up to current time. While accelerometer and gyroscope
+ * are enabled in FIFO_EN register, FIFO gains a sample every millisecond until
+ * it's full
+ * @param mpu sensor to update
+ */
+static void _SIMMPUFifoFill(struct _simMPU *mpu)
+{
+    uint64_t now = HAL_SIM_GetTimeUS();
+    uint64_t samples;
+
+    if (mpu->mpuRegs[HAL_SIM_MPU_FIFO_EN] == 0)
+    {
+        mpu->fifoSince = now;
+        return;
+    }
+
+    samples = (now - mpu->fifoSince) / HAL_SIM_MPU_FIFO_US;
+    mpu->fifoSince += samples * HAL_SIM_MPU_FIFO_US;
+
+    if ((mpu->fifoCount + samples * HAL_SIM_MPU_SAMPLE) > HAL_SIM_MPU_FIFO_SIZE)
+        mpu->fifoCount = HAL_SIM_MPU_FIFO_SIZE;
+    else
+        mpu->fifoCount += samples * HAL_SIM_MPU_SAMPLE;
+}
+
+static uint8_t _SIMMPUDefRead(uint8_t address, uint8_t reg)
+{
+    struct _simMPU *mpu = _SIMMPU();
+    uint8_t *regs = _SIMMPURegs(address);
+
+    if (regs == 0)
+        return 0xFF;
+
+    if (address == HAL_SIM_MPU_ADDR)
+    {
+        _SIMMPUFifoFill(mpu);
+
+        if (reg == HAL_SIM_MPU_FIFO_COUNTH)
+            return (uint8_t)(mpu->fifoCount >> 8);
+        else if (reg == HAL_SIM_MPU_FIFO_COUNTL)
+            return (uint8_t)(mpu->fifoCount & 0xFF);
+        else if (reg == HAL_SIM_MPU_FIFO_R_W)
+        {
+            ///  Empty FIFO keeps returning the last byte that was read
+            if (mpu->fifoCount == 0)
+                return _mpuRestSample[(mpu->fifoRead + HAL_SIM_MPU_SAMPLE - 1)
+                                      % HAL_SIM_MPU_SAMPLE];
+
+            mpu->fifoCount--;
+            return _mpuRestSample[(mpu->fifoRead++) % HAL_SIM_MPU_SAMPLE];
+        }
+    }
+
+    return regs[reg];
+}
+
+static void _SIMMPUDefWrite(uint8_t address, uint8_t reg, uint8_t data)
+{
+    struct _simMPU *mpu = _SIMMPU();
+    uint8_t *regs = _SIMMPURegs(address);
+
+    ///  ID registers are read-only
+    if ((regs == 0) || ((address == HAL_SIM_MPU_ADDR) && (reg == HAL_SIM_MPU_WHOAMI))
+        || ((address == HAL_SIM_MAG_ADDR) && (reg == HAL_SIM_MAG_WHOAMI)))
+        return;
+
+    ///  Samples collected so far belong to the old setting of FIFO_EN
+    if (address == HAL_SIM_MPU_ADDR)
+        _SIMMPUFifoFill(mpu);
+
+    regs[reg] = data;
+
+    ///  Bit 2 of USER_CTRL resets FIFO
+    if ((address == HAL_SIM_MPU_ADDR) && (reg == HAL_SIM_MPU_USER_CTRL)
+        && (data & 0x04))
+    {
+        mpu->fifoCount = 0;
+        mpu->fifoRead = 0;
+    }
+}
+
+static bool _SIMMPUDefDataAvail(void)
+{
+    return true;
+}
+
+/**
+ * Replace model of MPU9250 sensor
+ * @param model new model to use, 0 to use the default one
+ */
+void HAL_SIM_MPUSetModel(const struct _simMPUModel *model)
+{
+    struct _simMPU *mpu = _SIMMPU();
+
+    if (model == 0)
+        mpu->model = &_mpuDefModel;
+    else
+        mpu->model = model;
+}
+
+/**
+ * Initialize bus to the sensor, resets default model to its power-on state
+ */
+void HAL_MPU_Init()
+{
+    struct _simMPU *mpu = _SIMMPU();
+    uint16_t i;
+
+    for (i = 0; i < 256; i++)
+    {
+        mpu->mpuRegs[i] = 0;
+        mpu->magRegs[i] = 0;
+    }
+    mpu->fifoCount = 0;
+    mpu->fifoSince = HAL_SIM_GetTimeUS();
+    mpu->fifoRead = 0;
+    mpu->mpuRegs[HAL_SIM_MPU_WHOAMI] = 0x71;
+    mpu->magRegs[HAL_SIM_MAG_WHOAMI] = 0x48;
+}
+
+/**
+ * Turn sensor power on or off
+ * @param powerState new state of the power
+ */
+void HAL_MPU_PowerSwitch(bool powerState)
+{
+    struct _simMPU *mpu = _SIMMPU();
+
+    mpu->powered = powerState;
+}
+
+/**
+ * Check state of data-ready pin of the sensor
+ * @return true if new data is available, false otherwise
+ */
+bool HAL_MPU_DataAvail()
+{
+    struct _simMPU *mpu = _SIMMPU();
+
+    return mpu->powered && (mpu->model->DataAvail != 0)
+           && mpu->model->DataAvail();
+}
+
+/**
+ * Write single register of the device on the bus
+ * @param I2Caddress bus address of the device
+ * @param regAddress address of the register
+ * @param data value to write
+ */
+void HAL_MPU_WriteByte(uint8_t I2Caddress, uint8_t regAddress, uint8_t data)
+{
+    struct _simMPU *mpu = _SIMMPU();
+
+    if (mpu->powered && (mpu->model->Write != 0))
+        mpu->model->Write(I2Caddress, regAddress, data);
+}
+
+/**
+ * Write consecutive registers of the device on the bus
+ * @param I2Caddress bus address of the device
+ * @param regAddress address of the first register
+ * @param length number of registers to write
+ * @param data values to write
+ * @return 0 on success
+ */
+uint8_t HAL_MPU_WriteBytes(uint8_t I2Caddress, uint8_t regAddress,
+                           uint16_t length, uint8_t *data)
+{
+    uint16_t i;
+
+    for (i = 0; i < length; i++)
+        HAL_MPU_WriteByte(I2Caddress, regAddress + i, data[i]);
+
+    return 0;
+}
+
+/**
+ * Read single register of the device on the bus
+ * @param I2Caddress bus address of the device
+ * @param regAddress address of the register
+ * @return value of the register, 0xFF if device doesn't respond
+ */
+uint8_t HAL_MPU_ReadByte(uint8_t I2Caddress, uint8_t regAddress)
+{
+    struct _simMPU *mpu = _SIMMPU();
+
+    if (!mpu->powered || (mpu->model->Read == 0))
+        return 0xFF;
+
+    return mpu->model->Read(I2Caddress, regAddress);
+}
+
+/**
+ * Read consecutive registers of the device on the bus. Like on the sensor,
+ * reading FIFO_R_W register doesn't move to the next register, it reads
+ * consecutive bytes from FIFO instead
+ * @param I2Caddress bus address of the device
+ * @param regAddress address of the first register
+ * @param length number of registers to read
+ * @param data buffer to read values into
+ * @return 0 on success
+ */
+uint8_t HAL_MPU_ReadBytes(uint8_t I2Caddress, uint8_t regAddress,
+                          uint16_t length, uint8_t* data)
+{
+    uint16_t i;
+
+    for (i = 0; i < length; i++)
+        if ((I2Caddress == HAL_SIM_MPU_ADDR) && (regAddress == HAL_SIM_MPU_FIFO_R_W))
+            data[i] = HAL_MPU_ReadByte(I2Caddress, regAddress);
+        else
+            data[i] = HAL_MPU_ReadByte(I2Caddress, regAddress + i);
+
+    return 0;
+}
+
+#endif /* __BOARD_POSIX__ && __HAL_USE_MPU9250__ */
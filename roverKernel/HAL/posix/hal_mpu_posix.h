@@ -0,0 +1,53 @@
+/**
+ * hal_mpu_posix.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ *
+ ****Simulated hardware:
+ *      Bus to MPU9250 (register reads/writes are passed to the model)
+ *      Power switch of the sensor and its data-ready pin
+ *      MPU9250 itself is replaced by a model, by default a register file of
+ *          both MPU9250 and its AK8963 magnetometer with ID registers preset,
+ *          and FIFO filling at 1kHz with samples of a sensor lying still
+ */
+#include "hwconfig.h"
+
+//  Compile following section only if hwconfig.h says to include this module
+#if !defined(ROVERKERNEL_HAL_POSIX_HAL_MPU_POSIX_H_) && defined(__HAL_USE_MPU9250__)
+#define ROVERKERNEL_HAL_POSIX_HAL_MPU_POSIX_H_
+
+/**
+ * Model of MPU9250 sensor
+ */
+struct _simMPUModel
+{
+    //  Read single register of the device on given bus address
+    uint8_t (*Read)(uint8_t address, uint8_t reg);
+    //  Write single register of the device on given bus address
+    void (*Write)(uint8_t address, uint8_t reg, uint8_t data);
+    //  State of data-ready pin
+    bool (*DataAvail)(void);
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    extern void     HAL_MPU_Init();
+    extern void     HAL_MPU_PowerSwitch(bool powerState);
+    extern bool     HAL_MPU_DataAvail();
+    extern void     HAL_MPU_WriteByte(uint8_t I2Caddress, uint8_t regAddress,
+                                      uint8_t data);
+    extern uint8_t  HAL_MPU_WriteBytes(uint8_t I2Caddress, uint8_t regAddress,
+                                       uint16_t length, uint8_t *data);
+    extern uint8_t  HAL_MPU_ReadByte(uint8_t I2Caddress, uint8_t regAddress);
+    extern uint8_t  HAL_MPU_ReadBytes(uint8_t I2Caddress, uint8_t regAddress,
+                                      uint16_t length, uint8_t* data);
+
+    extern void     HAL_SIM_MPUSetModel(const struct _simMPUModel *model);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ROVERKERNEL_HAL_POSIX_HAL_MPU_POSIX_H_ */
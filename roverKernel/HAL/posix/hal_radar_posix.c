@@ -0,0 +1,152 @@
+/**
+ * hal_radar_posix.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran
+ */
+#include "hal_radar_posix.h"
+
+#if defined(__BOARD_POSIX__) && defined(__HAL_USE_RADAR__)
+
+#include "HAL/posix/hal_common_posix.h"
+
+//  ADC reading returned by default model, obstacle at roughly 40cm
+#define HAL_SIM_RAD_DEFAULT     1000
+
+static uint32_t _SIMRadDefMeasure(float horAngle, float verAngle);
+
+///  Default model sees the same distance in every direction
+static const struct _simRadarModel _radDefModel = { _SIMRadDefMeasure };
+
+/**
+ * Gimbal and IR sensor of radar
+ */
+struct _simRadar
+{
+    const struct _simRadarModel *model;
+    float       horAngle;
+    float       verAngle;
+    bool        enabled;
+};
+static const struct _simRadar _radInit = { .model = &_radDefModel };
+
+/**
+ * Get radar of the selected board
+ * @return pointer to the state of radar
+ */
+static struct _simRadar* _SIMRadar()
+{
+    return (struct _simRadar*)HAL_SIM_State(HAL_SIM_PART_RADAR,
+                                            sizeof(struct _simRadar),
+                                            &_radInit);
+}
+
+static uint32_t _SIMRadDefMeasure(float horAngle, float verAngle)
+{
+    (void)horAngle;
+    (void)verAngle;
+    return HAL_SIM_RAD_DEFAULT;
+}
+
+/**
+ * Replace model of surroundings seen by radar
+ * @param model new model to use, 0 to use the default one
+ */
+void HAL_SIM_RadarSetModel(const struct _simRadarModel *model)
+{
+    struct _simRadar *rad = _SIMRadar();
+
+    if (model == 0)
+        rad->model = &_radDefModel;
+    else
+        rad->model = model;
+}
+
+/**
+ * Initialize hardware used by radar
+ */
+void HAL_RAD_Init()
+{
+    struct _simRadar *rad = _SIMRadar();
+
+    rad->horAngle = 0.0f;
+    rad->verAngle = 0.0f;
+}
+
+/**
+ * Enable or disable servos of radar gimbal
+ * @param enable new state of the servos
+ */
+void HAL_RAD_Enable(bool enable)
+{
+    struct _simRadar *rad = _SIMRadar();
+
+    rad->enabled = enable;
+}
+
+/**
+ * Set vertical(up-down) angle of radar gimbal
+ * @param angle to move vertical joint to; 0°(up) to 160° (down)
+ */
+void HAL_RAD_SetVerAngle(float angle)
+{
+    struct _simRadar *rad = _SIMRadar();
+
+    if ((angle > 160.0f) || (angle < 0.0f)) return;
+
+    rad->verAngle = angle;
+}
+
+/**
+ * Get current vertical(up-down) angle of radar gimbal
+ * @return angle in range of 0° to 160°
+ */
+float HAL_RAD_GetVerAngle()
+{
+    struct _simRadar *rad = _SIMRadar();
+
+    return rad->verAngle;
+}
+
+/**
+ * Set horizontal(left-right) angle of radar gimbal
+ * @param angle to move horizontal joint to; 0°(right) to 160° (left)
+ */
+void HAL_RAD_SetHorAngle(float angle)
+{
+    struct _simRadar *rad = _SIMRadar();
+
+    if ((angle > 160.0f) || (angle < 0.0f)) return;
+
+    rad->horAngle = angle;
+}
+
+/**
+ * Get current horizontal angle of radar gimbal
+ * @return angle in range of 0° to 160°
+ */
+float HAL_RAD_GetHorAngle()
+{
+    struct _simRadar *rad = _SIMRadar();
+
+    return rad->horAngle;
+}
+
+/**
+ * Trigger ADC conversion of IR sensor reading
+ * @return 12-bit analog value of distance measured by IR sensor
+ */
+uint32_t HAL_RAD_ADCTrigger()
+{
+    struct _simRadar *rad = _SIMRadar();
+    uint32_t retVal;
+
+    if (!rad->enabled || (rad->model->Measure == 0))
+        return 0;
+
+    retVal = rad->model->Measure(rad->horAngle, rad->verAngle);
+
+    return (retVal > 4095) ? 4095 : retVal;
+}
+
+#endif /* __BOARD_POSIX__ && __HAL_USE_RADAR__ */
@@ -0,0 +1,47 @@
+/**
+ * hal_radar_posix.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ *
+ ****Simulated hardware:
+ *      Two servos of radar gimbal, moving instantly to set angle
+ *      ADC reading IR distance sensor, value is provided by the model of the
+ *          surroundings of the rover based on orientation of the gimbal
+ */
+#include "hwconfig.h"
+
+//  Compile following section only if hwconfig.h says to include this module
+#if !defined(ROVERKERNEL_HAL_POSIX_HAL_RADAR_POSIX_H_) && defined(__HAL_USE_RADAR__)
+#define ROVERKERNEL_HAL_POSIX_HAL_RADAR_POSIX_H_
+
+/**
+ * Model of surroundings seen by radar
+ */
+struct _simRadarModel
+{
+    //  Get 12-bit ADC reading of IR sensor for given gimbal orientation (in
+    //  degrees, same range as HAL_RAD_SetHorAngle/HAL_RAD_SetVerAngle)
+    uint32_t (*Measure)(float horAngle, float verAngle);
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+extern void        HAL_RAD_SetVerAngle(float angle);
+extern float       HAL_RAD_GetVerAngle();
+extern void        HAL_RAD_SetHorAngle(float angle);
+extern float       HAL_RAD_GetHorAngle();
+extern void        HAL_RAD_Init();
+extern void        HAL_RAD_Enable(bool enable);
+extern uint32_t    HAL_RAD_ADCTrigger();
+
+extern void        HAL_SIM_RadarSetModel(const struct _simRadarModel *model);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ROVERKERNEL_HAL_POSIX_HAL_RADAR_POSIX_H_ */
@@ -0,0 +1,440 @@
+/**
+ * hal_sim_posix.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran
+ */
+#include "hal_sim_posix.h"
+
+#if defined(__BOARD_POSIX__)
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "HAL/posix/hal_common_posix.h"
+
+/**
+ * Hardware timer, counting on the virtual clock
+ */
+struct _simTimer
+{
+    bool        running;
+    //  Virtual time at which timer expires (in us)
+    uint64_t    expiry;
+    //  Reload value of periodic timer, 0 for one-shot (in us)
+    uint64_t    period;
+    void((*isr)(void));
+};
+
+/**
+ * Clock, timers and interrupts of a simulated board
+ */
+struct _simCore
+{
+    ///  Virtual time since startup (in us)
+    uint64_t            timeUS;
+    struct _simTimer    timers[HAL_SIM_TIMERS];
+    ///  State of interrupts, disabled out of reset until board is initialized
+    bool                intEnabled;
+    ///  Set while an interrupt handler is running, interrupts don't nest
+    bool                inISR;
+    ///  Interrupts raised while they couldn't be served, in order of arrival
+    void((*pending[HAL_SIM_PENDING])(void));
+    uint8_t             pendingN;
+    uint64_t            pendingSince;
+    ///  Real time of the host (in ns) at which interrupts were disabled, 0 if
+    ///  they haven't been enabled since reset
+    uint64_t            intOffSince;
+    struct _simStats    stats;
+};
+
+/**
+ * Simulated board, made of parts allocated on their first use
+ */
+struct _simBoard
+{
+    void    *parts[HAL_SIM_PARTS];
+    ///  Called with state of the part before board is deleted, 0 if none
+    void((*release[HAL_SIM_PARTS])(void *state));
+};
+
+///  Board used until the thread selects another one
+static struct _simBoard _defBoard;
+///  Board selected by the calling thread, 0 for the default one
+static HAL_THREAD_LOCAL struct _simBoard *_board = 0;
+
+/**
+ * Get clock, timers and interrupts of the selected board
+ * @return pointer to the core of the board
+ */
+static struct _simCore* _SIMCore()
+{
+    return (struct _simCore*)HAL_SIM_State(HAL_SIM_PART_CORE,
+                                           sizeof(struct _simCore), 0);
+}
+
+/**
+ * Run all pending interrupt handlers, if interrupts are enabled and no other
+ * handler is running at the moment
+ */
+static void _SIMDispatch()
+{
+    struct _simCore *core = _SIMCore();
+
+    while (core->intEnabled && !core->inISR && (core->pendingN > 0))
+    {
+        void((*isr)(void)) = core->pending[0];
+        uint8_t i;
+
+        for (i = 1; i < core->pendingN; i++)
+            core->pending[i-1] = core->pending[i];
+        core->pendingN--;
+
+        if ((core->timeUS - core->pendingSince) > core->stats.maxIntLatency)
+            core->stats.maxIntLatency =
+                    (uint32_t)(core->timeUS - core->pendingSince);
+        core->pendingSince = core->timeUS;
+
+        core->inISR = true;
+        isr();
+        core->inISR = false;
+        core->stats.interrupts++;
+    }
+}
+
+/**
+ * Create new board, powered up as out of reset
+ * @return pointer to the board, 0 if out of memory
+ */
+struct _simBoard* HAL_SIM_NewBoard()
+{
+    return (struct _simBoard*)calloc(1, sizeof(struct _simBoard));
+}
+
+/**
+ * Delete a board created by HAL_SIM_NewBoard()
+ * @param board board to delete, mustn't be selected by any thread
+ */
+void HAL_SIM_DeleteBoard(struct _simBoard *board)
+{
+    uint8_t i;
+
+    if ((board == 0) || (board == &_defBoard))
+        return;
+
+    for (i = 0; i < HAL_SIM_PARTS; i++)
+    {
+        if ((board->parts[i] != 0) && (board->release[i] != 0))
+            board->release[i](board->parts[i]);
+        free(board->parts[i]);
+    }
+    free(board);
+}
+
+/**
+ * Select board to work on from the calling thread. Board can be selected by
+ * one thread at a time, but any thread can select it.
+ * @param board board to select, 0 for the default one
+ */
+void HAL_SIM_SelectBoard(struct _simBoard *board)
+{
+    _board = board;
+}
+
+/**
+ * Get state of a part of the selected board. State is allocated and set to its
+ * initial value on the first use of the part
+ * @param part ID of the part (one of HAL_SIM_PART_x)
+ * @param size size of the state
+ * @param init initial value of the state, 0 to start from all zeros
+ * @return pointer to the state
+ */
+void* HAL_SIM_State(uint8_t part, uint16_t size, const void *init)
+{
+    struct _simBoard *board = (_board != 0) ? _board : &_defBoard;
+
+    if (board->parts[part] == 0)
+    {
+        board->parts[part] = calloc(1, size);
+        if ((board->parts[part] != 0) && (init != 0))
+            memcpy(board->parts[part], init, size);
+    }
+
+    return board->parts[part];
+}
+
+/**
+ * Set function releasing whatever state of a part of the selected board holds
+ * on to (e.g. memory it allocated), called when the board is deleted
+ * @param part ID of the part (one of HAL_SIM_PART_x)
+ * @param release function to call with state of the part, 0 for none
+ */
+void HAL_SIM_OnDelete(uint8_t part, void((*release)(void *state)))
+{
+    struct _simBoard *board = (_board != 0) ? _board : &_defBoard;
+
+    board->release[part] = release;
+}
+
+/**
+ * Get statistics of the selected board
+ * @return pointer to the statistics
+ */
+struct _simStats* HAL_SIM_GetStats()
+{
+    return &(_SIMCore()->stats);
+}
+
+/**
+ * Get current value of virtual clock
+ * @return virtual time since startup (in us)
+ */
+uint64_t HAL_SIM_GetTimeUS()
+{
+    struct _simCore *core = _SIMCore();
+
+    return core->timeUS;
+}
+
+/**
+ * Move virtual clock forward, raising interrupts of all timers expiring in
+ * between, in the order of their expiry
+ * @param us amount of time to advance clock by (in us)
+ */
+void HAL_SIM_Advance(uint64_t us)
+{
+    struct _simCore *core = _SIMCore();
+    uint64_t target = core->timeUS + us;
+
+    while (1)
+    {
+        int8_t next = -1;
+        uint8_t i;
+
+        ///  Find timer expiring first, but not after the target time
+        for (i = 0; i < HAL_SIM_TIMERS; i++)
+            if (core->timers[i].running && (core->timers[i].expiry <= target))
+                if ((next < 0)
+                    || (core->timers[i].expiry < core->timers[next].expiry))
+                    next = i;
+
+        if (next < 0)
+            break;
+
+        if (core->timers[next].expiry > core->timeUS)
+            core->timeUS = core->timers[next].expiry;
+
+        ///  Reload periodic timer or stop one-shot one before calling its
+        ///  handler, as handler might restart it
+        if (core->timers[next].period > 0)
+            core->timers[next].expiry += core->timers[next].period;
+        else
+            core->timers[next].running = false;
+
+        HAL_SIM_RaiseInt(core->timers[next].isr);
+    }
+
+    core->timeUS = target;
+}
+
+/**
+ * Move virtual clock forward to the first timer to expire, or by 1ms if no
+ * timer is running so the caller doesn't spin in place. Returns immediately
+ * if an interrupt is already pending.
+ * @return amount of time (in us) clock was moved by
+ */
+uint64_t HAL_SIM_WaitEvent()
+{
+    struct _simCore *core = _SIMCore();
+    uint64_t next = core->timeUS + 1000;
+    bool found = false;
+    uint8_t i;
+
+    if (core->pendingN > 0)
+        return 0;
+
+    for (i = 0; i < HAL_SIM_TIMERS; i++)
+        if (core->timers[i].running
+            && (!found || (core->timers[i].expiry < next)))
+        {
+            next = core->timers[i].expiry;
+            found = true;
+        }
+
+    if (next < core->timeUS)
+        next = core->timeUS;
+
+    next -= core->timeUS;
+    HAL_SIM_Advance(next);
+
+    return next;
+}
+
+/**
+ * Put processor to sleep until the next interrupt
+ */
+void HAL_SIM_Sleep()
+{
+    struct _simCore *core = _SIMCore();
+
+    core->stats.wakeups++;
+    core->stats.sleepUS += HAL_SIM_WaitEvent();
+}
+
+/**
+ * Start (or restart) a hardware timer
+ * @param id ID of the timer (one of HAL_SIM_TIMER_x)
+ * @param us time (in us) from now until timer expires
+ * @param period reload time (in us) of periodic timer, 0 for one-shot timer
+ * @param isr interrupt handler to call when timer expires
+ */
+void HAL_SIM_TimerStart(uint8_t id, uint64_t us, uint64_t period,
+                        void((*isr)(void)))
+{
+    struct _simCore *core = _SIMCore();
+
+    if (id >= HAL_SIM_TIMERS)
+        return;
+
+    core->timers[id].expiry = core->timeUS + us;
+    core->timers[id].period = period;
+    core->timers[id].isr = isr;
+    core->timers[id].running = true;
+}
+
+/**
+ * Stop a hardware timer
+ * @param id ID of the timer (one of HAL_SIM_TIMER_x)
+ */
+void HAL_SIM_TimerStop(uint8_t id)
+{
+    struct _simCore *core = _SIMCore();
+
+    if (id < HAL_SIM_TIMERS)
+        core->timers[id].running = false;
+}
+
+/**
+ * Check whether a hardware timer is running
+ * @param id ID of the timer (one of HAL_SIM_TIMER_x)
+ * @return true if timer is running, false otherwise
+ */
+bool HAL_SIM_TimerRunning(uint8_t id)
+{
+    struct _simCore *core = _SIMCore();
+
+    return (id < HAL_SIM_TIMERS) && core->timers[id].running;
+}
+
+/**
+ * Get virtual time at which running timer expires next
+ * @param id ID of the timer (one of HAL_SIM_TIMER_x)
+ * @return expiry time (in us) or 0 if timer isn't running
+ */
+uint64_t HAL_SIM_TimerExpiry(uint8_t id)
+{
+    struct _simCore *core = _SIMCore();
+
+    if (!HAL_SIM_TimerRunning(id))
+        return 0;
+
+    return core->timers[id].expiry;
+}
+
+/**
+ * Raise an interrupt. Handler is called right away when possible, otherwise
+ * it's left pending until interrupts are enabled again. Same as with NVIC,
+ * interrupt which is already pending is not queued for the second time.
+ * @param isr interrupt handler to call
+ */
+void HAL_SIM_RaiseInt(void((*isr)(void)))
+{
+    struct _simCore *core = _SIMCore();
+    uint8_t i;
+
+    if (isr == 0)
+        return;
+
+    for (i = 0; i < core->pendingN; i++)
+        if (core->pending[i] == isr)
+            return;
+
+    if (core->pendingN >= HAL_SIM_PENDING)
+        return;
+
+    if (core->pendingN == 0)
+        core->pendingSince = core->timeUS;
+    core->pending[core->pendingN++] = isr;
+
+    _SIMDispatch();
+}
+
+/**
+ * Check whether an interrupt is raised but its handler hasn't been called yet,
+ * same as reading raw interrupt status of a peripheral
+ * @param isr interrupt handler of the interrupt
+ * @return true if interrupt is pending, false otherwise
+ */
+bool HAL_SIM_IntPending(void((*isr)(void)))
+{
+    struct _simCore *core = _SIMCore();
+    uint8_t i;
+
+    for (i = 0; i < core->pendingN; i++)
+        if (core->pending[i] == isr)
+            return true;
+
+    return false;
+}
+
+/**
+ * Enable or disable interrupts, enabling them serves all pending interrupts
+ * @param enabled new state of interrupts
+ */
+void HAL_SIM_SetIntState(bool enabled)
+{
+    struct _simCore *core = _SIMCore();
+    struct timespec now;
+
+    ///  Measure time spent with interrupts disabled
+    if (enabled != core->intEnabled)
+    {
+        uint64_t nowNS;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        nowNS = (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+
+        if (!enabled)
+            core->intOffSince = nowNS;
+        else if ((core->intOffSince != 0) &&
+                 ((nowNS - core->intOffSince) > core->stats.maxIntOffNS))
+            core->stats.maxIntOffNS = (uint32_t)(nowNS - core->intOffSince);
+    }
+
+    core->intEnabled = enabled;
+    _SIMDispatch();
+}
+
+/**
+ * Get current state of interrupts
+ * @return true if interrupts are enabled, false otherwise
+ */
+bool HAL_SIM_GetIntState()
+{
+    struct _simCore *core = _SIMCore();
+
+    return core->intEnabled;
+}
+
+/**
+ * Check whether the code is running from an interrupt handler
+ * @return true if called from interrupt handler, false otherwise
+ */
+bool HAL_SIM_InInterrupt()
+{
+    struct _simCore *core = _SIMCore();
+
+    return core->inISR;
+}
+
+#endif /* __BOARD_POSIX__ */
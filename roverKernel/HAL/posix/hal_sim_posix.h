@@ -0,0 +1,112 @@
+/**
+ * hal_sim_posix.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ *
+ *  Core of the POSIX board, used to run the kernel as a normal process on a
+ *  Linux host. Instead of real time, all simulated peripherals share a virtual
+ *  clock (in us) which only moves forward when the kernel waits for something:
+ *  delays, processor sleep or waiting on a reply from ESP chip. Because of that
+ *  a run is fully repeatable, and minutes of rover time take a fraction of a
+ *  second.
+ *  Hardware timers are events on the virtual clock. Once the clock passes one,
+ *  its interrupt handler is called, immediately if interrupts are enabled or
+ *  as soon as they get enabled again.
+ *  Devices connected to the board (ESP chip, MPU sensor, radar, engine
+ *  encoders) are represented by models which can be replaced through
+ *  HAL_SIM_xxxSetModel() functions to test specific scenarios.
+ *  All of the above makes up one simulated board. Process starts with a single
+ *  (default) board, more of them can be created to run several kernels side by
+ *  side. Each thread works on the board it has selected, state of simulated
+ *  peripherals (clock, timers, models...) is kept separately for every board.
+ */
+#include "hwconfig.h"
+
+//  Compile following section only if POSIX board is selected in hwconfig.h
+#if !defined(ROVERKERNEL_HAL_POSIX_HAL_SIM_POSIX_H_) && defined(__BOARD_POSIX__)
+#define ROVERKERNEL_HAL_POSIX_HAL_SIM_POSIX_H_
+
+//  Clock frequency of the simulated microcontroller (same as TM4C1294)
+#define HAL_SIM_CLOCK           120000000
+
+//  IDs of the simulated hardware timers
+#define HAL_SIM_TIMER_SYSTICK   0   /// Time step of task scheduler
+#define HAL_SIM_TIMER_WAKEUP    1   /// Wake-up timer of tickless scheduler
+#define HAL_SIM_TIMER_ESPWD     2   /// Watchdog of ESP UART port
+#define HAL_SIM_TIMER_ESPRX     3   /// Arrival of data from ESP chip
+#define HAL_SIM_TIMER_ENC0      4   /// Encoder of left engine
+#define HAL_SIM_TIMER_ENC1      5   /// Encoder of right engine
+#define HAL_SIM_TIMER_TIMEBASE  6   /// Overflow of time base counter
+#define HAL_SIM_TIMERS          7
+
+//  Max number of interrupts waiting for interrupts to be enabled
+#define HAL_SIM_PENDING         8
+
+//  Parts of the board keeping their own state, see HAL_SIM_State()
+#define HAL_SIM_PART_CORE       0   /// Clock, timers and interrupts
+#define HAL_SIM_PART_PWM        1   /// Generic PWM outputs
+#define HAL_SIM_PART_TS         2   /// SysTick and time base of scheduler
+#define HAL_SIM_PART_ENG        3
+#define HAL_SIM_PART_ESP        4
+#define HAL_SIM_PART_MPU        5
+#define HAL_SIM_PART_RADAR      6
+#define HAL_SIM_PART_STOR       7
+#define HAL_SIM_PARTS           8
+
+/**
+ * Statistics of the simulated board
+ */
+struct _simStats
+{
+    //  Number of times processor was woken up from sleep
+    uint32_t wakeups;
+    //  Total virtual time spent sleeping (in us)
+    uint64_t sleepUS;
+    //  Number of executed interrupt handlers
+    uint32_t interrupts;
+    //  Longest time an interrupt had to wait for interrupts to be enabled (in us)
+    uint32_t maxIntLatency;
+    //  Longest time interrupts were kept disabled, measured in real time of the
+    //  host (in ns) as virtual time doesn't move while kernel code runs
+    uint32_t maxIntOffNS;
+};
+
+//  Simulated board, contents are private to the simulator
+struct _simBoard;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//  Statistics of the board selected by the calling thread
+#define HAL_SIM_Stats       (*HAL_SIM_GetStats())
+
+extern struct _simBoard* HAL_SIM_NewBoard();
+extern void        HAL_SIM_DeleteBoard(struct _simBoard *board);
+extern void        HAL_SIM_SelectBoard(struct _simBoard *board);
+extern void*       HAL_SIM_State(uint8_t part, uint16_t size, const void *init);
+extern void        HAL_SIM_OnDelete(uint8_t part, void((*release)(void *state)));
+extern struct _simStats* HAL_SIM_GetStats();
+
+extern uint64_t    HAL_SIM_GetTimeUS();
+extern void        HAL_SIM_Advance(uint64_t us);
+extern uint64_t    HAL_SIM_WaitEvent();
+extern void        HAL_SIM_Sleep();
+extern void        HAL_SIM_TimerStart(uint8_t id, uint64_t us, uint64_t period,
+                                      void((*isr)(void)));
+extern void        HAL_SIM_TimerStop(uint8_t id);
+extern bool        HAL_SIM_TimerRunning(uint8_t id);
+extern uint64_t    HAL_SIM_TimerExpiry(uint8_t id);
+extern void        HAL_SIM_RaiseInt(void((*isr)(void)));
+extern bool        HAL_SIM_IntPending(void((*isr)(void)));
+extern void        HAL_SIM_SetIntState(bool enabled);
+extern bool        HAL_SIM_GetIntState();
+extern bool        HAL_SIM_InInterrupt();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ROVERKERNEL_HAL_POSIX_HAL_SIM_POSIX_H_ */
@@ -0,0 +1,209 @@
+/**
+ * hal_stor_posix.c
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran
+ */
+#include "hal_stor_posix.h"
+
+#if defined(__BOARD_POSIX__) && defined(__HAL_USE_STORAGE__)
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "HAL/posix/hal_common_posix.h"
+
+//  Size of storage region in bytes
+#define HAL_STOR_SIZE   (HAL_STOR_SECTOR_SIZE * HAL_STOR_SECTORS)
+
+/**
+ * Flash region of the board
+ */
+struct _simStor
+{
+    //  Content of storage, 0 until storage is first used
+    uint8_t     *mem;
+    //  True if content is a file mapped into memory, allocated otherwise
+    bool        mapped;
+    //  Virtual time (in us) at which the running operation completes
+    uint64_t    busyUntil;
+    //  Number of times each sector has been erased
+    uint32_t    erases[HAL_STOR_SECTORS];
+};
+
+/**
+ * Release content of storage when its board is deleted
+ * @param state state of storage
+ */
+static void _SIMStorRelease(void *state)
+{
+    struct _simStor *stor = (struct _simStor*)state;
+
+    if (stor->mapped)
+        munmap(stor->mem, HAL_STOR_SIZE);
+    else
+        free(stor->mem);
+}
+
+/**
+ * Get flash region of the selected board, allocating erased content in memory
+ * if it doesn't have any yet
+ * @return pointer to the state of storage
+ */
+static struct _simStor* _SIMStor()
+{
+    struct _simStor *stor = (struct _simStor*)HAL_SIM_State(
+                                    HAL_SIM_PART_STOR, sizeof(struct _simStor), 0);
+
+    if (stor->mem == 0)
+    {
+        stor->mem = (uint8_t*)malloc(HAL_STOR_SIZE);
+        memset(stor->mem, 0xFF, HAL_STOR_SIZE);
+        stor->mapped = false;
+        HAL_SIM_OnDelete(HAL_SIM_PART_STOR, _SIMStorRelease);
+    }
+
+    return stor;
+}
+
+/**
+ * Keep content of storage in a file, file is created (erased) if it doesn't
+ * exist. Changes are in the file as soon as they're made, so they survive the
+ * process being killed. Has to be called before storage is initialized
+ * @param path path to the file
+ * @return true if file has been mapped, false if storage is still in memory
+ */
+bool HAL_SIM_StorageFile(const char *path)
+{
+    struct _simStor *stor = _SIMStor();
+    struct stat st;
+    uint8_t *mem;
+    int fd;
+
+    fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+        return false;
+
+    //  Part of the file that's new reads as erased flash
+    if ((fstat(fd, &st) != 0) || (ftruncate(fd, HAL_STOR_SIZE) != 0))
+    {
+        close(fd);
+        return false;
+    }
+    mem = (uint8_t*)mmap(0, HAL_STOR_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED,
+                         fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED)
+        return false;
+    if (st.st_size < HAL_STOR_SIZE)
+        memset(mem + st.st_size, 0xFF, HAL_STOR_SIZE - st.st_size);
+
+    if (stor->mapped)
+        munmap(stor->mem, HAL_STOR_SIZE);
+    else
+        free(stor->mem);
+    stor->mem = mem;
+    stor->mapped = true;
+
+    return true;
+}
+
+/**
+ * Get number of times sector has been erased since the board was created
+ * @param sector index of the sector within storage
+ * @return number of erases
+ */
+uint32_t HAL_SIM_StorageErases(uint16_t sector)
+{
+    if (sector >= HAL_STOR_SECTORS)
+        return 0;
+
+    return _SIMStor()->erases[sector];
+}
+
+/**
+ * Initialize storage
+ * @return true if storage can be used
+ */
+bool HAL_STOR_Init()
+{
+    return (_SIMStor()->mem != 0);
+}
+
+/**
+ * Get address through which storage is read
+ * @param offset offset from the beginning of storage (in bytes)
+ * @return pointer to storage at given offset
+ */
+const uint8_t* HAL_STOR_Address(uint32_t offset)
+{
+    return _SIMStor()->mem + offset;
+}
+
+/**
+ * Start erasing sector of storage, setting all of its bytes to 0xFF
+ * @param sector index of the sector within storage
+ * @return HAL_OK if erase has started, one of HAL_STOR_* error codes otherwise
+ */
+uint32_t HAL_STOR_Erase(uint16_t sector)
+{
+    struct _simStor *stor = _SIMStor();
+
+    if (sector >= HAL_STOR_SECTORS)
+        return HAL_STOR_ARG_ERR;
+    if (HAL_STOR_Busy())
+        return HAL_STOR_BUSY;
+
+    memset(stor->mem + (uint32_t)sector * HAL_STOR_SECTOR_SIZE, 0xFF,
+           HAL_STOR_SECTOR_SIZE);
+    stor->erases[sector]++;
+    stor->busyUntil = HAL_SIM_GetTimeUS() + HAL_SIM_STOR_ERASE_US;
+
+    return HAL_OK;
+}
+
+/**
+ * Start programming words into storage
+ * @param offset offset from the beginning of storage (in bytes), word-aligned
+ * @param data words to program
+ * @param words number of words, all of them have to be within the same block
+ * of HAL_STOR_WRITE_MAX bytes
+ * @return HAL_OK if programming has started, one of HAL_STOR_* error codes
+ * otherwise
+ */
+uint32_t HAL_STOR_Program(uint32_t offset, const uint32_t *data,
+                          uint16_t words)
+{
+    struct _simStor *stor = _SIMStor();
+    const uint8_t *src = (const uint8_t*)data;
+    uint32_t i;
+
+    if (((offset & 0x03) != 0) || (words == 0) ||
+        ((offset + words * 4) > HAL_STOR_SIZE) ||
+        ((offset / HAL_STOR_WRITE_MAX) !=
+         ((offset + words * 4 - 1) / HAL_STOR_WRITE_MAX)))
+        return HAL_STOR_ARG_ERR;
+    if (HAL_STOR_Busy())
+        return HAL_STOR_BUSY;
+
+    //  Programming can only clear bits
+    for (i = 0; i < (uint32_t)words * 4; i++)
+        stor->mem[offset + i] &= src[i];
+    stor->busyUntil = HAL_SIM_GetTimeUS() + words * HAL_SIM_STOR_WORD_US;
+
+    return HAL_OK;
+}
+
+/**
+ * Check whether erase or programming is still running
+ * @return true if storage is busy
+ */
+bool HAL_STOR_Busy()
+{
+    return (HAL_SIM_GetTimeUS() < _SIMStor()->busyUntil);
+}
+
+#endif  /* __BOARD_POSIX__ && __HAL_USE_STORAGE__ */
@@ -0,0 +1,53 @@
+/**
+ * hal_stor_posix.h
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran Mikov
+ *
+ ****Simulated hardware:
+ *      NOR flash region with the same geometry as storage on TM4C1294: erased
+ *          bytes read as 0xFF, programming only clears bits. Erase and program
+ *          take time on the virtual clock, during which storage is busy
+ *      Content is kept in memory, or in a file mapped into memory (see
+ *          HAL_SIM_StorageFile()) so that it outlives the process
+ */
+#include "hwconfig.h"
+
+//  Compile following section only if hwconfig.h says to include this module
+#if !defined(ROVERKERNEL_HAL_POSIX_HAL_STOR_POSIX_H_) && defined(__HAL_USE_STORAGE__)
+#define ROVERKERNEL_HAL_POSIX_HAL_STOR_POSIX_H_
+
+//  Size of a sector (smallest erasable unit) in bytes, and number of sectors
+#define HAL_STOR_SECTOR_SIZE    16384
+#define HAL_STOR_SECTORS        4
+//  Most bytes programmed in one operation (size of flash write buffer)
+#define HAL_STOR_WRITE_MAX      128
+
+//  Error codes of storage functions (HAL_OK on success)
+#define HAL_STOR_BUSY           1   /// Another operation is still running
+#define HAL_STOR_ARG_ERR        2   /// Address out of range or not aligned
+
+//  Time (in us) it takes to erase a sector and to program a word
+#define HAL_SIM_STOR_ERASE_US   15000
+#define HAL_SIM_STOR_WORD_US    30
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+extern bool            HAL_STOR_Init();
+extern const uint8_t*  HAL_STOR_Address(uint32_t offset);
+extern uint32_t        HAL_STOR_Erase(uint16_t sector);
+extern uint32_t        HAL_STOR_Program(uint32_t offset, const uint32_t *data,
+                                        uint16_t words);
+extern bool            HAL_STOR_Busy();
+
+extern bool            HAL_SIM_StorageFile(const char *path);
+extern uint32_t        HAL_SIM_StorageErases(uint16_t sector);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ROVERKERNEL_HAL_POSIX_HAL_STOR_POSIX_H_ */
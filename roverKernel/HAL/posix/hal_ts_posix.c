@@ -0,0 +1,242 @@
+/**
+ * hal_ts_posix.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran
+ */
+#include "hal_ts_posix.h"
+
+#if defined(__BOARD_POSIX__) && defined(__HAL_USE_TASKSCH__)
+
+#include <time.h>
+#include "HAL/posix/hal_common_posix.h"
+
+//  Time base counts clock cycles in a 32-bit counter, same as on TM4C1294
+#define HAL_SIM_TB_WRAP     0x100000000ULL
+
+/**
+ * SysTick and time base of the scheduler
+ */
+struct _simTS
+{
+    ///  Time step of SysTick (in ms), 0 if it hasn't been configured
+    uint32_t    timeStep;
+    void((*sysTickHook)(void));
+    void((*wakeupHook)(void));
+    ///  Virtual time at which time base was started (in us)
+    uint64_t    timeBase;
+    ///  Upper 32 bits of the time base, incremented on counter overflow
+    volatile uint32_t timeBaseHigh;
+};
+
+/**
+ * Get SysTick and time base of the selected board
+ * @return pointer to the state of scheduler timers
+ */
+static struct _simTS* _SIMTS()
+{
+    return (struct _simTS*)HAL_SIM_State(HAL_SIM_PART_TS,
+                                         sizeof(struct _simTS), 0);
+}
+
+/**
+ * Initialize SysTick timer
+ * @param periodMs time step of the timer (in ms)
+ * @param custHook function to call every time SysTick expires
+ * @return HAL_OK on success, error code otherwise
+ */
+uint8_t HAL_TS_InitSysTick(uint32_t periodMs, void((*custHook)(void)))
+{
+    struct _simTS *ts = _SIMTS();
+
+    if (periodMs == 0)
+        return HAL_SYSTICK_PEROOR;
+
+    if (ts->timeStep != 0)
+        return HAL_SYSTICK_SET_ERR;
+
+    ts->timeStep = periodMs;
+    ts->sysTickHook = custHook;
+
+    return HAL_OK;
+}
+
+/**
+ * Start SysTick timer
+ * @return HAL_OK on success, HAL_SYSTICK_NOTSET_ERR if it wasn't configured
+ */
+uint8_t HAL_TS_StartSysTick()
+{
+    struct _simTS *ts = _SIMTS();
+
+    if (ts->timeStep == 0)
+        return HAL_SYSTICK_NOTSET_ERR;
+
+    HAL_SIM_TimerStart(HAL_SIM_TIMER_SYSTICK, ts->timeStep * 1000,
+                       ts->timeStep * 1000, ts->sysTickHook);
+
+    return HAL_OK;
+}
+
+/**
+ * Stop SysTick timer
+ * @return HAL_OK on success, HAL_SYSTICK_NOTSET_ERR if it wasn't configured
+ */
+uint8_t HAL_TS_StopSysTick()
+{
+    struct _simTS *ts = _SIMTS();
+
+    if (ts->timeStep == 0)
+        return HAL_SYSTICK_NOTSET_ERR;
+
+    HAL_SIM_TimerStop(HAL_SIM_TIMER_SYSTICK);
+
+    return HAL_OK;
+}
+
+/**
+ * Get time step of SysTick timer
+ * @return time step (in ms)
+ */
+uint32_t HAL_TS_GetTimeStepMS()
+{
+    struct _simTS *ts = _SIMTS();
+
+    return ts->timeStep;
+}
+
+/**
+ * Get value of the 32-bit counter of the time base, counting clock cycles
+ * @param ts scheduler timers of the board
+ * @return value of the counter
+ */
+static uint32_t _SIMTSCounter(struct _simTS *ts)
+{
+    return (uint32_t)((HAL_SIM_GetTimeUS() - ts->timeBase)
+                      * (HAL_SIM_CLOCK / 1000000));
+}
+
+/**
+ * Interrupt handler for overflow of the counter of the time base. Counter
+ * overflows in the middle of a microsecond, so timer is armed for the first
+ * microsecond after the next overflow
+ */
+static void _SIMTSTimeBaseISR(void)
+{
+    struct _simTS *ts = _SIMTS();
+    uint64_t next;
+
+    ts->timeBaseHigh++;
+
+    next = ((uint64_t)ts->timeBaseHigh + 1) * HAL_SIM_TB_WRAP;
+    next = ts->timeBase + (next + (HAL_SIM_CLOCK / 1000000) - 1)
+                          / (HAL_SIM_CLOCK / 1000000);
+    HAL_SIM_TimerStart(HAL_SIM_TIMER_TIMEBASE, next - HAL_SIM_GetTimeUS(), 0,
+                       _SIMTSTimeBaseISR);
+}
+
+/**
+ * Start microsecond time base of the scheduler. Same as on TM4C1294, it's a
+ * 32-bit counter of clock cycles (overflowing every ~35s) extended to 64 bits
+ * by counting its overflows
+ */
+void HAL_TS_InitTimeBase()
+{
+    struct _simTS *ts = _SIMTS();
+
+    ///  Time base is shared by all users, start it only once
+    if (HAL_SIM_TimerRunning(HAL_SIM_TIMER_TIMEBASE))
+        return;
+
+    ts->timeBase = HAL_SIM_GetTimeUS();
+    ts->timeBaseHigh = (uint32_t)-1;
+    _SIMTSTimeBaseISR();
+}
+
+/**
+ * Get time since the time base was started
+ * @note Can be called with interrupts disabled, overflow waiting for its
+ * interrupt to be served is taken into account
+ * @return time (in us)
+ */
+uint64_t HAL_TS_GetTimeUS()
+{
+    struct _simTS *ts = _SIMTS();
+    bool intState = HAL_BOARD_InterruptSuspend();
+    uint32_t high = ts->timeBaseHigh;
+    uint32_t low = _SIMTSCounter(ts);
+
+    ///  Counter has overflowed but interrupt hasn't been served yet. If the
+    ///  counter is still high it was read before the overflow
+    if (HAL_SIM_IntPending(_SIMTSTimeBaseISR) && (low < 0x80000000))
+        high++;
+    HAL_BOARD_InterruptRestore(intState);
+
+    return (((uint64_t)high << 32) | low) / (HAL_SIM_CLOCK / 1000000);
+}
+
+/**
+ * Initialize wake-up timer used in tickless mode
+ * @param custHook function to call when wake-up timer expires
+ * @return HAL_OK on success, HAL_WAKEUP_SET_ERR if already configured
+ */
+uint8_t HAL_TS_InitWakeup(void((*custHook)(void)))
+{
+    struct _simTS *ts = _SIMTS();
+
+    if (ts->wakeupHook != 0)
+        return HAL_WAKEUP_SET_ERR;
+
+    ts->wakeupHook = custHook;
+
+    return HAL_OK;
+}
+
+/**
+ * Arm wake-up timer to expire after given time, or stop it
+ * @param us time (in us) from now to wake up at, 0 to stop the timer
+ */
+void HAL_TS_SetWakeup(uint32_t us)
+{
+    struct _simTS *ts = _SIMTS();
+
+    HAL_SIM_TimerStop(HAL_SIM_TIMER_WAKEUP);
+
+    if (us > 0)
+        HAL_SIM_TimerStart(HAL_SIM_TIMER_WAKEUP, us, 0, ts->wakeupHook);
+}
+
+/**
+ * Put processor to sleep until the next interrupt, which moves the virtual
+ * clock to the next timer to expire
+ */
+void HAL_TS_Sleep()
+{
+    HAL_SIM_Sleep();
+}
+
+/**
+ * Get current value of CPU cycle counter. Calculated from the host's monotonic
+ * clock as if the host was running at the clock of the simulated board
+ * @return value of free-running 32-bit cycle counter
+ */
+uint32_t HAL_TS_GetCycles()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint32_t)((uint64_t)now.tv_sec * HAL_SIM_CLOCK
+                    + (uint64_t)now.tv_nsec * (HAL_SIM_CLOCK / 1000000) / 1000);
+}
+
+/**
+ * Get number of CPU cycles in one microsecond
+ * @return number of cycles
+ */
+uint32_t HAL_TS_GetCyclesPerUS()
+{
+    return (HAL_SIM_CLOCK / 1000000);
+}
+
+#endif /* __BOARD_POSIX__ && __HAL_USE_TASKSCH__ */
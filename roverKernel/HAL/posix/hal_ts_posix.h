@@ -0,0 +1,49 @@
+/**
+ * hal_ts_posix.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ *
+ ****Simulated hardware:
+ *      SysTick - time step of task scheduler, on the virtual clock
+ *      Time base - the virtual clock itself
+ *      Wake-up timer - one-shot timer on the virtual clock
+ *      Cycle counter - derived from the host's monotonic clock, so run time of
+ *          tasks is the real time they take on the host
+ */
+#include "hwconfig.h"
+
+//  Compile following section only if hwconfig.h says to include this module
+#if !defined(ROVERKERNEL_HAL_POSIX_HAL_TS_POSIX_H_) && defined(__HAL_USE_TASKSCH__)
+#define ROVERKERNEL_HAL_POSIX_HAL_TS_POSIX_H_
+
+#define HAL_SYSTICK_PEROOR      1   /// Period value for SysTick is out of range
+#define HAL_SYSTICK_SET_ERR     2   /// SysTick has already been configured
+#define HAL_SYSTICK_NOTSET_ERR  3   /// SysTick hasn't been configured yet
+#define HAL_WAKEUP_SET_ERR      4   /// Wake-up timer has already been configured
+
+#define HAL_TS_CYCLES()         HAL_TS_GetCycles()
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+extern uint8_t     HAL_TS_InitSysTick(uint32_t periodMs, void((*custHook)(void)));
+extern uint8_t     HAL_TS_StartSysTick();
+extern uint8_t     HAL_TS_StopSysTick();
+extern uint32_t    HAL_TS_GetTimeStepMS();
+extern void        HAL_TS_InitTimeBase();
+extern uint64_t    HAL_TS_GetTimeUS();
+extern uint8_t     HAL_TS_InitWakeup(void((*custHook)(void)));
+extern void        HAL_TS_SetWakeup(uint32_t us);
+extern void        HAL_TS_Sleep();
+extern uint32_t    HAL_TS_GetCycles();
+extern uint32_t    HAL_TS_GetCyclesPerUS();
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* ROVERKERNEL_HAL_POSIX_HAL_TS_POSIX_H_ */
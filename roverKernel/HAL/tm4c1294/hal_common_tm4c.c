@@ -55,6 +55,32 @@ void HAL_BOARD_Reset()
     MAP_SysCtlReset();
 }
 
+/**
+ * Create context for running another kernel on the board. There's only one
+ * microcontroller on the board, so only the default context exists
+ * @return 0, context can't be created
+ */
+void* HAL_BOARD_NewContext()
+{
+    return 0;
+}
+
+/**
+ * Select context to work on, the default context is always selected
+ * @param context handle of the context
+ */
+void HAL_BOARD_SelectContext(void *context)
+{
+}
+
+/**
+ * Delete context created by HAL_BOARD_NewContext(), nothing to delete
+ * @param context handle of the context
+ */
+void HAL_BOARD_DeleteContext(void *context)
+{
+}
+
 /**
  * Suppress or enable interrupts on the microcontroller
  * @param enable New state to set
@@ -67,6 +93,59 @@ void HAL_BOARD_InterruptEnable(bool enable)
         IntMasterDisable();
 }
 
+/**
+ * Disable interrupts on the microcontroller and return their previous state.
+ * Unlike HAL_BOARD_InterruptEnable() this can be used for nested critical
+ * sections and inside of interrupt handlers
+ * @return true if interrupts were enabled before the call, false otherwise
+ */
+bool HAL_BOARD_InterruptSuspend()
+{
+    //  IntMasterDisable() returns true if interrupts were already disabled
+    return !IntMasterDisable();
+}
+
+/**
+ * Restore state of interrupts saved by HAL_BOARD_InterruptSuspend()
+ * @param enabled state of interrupts returned by HAL_BOARD_InterruptSuspend()
+ */
+void HAL_BOARD_InterruptRestore(bool enabled)
+{
+    if (enabled)
+        IntMasterEnable();
+}
+
+/**
+ * Add to a variable shared with interrupts without disabling them. Exclusive
+ * store fails if an interrupt came in after the exclusive load (exception
+ * entry clears exclusive monitor), in which case addition is simply repeated
+ * @param ptr variable to add to
+ * @param val value to add
+ * @return value of the variable before addition
+ */
+uint32_t HAL_BOARD_AtomicAdd(volatile uint32_t *ptr, uint32_t val)
+{
+    uint32_t old;
+
+    do
+    {
+        old = __ldrex((void*)ptr);
+    }
+    while (__strex(old + val, (void*)ptr) != 0);
+
+    return old;
+}
+
+/**
+ * Get amount of memory in use on the heap. Run-time library keeps its free
+ * list private and has no call reporting its usage, so it's not supported here
+ * @return HAL_HEAP_UNKNOWN
+ */
+uint32_t HAL_BOARD_HeapUsed()
+{
+    return HAL_HEAP_UNKNOWN;
+}
+
 /**
  * Wait for given amount of us - blocking function
  * @param us time in us to wait
@@ -11,6 +11,12 @@
 
 #define HAL_OK                  0
 
+//  Only one thread of execution, nothing to keep separately
+#define HAL_THREAD_LOCAL
+
+//  Returned by HAL_BOARD_HeapUsed() if board can't tell how much heap is used
+#define HAL_HEAP_UNKNOWN        0xFFFFFFFF
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -24,7 +30,14 @@ extern void         HAL_DelayUS(uint32_t us);
 extern void         HAL_BOARD_CLOCK_Init();
 extern void         HAL_BOARD_Reset();
 extern void         HAL_BOARD_InterruptEnable(bool enable);
+extern bool         HAL_BOARD_InterruptSuspend();
+extern void         HAL_BOARD_InterruptRestore(bool enabled);
+extern uint32_t     HAL_BOARD_AtomicAdd(volatile uint32_t *ptr, uint32_t val);
+extern uint32_t     HAL_BOARD_HeapUsed();
 extern void         UNUSED (int32_t arg);
+extern void*        HAL_BOARD_NewContext();
+extern void         HAL_BOARD_SelectContext(void *context);
+extern void         HAL_BOARD_DeleteContext(void *context);
 extern uint32_t     _TM4CMsToCycles(uint32_t ms);
 
 
@@ -31,6 +31,8 @@
 #define HAL_ESP_SendChar(x)     MAP_UARTCharPut(ESP8266_UART_BASE, x)
 #define HAL_ESP_CharAvail()     MAP_UARTCharsAvail(ESP8266_UART_BASE)
 #define HAL_ESP_GetChar()       MAP_UARTCharGetNonBlocking(ESP8266_UART_BASE)
+//  Called while busy-waiting for reply from ESP, nothing to do on real hardware
+#define HAL_ESP_WaitReply()
 
 
 #ifdef __cplusplus
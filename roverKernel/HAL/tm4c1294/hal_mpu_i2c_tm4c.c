@@ -201,11 +201,14 @@ uint8_t HAL_MPU_ReadByte(uint8_t I2Caddress, uint8_t regAddress)
  * @param regAddress address of register in I2C device to write into
  * @param count number of bytes to red
  * @param dest pointer to data buffer in which data is saved after reading
+ * @return 0 on success, error flags of I2C master (I2C_MASTER_ERR_*) if
+ * sending register address or receiving failed
  */
 uint8_t HAL_MPU_ReadBytes(uint8_t I2Caddress, uint8_t regAddress,
                           uint16_t length, uint8_t* data)
 {
     uint16_t i;
+    uint8_t err;
 
     //  Set I2C address of MPU, reading mode (incorrect)
     //  I'm not sure why is the sending condition requires address in reading,
@@ -218,6 +221,13 @@ uint8_t HAL_MPU_ReadBytes(uint8_t I2Caddress, uint8_t regAddress,
     MAP_I2CMasterControl(MPU9250_I2C_BASE, I2C_MASTER_CMD_BURST_SEND_START);
     HAL_DelayUS(4);
     while(MAP_I2CMasterBusy(MPU9250_I2C_BASE));
+    //  Device didn't acknowledge, reading would only return garbage
+    err = (uint8_t)MAP_I2CMasterErr(MPU9250_I2C_BASE);
+    if (err != I2C_MASTER_ERR_NONE)
+    {
+        MAP_I2CMasterControl(MPU9250_I2C_BASE, I2C_MASTER_CMD_BURST_SEND_ERROR_STOP);
+        return err;
+    }
 
     //  Change address to reading mode
     MAP_I2CMasterSlaveAddrSet(MPU9250_I2C_BASE, I2Caddress, true);
@@ -246,7 +256,7 @@ uint8_t HAL_MPU_ReadBytes(uint8_t I2Caddress, uint8_t regAddress,
     while(MAP_I2CMasterBusy(MPU9250_I2C_BASE));
     data[length-1] = (uint8_t)(MAP_I2CMasterDataGet(MPU9250_I2C_BASE) & 0xFF);
 
-    return 0;
+    return (uint8_t)MAP_I2CMasterErr(MPU9250_I2C_BASE);
 }
 
 
@@ -197,6 +197,7 @@ uint8_t HAL_MPU_ReadByte(uint8_t I2Caddress, uint8_t regAddress)
  * @param regAddress Address of register in MPU to read from
  * @param count Number of bytes to red
  * @param dest Pointer to data buffer in which data is saved after reading
+ * @return 0, SPI has no acknowledge so failed reading can't be detected
  */
 uint8_t HAL_MPU_ReadBytes(uint8_t I2Caddress, uint8_t regAddress,
                           uint16_t length, uint8_t* data)
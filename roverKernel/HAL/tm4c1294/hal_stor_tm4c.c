@@ -0,0 +1,119 @@
+/**
+ * hal_stor_tm4c.c
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran
+ */
+#include "hal_stor_tm4c.h"
+
+#if defined(__BOARD_TM4C1294NCPDT__) && defined(__HAL_USE_STORAGE__)
+
+#include "HAL/tm4c1294/hal_common_tm4c.h"
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "inc/hw_flash.h"
+
+//  Size of storage region in bytes
+#define HAL_STOR_SIZE   (HAL_STOR_SECTOR_SIZE * HAL_STOR_SECTORS)
+
+/**
+ * Initialize flash controller for programming storage
+ * @return true if storage can be used
+ */
+bool HAL_STOR_Init()
+{
+    //  Clear status of previous operations (e.g. from before reset)
+    HWREG(FLASH_FCMISC) = HWREG(FLASH_FCRIS);
+
+    return true;
+}
+
+/**
+ * Get address through which storage is read
+ * @param offset offset from the beginning of storage (in bytes)
+ * @return pointer to storage at given offset
+ */
+const uint8_t* HAL_STOR_Address(uint32_t offset)
+{
+    return (const uint8_t*)(HAL_STOR_BASE + offset);
+}
+
+/**
+ * Start erasing sector of storage, setting all of its bytes to 0xFF
+ * @param sector index of the sector within storage
+ * @return HAL_OK if erase has started, one of HAL_STOR_* error codes otherwise
+ */
+uint32_t HAL_STOR_Erase(uint16_t sector)
+{
+    if (sector >= HAL_STOR_SECTORS)
+        return HAL_STOR_ARG_ERR;
+    if (HAL_STOR_Busy())
+        return HAL_STOR_BUSY;
+
+    //  Flash controller takes the sector from address of any byte in it
+    HWREG(FLASH_FCMISC) = HWREG(FLASH_FCRIS);
+    HWREG(FLASH_FMA) = HAL_STOR_BASE + (uint32_t)sector * HAL_STOR_SECTOR_SIZE;
+    HWREG(FLASH_FMC) = FLASH_FMC_WRKEY | FLASH_FMC_ERASE;
+
+    return HAL_OK;
+}
+
+/**
+ * Start programming words into storage, using write buffer of flash controller
+ * @param offset offset from the beginning of storage (in bytes), word-aligned
+ * @param data words to program
+ * @param words number of words, all of them have to be within the same block
+ * of HAL_STOR_WRITE_MAX bytes
+ * @return HAL_OK if programming has started, one of HAL_STOR_* error codes
+ * otherwise
+ */
+uint32_t HAL_STOR_Program(uint32_t offset, const uint32_t *data,
+                          uint16_t words)
+{
+    uint32_t addr = HAL_STOR_BASE + offset;
+    uint16_t i;
+
+    if (((offset & 0x03) != 0) || (words == 0) ||
+        ((offset + words * 4) > HAL_STOR_SIZE) ||
+        ((offset / HAL_STOR_WRITE_MAX) !=
+         ((offset + words * 4 - 1) / HAL_STOR_WRITE_MAX)))
+        return HAL_STOR_ARG_ERR;
+    if (HAL_STOR_Busy())
+        return HAL_STOR_BUSY;
+
+    HWREG(FLASH_FCMISC) = HWREG(FLASH_FCRIS);
+    //  Write buffer covers an aligned block, words not written into it (left
+    //  at 0xFFFFFFFF) leave flash untouched
+    HWREG(FLASH_FMA) = addr & ~(HAL_STOR_WRITE_MAX - 1);
+    for (i = 0; i < (HAL_STOR_WRITE_MAX / 4); i++)
+        HWREG(FLASH_FWBN + i * 4) = 0xFFFFFFFF;
+    for (i = 0; i < words; i++)
+        HWREG(FLASH_FWBN + (addr & (HAL_STOR_WRITE_MAX - 1)) + i * 4) = data[i];
+    HWREG(FLASH_FMC2) = FLASH_FMC_WRKEY | FLASH_FMC2_WRBUF;
+
+    return HAL_OK;
+}
+
+/**
+ * Check whether erase or programming is still running
+ * @return true if flash controller is busy
+ */
+bool HAL_STOR_Busy()
+{
+    if ((HWREG(FLASH_FMC) & FLASH_FMC_ERASE) ||
+        (HWREG(FLASH_FMC2) & FLASH_FMC2_WRBUF))
+        return true;
+
+    //  Operation has completed since the last check, drop stale content of
+    //  flash prefetch buffers, reads have to see what has just been written
+    if (HWREG(FLASH_FCRIS) & FLASH_FCRIS_PRIS)
+    {
+        HWREG(FLASH_FCMISC) = HWREG(FLASH_FCRIS);
+        HWREG(FLASH_CONF) |= FLASH_CONF_CLRTV;
+    }
+
+    return false;
+}
+
+#endif  /* __BOARD_TM4C1294NCPDT__ && __HAL_USE_STORAGE__ */
@@ -0,0 +1,52 @@
+/**
+ * hal_stor_tm4c.h
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran Mikov
+ *
+ **** Hardware dependencies:
+ *      Flash memory controller - last 64kB of on-chip flash (0xF0000-0xFFFFF)
+ *      are reserved for storage in linker command file (rover_ccs.cmd)
+ *
+ *  Storage is a region of NOR flash: erased bytes read as 0xFF, programming
+ *  can only clear bits. It's erased a sector at a time and programmed a word
+ *  (4 bytes) at a time, up to HAL_STOR_WRITE_MAX bytes within a single aligned
+ *  block of that size in one operation. Erase and program only start the
+ *  operation, HAL_STOR_Busy() tells when it's done. Storage is read directly
+ *  through the pointer returned by HAL_STOR_Address().
+ */
+#include "hwconfig.h"
+
+//  Compile following section only if hwconfig.h says to include this module
+#if !defined(ROVERKERNEL_HAL_TM4C1294_HAL_STOR_TM4C_H_) && defined(__HAL_USE_STORAGE__)
+#define ROVERKERNEL_HAL_TM4C1294_HAL_STOR_TM4C_H_
+
+//  Address of storage region in flash
+#define HAL_STOR_BASE           0x000F0000
+//  Size of a sector (smallest erasable unit) in bytes, and number of sectors
+#define HAL_STOR_SECTOR_SIZE    16384
+#define HAL_STOR_SECTORS        4
+//  Most bytes programmed in one operation (size of flash write buffer)
+#define HAL_STOR_WRITE_MAX      128
+
+//  Error codes of storage functions (HAL_OK on success)
+#define HAL_STOR_BUSY           1   /// Another operation is still running
+#define HAL_STOR_ARG_ERR        2   /// Address out of range or not aligned
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+extern bool            HAL_STOR_Init();
+extern const uint8_t*  HAL_STOR_Address(uint32_t offset);
+extern uint32_t        HAL_STOR_Erase(uint16_t sector);
+extern uint32_t        HAL_STOR_Program(uint32_t offset, const uint32_t *data,
+                                        uint16_t words);
+extern bool            HAL_STOR_Busy();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ROVERKERNEL_HAL_TM4C1294_HAL_STOR_TM4C_H_ */
@@ -26,6 +26,13 @@
 
 uint32_t g_ui32SysClock;
 
+/// Registers of the core debug block, used to run the CPU cycle counter
+#define HAL_DEMCR           0xE000EDFC  /// Debug exception & monitor control
+#define HAL_DEMCR_TRCENA    0x01000000  /// Enable DWT unit
+#define HAL_DWT_CTRL        0xE0001000  /// DWT control register
+#define HAL_DWT_CYCCNTENA   0x00000001  /// Enable cycle counter
+#define HAL_DWT_CYCCNT      0xE0001004  /// Cycle counter
+
 /**
  * Setup SysTick interrupt and period
  * @param periodMs time in milliseconds how often to trigger an interrupt
@@ -93,5 +100,148 @@ uint32_t HAL_TS_GetTimeStepMS()
     return _periodMS;
 }
 
+///Upper 32 bits of the time base, incremented on overflow of Timer 4
+volatile uint32_t _timeBaseHigh = 0;
+bool _timeBaseSet = false;
+
+/**
+ * Interrupt handler for overflow of the 32-bit counter of the time base
+ * (every ~35s at 120MHz)
+ */
+void _TM4CTimeBaseISR(void)
+{
+    MAP_TimerIntClear(TIMER4_BASE, TIMER_TIMA_TIMEOUT);
+    _timeBaseHigh++;
+}
+
+/**
+ * Start free-running timer counting system clock cycles, used as a monotonic
+ * time source with microsecond resolution. TM4C1294 has no 64-bit timers, so
+ * 32-bit counter is extended to 64 bits by counting its overflows
+ */
+void HAL_TS_InitTimeBase()
+{
+    /// Time base is shared by all users, start it only once
+    if (_timeBaseSet)
+        return;
+
+    MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER4);
+    MAP_SysCtlDelay(3);
+    MAP_TimerConfigure(TIMER4_BASE, TIMER_CFG_PERIODIC_UP);
+    MAP_TimerLoadSet(TIMER4_BASE, TIMER_A, 0xFFFFFFFF);
+    MAP_TimerIntClear(TIMER4_BASE, MAP_TimerIntStatus(TIMER4_BASE, true));
+    TimerIntRegister(TIMER4_BASE, TIMER_A, _TM4CTimeBaseISR);
+    MAP_IntPrioritySet(INT_TIMER4A, 0);
+    MAP_TimerIntEnable(TIMER4_BASE, TIMER_TIMA_TIMEOUT);
+    MAP_TimerEnable(TIMER4_BASE, TIMER_A);
+    _timeBaseSet = true;
+
+    /// Start counting CPU cycles in DWT unit of the core
+    HWREG(HAL_DEMCR) |= HAL_DEMCR_TRCENA;
+    HWREG(HAL_DWT_CYCCNT) = 0;
+    HWREG(HAL_DWT_CTRL) |= HAL_DWT_CYCCNTENA;
+}
+
+/**
+ * Get time since the time base was started
+ * @note Can be called with interrupts disabled, overflow waiting for its
+ * interrupt to be served is taken into account
+ * @return time in microseconds
+ */
+uint64_t HAL_TS_GetTimeUS()
+{
+    bool intState = HAL_BOARD_InterruptSuspend();
+    uint32_t high = _timeBaseHigh;
+    uint32_t low = MAP_TimerValueGet(TIMER4_BASE, TIMER_A);
+
+    /// Counter has overflowed but interrupt hasn't been served yet. If the
+    /// counter is still high it was read before the overflow
+    if ((MAP_TimerIntStatus(TIMER4_BASE, false) & TIMER_TIMA_TIMEOUT)
+        && (low < 0x80000000))
+        high++;
+    HAL_BOARD_InterruptRestore(intState);
+
+    return (((uint64_t)high << 32) | low) / (g_ui32SysClock / 1000000);
+}
+
+/**
+ * Setup one-shot timer used to wake up the task scheduler in tickless mode
+ * @param custHook pointer to function that will be called when timer expires
+ * @return HAL library error code
+ */
+///Keep track whether the wake-up timer has already been configured
+bool _wakeupSet = false;
+uint8_t HAL_TS_InitWakeup(void((*custHook)(void)))
+{
+    /// Forbid configuring the timer multiple times
+    if (_wakeupSet)
+        return HAL_WAKEUP_SET_ERR;
+
+    MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER5);
+    MAP_SysCtlDelay(3);
+    MAP_TimerConfigure(TIMER5_BASE, TIMER_CFG_ONE_SHOT);
+    MAP_TimerIntClear(TIMER5_BASE, MAP_TimerIntStatus(TIMER5_BASE, true));
+    TimerIntRegister(TIMER5_BASE, TIMER_A, custHook);
+    MAP_IntPrioritySet(INT_TIMER5A, 0);
+    MAP_TimerIntEnable(TIMER5_BASE, TIMER_TIMA_TIMEOUT);
+    _wakeupSet = true;
+
+    return 0;
+}
+
+/**
+ * (Re)arm wake-up timer to expire after a given time. Interrupt is cleared in
+ * here, so this also has to be called from within the wake-up hook.
+ * @param us time from now (in microseconds) after which to trigger interrupt,
+ * 0 to just stop the timer
+ */
+void HAL_TS_SetWakeup(uint32_t us)
+{
+    uint32_t cycles = g_ui32SysClock / 1000000;
+
+    MAP_TimerDisable(TIMER5_BASE, TIMER_A);
+    MAP_TimerIntClear(TIMER5_BASE, TIMER_TIMA_TIMEOUT);
+
+    if (us == 0)
+        return;
+
+    /// Saturate instead of wrapping around (35s at 120MHz)
+    if (us > (0xFFFFFFFF / cycles))
+        us = 0xFFFFFFFF / cycles;
+
+    MAP_TimerLoadSet(TIMER5_BASE, TIMER_A, us * cycles);
+    MAP_TimerEnable(TIMER5_BASE, TIMER_A);
+}
+
+/**
+ * Read CPU cycle counter, started in HAL_TS_InitTimeBase()
+ * @note Counter overflows every ~35s at 120MHz, use only for measuring short
+ * intervals (difference of two readings is correct across one overflow)
+ * @return number of CPU cycles
+ */
+uint32_t HAL_TS_GetCycles()
+{
+    return HWREG(HAL_DWT_CYCCNT);
+}
+
+/**
+ * Get number of CPU cycles in one microsecond
+ * @return cycles per microsecond
+ */
+uint32_t HAL_TS_GetCyclesPerUS()
+{
+    return (g_ui32SysClock / 1000000);
+}
+
+/**
+ * Put the processor to sleep until the next interrupt
+ * @note Safe to call with interrupts disabled, pending interrupt still wakes up
+ * the processor and is served once interrupts are enabled again
+ */
+void HAL_TS_Sleep()
+{
+    MAP_SysCtlSleep();
+}
+
 #endif  /* __HAL_USE_TASKSCH__ */
 
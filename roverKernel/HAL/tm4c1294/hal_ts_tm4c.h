@@ -6,6 +6,10 @@
  *
  ****Hardware dependencies:
  *  SysTick timer & interrupt
+ *  Timer 4, subtimer A & interrupt (32-bit free-running counter of system
+ *      clock, extended to 64-bit microsecond time base on its overflow)
+ *  Timer 5, subtimer A & interrupt (32-bit wake-up timer in tickless mode)
+ *  DWT cycle counter of the Cortex-M4 core (profiling of tasks)
  */
 #include "hwconfig.h"
 
@@ -17,6 +21,13 @@
 #define HAL_SYSTICK_PEROOR      1   /// Period value for SysTick is out of range
 #define HAL_SYSTICK_SET_ERR     2   /// SysTick has already been configured
 #define HAL_SYSTICK_NOTSET_ERR  3   /// SysTick hasn't been configured yet
+#define HAL_WAKEUP_SET_ERR      4   /// Wake-up timer has already been configured
+
+/*
+ * Read DWT cycle counter directly, for places where even a function call to
+ * HAL_TS_GetCycles() is too much (e.g. trace recorder)
+ */
+#define HAL_TS_CYCLES()         (*((volatile uint32_t*)0xE0001004))
 
 #ifdef __cplusplus
 extern "C"
@@ -27,6 +38,13 @@ extern uint8_t     HAL_TS_InitSysTick(uint32_t periodMs, void((*custHook)(void))
 extern uint8_t     HAL_TS_StartSysTick();
 extern uint8_t     HAL_TS_StopSysTick();
 extern uint32_t    HAL_TS_GetTimeStepMS();
+extern void        HAL_TS_InitTimeBase();
+extern uint64_t    HAL_TS_GetTimeUS();
+extern uint8_t     HAL_TS_InitWakeup(void((*custHook)(void)));
+extern void        HAL_TS_SetWakeup(uint32_t us);
+extern void        HAL_TS_Sleep();
+extern uint32_t    HAL_TS_GetCycles();
+extern uint32_t    HAL_TS_GetCyclesPerUS();
 
 /**     Test probes     */
 extern void        HAL_ESP_TestProbe();
@@ -5,6 +5,7 @@
  *      Author: Vedran
  */
 #include "engines.h"
+#include "init/kernelContext.h"
 
 #if defined(__HAL_USE_ENGINES__)       //  Compile only if module is enabled
 
@@ -32,158 +33,124 @@
 
 
 #if defined(__USE_TASK_SCHEDULER__)
+///-----------------------------------------------------------------------------
+///         Services provided to task scheduler                      [PROTECTED]
+///-----------------------------------------------------------------------------
+
+/**
+ * Services offered by engines, in the order of ENG_T_* IDs
+ */
+const _tsService EngineData::_services[] =
+{
+    //  ENG_T_MOVE_ENG: direction, length (cm) or angle (deg), blocking
+    TS_SERVICE3(EngineData, uint32_t, _StartEngines, uint8_t, float, bool),
+    //  ENG_T_MOVE_ARC: distance, angle, small radius
+    TS_SERVICE3(EngineData, uint32_t, _StartEnginesArc, float, float, float),
+    //  ENG_T_MOVE_PERC: direction, left and right percentage of full speed
+    TS_SERVICE3(EngineData, int8_t, RunAtPercPWM, uint8_t, float, float),
+    //  ENG_T_REBOOT
+    TS_SERVICE1(EngineData, uint32_t, _Reboot, uint8_t),
+    //  ENG_T_SPEEDLOOP: scheduled every 150ms by Platform, high priority. It
+    //  only does a handful of float operations (a few us), budget of 1000us is
+    //  one time step of task scheduler (1ms, see Platform::InitHW) so that it
+    //  never holds up tasks due in the next time step
+    TS_SERVICE0_BUDGET(EngineData, uint32_t, _SpeedLoop, 1000)
+};
+
 /**
- * Callback routine to invoke service offered by this module from task scheduler
- * @note It is assumed that once this function is called task scheduler has
- * already copied required variables into the memory space provided for it.
+ * Move vehicle in desired direction, see StartEngines(). Instead of blocking
+ * until the vehicle stops, task is resumed every 100ms to check whether it has
+ * @return one of myLib.h STATUS_* error codes, or TS_YIELD while driving
  */
-void _ENG_KernelCallback(void)
+uint32_t EngineData::_StartEngines(uint8_t dir, float arg, bool blocking)
 {
-    EngineData &__ed = EngineData::GetI();
-    //  Check for null-pointer
-    if (__ed._ker.args == 0)
-        return;
-    /*
-     *  Data in args[] contains bytes that constitute arguments for function
-     *  calls. The exact representation(i.e. whether bytes represent ints, floats)
-     *  of data is known only to individual blocks of switch() function. There
-     *  is no predefined data separator between arguments inside args[].
-     */
-    switch (__ed._ker.serviceID)
+    TS_CO_BEGIN(_moveCo);
+
+    if (_SetupMove(dir, arg) != STATUS_OK)
+        TS_CO_RETURN(_moveCo, STATUS_ARG_ERR);
+
+    //  Wait until the motors start turning
+    TS_CO_SLEEP(_moveCo, 100);
+
+    if (blocking)
     {
-    /*
-     * Move vehicle in a single direction given by arguments
-     * args[] = direction(uint8_t)|length-or-angle(4B float)|blocking(1B)
-     * retVal one of myLib.h STATUS_* error codes
-     */
-    case ENG_T_MOVE_ENG:
-        {
-            uint8_t dir, temp;
-            float arg;
-            bool blocking;
-
-            memcpy((void*)&dir,
-                   (void*)__ed._ker.args,
-                   1);
-            memcpy((void*)&arg,
-                   (void*)(__ed._ker.args + 1),
-                   sizeof(float));
-            memcpy((void*)&temp,
-                   (void*)(__ed._ker.args + 1 + sizeof(float)),
-                   1);
-            blocking = !(!temp);
-
-            //((EngineData*)__ed)->StartEngines(dir, arg, blocking);
-            __ed._ker.retVal = __ed.StartEngines(dir, arg, blocking);
-        }
-        break;
-    /*
-     * Move vehicle following an arch
-     * args[] = distance(4B float)|angle(4B float)|small-radius(4B float)
-     * retVal one of myLib.h STATUS_* error codes
-     */
-    case ENG_T_MOVE_ARC:
-        {
-            float dist, angl, smallRad;
-
-            memcpy((void*)&dist,
-                   (void*)__ed._ker.args,
-                   sizeof(float));
-            memcpy((void*)&angl,
-                   (void*)(__ed._ker.args + sizeof(float)),
-                   sizeof(float));
-            memcpy((void*)&smallRad,
-                   (void*)(__ed._ker.args + 2 * sizeof(float)),
-                   sizeof(float));
-            //((EngineData*)
-            __ed._ker.retVal = __ed.StartEnginesArc(dist, angl, smallRad);
-        }
-        break;
-    /*
-     * Move each wheel at given percentage of full speed
-     * args[] = direction(uint8_t)|leftPercent(4B float)|rightPercent(4B float)
-     * retVal one of myLib.h STATUS_* error codes
-     */
-    case ENG_T_MOVE_PERC:
-        {
-            uint8_t dir;
-            float percLeft, percRight;
-
-            memcpy((void*)&dir,
-                   (void*)__ed._ker.args,
-                   1);
-            memcpy((void*)&percLeft,
-                   (void*)(__ed._ker.args+1),
-                   sizeof(float));
-            memcpy((void*)&percRight,
-                   (void*)(__ed._ker.args + sizeof(float)+1),
-                   sizeof(float));
-            //((EngineData*)__ed)->RunAtPercPWM(dir, percLeft, percRight);
-            __ed._ker.retVal = __ed.RunAtPercPWM(dir, percLeft, percRight);
-        }
-        break;
-    /*
-     * Full reboot (reinitialization) of engines module
-     * args[] = rebootCode(0x17)
-     * retVal one of myLib.h STATUS_* error codes
-     */
-    case ENG_T_REBOOT:
-        {
-            //  Reboot only if 0x17 was sent as argument
-            if (__ed._ker.args[0] != 0x17)
-                return;
-
-            __ed._ker.retVal = __ed.InitHW();
-        }
-        break;
-    /*
-     * Task that calculates the speed of each wheel by calculating traveled
-     * distance per wheel within a fixed time-step
-     * args[] = none
-     * retVal STATUS_OK
-     */
-    case ENG_T_SPEEDLOOP:
-        {
-            static uint64_t lastMsCounter = 0;
-            static int32_t lastWheelCounter[2] = {0,0};
-
-            //  If no distance was traveled and current speed is 0 just return,
-            //  no point in redoing calculations
-            if ( (lastWheelCounter[0] == __ed.wheelCounter[0]) &&
-                 (lastWheelCounter[1] == __ed.wheelCounter[1]) &&
-                 ((__ed.wheelSpeed[0] + __ed.wheelSpeed[1]) < 0.01))
-                return;
-
-            //Left wheel speed calculation
-            __ed.wheelSpeed[ED_LEFT] = (float)(__ed.wheelCounter[ED_LEFT]-lastWheelCounter[ED_LEFT]) * (PI_CONST*__ed._wheelDia)/__ed._encRes;
-            //  Divide distance with time interval passes
-            __ed.wheelSpeed[ED_LEFT] /= ((float)(msSinceStartup-lastMsCounter)/1000.0);
-
-            //Right wheel speed calculation
-            //  Convert distance traveled from encoder ticks to cm
-            __ed.wheelSpeed[ED_RIGHT] = (float)(__ed.wheelCounter[ED_RIGHT]-lastWheelCounter[ED_RIGHT]) * (PI_CONST*__ed._wheelDia)/__ed._encRes;
-            //  Divide distance with time interval passes
-            __ed.wheelSpeed[ED_RIGHT] /= ((float)(msSinceStartup-lastMsCounter)/1000.0);
-
-            lastMsCounter = msSinceStartup;
-            memcpy((void*)lastWheelCounter, (void*)__ed.wheelCounter, 2*sizeof(int32_t));
-
-            __ed._ker.retVal = STATUS_OK;
-        }
-        break;
-    default:
-        break;
+        TS_CO_AWAIT(_moveCo, !IsDriving(), 100, TS_CO_FOREVER);
+        HAL_ENG_Enable(ED_BOTH, false);
     }
 
-#ifdef __HAL_USE_EVENTLOG__
-    if (__ed._ker.retVal == STATUS_OK)
-        EMIT_EV(__ed._ker.serviceID, EVENT_OK);
-    else
-        EMIT_EV(__ed._ker.serviceID, EVENT_ERROR);
-#endif  /* __HAL_USE_EVENTLOG__ */
-}
+    TS_CO_END(_moveCo);
 
+#if defined(__DEBUG_SESSION__)
+    DEBUG_WRITE("Drove LEFT: %d   RIGHT: %d  \n", wheelCounter[ED_LEFT], wheelCounter[ED_RIGHT]);
 #endif
+    return STATUS_OK;
+}
+
+/**
+ * Move vehicle over a circular path, see StartEnginesArc(). Task is resumed
+ * every 100ms until the vehicle stops
+ * @return one of myLib.h STATUS_* error codes, or TS_YIELD while driving
+ */
+uint32_t EngineData::_StartEnginesArc(float distance, float angle,
+                                      float smallRadius)
+{
+    TS_CO_BEGIN(_moveCo);
+
+    if (_SetupArc(distance, angle, smallRadius) != STATUS_OK)
+        TS_CO_RETURN(_moveCo, STATUS_ARG_ERR);
+
+    TS_CO_AWAIT(_moveCo, !IsDriving(), 100, TS_CO_FOREVER);
+    HAL_ENG_Enable(ED_BOTH, true);
+
+    TS_CO_END(_moveCo);
+    return STATUS_OK;
+}
+
+/**
+ * Full reboot (reinitialization) of engines module
+ * @param rebootCode has to be 0x17 for reboot to take place
+ * @return one of myLib.h STATUS_* error codes
+ */
+uint32_t EngineData::_Reboot(uint8_t rebootCode)
+{
+    //  Reboot only if 0x17 was sent as argument
+    if (rebootCode != 0x17)
+        return STATUS_ARG_ERR;
+
+    return InitHW();
+}
+
+/**
+ * Task that calculates the speed of each wheel by calculating traveled
+ * distance per wheel within a fixed time-step
+ * @return STATUS_OK, or STATUS_NO_EVENT if vehicle is standing still
+ */
+uint32_t EngineData::_SpeedLoop()
+{
+    //  If no distance was traveled and current speed is 0 just return,
+    //  no point in redoing calculations
+    if ( (_lastWheelCounter[0] == wheelCounter[0]) &&
+         (_lastWheelCounter[1] == wheelCounter[1]) &&
+         ((wheelSpeed[0] + wheelSpeed[1]) < 0.01))
+        return STATUS_NO_EVENT;
+
+    //Left wheel speed calculation
+    wheelSpeed[ED_LEFT] = (float)(wheelCounter[ED_LEFT]-_lastWheelCounter[ED_LEFT]) * (PI_CONST*_wheelDia)/_encRes;
+    //  Divide distance with time interval passes
+    wheelSpeed[ED_LEFT] /= ((float)(msSinceStartup-_lastMsCounter)/1000.0);
+
+    //Right wheel speed calculation
+    //  Convert distance traveled from encoder ticks to cm
+    wheelSpeed[ED_RIGHT] = (float)(wheelCounter[ED_RIGHT]-_lastWheelCounter[ED_RIGHT]) * (PI_CONST*_wheelDia)/_encRes;
+    //  Divide distance with time interval passes
+    wheelSpeed[ED_RIGHT] /= ((float)(msSinceStartup-_lastMsCounter)/1000.0);
+
+    _lastMsCounter = msSinceStartup;
+    memcpy((void*)_lastWheelCounter, (void*)wheelCounter, 2*sizeof(int32_t));
+
+    return STATUS_OK;
+}
+#endif  /* __USE_TASK_SCHEDULER__ */
 
 ///-----------------------------------------------------------------------------
 ///         Functions for returning static instance                     [PUBLIC]
@@ -191,12 +158,11 @@ void _ENG_KernelCallback(void)
 
 /**
  * Return reference to a singleton
- * @return reference to an internal static instance
+ * @return reference to the instance owned by current kernel context
  */
 EngineData& EngineData::GetI()
 {
-    static EngineData inst;
-    return inst;
+    return *(KernelContext::Current().engines);
 }
 
 /**
@@ -255,8 +221,12 @@ int8_t EngineData::InitHW()
 
 #if defined(__USE_TASK_SCHEDULER__)
     //  Register module services with task scheduler
-    _ker.callBackFunc = _ENG_KernelCallback;
-    TS_RegCallback(&_ker, ENGINES_UID);
+    TS_RegServices(ENGINES_UID, TS_SERVICES(_services));
+    //  Register metrics of the module
+    MetricsRegistry::GetI().Register(encoderISR[ED_LEFT], ENGINES_UID,
+                                     ENG_M_ENC_LEFT);
+    MetricsRegistry::GetI().Register(encoderISR[ED_RIGHT], ENGINES_UID,
+                                     ENG_M_ENC_RIGHT);
 #endif
 
 #ifdef __HAL_USE_EVENTLOG__
@@ -271,12 +241,40 @@ int8_t EngineData::InitHW()
 
 /**
  * Move vehicle in desired direction
- * @param direction - selects the direction of movement
- * @param arg - distance in centimeters(forward/backward) or angle in �(left/right)
+ * @param direction - selects the direction of movement
+ * @param arg - distance in centimeters(forward/backward) or angle in �(left/right)
+ * @param blocking - wait until the vehicle stops, then disable the motors
  * 	TODO: Configure startup_ccs.c to support ISR for counters
  * @return one of myLib.h STATUS_* error codes
  */
 int8_t EngineData::StartEngines(uint8_t dir, float arg, bool blocking)
+{
+    int8_t retVal = _SetupMove(dir, arg);
+
+    if (retVal != STATUS_OK)
+        return retVal;
+
+	//  Wait until the motors start turning
+    HAL_DelayUS(100000);
+
+	while ( blocking && IsDriving() )
+	    HAL_DelayUS(700000);
+	if (blocking) HAL_ENG_Enable(ED_BOTH, false);
+
+#if defined(__DEBUG_SESSION__)
+	DEBUG_WRITE("Drove LEFT: %d   RIGHT: %d  \n", wheelCounter[ED_LEFT], wheelCounter[ED_RIGHT]);
+#endif
+
+
+	return STATUS_OK;	//  Successful execution
+}
+
+/**
+ * Set wheel set-points and start the motors for a move in desired direction,
+ * shared by the blocking function and the task (see StartEngines)
+ * @return one of myLib.h STATUS_* error codes
+ */
+int8_t EngineData::_SetupMove(uint8_t dir, float arg)
 {
 	float wheelDistance ; //centimeters
 
@@ -319,19 +317,7 @@ int8_t EngineData::StartEngines(uint8_t dir, float arg, bool blocking)
 	HAL_ENG_SetPWM(ED_LEFT, ENG_SPEED_FULL);	//  Set left engine speed
 	HAL_ENG_SetPWM(ED_RIGHT, ENG_SPEED_FULL);	//  Set right engine speed
 
-	//  Wait until the motors start turning
-    HAL_DelayUS(100000);
-
-	while ( blocking && IsDriving() )
-	    HAL_DelayUS(700000);
-	if (blocking) HAL_ENG_Enable(ED_BOTH, false);
-
-#if defined(__DEBUG_SESSION__)
-	DEBUG_WRITE("Drove LEFT: %d   RIGHT: %d  \n", wheelCounter[ED_LEFT], wheelCounter[ED_RIGHT]);
-#endif
-
-
-	return STATUS_OK;	//  Successful execution
+	return STATUS_OK;
 }
 
 /**
@@ -374,8 +360,8 @@ int8_t EngineData::RunAtPercPWM(uint8_t dir, float percLeft, float percRight)
 
 /**
  *  Move vehicle over a circular path
- * 	@param distance - distance ALONG THE CIRCUMFERENCE of arc that's necessary to travel
- * 	@param angle - angle in �(left/right) that's needed to travel along the arc
+ * 	@param distance - distance ALONG THE CIRCUMFERENCE of arc that's necessary to travel
+ * 	@param angle - angle in �(left/right) that's needed to travel along the arc
  * 	@param smallRadius - radius that's going to be traveled by the inner wheel (smaller comparing to outter wheel)
  * 	Function can be called by only two of the arguments(leaving third 0) as arc parameters can be calculated based on:
  * 		-angle and distance
@@ -385,6 +371,28 @@ int8_t EngineData::RunAtPercPWM(uint8_t dir, float percLeft, float percRight)
  *  @return one of myLib.h STATUS_* error codes
  */
 int8_t EngineData::StartEnginesArc(float distance, float angle, float smallRadius)
+{
+    int8_t retVal = _SetupArc(distance, angle, smallRadius);
+
+    if (retVal != STATUS_OK)
+        return retVal;
+
+    //  Blocking call, wait until the vehicle is moving
+    while ( IsDriving() )
+        HAL_DelayUS(700000);
+
+    HAL_ENG_Enable(ED_BOTH, true);
+
+
+    return STATUS_OK;   //  Successful execution
+}
+
+/**
+ * Set wheel set-points and start the motors for a move over a circular path
+ * (see StartEnginesArc for arguments)
+ * @return one of myLib.h STATUS_* error codes
+ */
+int8_t EngineData::_SetupArc(float distance, float angle, float smallRadius)
 {
 	float speedFactor = 1;
 
@@ -430,14 +438,7 @@ int8_t EngineData::StartEnginesArc(float distance, float angle, float smallRadiu
 
 	HAL_ENG_SetHBridge(ED_BOTH, ENG_DIR_FW);
 
-	//  Blocking call, wait until the vehicle is moving
-	while ( IsDriving() )
-	    HAL_DelayUS(700000);
-
-	HAL_ENG_Enable(ED_BOTH, true);
-
-
-	return STATUS_OK;	//  Successful execution
+	return STATUS_OK;
 }
 
 /**
@@ -447,14 +448,13 @@ int8_t EngineData::StartEnginesArc(float distance, float angle, float smallRadiu
  */
 bool EngineData::IsDriving() volatile
 {
-    static int32_t ref[0];
     bool retVal = false;
 
-    if ((wheelCounter[ED_LEFT] != ref[ED_LEFT]) || (wheelCounter[ED_RIGHT] != ref[ED_RIGHT]))
+    if ((wheelCounter[ED_LEFT] != _drivingRef[ED_LEFT]) || (wheelCounter[ED_RIGHT] != _drivingRef[ED_RIGHT]))
         retVal = true;
 
-    ref[ED_LEFT] = wheelCounter[ED_LEFT];
-    ref[ED_RIGHT] = wheelCounter[ED_RIGHT];
+    _drivingRef[ED_LEFT] = wheelCounter[ED_LEFT];
+    _drivingRef[ED_RIGHT] = wheelCounter[ED_RIGHT];
 
     return retVal;
 }
@@ -510,8 +510,13 @@ EngineData::~EngineData() {}
  */
 void PP0ISR(void)
 {
+#if defined(__USE_TASK_SCHEDULER__)
+    TS_TRACE(TR_ISR, ENGINES_UID, TR_ISR_ENC_LEFT, 0, 0);
+#endif  /* __USE_TASK_SCHEDULER__ */
+
     EngineData *__ed = EngineData::GetP();
     HAL_ENG_IntClear(ED_LEFT);
+    __ed->encoderISR[ED_LEFT].Add();
 
     //  Increase/decrease counter based on direction in which the vehicle is moving
     if (HAL_ENG_GetHBridge(ED_LEFT) == 0x01)    //0b00000001
@@ -534,8 +539,13 @@ void PP0ISR(void)
  */
 void PP1ISR(void)
 {
+#if defined(__USE_TASK_SCHEDULER__)
+    TS_TRACE(TR_ISR, ENGINES_UID, TR_ISR_ENC_RIGHT, 0, 0);
+#endif  /* __USE_TASK_SCHEDULER__ */
+
     EngineData *__ed = EngineData::GetP();
     HAL_ENG_IntClear(ED_RIGHT);
+    __ed->encoderISR[ED_RIGHT].Add();
 
     //  Increase/decrease counter based on direction in which the vehicle is moving
     if (HAL_ENG_GetHBridge(ED_RIGHT) == 0x04)    //0b00000100
@@ -3,7 +3,7 @@
  *
  *  Created on: 29. 5. 2016.
  *      Author: Vedran Mikov
- *  @version v2.2.0
+ *  @version v2.6.0
  *  V1.0 - 29.5.2016
  *  +Implemented C code as C++ object, adjusted it to use HAL
  *  V2.0 - 7.2.2017
@@ -20,6 +20,16 @@
  *  +Integration with event logger
  *  V2.2.0 - 23.9.2017
  *  +Added support for measuring wheel speed
+ *  V2.3.0 - 17.10.2026
+ *  +Kernel callback replaced with a table of services (tsService.h)
+ *  V2.4.0 - 17.10.2026
+ *  +Moves started through task scheduler no longer block it while driving,
+ *  they're resumed until the vehicle stops (tsCoroutine.h)
+ *  V2.5.0 - 17.10.2026
+ *  +Instance is owned by kernel context (init/kernelContext.h), state kept in
+ *  function-static variables moved into the object
+ *  V2.6.0 - 17.10.2026
+ *  +Counts encoder interrupts of each wheel (init/metrics.h)
  */
 #include "hwconfig.h"
 
@@ -44,9 +54,14 @@
     #define ENG_T_MOVE_PERC       2
     #define ENG_T_REBOOT          3
     #define ENG_T_SPEEDLOOP       4
+    //  Metrics of this module (see init/metrics.h)
+    #define ENG_M_ENC_LEFT        0   //  Interrupts of left wheel encoder
+    #define ENG_M_ENC_RIGHT       1   //  Interrupts of right wheel encoder
 
 #endif
 
+#include "init/metrics.h"
+
 /**     PWM arguments for different motor speed */
 #define ENG_SPEED_STOP 		1		//PWM argument for stopping engine
 #define ENG_SPEED_FULL 		15000	//PWM argument for engine full-speed
@@ -61,7 +76,7 @@
 class EngineData
 {
     friend void ControlLoop(void);
-    friend void _ENG_KernelCallback(void);
+    friend class KernelContext;
 	public:
         static EngineData& GetI();
         static EngineData* GetP();
@@ -83,15 +98,19 @@ class EngineData
 		volatile int32_t wheelSetPoint[2];  //  In encoder ticks
 		//  Pre-calculated speed of each wheel
 		volatile float wheelSpeed[2];       //  In cm/s
+		//  Number of encoder interrupts of each wheel, incremented in ISR
+		MetricCounter encoderISR[2];
 
 	protected:
         EngineData();
         ~EngineData();
         EngineData(float wheelD, float wheelS, float vehSiz, float encRes);
-        EngineData(EngineData &arg) {}           //  No definition - forbid this
-        void operator=(EngineData const &arg) {} //  No definition - forbid this
+        EngineData(EngineData &) {}              //  No definition - forbid this
+        void operator=(EngineData const &) {}    //  No definition - forbid this
 
 		bool _DirValid(uint8_t dir);
+		int8_t _SetupMove(uint8_t dir, float arg);
+		int8_t _SetupArc(float distance, float angle, float smallRadius);
 		uint32_t _cmpsToEncT(float &ticks);
 
 		//  Mechanical properties of platform
@@ -99,11 +118,22 @@ class EngineData
 		float _wheelSpacing;    //in cm
 		float _vehicleSize; 	//in cm
 		float _encRes;	//  Encoder resolution in points (# of points/rotation)
+		//  Wheel counters at the last call to IsDriving()
+		int32_t _drivingRef[2];
 
-        //  Interface with task scheduler - provides memory space and function
-        //  to call in order for task scheduler to request service from this module
+        //  Services provided to task scheduler, indexed by ENG_T_* IDs
 #if defined(__USE_TASK_SCHEDULER__)
-        _kernelEntry _ker;
+        static const _tsService _services[];
+        uint32_t _Reboot(uint8_t rebootCode);
+        uint32_t _SpeedLoop();
+        //  Time and wheel counters at the last speed calculation
+        uint64_t _lastMsCounter;
+        int32_t _lastWheelCounter[2];
+        uint32_t _StartEngines(uint8_t dir, float arg, bool blocking);
+        uint32_t _StartEnginesArc(float distance, float angle,
+                                  float smallRadius);
+        //  Move in progress, started by a task. Moves are run one at a time
+        Coroutine _moveCo;
 #endif
 };
 
@@ -5,6 +5,7 @@
  *      Author: Vedran Mikov
  */
 #include "esp8266.h"
+#include "init/kernelContext.h"
 
 #if defined(__HAL_USE_ESP8266__)       //  Compile only if module is enabled
 
@@ -31,175 +32,294 @@
 //  Function prototype for an interrupt handler (declared at the bottom)
 void UART7RxIntHandler(void);
 
-//  Buffer used to assemble commands (shared between all functions )
-//  2048 is max allowed length for a continuous stream ESP can handle
-char _commBuf[2048];
-
 
 #if defined(__USE_TASK_SCHEDULER__)
+///-----------------------------------------------------------------------------
+///         Services provided to task scheduler                      [PROTECTED]
+///-----------------------------------------------------------------------------
+
 /**
- * Callback routine to invoke service offered by this module from task scheduler
- * @note It is assumed that once this function is called task scheduler has
- * already copied required variables into the memory space provided for it.
+ * Services offered by ESP, in the order of ESP_T_* IDs
  */
-void _ESP_KernelCallback(void)
+const _tsService ESP8266::_services[] =
 {
-    //  Grab a pointer to singleton
-    //ESP8266 *__esp = ESP8266::GetP();
-    ESP8266 &__esp = ESP8266::GetI();
+    //  ESP_T_TCPSERV: enable(1B)|port(2B, only when enabling)
+    TS_SERVICE_RAW(ESP8266, uint32_t, _TCPServer, 1),
+    //  ESP_T_CONNTCP: KeepAlive(1B)|IPaddress(7B-15B)|port(2B)|socketID(1B)
+    TS_SERVICE_RAW(ESP8266, uint32_t, _ConnectTCP, 5),
+    //  ESP_T_SENDTCP: socketID(1B)|message, writing the longest message ESP
+    //  accepts (2048B) over UART at 115200 baud takes ~180ms
+    TS_SERVICE_RAW_BUDGET(ESP8266, uint32_t, _SendTCP, 1, 250000),
+    //  ESP_T_RECVSOCK: socketID
+    TS_SERVICE1(ESP8266, uint32_t, _ReceiveSocket, uint8_t),
+    //  ESP_T_CLOSETCP: socketID
+    TS_SERVICE1(ESP8266, uint32_t, _CloseTCP, uint8_t),
+    //  ESP_T_REBOOT: rebootCode(0x17)
+    TS_SERVICE1(ESP8266, uint32_t, _Reboot, uint8_t),
+    //  ESP_T_PARSE: only goes through data already received
+    TS_SERVICE0_BUDGET(ESP8266, uint32_t, _Parse, 2000)
+};
 
-    //  Check for null-pointer
-    if (__esp._ker.argN == 0)
-        return;
-    /*
-     *  Data in args[] contains bytes that constitute arguments for function
-     *  calls. The exact representation(i.e. whether bytes represent ints, floats)
-     *  of data is known only to individual blocks of switch() function. There
-     *  is no predefined data separator between arguments inside args[].
-     */
-    switch (__esp._ker.serviceID)
+/**
+ * Convert ESP library status code into one of myLib.h STATUS_* codes
+ * @param espStatus status code returned by ESP library
+ * @return STATUS_OK if ESP_STATUS_OK flag is set, STATUS_PROG_ERR otherwise
+ */
+uint32_t ESP8266::_TSStatus(uint32_t espStatus)
+{
+    return ((espStatus & ESP_STATUS_OK) > 0) ? STATUS_OK : STATUS_PROG_ERR;
+}
+
+/**
+ * Start/Stop control for TCP server
+ * 1st data byte of args[] is either 0(stop) or 1(start). Following bytes
+ * 2 & 3 contain uint16_t value of port at which to start server
+ * @return STATUS_OK
+ */
+uint32_t ESP8266::_TCPServer(const uint8_t *args, uint16_t argN)
+{
+    if (args[0] == 1)
     {
-    /*
-     * Start/Stop control for TCP server
-     * 1st data byte of args[] is either 0(stop) or 1(start). Following bytes
-     * 2 & 3 contain uint16_t value of port at which to start server
-     * args[] = enable(1B)|port(2B)
-     * retVal ESP library status code
-     */
-    case ESP_T_TCPSERV:
-        {
-            if (__esp._ker.args[0] == 1)
-            {
-                uint16_t port;
-                memcpy((void*)&port, (void*)(__esp._ker.args + 1), 2);
-                __esp._ker.retVal = __esp.StartTCPServer(port);
-                __esp.TCPListen(true);
-            }
-            else
-            {
-                __esp._ker.retVal = __esp.StopTCPServer();
-                __esp.TCPListen(false);
-            }
-            __esp._ker.retVal = ESP_STATUS_OK;
-        }
-        break;
-    /*
-     * Connect to TCP client on given IP address and port
-     * args[] = KeepAlive(1B)|IPaddress(7B-15B)|port(2B)|socketID(1B)
-     * retVal ESP library error code (if > 5); or socket ID (if <=5)
-     */
-    case ESP_T_CONNTCP:
-        {
-            char ipAddr[15] = {0};
-            uint16_t port;
-            uint8_t sockID;
-            //  IP address starts on 2nd data byte and its a string of length
-            //  equal to total length of data - 4bytes(port,KA,socketID)
-            memcpy( (void*)ipAddr,
-                    (void*)(__esp._ker.args + 1),
-                    __esp._ker.argN - 4);
-            //  Port is 3rd and 2nd byte from the back
-            memcpy( (void*)&port,
-                    (void*)(__esp._ker.args + (__esp._ker.argN-3)),
-                    2);
-            //  socketID is last byte
-            sockID =  __esp._ker.args[__esp._ker.argN-1];
-            //  If IP address is valid process request
-            if (__esp._IPtoInt(ipAddr) == 0)
-                return;
-            //  1st data byte is keep alive flag
-            //  Double negation to convert any integer !=0 into boolean
-            bool KA = !(!__esp._ker.args[0]);
-            __esp._ker.retVal = __esp.OpenTCPSock(ipAddr, port, KA, sockID);
-        }
-        break;
-    /*
-     * Send message to specific TCP client
-     * args[] = socketID(1B)|message|
-     */
-    case ESP_T_SENDTCP:
-        {
-            //  Check if socket ID is valid
-            if (!__esp.ValidSocket(__esp._ker.args[0]))
-               return;
-            //  Ensure that message is null-terminated
-            __esp._ker.args[__esp._ker.argN] = '\0';
-            //  Initiate TCP send to required client
-            __esp._ker.retVal = __esp.GetClientBySockID(__esp._ker.args[0])
-                                      ->SendTCP((char*)(__esp._ker.args+1));
-        }
-        break;
-    /*
-     * Receive data from an opened socket and pass it to user-defined routine
-     * args[] = socketID(1B)
-     */
-    case ESP_T_RECVSOCK:
-        {
-            _espClient  *cli;
-            //  Check if socket ID is valid
-            if (!__esp.ValidSocket(__esp._ker.args[0]))
-                return;
-            cli = __esp.GetClientBySockID(__esp._ker.args[0]);
-            __esp.custHook(__esp._ker.args[0],
-                            (uint8_t*)(cli->RespBody),
-                            (uint16_t)((cli->RespLen)));
-            __esp._ker.retVal = ESP_STATUS_OK;
-        }
-        break;
-    /*
-     * Close socket with specified ID
-     * args[] = socketID(1B)
-     */
-    case ESP_T_CLOSETCP:
-        {
-            //  Check if socket ID is valid
-            if (!__esp.ValidSocket(__esp._ker.args[0]))
-                return;
-            //  Initiate socket closing from client object
-            __esp._ker.retVal = __esp.GetClientBySockID(__esp._ker.args[0])
-                                              ->Close();
-        }
-        break;
-    case ESP_T_REBOOT:
-        {
-            //  Set initial error status
-            __esp._ker.retVal = ESP_STATUS_ERROR;
-            //  Reboot only if 0x17 was sent as argument
-            if (__esp._ker.args[0] != 0x17)
-                return;
-            //  Start by closing all opened sockets
-            for (uint8_t i = 0; i < ESP_MAX_CLI; i++)
-                if (__esp._clients[i] != 0)
-                    ((_espClient*)__esp._clients[i])->Close();
-            //  Power down ESP chip
-            __esp.Enable(false);
-#ifdef __HAL_USE_EVENTLOG__
-            EMIT_EV(__esp._ker.serviceID, EVENT_UNINITIALIZED);
-#endif  /* __HAL_USE_EVENTLOG__ */
-            //  Rerun initialization sequence
-            __esp._ker.retVal = __esp.InitHW();
-            __esp.wifiStatus = ESP_WIFI_CONNECTING;
+        //  Port is needed only when starting the server
+        if (argN < 3)
+            return STATUS_ARG_ERR;
 
-            //  ESP is now connecting to AP on its own, based on data stored in
-            //  its flash memory. Result is picked up through ISR asynchronously
-        }
-        break;
-    case ESP_T_PARSE:
-        {
+        StartTCPServer(_tsArg<uint16_t>(args, 1));
+        TCPListen(true);
+    }
+    else
+    {
+        StopTCPServer();
+        TCPListen(false);
+    }
 
-        }
-        break;
-    default:
-        break;
+    return STATUS_OK;
+}
+
+/**
+ * Connect to TCP client on given IP address and port
+ * @return one of myLib.h STATUS_* codes, STATUS_NO_EVENT if IP address is not
+ * valid
+ */
+uint32_t ESP8266::_ConnectTCP(const uint8_t *args, uint16_t argN)
+{
+    char ipAddr[16] = {0};
+    //  IP address starts on 2nd data byte and its a string of length
+    //  equal to total length of data - 4bytes(port,KA,socketID)
+    uint16_t ipLen = argN - 4;
+
+    TS_CO_BEGIN(_co);
+
+    if (ipLen >= sizeof(ipAddr))
+        TS_CO_RETURN(_co, STATUS_ARG_ERR);
+
+    memcpy((void*)ipAddr, (void*)(args + 1), ipLen);
+    //  If IP address is valid process request
+    if (_IPtoInt(ipAddr) == 0)
+        TS_CO_RETURN(_co, STATUS_NO_EVENT);
+
+    //  Port is 3rd and 2nd byte from the back and socketID is the last byte
+    _coSock = args[argN - 1];
+    if (_PrepOpen(ipAddr, _tsArg<uint16_t>(args, argN - 3), &_coSock)
+            != ESP_STATUS_OK)
+        TS_CO_RETURN(_co, STATUS_PROG_ERR);
+
+    _SendCmd(_commBuf, 250);
+    TS_CO_AWAIT(_co, _Replied(0), 1, 500);
+    TS_CO_SLEEP(_co, 1);
+    _EndCmd();
+
+    //  Client object is created by the parser once ESP confirms connection
+    if (!_InStatus(flowControl, ESP_STATUS_OK) ||
+        _InStatus(flowControl, ESP_STATUS_ERROR) ||
+        (GetClientBySockID(_coSock) == 0))
+        TS_CO_RETURN(_co, STATUS_PROG_ERR);
+
+    //  Start listening for potential incoming data from server, 1st data byte
+    //  is keep alive flag
+    TCPListen(true);
+    GetClientBySockID(_coSock)->KeepAlive = _tsArg<bool>(args, 0);
+
+    TS_CO_END(_co);
+    return STATUS_OK;
+}
+
+/**
+ * Send message to specific TCP client
+ * @return one of myLib.h STATUS_* codes, STATUS_NO_EVENT if socket is not valid
+ */
+uint32_t ESP8266::_SendTCP(const uint8_t *args, uint16_t argN)
+{
+    TS_CO_BEGIN(_co);
+
+    //  Check if socket ID is valid
+    if (!ValidSocket(args[0]))
+        TS_CO_RETURN(_co, STATUS_NO_EVENT);
+
+    //  Announce length of the message (it can hold any byte), ESP replies with
+    //  a prompt once it's ready to receive it
+    GetClientBySockID(args[0])->_PrepSend(argN - 1);
+    _SendCmd(_commBuf, 600);
+    TS_CO_AWAIT(_co, _Replied(ESP_STATUS_RECV), 1, 1200);
+    TS_CO_SLEEP(_co, 1);
+
+    //  Socket might have been closed while waiting
+    if ((flowControl == ESP_NO_STATUS) ||
+        _InStatus(flowControl, ESP_STATUS_ERROR) || !ValidSocket(args[0]))
+    {
+        _EndCmd();
+        TS_CO_RETURN(_co, STATUS_PROG_ERR);
     }
 
-    //  Report outcome to event logger
+    flowControl = ESP_NO_STATUS;
+    _HoldChannel(600);
+    //  If ESP is not in server mode we need to manually start listening for
+    //  incoming data from ESP
+    if (!_servOpen)
+        HAL_ESP_IntEnable(true);
+    _RAWPortWrite((const char*)(args + 1), argN - 1);
+
+    TS_CO_AWAIT(_co, (flowControl != ESP_NO_STATUS), 1, 1200);
+    _EndCmd();
+
+    TS_CO_END(_co);
+    return _TSStatus(flowControl);
+}
+
+/**
+ * Receive data from an opened socket and pass it to user-defined routine
+ * @param sockID ID of the socket
+ * @return STATUS_OK, STATUS_NO_EVENT if socket is not valid
+ */
+uint32_t ESP8266::_ReceiveSocket(uint8_t sockID)
+{
+    _espClient  *cli;
+    //  Check if socket ID is valid
+    if (!ValidSocket(sockID))
+        return STATUS_NO_EVENT;
+
+    cli = GetClientBySockID(sockID);
+    custHook(sockID, (uint8_t*)(cli->RespBody), (uint16_t)((cli->RespLen)));
+
+    return STATUS_OK;
+}
+
+/**
+ * Close socket with specified ID
+ * @param sockID ID of the socket
+ * @return one of myLib.h STATUS_* codes, STATUS_NO_EVENT if socket is not valid
+ */
+uint32_t ESP8266::_CloseTCP(uint8_t sockID)
+{
+    TS_CO_BEGIN(_co);
+
+    //  Check if socket ID is valid
+    if (!ValidSocket(sockID))
+        TS_CO_RETURN(_co, STATUS_NO_EVENT);
+
+    //  Client object is deleted by the parser once ESP confirms closing
+    GetClientBySockID(sockID)->_PrepClose();
+    _SendCmd(_commBuf, 250);
+    TS_CO_AWAIT(_co, _Replied(0), 1, 500);
+    TS_CO_SLEEP(_co, 1);
+    _EndCmd();
+
+    TS_CO_END(_co);
+    return _TSStatus(flowControl);
+}
+
+/**
+ * Reboot ESP module, closing all sockets and rerunning initialization
+ * @param rebootCode has to be 0x17 for reboot to take place
+ * @return one of myLib.h STATUS_* codes
+ */
+uint32_t ESP8266::_Reboot(uint8_t rebootCode)
+{
+    //  Reboot only if 0x17 was sent as argument
+    if (rebootCode != 0x17)
+        return STATUS_ARG_ERR;
+
+    //  Start by closing all opened sockets
+    for (uint8_t i = 0; i < ESP_MAX_CLI; i++)
+        if (_clients[i] != 0)
+            ((_espClient*)_clients[i])->Close();
+    //  Power down ESP chip
+    Enable(false);
 #ifdef __HAL_USE_EVENTLOG__
-    if ((__esp._ker.retVal & ESP_STATUS_OK) > 0)
-        EMIT_EV(__esp._ker.serviceID, EVENT_OK);
-    else
-        EMIT_EV(__esp._ker.serviceID, EVENT_ERROR);
+    EMIT_EV(ESP_T_REBOOT, EVENT_UNINITIALIZED);
 #endif  /* __HAL_USE_EVENTLOG__ */
+    //  Rerun initialization sequence
+    uint32_t retVal = InitHW();
+    wifiStatus = ESP_WIFI_CONNECTING;
+
+    //  ESP is now connecting to AP on its own, based on data stored in
+    //  its flash memory. Result is picked up through ISR asynchronously
+    return _TSStatus(retVal);
+}
+
+/**
+ * Placeholder for parsing of received data from task scheduler
+ * @return STATUS_NO_EVENT
+ */
+uint32_t ESP8266::_Parse()
+{
+    return STATUS_NO_EVENT;
+}
+
+/**
+ * Send command to ESP without waiting for the reply. Task awaits the reply
+ * with _Replied() and releases the channel with _EndCmd() once it's done
+ * @param cmd null-terminated string with command to execute
+ * @param timeout time in ms before watchdog timer interrupts waiting
+ */
+void ESP8266::_SendCmd(const char *cmd, uint32_t timeout)
+{
+    //  Only one task at a time gets here (socket services share a coroutine),
+    //  channel can still be held by a task killed while waiting
+    _cmdBusy = false;
+    _SendRAW(cmd, ESP_NONBLOCKING_MODE, timeout);
+    _HoldChannel(timeout);
+}
+
+/**
+ * Start watchdog timer and keep the channel for the task awaiting reply. If
+ * the task never comes back channel is released after twice the timeout
+ * @param timeout time in ms before watchdog timer interrupts waiting
+ */
+void ESP8266::_HoldChannel(uint32_t timeout)
+{
+    HAL_ESP_WDControl(true, timeout);
+    _cmdUntil = (uint32_t)msSinceStartup + 2 * timeout;
+    _cmdBusy = true;
+}
+
+/**
+ * Check whether ESP has replied to the last command
+ * @param flags bitwise OR of ESP_STATUS_* values accepted as reply, in addition
+ * to status OK and ERROR
+ * @return true if reply has been received (or watchdog timer has expired)
+ */
+bool ESP8266::_Replied(uint32_t flags)
+{
+    return ((flowControl & (ESP_STATUS_OK | ESP_STATUS_ERROR | flags)) != 0);
+}
+
+/**
+ * Stop watchdog timer and release the channel held by a task
+ */
+void ESP8266::_EndCmd()
+{
+    HAL_ESP_WDControl(false, 0);
+    _cmdBusy = false;
+}
+
+/**
+ * Check whether a task is waiting for reply on the channel
+ * @return true if channel is held by a task
+ */
+bool ESP8266::_ChannelBusy()
+{
+    return _cmdBusy && ((int32_t)(_cmdUntil - (uint32_t)msSinceStartup) > 0);
 }
 #endif  /* __USE_TASK_SCHEDULER__ */
 
@@ -211,6 +331,10 @@ void _ESP_KernelCallback(void)
  */
 void ESPWDISR()
 {
+#if defined(__USE_TASK_SCHEDULER__)
+    TS_TRACE(TR_ISR, ESP_UID, TR_ISR_ESP_WD, 0, 0);
+#endif  /* __USE_TASK_SCHEDULER__ */
+
     ESP8266::GetI().flowControl = ESP_STATUS_ERROR;
 
 #ifdef __HAL_USE_EVENTLOG__
@@ -226,12 +350,11 @@ void ESPWDISR()
 
 /**
  * Return reference to a singleton
- * @return reference to an internal static instance
+ * @return reference to the instance owned by current kernel context
  */
 ESP8266& ESP8266::GetI()
 {
-    static ESP8266 singletonInstance;
-    return singletonInstance;
+    return *(KernelContext::Current().esp);
 }
 
 /**
@@ -287,8 +410,20 @@ uint32_t ESP8266::InitHW(int32_t baud)
 
 #if defined(__USE_TASK_SCHEDULER__)
     //  Register module services with task scheduler
-    _ker.callBackFunc = _ESP_KernelCallback;
-    TS_RegCallback(&_ker, ESP_UID);
+    TS_RegServices(ESP_UID, TS_SERVICES(_services));
+    //  Burst of incoming data schedules a receive for every +IPD line, one
+    //  pending receive per socket reads all of it. Same for repeated reboots
+    TaskScheduler::GetP()->SetCoalescing(ESP_UID, ESP_T_RECVSOCK,
+                                         T_COALESCE_KEEP, 1);
+    TaskScheduler::GetP()->SetCoalescing(ESP_UID, ESP_T_REBOOT,
+                                         T_COALESCE_KEEP);
+
+    //  Register metrics of the module
+    MetricsRegistry &metrics = MetricsRegistry::GetI();
+    metrics.Register(_mTxBytes, ESP_UID, ESP_M_TX_BYTES);
+    metrics.Register(_mRxBytes, ESP_UID, ESP_M_RX_BYTES);
+    metrics.Register(_mParseErr, ESP_UID, ESP_M_PARSE_ERR);
+    metrics.Register(_mRxSize, ESP_UID, ESP_M_RX_SIZE);
 #endif  /* __USE_TASK_SCHEDULER__ */
 
 #ifdef __HAL_USE_EVENTLOG__
@@ -344,7 +479,7 @@ void ESP8266::AddHook(void((*funPoint)(const uint8_t, const uint8_t*, const uint
  * as it comes through interrupt
  * @return error code, depending on the outcome
  */
-uint32_t ESP8266::ConnectAP(char* APname, char* APpass, bool nonBlocking)
+uint32_t ESP8266::ConnectAP(const char* APname, const char* APpass, bool nonBlocking)
 {
     int8_t retVal = ESP_NO_STATUS;
 
@@ -499,39 +634,10 @@ uint32_t ESP8266::OpenTCPSock(char *ipAddr, uint16_t port,
                               bool keepAlive, uint8_t sockID)
 {
     uint32_t retVal;
-    uint8_t strNum[6] = {0};
 
-    //  Can't continue if ESP is not connected
-    if (wifiStatus != ESP_WIFI_CONNECTED)
+    if (_PrepOpen(ipAddr, port, &sockID) != ESP_STATUS_OK)
         return ESP_STATUS_ERROR;
 
-    //  Check if socket with this ID already exists, if not create it, if yes
-    //  fined first free socket ID and use it instead
-    if (GetClientBySockID(sockID) != 0 || (sockID >= ESP_MAX_CLI))
-    {
-        //  Find free socket number (0-(ESP_MAX_CLI-1) supported)
-        for (sockID = 0; sockID <= ESP_MAX_CLI; sockID++)
-            if (_clients[sockID] == 0)
-                break;
-        //  If loop hit ESP_MAX_CLI there are no free sockets, return error code
-        if (sockID >= ESP_MAX_CLI)
-            return ESP_STATUS_ERROR;
-    }
-
-    //  Assemble command: Open TCP socket to specified IP and port, set
-    //  keep alive interval to 7200ms
-    memset(_commBuf, 0, sizeof(_commBuf));
-    strcat(_commBuf, "AT+CIPSTART=");
-    itoa(sockID, strNum);
-    strcat(_commBuf, (char*)strNum);
-    strcat(_commBuf, ",\"TCP\",\"");
-    strcat(_commBuf, ipAddr);
-    strcat(_commBuf, "\",");
-    memset(strNum, 0, sizeof(strNum));
-    itoa(port, strNum);
-    strcat(_commBuf, (char*)strNum);
-    strcat(_commBuf, ",7200\0");
-
     //  Execute command and check outcome
     retVal = _SendRAW(_commBuf);
     if (_InStatus(retVal, ESP_STATUS_OK) && !_InStatus(retVal, ESP_STATUS_ERROR))
@@ -693,7 +799,17 @@ uint32_t ESP8266::ParseResponse(char* rxBuffer, uint16_t rxLen)
     {
         int i;
         //  Get client who sent the incoming data (based on socket ID)
-        _espClient *cli = const_cast<_espClient*>(_clients[_IDtoIndex(rxBuffer[respFlag] - 48)]);
+        uint8_t index = _IDtoIndex(rxBuffer[respFlag] - 48);
+        _espClient *cli = 0;
+        if (index < ESP_MAX_CLI)
+            cli = const_cast<_espClient*>(_clients[index]);
+
+        //  Data for a socket ESP hasn't reported as opened, nowhere to put it
+        if (cli == 0)
+        {
+            _mParseErr.Add();
+            return retVal;
+        }
 
         //  respFlag points to socket ID (single digit < 5)
         i = respFlag+2; //Skip comma and go to first digit of length
@@ -705,6 +821,14 @@ uint32_t ESP8266::ParseResponse(char* rxBuffer, uint16_t rxLen)
             cmsgLen[i-1-respFlag-2] = rxBuffer[i-1];
         //  Convert message length string to int and save it
         cli->RespLen = (uint16_t)lroundf(stof(cmsgLen, i-1-respFlag));
+        //  Length doesn't fit into client's buffer, reply is corrupted
+        if (cli->RespLen > sizeof(cli->RespBody))
+        {
+            cli->RespLen = 0;
+            _mParseErr.Add();
+            return retVal;
+        }
+        _mRxSize.Observe(cli->RespLen);
         // i now points to the first char of the actual received message
         //  Use raspFlag to mark starting point
         respFlag = i;
@@ -725,9 +849,13 @@ uint32_t ESP8266::ParseResponse(char* rxBuffer, uint16_t rxLen)
 ///                      Class constructor & destructor              [PROTECTED]
 ///-----------------------------------------------------------------------------
 
-ESP8266::ESP8266() : custHook(0), flowControl(ESP_NO_STATUS), _tcpServPort(0),
-                     _ipAddress(0), _servOpen(false), wifiStatus(0)
+ESP8266::ESP8266() : flowControl(ESP_NO_STATUS), wifiStatus(0), custHook(0),
+                     _ipAddress(0), _tcpServPort(0), _servOpen(false)
 {
+#if defined(__USE_TASK_SCHEDULER__)
+    _cmdBusy = false;
+    _cmdUntil = 0;
+#endif  /* __USE_TASK_SCHEDULER__ */
 #ifdef __HAL_USE_EVENTLOG__
     EMIT_EV(-1, EVENT_UNINITIALIZED);
 #endif  /* __HAL_USE_EVENTLOG__ */
@@ -769,6 +897,12 @@ uint32_t ESP8266::_SendRAW(const char* txBuffer, uint32_t flags, uint32_t timeou
 {
     uint16_t txLen = 0;
 
+#if defined(__USE_TASK_SCHEDULER__)
+    //  Reply on the way belongs to a task, don't steal it
+    if (_ChannelBusy())
+        return ESP_STATUS_BUSY;
+#endif
+
     HAL_ESP_WDControl(false, timeout);
 
     //  Reset global status
@@ -789,6 +923,7 @@ uint32_t ESP8266::_SendRAW(const char* txBuffer, uint32_t flags, uint32_t timeou
     //  ESP messages terminated by \r\n
     HAL_ESP_SendChar('\r');
     HAL_ESP_SendChar('\n');
+    _mTxBytes.Add(txLen + 2);
 
     //  Start listening for reply
     HAL_ESP_IntEnable(true);
@@ -801,7 +936,8 @@ uint32_t ESP8266::_SendRAW(const char* txBuffer, uint32_t flags, uint32_t timeou
 
         while( !(flowControl & ESP_STATUS_OK) &&
                 !(flowControl & ESP_STATUS_ERROR) &&
-                !(flowControl & flags));
+                !(flowControl & flags))
+            HAL_ESP_WaitReply();
 
         HAL_DelayUS(1000);
         //  Stop watchdog timer
@@ -811,6 +947,53 @@ uint32_t ESP8266::_SendRAW(const char* txBuffer, uint32_t flags, uint32_t timeou
     else return ESP_NONBLOCKING_MODE;
 }
 
+/**
+ * Assemble command opening TCP socket to specific IP and port in _commBuf
+ * @param ipAddr string containing IP address of server(null-terminated)
+ * @param port TCP socket port of server
+ * @param sockID[in/out] desired socket ID, replaced with smallest free ID if
+ * it's taken or not valid
+ * @return ESP_STATUS_OK if command is ready, ESP_STATUS_ERROR if ESP is not
+ * connected or there are no free sockets
+ */
+uint32_t ESP8266::_PrepOpen(char *ipAddr, uint16_t port, uint8_t *sockID)
+{
+    uint8_t strNum[6] = {0};
+
+    //  Can't continue if ESP is not connected
+    if (wifiStatus != ESP_WIFI_CONNECTED)
+        return ESP_STATUS_ERROR;
+
+    //  Check if socket with this ID already exists, if not create it, if yes
+    //  fined first free socket ID and use it instead
+    if (GetClientBySockID(*sockID) != 0 || ((*sockID) >= ESP_MAX_CLI))
+    {
+        //  Find free socket number (0-(ESP_MAX_CLI-1) supported)
+        for ((*sockID) = 0; (*sockID) < ESP_MAX_CLI; (*sockID)++)
+            if (_clients[*sockID] == 0)
+                break;
+        //  If loop hit ESP_MAX_CLI there are no free sockets, return error code
+        if ((*sockID) >= ESP_MAX_CLI)
+            return ESP_STATUS_ERROR;
+    }
+
+    //  Assemble command: Open TCP socket to specified IP and port, set
+    //  keep alive interval to 7200ms
+    memset(_commBuf, 0, sizeof(_commBuf));
+    strcat(_commBuf, "AT+CIPSTART=");
+    itoa(*sockID, strNum);
+    strcat(_commBuf, (char*)strNum);
+    strcat(_commBuf, ",\"TCP\",\"");
+    strcat(_commBuf, ipAddr);
+    strcat(_commBuf, "\",");
+    memset(strNum, 0, sizeof(strNum));
+    itoa(port, strNum);
+    strcat(_commBuf, (char*)strNum);
+    strcat(_commBuf, ",7200\0");
+
+    return ESP_STATUS_OK;
+}
+
 /**
  * Write bytes directly to port (used when sending data of TCP/UDP socket)
  * @param buffer data to send to serial port
@@ -827,6 +1010,7 @@ void ESP8266::_RAWPortWrite(const char* buffer, uint16_t bufLen)
         while(HAL_ESP_UARTBusy());
         HAL_ESP_SendChar(buffer[i]);
     }
+    _mTxBytes.Add(bufLen);
 }
 
 /**
@@ -889,11 +1073,16 @@ uint8_t ESP8266::_IDtoIndex(uint8_t sockID)
 
 void UART7RxIntHandler(void)
 {
+#if defined(__USE_TASK_SCHEDULER__)
+    TS_TRACE(TR_ISR, ESP_UID, TR_ISR_ESP_RX, 0, 0);
+#endif  /* __USE_TASK_SCHEDULER__ */
+
     //  Grab a pointer to singleton
     ESP8266 &__esp = ESP8266::GetI();
 
-    static char rxBuffer[1024] ;
-    static uint16_t rxLen = 0;
+    char (&rxBuffer)[1024] = __esp._rxBuffer;
+    uint16_t &rxLen = __esp._rxLen;
+    uint32_t rxNum = 0;
 
     HAL_ESP_ClearInt();             //  Clear interrupt
 
@@ -905,9 +1094,15 @@ void UART7RxIntHandler(void)
         HAL_ESP_WDControl(true, 0);
 
         rxBuffer[rxLen++] = temp;
-        //  Keep in mind buffer size
-        rxLen %= sizeof(rxBuffer);
+        rxNum++;
+        //  Keep in mind buffer size, reply longer than that is lost
+        if (rxLen == sizeof(rxBuffer))
+        {
+            rxLen = 0;
+            __esp._mParseErr.Add();
+        }
     }
+    __esp._mRxBytes.Add(rxNum);
 
     /*
      * If watchdog timer times out, artificially produce terminating sequence at
@@ -982,9 +1177,8 @@ void UART7RxIntHandler(void)
                 {
 #if defined(__USE_TASK_SCHEDULER__)
                 //  If using task scheduler, schedule receiving outside this ISR
-                    volatile TaskEntry tE(ESP_UID, ESP_T_RECVSOCK, 0);
-                    tE.AddArg(&__esp.GetClientByIndex(i)->_id, 1);
-                    TaskScheduler::GetP()->SyncTask(tE);
+                    TaskScheduler::GetP()->SyncTaskISR(ESP_UID, ESP_T_RECVSOCK,
+                                      (void*)&__esp.GetClientByIndex(i)->_id, 1);
 #else
                     //  If no task scheduler do everything in here
                     _espClient* cli = __esp.GetClientByIndex(i);
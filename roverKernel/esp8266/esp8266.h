@@ -5,7 +5,7 @@
  *      Author: Vedran Mikov
  *
  *  ESP8266 WiFi module communication library
- *  @version 1.4.5
+ *  @version 1.8.0
  *  V1.1.4
  *  +Connect/disconnect from AP, get acquired IP as string/int
  *	+Start TCP server and allow multiple connections, keep track of
@@ -54,6 +54,23 @@
  *  +Stability improvements, different placement of watchdog resets
  *  V1.4.5 - 2.9.2017
  *  +Bugfix in parser, fixed problem with multiple sockets closing at the same time
+ *  V1.5.0 - 17.10.2026
+ *  +Kernel callback replaced with a table of services (tsService.h)
+ *  +Data sent to socket through task scheduler can hold any byte (length of
+ *  the message is passed on instead of looking for terminating zero)
+ *  V1.6.0 - 17.10.2026
+ *  +Opening, closing and sending to a socket through task scheduler no longer
+ *  waits for ESP reply in a loop; task yields until the reply arrives
+ *  (tsCoroutine.h). Meanwhile AT channel is held by the task and blocking
+ *  calls return ESP_STATUS_BUSY instead of interleaving their own command
+ *  V1.7.0 - 17.10.2026
+ *  +Instance is owned by kernel context (init/kernelContext.h), command buffer
+ *  and receive buffer of the interrupt handler are members of the object
+ *  V1.8.0 - 17.10.2026
+ *  +Counts bytes sent to and received from ESP, replies that couldn't be
+ *  parsed and sizes of data received on sockets (init/metrics.h)
+ *  *Bugfix: Data for a socket with no client, or longer than the buffer of
+ *  the client, is dropped instead of being written through a bad pointer
  *
  *  TODO:Add interface to send UDP packet
  */
@@ -65,12 +82,10 @@
 
 //  Define class prototype
 class ESP8266;
-//  Shared buffer for ESP library to assemble text requests in (declared extern
-//  because it's shared with espClient library
-extern char _commBuf[2048];
 
 //  Include client library
 #include "espClient.h"
+#include "init/metrics.h"
 
 //  Enable integration of this library with task scheduler but only if task
 //  scheduler is being compiled into this project
@@ -91,6 +106,11 @@ extern char _commBuf[2048];
     #define ESP_T_CLOSETCP  4   //  Close socket with specific ID
     #define ESP_T_REBOOT    5   //  Reboot ESP module and UART bus
     #define ESP_T_PARSE     6
+    //  Metrics of this module (see init/metrics.h)
+    #define ESP_M_TX_BYTES  0   //  Bytes sent to ESP, commands and socket data
+    #define ESP_M_RX_BYTES  1   //  Bytes received from ESP
+    #define ESP_M_PARSE_ERR 2   //  Replies that couldn't be parsed
+    #define ESP_M_RX_SIZE   3   //  Histogram of sizes of data from sockets
 #endif
 
 /*		Communication settings	 	*/
@@ -136,7 +156,7 @@ class ESP8266
     /// Functions & classes needing direct access to all members
     friend class    _espClient;
     friend void     UART7RxIntHandler(void);
-    friend void     _ESP_KernelCallback(void);
+    friend class    KernelContext;
 	public:
         //  Functions for returning static instance
         static ESP8266& GetI();
@@ -148,7 +168,7 @@ class ESP8266
         void        AddHook(void((*funPoint)(const uint8_t, const uint8_t*,
                                              const uint16_t)));
 		//  Functions used with access points
-		uint32_t    ConnectAP(char* APname, char* APpass, bool nonBlocking=false);
+		uint32_t    ConnectAP(const char* APname, const char* APpass, bool nonBlocking=false);
 		bool        IsConnected();
 		uint32_t    DisconnectAP();
 		uint32_t    MyIP();
@@ -164,7 +184,7 @@ class ESP8266
 		uint32_t    OpenTCPSock(char *ipAddr, uint16_t port,
 		                        bool keepAlive=true, uint8_t sockID = 9);
 		bool        ValidSocket(uint8_t id);
-		uint32_t    Send(const char* arg, ...) { return ESP_NO_STATUS; }
+		uint32_t    Send(const char*, ...) { return ESP_NO_STATUS; }
 		//  Miscellaneous functions
 		uint32_t 	ParseResponse(char* rxBuffer, uint16_t rxLen);
 
@@ -176,8 +196,8 @@ class ESP8266
 	protected:
         ESP8266();
         ~ESP8266();
-        ESP8266(ESP8266 &arg) {}                //  No definition - forbid this
-        void operator=(ESP8266 const &arg) {}   //  No definition - forbid this
+        ESP8266(ESP8266 &) {}                   //  No definition - forbid this
+        void operator=(ESP8266 const &) {}      //  No definition - forbid this
 
 		bool        _InStatus(const uint32_t status, const uint32_t flag);
 		uint32_t	_SendRAW(const char* txBuffer, uint32_t flags = 0,
@@ -185,10 +205,11 @@ class ESP8266
 		void        _RAWPortWrite(const char* buffer, uint16_t bufLen);
 		void	    _FlushUART();
 		uint32_t    _IPtoInt(char *ipAddr);
+		uint32_t    _PrepOpen(char *ipAddr, uint16_t port, uint8_t *sockID);
 		uint8_t     _IDtoIndex(uint8_t sockID);
 
         //  Hook to user routine called when data from socket is received
-        void    ((*custHook)(const uint8_t, const uint8_t*, const uint16_t));
+        void    (*custHook)(const uint8_t, const uint8_t*, const uint16_t);
 		//  IP address in decimal and string format
 		uint32_t    _ipAddress;
 		char        _ipStr[16];
@@ -200,10 +221,41 @@ class ESP8266
 		//  ESP. It's important that pointers itself are volatile, not _espClient
 		//  object because pointers get changed within ISR. Array index is socket ID!
 		_espClient volatile *_clients[ESP_MAX_CLI];
-		//  Interface with task scheduler - provides memory space and function
-		//  to call in order for task scheduler to request service from this module
+		//  Buffer used to assemble commands (shared with espClient library)
+		//  2048 is max allowed length for a continuous stream ESP can handle
+		char        _commBuf[2048];
+		//  Reply being received in UART interrupt, until it's complete
+		char        _rxBuffer[1024];
+		uint16_t    _rxLen;
+		//  Metrics of the module, see ESP_M_* IDs
+		MetricCounter   _mTxBytes;
+		MetricCounter   _mRxBytes;
+		MetricCounter   _mParseErr;
+		MetricHistogram _mRxSize;
+		//  Services provided to task scheduler, indexed by ESP_T_* IDs
 #if defined(__USE_TASK_SCHEDULER__)
-		_kernelEntry _ker;
+		static const _tsService _services[];
+		static uint32_t _TSStatus(uint32_t espStatus);
+		uint32_t    _TCPServer(const uint8_t *args, uint16_t argN);
+		uint32_t    _ConnectTCP(const uint8_t *args, uint16_t argN);
+		uint32_t    _SendTCP(const uint8_t *args, uint16_t argN);
+		uint32_t    _ReceiveSocket(uint8_t sockID);
+		uint32_t    _CloseTCP(uint8_t sockID);
+		uint32_t    _Reboot(uint8_t rebootCode);
+		uint32_t    _Parse();
+		//  Issuing command from a task without waiting for reply
+		void        _SendCmd(const char *cmd, uint32_t timeout);
+		void        _HoldChannel(uint32_t timeout);
+		bool        _Replied(uint32_t flags);
+		void        _EndCmd();
+		bool        _ChannelBusy();
+		//  Socket operation in progress, one at a time, and the socket it's on
+		Coroutine   _co;
+		uint8_t     _coSock;
+		//  Set while a task is waiting for reply, until time stamp (in ms) at
+		//  which the channel is released even if task never comes back
+		volatile bool       _cmdBusy;
+		volatile uint32_t   _cmdUntil;
 #endif
 };
 
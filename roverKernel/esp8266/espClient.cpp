@@ -60,7 +60,13 @@ void _espClient::operator= (const _espClient &arg)
 uint32_t _espClient::SendTCP(char *buffer, uint16_t bufferLen)
 {
     uint16_t bufLen = bufferLen;
-    uint8_t numStr[6] = {0};
+
+#if defined(__USE_TASK_SCHEDULER__)
+    //  Task is waiting for reply to its command, writing to the port now
+    //  would end up in the middle of it
+    if (_parent->_ChannelBusy())
+        return ESP_STATUS_BUSY;
+#endif
 
     //  If buffer length is not provided find it by looking for \0 char in string
     if (bufferLen == 0)
@@ -70,16 +76,9 @@ uint32_t _espClient::SendTCP(char *buffer, uint16_t bufferLen)
         bufLen--;   //Exclude \0 char from size of buffer
     }
 
-    memset(_commBuf, 0, sizeof(_commBuf));
-    strcat(_commBuf, "AT+CIPSEND=");
-    itoa(_id, numStr);
-    strcat(_commBuf, (char*)numStr);
-    strcat(_commBuf, ",");
-    memset(numStr, 0, sizeof(numStr));
-    itoa(bufLen, numStr);
-    strcat(_commBuf, (char*)numStr);
+    _PrepSend(bufLen);
 
-    if (_parent->_SendRAW(_commBuf, ESP_STATUS_RECV, 600))
+    if (_parent->_SendRAW(_parent->_commBuf, ESP_STATUS_RECV, 600))
     {
         _parent->flowControl = ESP_NO_STATUS;
         HAL_ESP_WDControl(true, 600);
@@ -93,7 +92,8 @@ uint32_t _espClient::SendTCP(char *buffer, uint16_t bufferLen)
         _parent->_RAWPortWrite(buffer, bufLen);
 
         //  Listen for potential response
-        while (_parent->flowControl == ESP_NO_STATUS);
+        while (_parent->flowControl == ESP_NO_STATUS)
+            HAL_ESP_WaitReply();
     }
     //   Stop watchdog timer (started in ISR)
     //HAL_ESP_WDControl(false, 0);
@@ -130,8 +130,9 @@ bool _espClient::Receive(char *buffer, uint16_t *bufferLen)
         if (!KeepAlive)
         {
 #if defined(__USE_TASK_SCHEDULER__)
-            TaskScheduler::GetP()->SyncTask(ESP_UID, ESP_T_CLOSETCP, 0);
-            TaskScheduler::GetP()->AddArgs(&_id, 1);
+            //  Can be called from a hook run in interrupt, only post request
+            TaskScheduler::GetP()->SyncTaskISR(ESP_UID, ESP_T_CLOSETCP,
+                                               (void*)&_id, 1);
 #else
             Close();
 #endif
@@ -169,8 +170,9 @@ void _espClient::Done()
     if (!KeepAlive)
     {
 #if defined(__USE_TASK_SCHEDULER__)
-        TaskScheduler::GetP()->SyncTask(ESP_UID, ESP_T_CLOSETCP, 0);
-        TaskScheduler::GetP()->AddArgs(&_id, 1);
+        //  Can be called from a hook run in interrupt, only post request
+        TaskScheduler::GetP()->SyncTaskISR(ESP_UID, ESP_T_CLOSETCP,
+                                           (void*)&_id, 1);
 #else
         Close();
 #endif
@@ -183,16 +185,48 @@ void _espClient::Done()
  * @return status of close process (binary or of ESP_* flags received while closing)
  */
 uint32_t _espClient::Close()
+{
+    _PrepClose();
+
+    return _parent->_SendRAW(_parent->_commBuf);
+}
+
+///-----------------------------------------------------------------------------
+///                      Command assembly                              [PRIVATE]
+///-----------------------------------------------------------------------------
+
+/**
+ * Assemble command announcing data to be sent over this socket in _commBuf
+ * @param bufLen length of data (in bytes) that will follow
+ */
+void _espClient::_PrepSend(uint16_t bufLen)
+{
+    uint8_t numStr[6] = {0};
+
+    memset(_parent->_commBuf, 0, sizeof(_parent->_commBuf));
+    strcat(_parent->_commBuf, "AT+CIPSEND=");
+    itoa(_id, numStr);
+    strcat(_parent->_commBuf, (char*)numStr);
+    strcat(_parent->_commBuf, ",");
+    memset(numStr, 0, sizeof(numStr));
+    itoa(bufLen, numStr);
+    strcat(_parent->_commBuf, (char*)numStr);
+}
+
+/**
+ * Assemble command closing this socket in _commBuf, socket is no longer alive
+ * from this point on
+ */
+void _espClient::_PrepClose()
 {
     uint8_t strNum[6] = {0};
 
-    memset(_commBuf, 0, sizeof(_commBuf));
-    strcat(_commBuf, "AT+CIPCLOSE=");
+    memset(_parent->_commBuf, 0, sizeof(_parent->_commBuf));
+    strcat(_parent->_commBuf, "AT+CIPCLOSE=");
     itoa(_id, strNum);
-    strcat(_commBuf, (char*)strNum);
+    strcat(_parent->_commBuf, (char*)strNum);
 
     _alive = false;
-    return _parent->_SendRAW(_commBuf);
 }
 
 /**
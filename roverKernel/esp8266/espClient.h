@@ -43,6 +43,8 @@ class _espClient
 
     private:
         void        _Clear();
+        void        _PrepSend(uint16_t bufLen);
+        void        _PrepClose();
 
         //  Pointer to a parent device of of this client
         ESP8266         *_parent;
@@ -16,7 +16,12 @@
 #include <stdbool.h>
 
 //  Define platform in use in hal.h
+//  Kernel can also run as a process on a Linux host, on a simulated board with
+//  virtual time (see HAL/posix/hal_sim_posix.h). To build it that way, define
+//  __BOARD_POSIX__ on compiler's command line (-D__BOARD_POSIX__)
+#if !defined(__BOARD_POSIX__)
 #define __BOARD_TM4C1294NCPDT__
+#endif
 
 /*
  * Compile all libraries in debug mode, allowing them to print debug data to
@@ -35,6 +40,7 @@
 #define __HAL_USE_RADAR__
 #define __HAL_USE_TASKSCH__
 #define __HAL_USE_EVENTLOG__
+#define __HAL_USE_STORAGE__
 
 /*
  * This section configures MPU9250 sensor
@@ -60,6 +66,82 @@
 //  Define number of modules in the kernel (used to initialize memory space)
 #define NUM_OF_MODULES  10
 
+//  Define max number of tasks pending in task scheduler at the same time (used
+//  to initialize memory space for task queue). Both this and the number of
+//  index buckets can be given on compiler's command line instead, host
+//  benchmarks use it to build kernel with a bigger queue
+#ifndef TS_MAX_TASKS
+#define TS_MAX_TASKS    64
+#endif
+
+//  Define number of buckets in each hash table of index of pending tasks (see
+//  tsIndex.h). Has to be a power of 2, shouldn't be smaller than TS_MAX_TASKS
+#ifndef TS_INDEX_BUCKETS
+#define TS_INDEX_BUCKETS    64
+#endif
+
+//  Define size (in bytes, including null-terminator) of arguments stored inside
+//  the task entry itself. Only longer arguments are placed in memory pools.
+#define TS_ARG_INLINE_SIZE  16
+
+//  Define memory pools for arguments of tasks in task scheduler. Arguments are
+//  stored in small blocks if they fit, in large blocks otherwise. Task with
+//  arguments bigger than large block is refused. Size in bytes.
+#define TS_ARG_SMALL_SIZE   64
+#define TS_ARG_SMALL_NUM    16
+#define TS_ARG_LARGE_SIZE   256
+#define TS_ARG_LARGE_NUM    4
+
+//  Define number of requests interrupts can defer to task scheduler between two
+//  calls of TS_GlobalCheck (see tsDefer.h). Has to be a power of 2.
+#define TS_DEFER_SIZE       16
+
+//  Define max number of tasks and total size of their arguments (in bytes) in a
+//  batch of tasks added to task scheduler at once (see tsBatch.h)
+#define TS_BATCH_SIZE       8
+#define TS_BATCH_ARG_SIZE   128
+
+//  Define max number of services with a coalescing policy for their tasks
+//  (see TaskScheduler::SetCoalescing)
+#define TS_COALESCE_RULES   8
+
+//  Define max number of services task scheduler keeps a profile of, services
+//  called once the table is full aren't profiled (see tsProfiler.h)
+#define TS_PROFILE_SERVICES 16
+
+//  Define lateness (in ms) of the oldest due task after which task scheduler is
+//  considered overloaded and starts skipping tasks of sheddable services (see
+//  tsLoad.h), 0 to disable. Load is measured over windows of TS_LOAD_WINDOW_MS
+#define TS_OVERLOAD_MS      500
+#define TS_LOAD_WINDOW_MS   1000
+
+//  Uncomment to run task scheduler without periodic SysTick interrupt. Instead,
+//  a timer is programmed to wake up the scheduler when the next task is due
+//#define __TS_TICKLESS__
+//  Longest time (in ms) the scheduler sleeps for in tickless mode
+#define TS_TICKLESS_MAX_SLEEP   1000
+
+//  Check run-time budget of the task being executed (see tsBudget.h) from
+//  SysTick, or from wake-up timer armed for the budget in tickless mode, to
+//  catch tasks that never return. Without it budget is only checked once the
+//  task returns
+#define __TS_BUDGET_WATCHDOG__
+
+//  Record activity of the kernel (task runs, task requests, interrupts, events)
+//  into a ring buffer of binary records, see tsTrace.h. Comment out to remove
+//  recording completely
+#define __TS_TRACE__
+//  Number of records in trace buffer, 12B each. Has to be a power of 2.
+#define TS_TRACE_SIZE       512
+
+//  Define max number of metrics kernel modules can register (see
+//  init/metrics.h)
+#define METRICS_MAX         32
+
+//  Select container used by task scheduler to keep pending tasks. Binary
+//  min-heap is used by default, uncomment to use hierarchical timing wheel
+//#define __TS_USE_TIMING_WHEEL__
+
 //  Define sensor for sensor library
 #define __MPU9250
 
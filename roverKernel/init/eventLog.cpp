@@ -5,6 +5,8 @@
  *      Author: Vedran
  */
 #include "eventLog.h"
+#include "init/kernelContext.h"
+#include "taskScheduler/tsTrace.h"
 
 //  Enable debug information printed on serial port
 //#define __DEBUG_SESSION__
@@ -14,82 +16,87 @@
 //  Simplify emitting events
 #define EMIT_EV(X, Y)  EventLog::EmitEvent(EVLOG_UID, X, Y)
 
+#if defined(__USE_TASK_SCHEDULER__)
+///-----------------------------------------------------------------------------
+///         Services provided to task scheduler                     [PROTECTED]
+///-----------------------------------------------------------------------------
+
 /**
- * Callback routine to invoke service offered by this module from task scheduler
- * @note It is assumed that once this function is called task scheduler has
- * already copied required variables into the memory space provided for it.
+ * Services offered by event log, in the order of EVLOG_* service IDs
  */
-void _EVLOG_KernelCallback()
+const _tsService EventLog::_services[] =
 {
-    //  Grab a pointer to singleton
-    EventLog &__evlog = EventLog::GetI();
+    //  EVLOG_DROP: drop all data in event log before time stamp (in ms)
+    TS_SERVICE1(EventLog, uint32_t, DropBefore, uint32_t),
+    //  EVLOG_REBOOT
+    TS_SERVICE1(EventLog, uint32_t, _Reboot, uint8_t),
+    //  EVLOG_SOFT_REBOOT
+    TS_SERVICE2(EventLog, uint32_t, _SoftReboot, uint8_t, uint8_t),
+    //  EVLOG_ACK: sequence number of the first event not yet received
+    TS_SERVICE1(EventLog, uint32_t, _Ack, uint32_t)
+};
 
-    //  Check for null-pointer
-    if (__evlog._evlogKer.argN == 0)
-        return;
-    /*
-     *  Data in args[] contains bytes that constitute arguments for function
-     *  calls. The exact representation(i.e. whether bytes represent ints, floats)
-     *  of data is known only to individual blocks of switch() function. There
-     *  is no predefined data separator between arguments inside args[].
-     */
-    switch (__evlog._evlogKer.serviceID)
-    {
-    /*
-     * Drop all data in event log before given timestamp (in milliseconds)
-     * First 4 bytes contain time in ms as given by the task scheduler
-     * args[] = timestamp(uint32_t)
-     * retVal one of myLib.h STATUS_* error codes
-     */
-    case EVLOG_DROP:
-        {
-            uint32_t timestamp;
-            memcpy(&timestamp, __evlog._evlogKer.args, sizeof(uint32_t));
-
-            __evlog._evlogKer.retVal = __evlog.DropBefore(timestamp);
-        }
-        break;
-    /*
-     * Perform full reboot of event log, completely deleting all data in it
-     * args[] = accessCode(0x17)
-     * retVal one of myLib.h STATUS_* error codes
-     */
-    case EVLOG_REBOOT:
-        {
-            //  Reboot only if 0x17 was sent as access code
-            if (__evlog._evlogKer.args[0] != 0x17)
-                return;
-            __evlog._evlogKer.retVal = __evlog.Reset();
-
-            EMIT_EV(__evlog._evlogKer.serviceID, EVENT_INITIALIZED);
-        }
-        break;
-        /*
-         * Perform soft reboot (only event logger status) for specified module
-         * args[] = accessCode(0xCF)|libUID
-         * retVal one of myLib.h STATUS_* error codes
-         */
-    case EVLOG_SOFT_REBOOT:
-        {
-            //  Soft reboot access code is 0xCF, skip if it's not valid
-            if (__evlog._evlogKer.args[0] != 0xCF)
-                return;
-            //  Perform soft reboot only if the module exists, otherwise we risk
-            //  fault
-            if (TaskScheduler::ValidKernModule(__evlog._evlogKer.args[1]));
-                EventLog::SoftReboot(__evlog._evlogKer.args[1]);
-        }
-        break;
-    default:
-        break;
-    }
+/**
+ * Perform full reboot of event log, completely deleting all data in it
+ * @param accessCode has to be 0x17 for reboot to take place
+ * @return one of myLib.h STATUS_* error codes
+ */
+uint32_t EventLog::_Reboot(uint8_t accessCode)
+{
+    //  Reboot only if 0x17 was sent as access code
+    if (accessCode != 0x17)
+        return STATUS_ARG_ERR;
 
-    //  Emit event corresponding to result of task execution
-    if (__evlog._evlogKer.retVal != STATUS_OK)
-        EMIT_EV(__evlog._evlogKer.serviceID, EVENT_ERROR);
-    else
-        EMIT_EV(__evlog._evlogKer.serviceID, EVENT_OK);
+    uint32_t retVal = Reset();
+    EMIT_EV(EVLOG_REBOOT, EVENT_INITIALIZED);
+
+    return retVal;
+}
+
+/**
+ * Perform soft reboot (only event logger status) for specified module
+ * @param accessCode has to be 0xCF for reboot to take place
+ * @param libUID UID of the module to soft-reboot
+ * @return one of myLib.h STATUS_* error codes
+ */
+uint32_t EventLog::_SoftReboot(uint8_t accessCode, uint8_t libUID)
+{
+    //  Soft reboot access code is 0xCF, skip if it's not valid
+    if (accessCode != 0xCF)
+        return STATUS_ARG_ERR;
+
+    //  Perform soft reboot only if the module exists, otherwise we risk fault
+    if (!TaskScheduler::ValidKernModule(libUID))
+        return STATUS_ARG_ERR;
+
+    EventLog::SoftReboot(libUID);
+
+    return STATUS_OK;
+}
+
+/**
+ * Drop events the server has acknowledged receiving
+ * @param seq sequence number of the first event server hasn't received, all
+ * events before it are dropped
+ * @return one of myLib.h STATUS_* error codes
+ */
+uint32_t EventLog::_Ack(uint32_t seq)
+{
+    uint32_t first = FirstSeq();
+
+    //  Events server is acknowledging are gone already (overwritten)
+    if ((int32_t)(seq - first) <= 0)
+        return STATUS_OK;
+    //  Can't acknowledge events that haven't been emitted yet
+    if ((seq - first) > (_nextSeq - first))
+        return STATUS_ARG_ERR;
+
+    _lost += first - _dropSeq;
+    _dropSeq = seq;
+
+    return STATUS_OK;
 }
+#endif  /* __USE_TASK_SCHEDULER__ */
 
 ///-----------------------------------------------------------------------------
 ///         Functions for returning static instance                     [PUBLIC]
@@ -97,12 +104,11 @@ void _EVLOG_KernelCallback()
 
 /**
  * Return reference to a singleton
- * @return reference to an internal static instance
+ * @return reference to the instance owned by current kernel context
  */
 EventLog& EventLog::GetI()
 {
-    static EventLog singletonInstance;
-    return singletonInstance;
+    return *(KernelContext::Current().eventLog);
 }
 
 /**
@@ -123,8 +129,7 @@ void EventLog::InitSW()
     EMIT_EV(-1, EVENT_STARTUP);
 #if defined(__USE_TASK_SCHEDULER__)
     //  Register module services with task scheduler
-    _evlogKer.callBackFunc = _EVLOG_KernelCallback;
-    TS_RegCallback(&_evlogKer, EVLOG_UID);
+    TS_RegServices(EVLOG_UID, TS_SERVICES(_services));
 #endif
     EMIT_EV(-1, EVENT_INITIALIZED);
 }
@@ -148,7 +153,9 @@ void EventLog::RecordEvents(bool enable)
  * Interface for logging events
  * Called by all system modules when they want to log an event. Function
  * constructs event entry from provided arguments, appends current timestamp to
- * it and saves it in linked list stored in EventLog class.
+ * it and saves it in the ring buffer of EventLog class. Event the module has
+ * just emitted is only counted in the entry of its first occurrence. Safe to
+ * call from interrupts, doesn't allocate memory.
  * @param libUID ID of module which emitted event
  * @param taskID ID of task which was being executed when event occurred
  * @param event One of EVENT_* enums from header file, describing event
@@ -158,78 +165,76 @@ void EventLog::EmitEvent(uint8_t libUID, int8_t taskID, Events event)
     //  Get reference of singleton
     EventLog &el = EventLog::GetI();
 
+    //  Trace records events even if event logger is disabled
+    TS_TRACE(TR_EVENT, libUID, (uint8_t)taskID, 0, (uint8_t)event);
+
     //  If event logger is not enabled stop here
-    if (!el._enSig)
+    if (!el._enSig || (libUID >= NUM_OF_MODULES) ||
+        (event >= EVLOG_EVENT_TYPES))
         return;
 
-    //  Check if log is over its allowed size, remove all log entries if log is full
-    if (el._entryvCount > MAX_LOG_ENTRIES)
-        el.DropBefore(0xFFFFFFFF);
+    //  Populate event instance with event data
+    struct _eventEntry eventInst;
+    eventInst.libUID = libUID;
+    eventInst.taskID = taskID;
+    eventInst.timestamp = msSinceStartup;
+    eventInst.lastTime = eventInst.timestamp;
+    eventInst.count = 1;
+    eventInst.event = event;
 
-    //  Allocate new memory for linked least
-    static volatile struct _eventEntry *lastEntry = 0;
-    volatile struct _eventEntry *eventInst = new struct _eventEntry,
-                                *prioInvEvent = 0;
+    //  State of the module is updated with interrupts suspended, an interrupt
+    //  emitting event for the same module mustn't see it half-updated
+    bool intState = HAL_BOARD_InterruptSuspend();
 
-    //  Populate event instance with event data
-    eventInst->libUID = libUID;
-    eventInst->taskID = taskID;
-    eventInst->timestamp = msSinceStartup;
-    eventInst->event = event;
-    eventInst->next = 0;
+    el._counters[libUID][event]++;
 
     //  Prevent repeated logging of same events within a module
     //  Check if the same event for this module has already been logged on the
-    //  last function call, if so add this event only if enough time has
-    //  passed between those two events
-    if ((el._lastEvent[libUID].event == event) &&
-        ((eventInst->timestamp-el._lastEvent[libUID].timestamp) < REP_TIME_DIFF_MS))
+    //  last function call, if so count this one in the entry of the logged
+    //  event, unless enough time has passed between those two events. Event
+    //  is logged anyway if the entry has been sent (or dropped) already
+    bool repeated = (el._lastEvent[libUID].event == event) &&
+        ((eventInst.timestamp-el._lastEvent[libUID].timestamp) < REP_TIME_DIFF_MS);
+    if (repeated && el._Fold(libUID, eventInst.timestamp))
     {
-        //  If there wasn't enough time remove the object from heap and stop here
-        delete eventInst;
+        HAL_BOARD_InterruptRestore(intState);
         return;
     }
 
     //  If current event is the new highest priority one, save it       OR
     //  If it's a startup event, save it as new high prio. one thereby resetting
     //  the highest priority entry for this module
-    if ((event >= el._highestPrioEv[libUID].event) || (event == EVENT_STARTUP))
+    //  Otherwise module experienced priority inversion, priority inversion
+    //  event is added to the log after the original event
+    //  Repeated event has been dealt with when it was logged the first time
+    bool prioInv = false;
+    if (repeated)
+        ;
+    else if ((event >= el._highestPrioEv[libUID].event) ||
+             (event == EVENT_STARTUP))
     {
-        el._highestPrioEv[libUID] = *((struct _eventEntry *)eventInst);
+        el._highestPrioEv[libUID] = eventInst;
         el._prioInvOcc[libUID] = false;
     }
     else
     {
-        //  If there is higher priority event than this already logged, module
-        //  experienced priority inversion. Add original event in the list, but
-        //  also add priority inversion event after it.
-        prioInvEvent = new struct _eventEntry;
-        prioInvEvent->libUID = libUID;
-        prioInvEvent->taskID = taskID;
-        prioInvEvent->timestamp = msSinceStartup;
-        prioInvEvent->event = EVENT_PRIOINV;
-        prioInvEvent->next = 0;
         el._prioInvOcc[libUID] = true;
+        el._counters[libUID][EVENT_PRIOINV]++;
+        prioInv = true;
     }
+    el._lastEvent[libUID] = eventInst;
 
-    //  Adding event to a linked list of EventLog
-    //  If it's not first entry update 'next' pointer of previous entry
-    if (el._entryVectorHead == 0)
-        el._entryVectorHead = eventInst;
-    else
-        lastEntry->next = eventInst;
+    HAL_BOARD_InterruptRestore(intState);
 
-    //  Save current entry to be used as new 'previous' entry in next run
-    lastEntry = eventInst;
-    el._lastEvent[libUID] = *((struct _eventEntry *)eventInst);
-    el._entryvCount++;
-
-    //  Check if there's an event for priority inversion that needs to be added
-    if (prioInvEvent != 0)
+    //  Adding event to the ring buffer of EventLog. Interrupt emitting the
+    //  same event before sequence number is known here finds the previous
+    //  entry of the module, _Fold() either counts it there or refuses it and
+    //  the interrupt logs its own entry
+    el._lastSeq[libUID] = el._Append(eventInst);
+    if (prioInv)
     {
-        lastEntry->next = prioInvEvent;
-        lastEntry = prioInvEvent;
-        el._entryvCount++;
+        eventInst.event = EVENT_PRIOINV;
+        el._Append(eventInst);
     }
 }
 
@@ -241,30 +246,25 @@ void EventLog::EmitEvent(uint8_t libUID, int8_t taskID, Events event)
  */
 uint32_t EventLog::DropBefore(uint32_t timestamp)
 {
-    uint32_t retVal = STATUS_OK;
-    //  Delete dynamically allocated list
-   volatile struct _eventEntry *node = _entryVectorHead;
+    uint32_t seq = FirstSeq(),
+             next = _nextSeq;
+    struct _eventEntry entry;
 
-   //   Loop through the list and delete everything with time before timestamp
-   while (node != 0)
-   {
-       //   Check if end condition has been reached
-       if (node->timestamp > timestamp)
-           break;
-
-       //   Save pointer to next element
-       volatile struct _eventEntry *tmp = node->next;
-       //   Delete current element
-       delete node;
-       //    Set next as new current element
-       node = tmp;
-       //   Decrease number of entries in list
-       _entryvCount--;
-   }
+    //  Events overwritten since the last drop have never been read
+    _lost += seq - _dropSeq;
 
-   _entryVectorHead = node;
+    //  Events are in the order they were emitted in, stop at the first one
+    //  emitted after timestamp (or one still being written)
+    while ((seq != next) && GetEvent(seq, entry))
+    {
+        if (entry.timestamp > timestamp)
+            break;
+        seq++;
+    }
 
-   return retVal;
+    _dropSeq = seq;
+
+    return STATUS_OK;
 }
 
 /**
@@ -274,31 +274,9 @@ uint32_t EventLog::DropBefore(uint32_t timestamp)
  */
 uint32_t EventLog::Reset()
 {
-    uint32_t retVal = STATUS_OK;
-
-    //  Delete dynamically allocated list
-   volatile struct _eventEntry *node = _entryVectorHead;
-
-   //   Loop through the list until node is null pointer
-   while (node != 0)
-   {
-       //   Save pointer to next element
-       volatile struct _eventEntry *tmp = node->next;
-       //   Delete current element
-       delete node;
-       //    Set next as new current element
-       node = tmp;
-       //   Decrease number of entries in list
-       _entryvCount--;
-   }
-
-   //   If we've reached end of the list but number of items in the list is !=0
-   //   we have memory leakage, raise event
-   if(_entryvCount != 0)
-   {
-       EMIT_EV(-1, EVENT_ERROR);
-       retVal = STATUS_PROG_ERR;
-   }
+   //   Drop all events in the log
+   _dropSeq = _nextSeq;
+   _lost = 0;
 
    //   Construct empty task entry for resetting event arrays
    struct _eventEntry empty;
@@ -310,11 +288,14 @@ uint32_t EventLog::Reset()
    for (uint8_t i = 0; i < NUM_OF_MODULES; i++)
    {
        _lastEvent[i] = empty;
+       _lastSeq[i] = _nextSeq;
        _highestPrioEv[i] = empty;
        _prioInvOcc[i] = false;
+       for (uint8_t j = 0; j < EVLOG_EVENT_TYPES; j++)
+           _counters[i][j] = 0;
    }
 
-   return retVal;
+   return STATUS_OK;
 }
 
 /**
@@ -337,16 +318,152 @@ void EventLog::SoftReboot(uint8_t libUID)
  */
 uint16_t EventLog::EventCount()
 {
-    return _entryvCount;
+    uint32_t next = _nextSeq;
+
+    return (uint16_t)(next - FirstSeq());
 }
 
 /**
- * Get first node of the linked list containing event log
- * @return
+ * Get sequence number of the oldest event still in the log
+ * @return sequence number, equal to NextSeq() if log is empty
+ */
+uint32_t EventLog::FirstSeq()
+{
+    uint32_t next = _nextSeq,
+             first = _dropSeq;
+
+    //  Events older than the last EVLOG_SIZE ones have been overwritten
+    if ((next - first) > EVLOG_SIZE)
+        first = next - EVLOG_SIZE;
+
+    return first;
+}
+
+/**
+ * Get sequence number the next emitted event will get
+ * @return sequence number, one past the newest event in the log
+ */
+uint32_t EventLog::NextSeq()
+{
+    return _nextSeq;
+}
+
+/**
+ * Copy event with given sequence number out of the log
+ * @param seq sequence number of the event
+ * @param entry [out] copy of the event
+ * @return true if event was copied, false if it has been overwritten already
+ * or is still being written (e.g. emitted from an interrupt while reading)
+ * @note Count and time of the last occurrence of the newest event of a module
+ * can still grow after it's copied, until it's encoded for sending
+ */
+bool EventLog::GetEvent(uint32_t seq, struct _eventEntry &entry)
+{
+    volatile struct _eventSlot &slot = _ring[seq & (EVLOG_SIZE - 1)];
+
+    if (slot.seq != (seq + 1))
+        return false;
+
+    entry.timestamp = slot.entry.timestamp;
+    entry.lastTime = slot.entry.lastTime;
+    entry.count = slot.entry.count;
+    entry.libUID = slot.entry.libUID;
+    entry.taskID = slot.entry.taskID;
+    entry.event = slot.entry.event;
+
+    //  Event could have been overwritten while copying it
+    return (slot.seq == (seq + 1));
+}
+
+/**
+ * Encode events into binary records (see format in eventLog.h), for as long as
+ * there are events and space in the buffer. Encoded events stop counting
+ * repeated occurrences, those are logged as new events instead
+ * @param seq [in/out] sequence number of the first event to encode, on return
+ * sequence number of the first event that wasn't encoded
+ * @param lastSeq sequence number to stop at (excluding the event with it)
+ * @param buf buffer to write records to
+ * @param bufLen size of the buffer in bytes
+ * @return number of bytes written to buffer
+ */
+uint16_t EventLog::EncodeEvents(uint32_t &seq, uint32_t lastSeq, uint8_t *buf,
+                                uint16_t bufLen)
+{
+    struct _eventEntry entry;
+    uint64_t prevTime = 0;
+    uint16_t len = 0;
+
+    //  Stop at an event that can't be read, its sequence number is where the
+    //  next batch has to start from anyway
+    while ((seq != lastSeq) && ((len + EVLOG_REC_MAX) <= bufLen))
+    {
+        //  Event must not be folded into after it's copied, or the record sent
+        //  would miss the occurrences (_Fold() checks this with interrupts
+        //  suspended)
+        bool intState = HAL_BOARD_InterruptSuspend();
+        if ((int32_t)(seq + 1 - _sentSeq) > 0)
+            _sentSeq = seq + 1;
+        HAL_BOARD_InterruptRestore(intState);
+
+        if (!GetEvent(seq, entry))
+            break;
+
+        int64_t delta = (int64_t)(entry.timestamp - prevTime);
+        uint64_t zigzag = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+
+        buf[len++] = ((uint8_t)entry.event << 4) | (entry.libUID & 0x0F);
+        buf[len++] = (uint8_t)entry.taskID;
+        len += _Varint(zigzag, buf + len);
+        len += _Varint(entry.count - 1, buf + len);
+        if (entry.count > 1)
+            len += _Varint((uint32_t)(entry.lastTime - entry.timestamp),
+                           buf + len);
+
+        prevTime = entry.timestamp;
+        seq++;
+    }
+
+    return len;
+}
+
+/**
+ * Get number of times a module has emitted an event since the last Reset(),
+ * including repeated occurrences and those no longer in the log
+ * @param libUID UID of the module
+ * @param event event to get the number for
+ * @return number of occurrences, 0 if module or event are out of range
+ */
+uint32_t EventLog::GetCount(uint8_t libUID, Events event)
+{
+    if ((libUID >= NUM_OF_MODULES) || (event >= EVLOG_EVENT_TYPES))
+        return 0;
+
+    return _counters[libUID][event];
+}
+
+/**
+ * Get rate at which an event has been repeating, from its first to the last
+ * occurrence
+ * @param entry event as copied out of the log
+ * @return number of occurrences per minute, 0 if event occurred only once
+ */
+uint32_t EventLog::Rate(const struct _eventEntry &entry)
+{
+    uint32_t span = (uint32_t)(entry.lastTime - entry.timestamp);
+
+    if ((entry.count < 2) || (span == 0))
+        return 0;
+
+    return (uint32_t)(((uint64_t)(entry.count - 1) * 60000) / span);
+}
+
+/**
+ * Get number of events overwritten before they were dropped from the log
+ * @return number of events lost since the last Reset()
  */
-volatile struct _eventEntry* EventLog::GetHead()
+uint32_t EventLog::Lost()
 {
-    return _entryVectorHead;
+    return _lost + (FirstSeq() - _dropSeq);
 }
 
 struct _eventEntry EventLog::GetLastEvAt(uint8_t index)
@@ -361,17 +478,107 @@ bool EventLog::GetPrioInvAt(uint8_t index)
 {
         return _prioInvOcc[index];
 }
+
+///-----------------------------------------------------------------------------
+///         Functions for manipulating event log                     [PROTECTED]
+///-----------------------------------------------------------------------------
+
+/**
+ * Add event at the end of the ring buffer, overwriting the oldest one if the
+ * buffer is full. Event is written without disabling interrupts, an interrupt
+ * adding its own event in the meantime writes it in the next place
+ * @param entry event to add
+ * @return sequence number given to the event
+ */
+uint32_t EventLog::_Append(const struct _eventEntry &entry)
+{
+    uint32_t seq = HAL_BOARD_AtomicAdd(&_nextSeq, 1);
+    volatile struct _eventSlot &slot = _ring[seq & (EVLOG_SIZE - 1)];
+
+    //  Readers skip the place until event is completely written
+    slot.seq = 0;
+    slot.entry.timestamp = entry.timestamp;
+    slot.entry.lastTime = entry.lastTime;
+    slot.entry.count = entry.count;
+    slot.entry.libUID = entry.libUID;
+    slot.entry.taskID = entry.taskID;
+    slot.entry.event = entry.event;
+    slot.seq = seq + 1;
+
+    return seq;
+}
+
+/**
+ * Count repeated occurrence of the last event of a module in its entry in the
+ * ring buffer. Called with interrupts suspended
+ * @param libUID module that emitted the event again
+ * @param now time (in ms) of the occurrence
+ * @return true if occurrence was counted, false if entry is no longer there,
+ * has been sent or dropped already, or hasn't been completely written yet
+ */
+bool EventLog::_Fold(uint8_t libUID, uint64_t now)
+{
+    uint32_t seq = _lastSeq[libUID];
+    volatile struct _eventSlot &slot = _ring[seq & (EVLOG_SIZE - 1)];
+
+    if ((slot.seq != (seq + 1)) ||
+        (slot.entry.libUID != _lastEvent[libUID].libUID) ||
+        (slot.entry.event != _lastEvent[libUID].event) ||
+        ((int32_t)(seq - _sentSeq) < 0) ||
+        ((int32_t)(seq - _dropSeq) < 0))
+        return false;
+
+    //  Reader copying the entry at the same time sees either count, both are
+    //  valid
+    slot.entry.count++;
+    slot.entry.lastTime = now;
+    _lastEvent[libUID].count = slot.entry.count;
+    _lastEvent[libUID].lastTime = now;
+
+    return true;
+}
+
+/**
+ * Write number into buffer 7 bits per byte, starting with the lowest ones, MSB
+ * set in all but the last byte
+ * @param value number to write
+ * @param buf buffer to write into
+ * @return number of bytes written
+ */
+uint8_t EventLog::_Varint(uint64_t value, uint8_t *buf)
+{
+    uint8_t len = 0;
+
+    do
+    {
+        buf[len] = value & 0x7F;
+        value >>= 7;
+        if (value != 0)
+            buf[len] |= 0x80;
+        len++;
+    }
+    while (value != 0);
+
+    return len;
+}
 ///-----------------------------------------------------------------------------
 ///                      Class constructor & destructor              [PROTECTED]
 ///-----------------------------------------------------------------------------
 
-EventLog::EventLog() : _entryVectorHead(0), _entryvCount(0), _enSig(true)
+EventLog::EventLog() : _nextSeq(0), _dropSeq(0), _sentSeq(0), _lost(0),
+                       _enSig(true)
 {
+    for (int i = 0; i < EVLOG_SIZE; i++)
+        _ring[i].seq = 0;
+
     for (int i = 0; i < NUM_OF_MODULES; i++)
     {
         _lastEvent[i].libUID = -1;
+        _lastSeq[i] = 0;
         _highestPrioEv[i].libUID = -1;
         _prioInvOcc[i] = false;
+        for (int j = 0; j < EVLOG_EVENT_TYPES; j++)
+            _counters[i][j] = 0;
     }
 }
 
@@ -9,14 +9,20 @@
  *  that tasks get scheduled in advanced and the issuer of the task doesn't
  *  wait until the task is completed, there is generally no way of telling how
  *  did the task perform. Event logger then provides a way of reporting the
- *  execution outcome by collecting system-wide events into a single linked list,
+ *  execution outcome by collecting system-wide events into a ring buffer,
  *  noting which module emitted the event, at what time and during execution of
- *  which task. Event log is deleted after reaching certain size but most
- *  important information(highest-priority event since startup, last emitted
- *  event and appearance of priority inversion) about events from each module
- *  get remembered even after dropping the log.
+ *  which task. Once the buffer is full the oldest events are overwritten but
+ *  most important information(highest-priority event since startup, last
+ *  emitted event and appearance of priority inversion) about events from each
+ *  module get remembered regardless.
+ *  Events are emitted without allocating memory and can be emitted from
+ *  interrupts: place in the ring is reserved with an atomic increment of the
+ *  sequence number, so an interrupt emitting an event while another event is
+ *  being written simply takes the next place. Each place is stamped with the
+ *  sequence number of the event in it once the event is written, which is how
+ *  readers tell whether the event they copied is complete and still there.
  *
- *  @version 1.2.1
+ *  @version 1.8.0
  *  V1.0.0 - 2.7.2017
  *  +Support 6 events that can be emitted by different libraries
  *  +Integrated with task scheduler for remote emptying of log
@@ -40,6 +46,29 @@
  *  V1.2.1 - 2.9.2017
  *  +Added interface for soft-reboot of kernel module
  *  +Moved soft reboot of all other modules to event logger kernel callback
+ *  V1.3.0 - 17.10.2026
+ *  +Services registered with task scheduler as a table of member functions
+ *  V1.4.0 - 17.10.2026
+ *  +Instance is owned by kernel context (init/kernelContext.h)
+ *  V1.5.0 - 17.10.2026
+ *  +Added EVENT_OVERRUN, emitted on behalf of a service that went over its
+ *  run-time budget. Added at the end so values of existing events stay the same
+ *  V1.6.0 - 17.10.2026
+ *  +Events are kept in a fixed-size ring buffer instead of a linked list on
+ *  the heap, oldest events are overwritten once it's full
+ *  +EmitEvent() doesn't allocate memory and can be called from interrupts
+ *  +Log is read by sequence numbers of events (FirstSeq(), NextSeq(),
+ *  GetEvent()) instead of walking the list
+ *  V1.7.0 - 17.10.2026
+ *  +Events can be encoded into compact binary records (EncodeEvents()) to be
+ *  sent in batches, see format below
+ *  +Added EVLOG_ACK service, dropping events by sequence number
+ *  V1.8.0 - 17.10.2026
+ *  +Same event repeated by a module is no longer discarded, it's folded into
+ *  the record of its first occurrence, counting occurrences and keeping time
+ *  of the last one (see Rate()). Binary record carries both
+ *  +Added number of events emitted by each module, for each type of event
+ *  (GetCount())
  */
 #include "hwconfig.h"
 #if !defined(ROVERKERNEL_INIT_EVENTLOG_H_) \
@@ -62,14 +91,41 @@
     #define EVLOG_DROP           0
     #define EVLOG_REBOOT         1
     #define EVLOG_SOFT_REBOOT    2
+    #define EVLOG_ACK            3
 #endif
 
-//  Defines minimum time difference between two same events of a single module
-//  to be logged - prevents unnecessary logging of same events happening fast
+//  Same event repeated by a module within this time (in ms) from its first
+//  occurrence is counted in the record of the first occurrence instead of being
+//  logged again - prevents filling the log with same events happening fast
 #define REP_TIME_DIFF_MS    300000      //  5 minutes
-//  After reaching max number of entries log is dropped to save memory
-//  max 200*(64+8+8+8)=17600bytes on the heap
-#define MAX_LOG_ENTRIES     100
+//  Number of events kept in the log, oldest events are overwritten once the log
+//  is full. Has to be a power of 2. (128*32=4096bytes)
+#define EVLOG_SIZE          128
+
+#if ((EVLOG_SIZE & (EVLOG_SIZE - 1)) != 0)
+    #error "EVLOG_SIZE has to be a power of 2"
+#endif
+
+/*
+ * Binary record of an event, as produced by EncodeEvents():
+ *  byte 0:     event (upper 4 bits) | libUID (lower 4 bits)
+ *  byte 1:     taskID (signed)
+ *  bytes 2-:   difference between timestamp of the event and of the previous
+ *              record (in ms), zigzag encoded (0,-1,1,-2,... -> 0,1,2,3,...)
+ *              and written 7 bits per byte starting with the lowest ones, MSB
+ *              set in all but the last byte. Timestamp before the first record
+ *              is 0, so the first record carries the full timestamp
+ *  bytes n-:   number of occurrences minus one, written 7 bits per byte as above
+ *  bytes m-:   only if event occurred more than once, time (in ms) from the
+ *              first to the last occurrence, written 7 bits per byte as above
+ * Events following one another are usually less than 64ms apart, so a typical
+ * record takes 4 bytes and none takes more than EVLOG_REC_MAX
+ */
+#define EVLOG_REC_MAX       22
+
+#if (NUM_OF_MODULES > 16)
+    #error "Binary record of an event only has 4 bits for libUID"
+#endif
 
 /**
  * Events that modules can transmit
@@ -84,20 +140,34 @@ enum Events {EVENT_UNINITIALIZED,   //Module is not yet initialized
              EVENT_OK,              //Module performed request
              EVENT_HANG,            //Module is hanging in communication with HW
              EVENT_ERROR,           //Module experienced error
-             EVENT_PRIOINV };       //Priority inversion event
+             EVENT_PRIOINV,         //Priority inversion event
+             EVENT_OVERRUN };       //Service took longer than its budget
+
+//  Number of different events, event has to fit in 4 bits of binary record
+#define EVLOG_EVENT_TYPES   (EVENT_OVERRUN + 1)
 
 /**
  * Single event entry in event log
- * Event log implemented as a linked list, 'next' points to next element in list
  */
 struct _eventEntry
 {
         uint64_t timestamp; //  Time in ms since startup when event was emitted
+        uint64_t lastTime;  //  Time in ms of the last occurrence of the event
+        uint32_t count;     //  Number of occurrences of the event
         int8_t libUID;      //  Module that emitted event
         int8_t taskID;      //  Task within module that emitted event
         Events  event;      //  Emitted event
+};
 
-        volatile struct _eventEntry *next;
+/**
+ * Place for a single event in the ring buffer of event log
+ */
+struct _eventSlot
+{
+        //  Sequence number of the event in this place plus one, 0 while event
+        //  is being written
+        uint32_t seq;
+        struct _eventEntry entry;
 };
 
 /**
@@ -107,8 +177,7 @@ struct _eventEntry
  */
 class EventLog
 {
-    friend void _EVLOG_KernelCallback(void);
-
+    friend class KernelContext;
     public:
         //  Functions for returning static instance
         static EventLog& GetI();
@@ -124,7 +193,18 @@ class EventLog
         static void     SoftReboot(uint8_t libUID);
         //  Functions for accessing event log
         uint16_t                        EventCount();
-        volatile struct _eventEntry*    GetHead();
+        uint32_t                        FirstSeq();
+        uint32_t                        NextSeq();
+        bool                            GetEvent(uint32_t seq,
+                                                 struct _eventEntry &entry);
+        uint32_t                        Lost();
+        uint16_t                        EncodeEvents(uint32_t &seq,
+                                                     uint32_t lastSeq,
+                                                     uint8_t *buf,
+                                                     uint16_t bufLen);
+        uint32_t                        GetCount(uint8_t libUID,
+                                                 Events event);
+        static uint32_t                 Rate(const struct _eventEntry &entry);
         struct _eventEntry              GetLastEvAt(uint8_t index);
         struct _eventEntry              GetHigPrioEvAt(uint8_t index);
         bool                            GetPrioInvAt(uint8_t index);
@@ -132,26 +212,43 @@ class EventLog
     protected:
         EventLog();
         ~EventLog();
-        EventLog(EventLog &arg) {}              //  No definition - forbid this
-        void operator=(EventLog const &arg) {}  //  No definition - forbid this
+        EventLog(EventLog &) {}                 //  No definition - forbid this
+        void operator=(EventLog const &) {}     //  No definition - forbid this
+
+        uint32_t        _Append(const struct _eventEntry &entry);
+        bool            _Fold(uint8_t libUID, uint64_t now);
+        static uint8_t  _Varint(uint64_t value, uint8_t *buf);
 
-        //  Head of linked list with events
-        volatile struct _eventEntry *_entryVectorHead;
-        //  Number of events in linked list
-        uint16_t                     _entryvCount;
+        //  Ring buffer with events, event with sequence number seq is kept at
+        //  index (seq % EVLOG_SIZE)
+        volatile struct _eventSlot   _ring[EVLOG_SIZE];
+        //  Sequence number of the next event to be emitted
+        volatile uint32_t            _nextSeq;
+        //  Sequence number of the oldest event not yet dropped
+        volatile uint32_t            _dropSeq;
+        //  Sequence number following the newest event encoded for sending,
+        //  events before it are no longer updated with repeated occurrences
+        volatile uint32_t            _sentSeq;
+        //  Number of events overwritten before being dropped, up to _dropSeq
+        uint32_t                     _lost;
         //  Enable signal for event logger; events are logged only when _enSig=true
         bool                         _enSig;
-        //  Last recorded event for each module
+        //  Last recorded event for each module, and its sequence number
         struct _eventEntry  _lastEvent[NUM_OF_MODULES];
+        volatile uint32_t   _lastSeq[NUM_OF_MODULES];
+        //  Number of events emitted by each module, for each type of event
+        uint32_t            _counters[NUM_OF_MODULES][EVLOG_EVENT_TYPES];
         //  Highest priority event for each module since last EVENT_STARTUP
         struct _eventEntry  _highestPrioEv[NUM_OF_MODULES];
         //  Goes true whenever a priority inversion has occurred in a module
         bool                _prioInvOcc[NUM_OF_MODULES];
 
-    //  Interface with task scheduler - provides memory space and function
-    //  to call in order for task scheduler to request service from this module
+    //  Services provided to task scheduler, indexed by service ID
 #if defined(__USE_TASK_SCHEDULER__)
-        _kernelEntry _evlogKer;
+        static const _tsService _services[];
+        uint32_t        _Reboot(uint8_t accessCode);
+        uint32_t        _SoftReboot(uint8_t accessCode, uint8_t libUID);
+        uint32_t        _Ack(uint32_t seq);
 #endif
 };
 
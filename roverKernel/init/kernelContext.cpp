@@ -0,0 +1,239 @@
+/**
+ * kernelContext.cpp
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran
+ */
+#include "kernelContext.h"
+#include "init/platform.h"
+#include "init/eventLog.h"
+#include "init/metrics.h"
+#include "storage/eventStore.h"
+
+#include <new>
+
+//  Size of memory (in number of uint64_t elements) holding an object of type T
+#define KC_STORAGE(T)   ((sizeof(T) + 7) / 8)
+
+/**
+ * Memory of a kernel context, sized at compile time. Objects are constructed in
+ * it by KernelContext, in the order of members below
+ */
+struct _kernelStorage
+{
+#if defined(__HAL_USE_TASKSCH__)
+    //  Queue never holds more than TS_MAX_TASKS tasks, one more node is needed
+    //  for the task being executed (it's out of the queue until rescheduled)
+    uint64_t    nodes[MEMPOOL_STORAGE(sizeof(_tqnode), TS_MAX_TASKS+1)];
+    uint64_t    smallArgs[MEMPOOL_STORAGE(TS_ARG_SMALL_SIZE, TS_ARG_SMALL_NUM)];
+    uint64_t    largeArgs[MEMPOOL_STORAGE(TS_ARG_LARGE_SIZE, TS_ARG_LARGE_NUM)];
+    uint64_t    nodePool[KC_STORAGE(MemPool)];
+    uint64_t    argPool[TS_ARG_POOLS][KC_STORAGE(MemPool)];
+#if defined(__TS_TRACE__)
+    uint64_t    trace[KC_STORAGE(TraceBuffer)];
+#endif  /* __TS_TRACE__ */
+#endif  /* __HAL_USE_TASKSCH__ */
+    uint64_t    metrics[KC_STORAGE(MetricsRegistry)];
+#if defined(__HAL_USE_EVENTLOG__)
+    uint64_t    eventLog[KC_STORAGE(EventLog)];
+#endif  /* __HAL_USE_EVENTLOG__ */
+#if defined(__HAL_USE_TASKSCH__)
+    uint64_t    taskSch[KC_STORAGE(TaskScheduler)];
+#endif  /* __HAL_USE_TASKSCH__ */
+#if defined(__HAL_USE_ESP8266__)
+    uint64_t    esp[KC_STORAGE(ESP8266)];
+#endif  /* __HAL_USE_ESP8266__ */
+#if defined(__HAL_USE_ENGINES__)
+    uint64_t    engines[KC_STORAGE(EngineData)];
+#endif  /* __HAL_USE_ENGINES__ */
+#if defined(__HAL_USE_RADAR__)
+    uint64_t    radar[KC_STORAGE(RadarModule)];
+#endif  /* __HAL_USE_RADAR__ */
+#if defined(__HAL_USE_MPU9250__)
+    uint64_t    mpu[KC_STORAGE(MPU9250)];
+#endif  /* __HAL_USE_MPU9250__ */
+#if defined(__HAL_USE_STORAGE__)
+    uint64_t    store[KC_STORAGE(EventStore)];
+#endif  /* __HAL_USE_STORAGE__ */
+    uint64_t    platform[KC_STORAGE(Platform)];
+};
+
+HAL_THREAD_LOCAL KernelContext* KernelContext::_current = 0;
+
+///-----------------------------------------------------------------------------
+///                      Functions for creating contexts                [PUBLIC]
+///-----------------------------------------------------------------------------
+
+/**
+ * Return reference to the default context, used by the firmware
+ * @return reference to an internal static instance
+ */
+KernelContext& KernelContext::Default()
+{
+    static struct _kernelStorage storage;
+    static KernelContext singletonInstance(&storage, 0);
+    return singletonInstance;
+}
+
+/**
+ * Create a new context with its own instance of every kernel module
+ * @return pointer to new context, 0 if the board can't run more than one
+ */
+KernelContext* KernelContext::Create()
+{
+    void *board = HAL_BOARD_NewContext();
+
+    if (board == 0)
+        return 0;
+
+    //  Storage is zeroed, as static storage of the default context is; not all
+    //  modules initialize every member in their constructors
+    return new KernelContext(new struct _kernelStorage(), board);
+}
+
+/**
+ * Destroy context made by Create() together with its board. Calling thread
+ * switches to the default context if it was running the destroyed one
+ * @param ctx context to destroy, mustn't be current in any other thread
+ */
+void KernelContext::Destroy(KernelContext *ctx)
+{
+    if ((ctx == 0) || (ctx == &Default()))
+        return;
+
+    KernelContext *prev = (_current == ctx) ? 0 : _current;
+    struct _kernelStorage *storage = ctx->_storage;
+    void *board = ctx->board;
+
+    //  Modules might still use the board while being destroyed
+    _Select(ctx);
+    delete ctx;
+    _Select(prev);
+
+    HAL_BOARD_DeleteContext(board);
+    delete storage;
+}
+
+/**
+ * Make this context current in the calling thread, kernel modules called from
+ * the thread (including interrupts of the board) are the ones of this context
+ */
+void KernelContext::Enter()
+{
+    _Select(this);
+}
+
+///-----------------------------------------------------------------------------
+///                      Class constructor & destructor                [PRIVATE]
+///-----------------------------------------------------------------------------
+
+/**
+ * Construct all kernel modules in the given memory
+ * @param storage memory of the context
+ * @param boardArg board the context runs on, 0 for the default board
+ */
+KernelContext::KernelContext(struct _kernelStorage *storage, void *boardArg)
+    : timeMS(0), metrics(0), eventLog(0), esp(0), engines(0), radar(0), mpu(0), store(0),
+      board(boardArg), _storage(storage)
+{
+    KernelContext *prev = _current;
+
+    //  Modules emit events from their constructors, switch to this context so
+    //  that they end up in its event log
+    _Select(this);
+
+#if defined(__HAL_USE_TASKSCH__)
+    for (uint8_t i = 0; i < NUM_OF_MODULES; i++)
+    {
+        services[i].services = 0;
+        services[i].num = 0;
+    }
+    curPID = 0;
+
+    nodePool = new (_storage->nodePool)
+                    MemPool(_storage->nodes, sizeof(_tqnode), TS_MAX_TASKS+1);
+    argPool[0] = new (_storage->argPool[0])
+                    MemPool(_storage->smallArgs, TS_ARG_SMALL_SIZE,
+                            TS_ARG_SMALL_NUM);
+    argPool[1] = new (_storage->argPool[1])
+                    MemPool(_storage->largeArgs, TS_ARG_LARGE_SIZE,
+                            TS_ARG_LARGE_NUM);
+#if defined(__TS_TRACE__)
+    trace = new (_storage->trace) TraceBuffer();
+#else
+    trace = 0;
+#endif  /* __TS_TRACE__ */
+#endif  /* __HAL_USE_TASKSCH__ */
+
+    //  Modules register their metrics in InitHW(), registry has to be there
+    //  before any of them
+    metrics = new (_storage->metrics) MetricsRegistry();
+#if defined(__HAL_USE_EVENTLOG__)
+    eventLog = new (_storage->eventLog) EventLog();
+#endif  /* __HAL_USE_EVENTLOG__ */
+#if defined(__HAL_USE_TASKSCH__)
+    taskSch = new (_storage->taskSch) TaskScheduler();
+#endif  /* __HAL_USE_TASKSCH__ */
+#if defined(__HAL_USE_ESP8266__)
+    esp = new (_storage->esp) ESP8266();
+#endif  /* __HAL_USE_ESP8266__ */
+#if defined(__HAL_USE_ENGINES__)
+    engines = new (_storage->engines) EngineData();
+#endif  /* __HAL_USE_ENGINES__ */
+#if defined(__HAL_USE_RADAR__)
+    radar = new (_storage->radar) RadarModule();
+#endif  /* __HAL_USE_RADAR__ */
+#if defined(__HAL_USE_MPU9250__)
+    mpu = new (_storage->mpu) MPU9250();
+#endif  /* __HAL_USE_MPU9250__ */
+#if defined(__HAL_USE_STORAGE__)
+    store = new (_storage->store) EventStore();
+#endif  /* __HAL_USE_STORAGE__ */
+    platform = new (_storage->platform) Platform();
+
+    _Select(prev);
+}
+
+/**
+ * Destroy kernel modules in the reverse order of their construction
+ */
+KernelContext::~KernelContext()
+{
+    platform->~Platform();
+#if defined(__HAL_USE_STORAGE__)
+    store->~EventStore();
+#endif  /* __HAL_USE_STORAGE__ */
+#if defined(__HAL_USE_MPU9250__)
+    mpu->~MPU9250();
+#endif  /* __HAL_USE_MPU9250__ */
+#if defined(__HAL_USE_RADAR__)
+    radar->~RadarModule();
+#endif  /* __HAL_USE_RADAR__ */
+#if defined(__HAL_USE_ENGINES__)
+    engines->~EngineData();
+#endif  /* __HAL_USE_ENGINES__ */
+#if defined(__HAL_USE_ESP8266__)
+    esp->~ESP8266();
+#endif  /* __HAL_USE_ESP8266__ */
+#if defined(__HAL_USE_TASKSCH__)
+    const_cast<TaskScheduler*>(taskSch)->~TaskScheduler();
+#endif  /* __HAL_USE_TASKSCH__ */
+#if defined(__HAL_USE_EVENTLOG__)
+    eventLog->~EventLog();
+#endif  /* __HAL_USE_EVENTLOG__ */
+    metrics->~MetricsRegistry();
+}
+
+///-----------------------------------------------------------------------------
+///                      Switching contexts                            [PRIVATE]
+///-----------------------------------------------------------------------------
+
+/**
+ * Make context current in the calling thread, together with its board
+ * @param ctx context to select, 0 to go back to the default one
+ */
+void KernelContext::_Select(KernelContext *ctx)
+{
+    _current = ctx;
+    HAL_BOARD_SelectContext((ctx != 0) ? ctx->board : 0);
+}
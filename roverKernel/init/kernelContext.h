@@ -0,0 +1,131 @@
+/**
+ *  kernelContext.h
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran Mikov
+ *
+ *  Kernel context holds everything that makes up one running rover: instances
+ *  of all kernel modules, services they registered with task scheduler, memory
+ *  pools of the scheduler, its time base and the board they all run on. Kernel
+ *  modules are still singletons as far as the rest of the code is concerned,
+ *  GetI()/GetP() return the instance owned by the current context.
+ *  Firmware only ever uses the default context, created on the first call to
+ *  any of GetI() functions, with all of its memory allocated statically.
+ *  On the POSIX board more contexts can be created, each one with its own
+ *  simulated board, to run several rovers inside of the same process. Context
+ *  is current in the thread that has entered it last. It isn't bound to the
+ *  thread, e.g. a pool of threads can take turns running a set of contexts, as
+ *  long as a context is never entered by two threads at the same time:
+ *
+ *      KernelContext *ctx = KernelContext::Create();
+ *      ctx->Enter();
+ *      Platform::GetI().InitHW();
+ *      ...
+ *      ctx->Enter();   //  Possibly from another thread
+ *      TS_GlobalCheck();
+ *      ...
+ *      KernelContext::Destroy(ctx);
+ *
+ *  @note MPU driver using DMP keeps state of the sensor in eMPL library, which
+ *  is shared by all contexts
+ *  @version 1.2
+ *  V1.0 - 17.10.2026
+ *  +Creation of file, kernel modules, service table, pools, trace buffer and
+ *  time base of task scheduler moved from globals into a context
+ *  V1.1 - 17.10.2026
+ *  +Added persistent event store (storage/eventStore.h)
+ *  V1.2 - 17.10.2026
+ *  +Added registry of metrics of kernel modules (init/metrics.h)
+ */
+
+#ifndef ROVERKERNEL_INIT_KERNELCONTEXT_H_
+#define ROVERKERNEL_INIT_KERNELCONTEXT_H_
+
+#include "hwconfig.h"
+#include "HAL/hal.h"
+#include "taskScheduler/tsService.h"
+#include "taskScheduler/tsPool.h"
+
+class TaskScheduler;
+class TraceBuffer;
+class MetricsRegistry;
+class EventLog;
+class ESP8266;
+class EngineData;
+class RadarModule;
+class MPU9250;
+class Platform;
+class EventStore;
+struct _kernelStorage;
+
+/**
+ * Instance of the kernel, see description at the top of the file
+ */
+class KernelContext
+{
+    public:
+        static KernelContext&   Default();
+        static KernelContext*   Create();
+        static void             Destroy(KernelContext *ctx);
+
+        void                    Enter();
+
+        /**
+         * Get context current in the calling thread
+         * @return reference to the context, default one if the thread hasn't
+         * entered any other
+         */
+        static inline KernelContext& Current()
+        {
+            if (_current == 0)
+                _current = &Default();
+
+            return *_current;
+        }
+
+        //  Time since startup of this context (in ms), see msSinceStartup
+        volatile uint64_t   timeMS;
+
+#if defined(__HAL_USE_TASKSCH__)
+        //  Services of all kernel modules, indexed by UID of the module
+        _tsModule           services[NUM_OF_MODULES];
+        //  PID of the task being executed at the moment, 0 if none
+        volatile uint16_t   curPID;
+        //  Memory pools of task scheduler (see tsPool.h)
+        MemPool             *nodePool;
+        MemPool             *argPool[TS_ARG_POOLS];
+        volatile TraceBuffer    *trace;
+        volatile TaskScheduler  *taskSch;
+#endif  /* __HAL_USE_TASKSCH__ */
+
+        //  Metrics registered by kernel modules
+        MetricsRegistry     *metrics;
+
+        //  Kernel modules, 0 for the ones disabled in hwconfig.h
+        EventLog            *eventLog;
+        ESP8266             *esp;
+        EngineData          *engines;
+        RadarModule         *radar;
+        MPU9250             *mpu;
+        EventStore          *store;
+        Platform            *platform;
+
+        //  Board the context runs on, as returned by HAL_BOARD_NewContext()
+        void                *board;
+
+    private:
+        KernelContext(struct _kernelStorage *storage, void *boardArg);
+        ~KernelContext();
+        KernelContext(KernelContext &) {}               //  No definition - forbid this
+        void operator=(KernelContext const &) {}        //  No definition - forbid this
+
+        static void _Select(KernelContext *ctx);
+
+        //  Memory in which kernel modules are constructed
+        struct _kernelStorage   *_storage;
+
+        //  Context current in the calling thread, 0 until it's first needed
+        static HAL_THREAD_LOCAL KernelContext *_current;
+};
+
+#endif /* ROVERKERNEL_INIT_KERNELCONTEXT_H_ */
@@ -0,0 +1,187 @@
+/**
+ * metrics.cpp
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran
+ */
+#include "metrics.h"
+#include "init/kernelContext.h"
+
+#include <string.h>
+
+///-----------------------------------------------------------------------------
+///         Functions for returning static instance                     [PUBLIC]
+///-----------------------------------------------------------------------------
+
+/**
+ * Return reference to a singleton
+ * @return reference to the instance owned by current kernel context
+ */
+MetricsRegistry& MetricsRegistry::GetI()
+{
+    return *(KernelContext::Current().metrics);
+}
+
+/**
+ * Return pointer to a singleton
+ * @return pointer to a internal static instance
+ */
+MetricsRegistry* MetricsRegistry::GetP()
+{
+    return &(MetricsRegistry::GetI());
+}
+
+///-----------------------------------------------------------------------------
+///                      Class member function definitions              [PUBLIC]
+///-----------------------------------------------------------------------------
+
+/**
+ * Add metric to the registry. Metric registered again (e.g. module being
+ * initialized once more) keeps its place and takes the new UID and ID
+ * @note Not to be called from interrupts
+ * @param metric metric to register, has to live as long as the registry does
+ * @param libUID UID of the module metric belongs to
+ * @param id ID of the metric within module, up to METRIC_ID_MAX
+ * @return true if metric is in registry, false if ID is out of range or
+ * registry is full (metric can still be updated, it just isn't reported)
+ */
+bool MetricsRegistry::Register(Metric &metric, uint8_t libUID, uint8_t id)
+{
+    if (id > METRIC_ID_MAX)
+        return false;
+
+    uint16_t i;
+    for (i = 0; i < _num; i++)
+        if (_metrics[i] == &metric)
+            break;
+
+    if (i == METRICS_MAX)
+    {
+        overflows++;
+        return false;
+    }
+
+    metric._libUID = libUID;
+    metric._id = id;
+    _metrics[i] = &metric;
+    if (i == _num)
+        _num++;
+
+    return true;
+}
+
+/**
+ * Get number of metrics in registry
+ * @return number of registered metrics
+ */
+uint16_t MetricsRegistry::Count()
+{
+    return _num;
+}
+
+/**
+ * Get metric at given place in registry
+ * @param index place of the metric, in the order of registration
+ * @return pointer to metric, 0 if index is out of range
+ */
+Metric* MetricsRegistry::At(uint16_t index)
+{
+    if (index >= _num)
+        return 0;
+
+    return _metrics[index];
+}
+
+/**
+ * Encode current values of metrics into binary records, see format in
+ * metrics.h. Snapshot that doesn't fit into the buffer is continued from
+ * where this call has stopped
+ * @param index [in/out] place of the first metric to encode, on exit place of
+ * the first metric that wasn't encoded (Count() if all were)
+ * @param buf buffer to write records into
+ * @param bufLen size of buffer (in bytes)
+ * @return number of bytes written into buffer
+ */
+uint16_t MetricsRegistry::Encode(uint16_t &index, uint8_t *buf,
+                                 uint16_t bufLen)
+{
+    uint8_t rec[METRIC_REC_MAX];
+    uint16_t len = 0;
+
+    for (; index < _num; index++)
+    {
+        Metric &m = *_metrics[index];
+        uint8_t recLen = 0;
+
+        rec[recLen++] = m._libUID;
+        rec[recLen++] = (m._type << 6) | m._id;
+        recLen += _Varint(m.value, rec + recLen);
+
+        if (m._type == METRIC_HISTOGRAM)
+        {
+            volatile uint32_t *bucket = ((MetricHistogram&)m).bucket;
+            uint32_t copy[METRIC_BUCKETS];
+            uint8_t num = 0;
+
+            //  Read each bucket once, interrupt can change it meanwhile
+            for (uint8_t i = 0; i < METRIC_BUCKETS; i++)
+            {
+                copy[i] = bucket[i];
+                if (copy[i] != 0)
+                    num = i + 1;
+            }
+
+            rec[recLen++] = num;
+            for (uint8_t i = 0; i < num; i++)
+                recLen += _Varint(copy[i], rec + recLen);
+        }
+
+        if ((len + recLen) > bufLen)
+            break;
+
+        memcpy((void*)(buf + len), (void*)rec, recLen);
+        len += recLen;
+    }
+
+    return len;
+}
+
+///-----------------------------------------------------------------------------
+///                      Class member functions                        [PRIVATE]
+///-----------------------------------------------------------------------------
+
+/**
+ * Write number as a varint (7 bits per byte, lowest first)
+ * @param value number to write
+ * @param buf buffer to write into, needs room for 5 bytes
+ * @return number of bytes written
+ */
+uint8_t MetricsRegistry::_Varint(uint32_t value, uint8_t *buf)
+{
+    uint8_t len = 0;
+
+    do
+    {
+        buf[len] = value & 0x7F;
+        value >>= 7;
+        if (value != 0)
+            buf[len] |= 0x80;
+        len++;
+    }
+    while (value != 0);
+
+    return len;
+}
+
+///-----------------------------------------------------------------------------
+///                      Class constructor & destructor              [PROTECTED]
+///-----------------------------------------------------------------------------
+
+MetricsRegistry::MetricsRegistry() : overflows(0), _num(0)
+{
+    for (uint16_t i = 0; i < METRICS_MAX; i++)
+        _metrics[i] = 0;
+}
+
+MetricsRegistry::~MetricsRegistry()
+{}
@@ -0,0 +1,183 @@
+/**
+ *  metrics.h
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran Mikov
+ *
+ *  Registry of run-time metrics of kernel modules. A metric is a counter, a
+ *  gauge or a histogram, kept by the module that updates it (as a member of
+ *  its object). Modules register their metrics in InitHW(), registry only
+ *  keeps pointers to them and reads them when a snapshot is taken:
+ *   -Counter only ever grows. Rates (e.g. encoder pulses per second) are
+ *  obtained by the receiver from two snapshots and the time they were taken
+ *   -Gauge holds the latest value of something, e.g. heap in use
+ *   -Histogram counts values in METRIC_BUCKETS buckets, same as PerfHistogram:
+ *  bucket 0 counts values of 0, bucket i values in range [2^(i-1), 2^i - 1]
+ *  and the last bucket everything bigger than that
+ *  Updates take no locks and don't suspend interrupts, counters and buckets
+ *  are incremented with HAL_BOARD_AtomicAdd() and gauge is a single store of a
+ *  word, so they can be called from interrupts. Snapshot reads every word
+ *  once; it can see a histogram half-way through an update (number of values
+ *  and buckets off by one), but never a torn value.
+ *  Metric is identified by UID of its module and an ID unique within that
+ *  module (*_M_* macros next to module's UID).
+ *
+ *  Snapshot is encoded into binary records (see Encode()), little-endian:
+ *  record:     libUID(1B) type|ID(1B) value
+ *              type (METRIC_*) in upper 2 bits, ID in lower 6 bits
+ *  value:      counter, gauge: varint(value)
+ *              histogram: varint(number of values) buckets(1B) followed by
+ *              varint(count) of that many buckets, starting with bucket 0;
+ *              empty buckets at the end are left out
+ *  varint holds 7 bits per byte, lowest bits first, highest bit of the byte
+ *  is set if more bytes follow
+ *
+ *  @version 1.0
+ *  V1.0 - 17.10.2026
+ *  +Creation of file, registry of counters, gauges and histograms updated
+ *  without locks, encoded into compact binary snapshot
+ */
+#include "hwconfig.h"
+
+#ifndef ROVERKERNEL_INIT_METRICS_H_
+#define ROVERKERNEL_INIT_METRICS_H_
+
+#include "HAL/hal.h"
+
+//  Types of metrics
+#define METRIC_COUNTER      0
+#define METRIC_GAUGE        1
+#define METRIC_HISTOGRAM    2
+
+//  Number of buckets in a histogram metric (values up to 2^14 - 1 get a bucket
+//  of their own)
+#define METRIC_BUCKETS      16
+//  Highest ID of a metric within module, ID is kept in 6 bits of a record
+#define METRIC_ID_MAX       63
+//  Longest encoded record (in bytes), histogram with all buckets
+#define METRIC_REC_MAX      (2 + 5 + 1 + 5*METRIC_BUCKETS)
+
+/**
+ * Common part of all types of metrics, see description at the top of the file
+ */
+class Metric
+{
+    friend class MetricsRegistry;
+    public:
+        uint8_t     Type() const { return _type; }
+
+        //  Value of counter or gauge, number of values added to histogram
+        volatile uint32_t   value;
+
+    protected:
+        Metric(uint8_t type) : value(0), _type(type), _libUID(0), _id(0) {}
+
+        //  One of METRIC_* types
+        uint8_t     _type;
+        //  Module and ID metric was registered with
+        uint8_t     _libUID;
+        uint8_t     _id;
+};
+
+/**
+ * Counter, number of times something has happened since startup
+ */
+class MetricCounter : public Metric
+{
+    public:
+        MetricCounter() : Metric(METRIC_COUNTER) {}
+
+        /**
+         * Increase counter
+         * @param n amount to increase it by
+         */
+        void Add(uint32_t n = 1)
+        {
+            HAL_BOARD_AtomicAdd(&value, n);
+        }
+};
+
+/**
+ * Gauge, latest value of a quantity that goes up and down
+ */
+class MetricGauge : public Metric
+{
+    public:
+        MetricGauge() : Metric(METRIC_GAUGE) {}
+
+        /**
+         * Set new value of gauge
+         * @param v new value
+         */
+        void Set(uint32_t v)
+        {
+            value = v;
+        }
+};
+
+/**
+ * Histogram, distribution of values in logarithmic (power of 2) buckets
+ */
+class MetricHistogram : public Metric
+{
+    public:
+        MetricHistogram() : Metric(METRIC_HISTOGRAM)
+        {
+            for (uint8_t i = 0; i < METRIC_BUCKETS; i++)
+                bucket[i] = 0;
+        }
+
+        /**
+         * Add a value into histogram
+         * @param v value to add
+         */
+        void Observe(uint32_t v)
+        {
+            uint8_t i = 0;
+
+            //  Find bucket index as the number of significant bits in value
+            while ((v >> i) && (i < (METRIC_BUCKETS - 1)))
+                i++;
+
+            HAL_BOARD_AtomicAdd(&bucket[i], 1);
+            HAL_BOARD_AtomicAdd(&value, 1);
+        }
+
+        //  Number of values in each bucket
+        volatile uint32_t   bucket[METRIC_BUCKETS];
+};
+
+/**
+ * MetricsRegistry class definition
+ * List of metrics of all kernel modules, see description at the top of the file
+ */
+class MetricsRegistry
+{
+    friend class KernelContext;
+    public:
+        static MetricsRegistry& GetI();
+        static MetricsRegistry* GetP();
+
+        bool        Register(Metric &metric, uint8_t libUID, uint8_t id);
+        uint16_t    Count();
+        Metric*     At(uint16_t index);
+
+        uint16_t    Encode(uint16_t &index, uint8_t *buf, uint16_t bufLen);
+
+        //  Number of metrics that didn't fit into registry
+        uint32_t    overflows;
+
+    protected:
+        MetricsRegistry();
+        ~MetricsRegistry();
+        MetricsRegistry(MetricsRegistry &) {}           //  No definition - forbid this
+        void operator=(MetricsRegistry const &) {}      //  No definition - forbid this
+
+        static uint8_t  _Varint(uint32_t value, uint8_t *buf);
+
+        //  Registered metrics, in the order of registration
+        Metric      *_metrics[METRICS_MAX];
+        uint16_t    _num;
+};
+
+#endif /* ROVERKERNEL_INIT_METRICS_H_ */
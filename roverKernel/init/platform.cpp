@@ -5,6 +5,7 @@
  *      Author: Vedran
  */
 #include "init/platform.h"
+#include "init/kernelContext.h"
 #include "init/hooks.h"
 #include "libs/myLib.h"
 #include "HAL/hal.h"
@@ -28,6 +29,9 @@
     #define EMIT_EV(X, Y)  EventLog::EmitEvent(PLAT_UID, X, Y)
 #endif /* __HAL_USE_EVENTLOG__ */
 
+//  Number of trace records sent in a single telemetry frame
+#define PLAT_TRACE_CHUNK    32
+
 /**
  * Template function to convert any number into a std::string
  * @param t Number of any type
@@ -39,282 +43,498 @@ template <typename T> inline std::string tostr(const T& t) {
    return os.str();
 }
 
+///-----------------------------------------------------------------------------
+///         Services provided to task scheduler                      [PROTECTED]
+///-----------------------------------------------------------------------------
+
 /**
- * Callback routine to invoke service offered by this module from task scheduler
- * @note It is assumed that once this function is called task scheduler has
- * already copied required variables into the memory space provided for it.
+ * Services offered by platform, in the order of PLAT_T_* IDs
  */
-void _PLAT_KernelCallback(void)
+const _tsService Platform::_services[] =
 {
-    Platform  &__plat = Platform::GetI();
-
-    //  Check for null-pointer
-    if (__plat._ker.args == 0)
-        return;
+    //  PLAT_T_TEL
+    TS_SERVICE0(Platform, uint32_t, _SendTelemetry),
+    //  PLAT_T_REBOOT: rebootCode(0x17)
+    TS_SERVICE1(Platform, uint32_t, _Reboot, uint8_t),
+    //  PLAT_T_EVLOG_DUMP
+    TS_SERVICE0(Platform, uint32_t, _EvlogDump),
+    //  PLAT_T_SOFT_REBOOT: rebootCode(0x17)
+    TS_SERVICE1(Platform, uint32_t, _SoftReboot, uint8_t),
+    //  PLAT_T_TS_DUMP
+    TS_SERVICE0(Platform, uint32_t, _TSDump),
+    //  PLAT_T_ENG_DUMP
+    TS_SERVICE0(Platform, uint32_t, _EngDump),
+    //  PLAT_T_TRACE_DUMP
+    TS_SERVICE0(Platform, uint32_t, _TraceDump),
+    //  PLAT_T_METRICS_DUMP
+    TS_SERVICE0(Platform, uint32_t, _MetricsDump)
+};
 
+/**
+ * Pack & send telemetry frame
+ * @return STATUS_NO_EVENT, telemetry is not important and if sending fails
+ * software does best-effort to try and resend it, no need to report status
+ */
+uint32_t Platform::_SendTelemetry()
+{
     /*
-     *  Data in args[] contains bytes that constitute arguments for function
-     *  calls. The exact representation(i.e. whether bytes represent ints, floats)
-     *  of data is known only to individual blocks of switch() function. There
-     *  is no predefined data separator between arguments inside args[].
-     */
-    switch (__plat._ker.serviceID)
-    {
-    /*
-     *  Pack & send telemetry frame
-     *  args[] = none
-     *  retVal on of myLib.h STATUS_* macros
+     * Telemetry frame has the following format:
+     * @note numbers are represented as strings not byte values
+     * timeSinceStartup:Roll:Pitch:Yaw:distanceLeft:distanceRight:speedLeft:speedRight:accX:accY:accZ:load:backlog:lateness:shed\n
      */
-    case PLAT_T_TEL:
-        {
-            /*
-             * Telemetry frame has the following format:
-             * @note numbers are represented as strings not byte values
-             * timeSinceStartup:Roll:Pitch:Yaw:distanceLeft:distanceRight:speedLeft:speedRight:accX:accY:accZ\n
-             */
-            std::string telemetryFrame;
-            float rpy[3];
-
-            //  Starting sequence "1*" marks beginning of standard telemetry
-            //  frame with all sensor data
-            telemetryFrame = "1*:" + tostr(msSinceStartup) + ":";
+    std::string telemetryFrame;
+    float rpy[3];
+
+    //  Starting sequence "1*" marks beginning of standard telemetry
+    //  frame with all sensor data
+    telemetryFrame = "1*:" + tostr(msSinceStartup) + ":";
 #ifdef __HAL_USE_MPU9250__
-            //  Get RPY orientation on degrees
-            __plat.mpu->RPY(rpy, true);
-            telemetryFrame += tostr(rpy[0])+":"+tostr(rpy[1])+":"+tostr(rpy[2])+":";
+    //  Get RPY orientation on degrees
+    mpu->RPY(rpy, true);
+    telemetryFrame += tostr(rpy[0])+":"+tostr(rpy[1])+":"+tostr(rpy[2])+":";
 #else
-            telemetryFrame += tostr<float>(0.0)+":"+tostr<float>(0.0)+":"+tostr<float>(0.0)+":";
+    telemetryFrame += tostr<float>(0.0)+":"+tostr<float>(0.0)+":"+tostr<float>(0.0)+":";
 #endif
 
-            //  Get 3-axis acceleration from MPU
-            float acc[3];
-            __plat.mpu->Acceleration(acc);
+    //  Get 3-axis acceleration from MPU
+    float acc[3];
+    mpu->Acceleration(acc);
+
+    //  Write engine telemetry into the packet
+    telemetryFrame += tostr<float>((float)eng->GetDistance(0)) + ":";
+    telemetryFrame += tostr<float>((float)eng->GetDistance(1)) + ":";
+    telemetryFrame += tostr<float>((float)eng->wheelSpeed[0]) + ":";
+    telemetryFrame += tostr<float>((float)eng->wheelSpeed[1]) + ":";
+    telemetryFrame += tostr<float>(acc[0]) + ":";
+    telemetryFrame += tostr<float>(acc[1]) + ":";
+    telemetryFrame += tostr<float>(acc[2]) + ":";
+
+    //  Task scheduler load (%), due tasks, lateness (ms) of the oldest
+    //  one and number of skipped tasks
+    volatile LoadMonitor &lm = ts->GetLoad();
+    telemetryFrame += tostr((uint32_t)lm.load) + ":";
+    telemetryFrame += tostr((uint32_t)lm.backlog) + ":";
+    telemetryFrame += tostr((uint32_t)lm.lateness) + ":";
+    telemetryFrame += tostr((uint32_t)lm.shed) + ":";
+
+    telemetryFrame += '\n';
+
+    //  Queue for sending over telemetry stream, ESP send service yields while
+    //  waiting for ESP instead of blocking other tasks
+    uint32_t retVal = telemetry.Post((const uint8_t*)telemetryFrame.c_str(),
+                                     telemetryFrame.length());
+
+#ifdef __DEBUG_SESSION__
+    DEBUG_WRITE("\nSending frame(%d), len:%d \n  %s \n",     \
+            retVal, telemetryFrame.length(),   \
+            telemetryFrame.c_str());
+#endif
 
-            //  Write engine telemetry into the packet
-            telemetryFrame += tostr<float>((float)__plat.eng->GetDistance(0)) + ":";
-            telemetryFrame += tostr<float>((float)__plat.eng->GetDistance(1)) + ":";
-            telemetryFrame += tostr<float>((float)__plat.eng->wheelSpeed[0]) + ":";
-            telemetryFrame += tostr<float>((float)__plat.eng->wheelSpeed[1]) + ":";
-            telemetryFrame += tostr<float>(acc[0]) + ":";
-            telemetryFrame += tostr<float>(acc[1]) + ":";
-            telemetryFrame += tostr<float>(acc[2]) + ":";
+    //  If previous sending failed, no need to force next sending, pass
+    if (retVal != STATUS_OK)
+        return STATUS_NO_EVENT;
 
-            telemetryFrame += '\n';
+    //  If there are any unsent events, ship them off now, as many in a single
+    //  frame as fit (see PLAT_EVB_* in platform.h). Only events in the log at
+    //  this point are sent, events emitted while sending wait for the next
+    //  time. Events stay in the log until server acknowledges them
+    EventLog &evLog = EventLog::GetI();
+    uint32_t seq = evLog.FirstSeq(),
+             lastSeq = evLog.NextSeq();
 
-            //  Send over telemetry stream
-            __plat._ker.retVal =
-                    __plat.telemetry.Send((uint8_t*)telemetryFrame.c_str());
+    while (seq != lastSeq)
+    {
+        uint32_t firstSeq = seq;
+        uint16_t len = evLog.EncodeEvents(seq, lastSeq,
+                                          _evFrame + PLAT_EVB_HEADER,
+                                          PLAT_EVB_SIZE - PLAT_EVB_HEADER);
+        //  Event has been overwritten in the meantime, or is still being
+        //  written, next telemetry frame starts from there
+        if (seq == firstSeq)
+            break;
+
+        //  Length field counts the bytes after it (start sequence and the
+        //  field itself take 7 bytes)
+        uint16_t num = (uint16_t)(seq - firstSeq),
+                 left = (uint16_t)(lastSeq - seq),
+                 frameLen = PLAT_EVB_HEADER + len;
+        len = frameLen - 7;
+        memcpy((void*)_evFrame, (void*)"2*:B:", 5);
+        _evFrame[5] = (uint8_t)len;
+        _evFrame[6] = (uint8_t)(len >> 8);
+        _evFrame[7] = (uint8_t)firstSeq;
+        _evFrame[8] = (uint8_t)(firstSeq >> 8);
+        _evFrame[9] = (uint8_t)(firstSeq >> 16);
+        _evFrame[10] = (uint8_t)(firstSeq >> 24);
+        _evFrame[11] = (uint8_t)num;
+        _evFrame[12] = (uint8_t)(num >> 8);
+        _evFrame[13] = (uint8_t)left;
+        _evFrame[14] = (uint8_t)(left >> 8);
+
+        retVal = telemetry.Post(_evFrame, frameLen);
 
 #ifdef __DEBUG_SESSION__
-            DEBUG_WRITE("\nSending frame(%d), len:%d \n  %s \n",     \
-                    __plat._ker.retVal, telemetryFrame.length(),   \
-                    telemetryFrame.c_str());
+        DEBUG_WRITE("\nSending events(%d), seq:%d num:%d len:%d \n", \
+                retVal, firstSeq, num, frameLen);
 #endif
+        if (retVal != STATUS_OK)
+            break;
+    }
 
-            //  If previous sending failed, no need to force next sending, pass
-            if (__plat._ker.retVal != STATUS_OK)
-                return;
+    return STATUS_NO_EVENT;
+}
 
-            //  If there are any unsent events, ship them off now
-            if (EventLog::GetI().EventCount() > 0)
-            {
-                //  Loop through linked list of events and send them one by one
-                volatile struct _eventEntry* node = EventLog::GetI().GetHead();
-                uint16_t nodesSent = 1;
-                while(node != 0)
-                {
-                    //  Assemble telemetry frame from event log
-                    //  Starting sequence "2*" marks beginning of frame carrying
-                    //  event log data, one log entry per frame
-                    telemetryFrame =  "2*:" + tostr<uint16_t>(EventLog::GetI().EventCount()-nodesSent) + ":";
-                    telemetryFrame += "[" + tostr<uint32_t>(node->timestamp) + "]:";
-                    telemetryFrame += tostr<uint16_t>(node->libUID) + ":";
-                    telemetryFrame += tostr<int16_t>(node->taskID) + ":";
-                    telemetryFrame += tostr<uint16_t>(node->event) + ":";
-
-                    __plat.telemetry.Send((uint8_t*)telemetryFrame.c_str(),
-                                                   telemetryFrame.length());
+/**
+ * Reboot microcontroller
+ * @param rebootCode has to be 0x17 for reboot to take place
+ * @return STATUS_ARG_ERR if reboot code is wrong, doesn't return otherwise
+ */
+uint32_t Platform::_Reboot(uint8_t rebootCode)
+{
+    //  Reboot only if 0x17 was sent as argument
+    if (rebootCode == 0x17)
+    {
+#ifdef __HAL_USE_STORAGE__
+        //  Write whatever is still in RAM into storage, so that it's there
+        //  after reboot
+        store->Sync();
+#endif  /* __HAL_USE_STORAGE__ */
+        HAL_BOARD_Reset();
+    }
 
-#ifdef __DEBUG_SESSION__
-                    DEBUG_WRITE("\nSending frame(%d), len:%d \n  %s \n",     \
-                            __plat._ker.retVal, telemetryFrame.length(),   \
-                            telemetryFrame.c_str());
-#endif
+    return STATUS_ARG_ERR;
+}
 
-                    node = node->next;
-                    nodesSent++;
-                }
-            }
+/**
+ * Send only highest priority events emitted until now
+ * @return STATUS_OK, telemetry can't affect status, it's only a best-effort to
+ * deliver data
+ */
+uint32_t Platform::_EvlogDump()
+{
+    std::string telemetryFrame;
 
-            //  Telemetry doesn't affect status, if it fails, software
-            //  does best-effort to try and resend it
-            __plat._ker.retVal = STATUS_OK;
-            return; //  No need to report status, telemetry is not important
-        }
-    /*
-     * Reboot microcontroller
-     * args[] = rebootCode(0x17)
-     * retVal none
-     */
-    case PLAT_T_REBOOT:
-        {
-            //  Reboot only if 0x17 was sent as argument
-            if (__plat._ker.args[0] == 0x17)
-            {
-                HAL_BOARD_Reset();
-            }
-        }
-        break;
-    /*
-     * Send only highest priority events emitted until now
-     * args[] = none
-     * retVal STATUS_OK
-     */
-    case PLAT_T_EVLOG_DUMP:
-        {
-            std::string telemetryFrame;
+    for (uint8_t i = 0; i < NUM_OF_MODULES; i++)
+    {
+        struct _eventEntry ee = EventLog::GetI().GetHigPrioEvAt(i);
+
+        //  (-1) is default initialization value, means there's no entry
+        //  yet for this module in event log
+        if (ee.libUID == (-1))
+            continue;
+
+        //  Construct standard telemetry frame with event log data, format:
+        //  2*:numOfEvents:[time]:libUID:taskUID:event
+        //  NOTE: First argument numOfEvents is here set to 5, it can be
+        //  any number !=0. When 0 is sent client will request DropBefore(time)
+        //  function event log, deleting all entries before given time
+        telemetryFrame =  "2*:" + tostr<uint16_t>(5) + ":";
+        telemetryFrame += "[" + tostr<uint32_t>(ee.timestamp) + "]:";
+        telemetryFrame += tostr<uint16_t>(ee.libUID) + ":";
+        telemetryFrame += tostr<int16_t>(ee.taskID) + ":";
+        telemetryFrame += tostr<uint16_t>(ee.event) + ":";
+
+        //  Send telemetry frame
+        telemetry.Send((uint8_t*)telemetryFrame.c_str(),
+                       telemetryFrame.length());
+    }
 
-            for (uint8_t i = 0; i < NUM_OF_MODULES; i++)
-            {
-                struct _eventEntry ee = EventLog::GetI().GetHigPrioEvAt(i);
-
-                //  (-1) is default initialization value, means there's no entry
-                //  yet for this module in event log
-                if (ee.libUID == (-1))
-                    continue;
-
-                //  Construct standard telemetry frame with event log data, format:
-                //  2*:numOfEvents:[time]:libUID:taskUID:event
-                //  NOTE: First argument numOfEvents is here set to 5, it can be
-                //  any number !=0. When 0 is sent client will request DropBefore(time)
-                //  function event log, deleting all entries before given time
-                telemetryFrame =  "2*:" + tostr<uint16_t>(5) + ":";
-                telemetryFrame += "[" + tostr<uint32_t>(ee.timestamp) + "]:";
-                telemetryFrame += tostr<uint16_t>(ee.libUID) + ":";
-                telemetryFrame += tostr<int16_t>(ee.taskID) + ":";
-                telemetryFrame += tostr<uint16_t>(ee.event) + ":";
-
-                //  Send telemetry frame
-                __plat.telemetry.Send((uint8_t*)telemetryFrame.c_str(),
-                                               telemetryFrame.length());
-            }
-            //  Telemetry can't affect status, it's only a best-effort to
-            //  deliver data
-            __plat._ker.retVal = STATUS_OK;
-        }
-        break;
-    /*
-     * Perform soft reset of platform module, reset only event log state
-     * args[] = rebootCode(0x17)
-     * retVal STATUS_OK
-     */
-    case PLAT_T_SOFT_REBOOT:
-        {
-            //  Reboot only if 0x17 was sent as argument
-            if (__plat._ker.args[0] == 0x17)
-            {
+    return STATUS_OK;
+}
+
+/**
+ * Perform soft reset of platform module, reset only event log state
+ * @param rebootCode has to be 0x17 for reset to take place
+ * @return STATUS_OK, there's nothing that can affect outcome of this task
+ */
+uint32_t Platform::_SoftReboot(uint8_t rebootCode)
+{
+    //  Reboot only if 0x17 was sent as argument
+    if (rebootCode == 0x17)
+    {
 #ifdef __HAL_USE_EVENTLOG__
-                EventLog::SoftReboot(PLAT_UID);
+        EventLog::SoftReboot(PLAT_UID);
 #endif  /* __HAL_USE_EVENTLOG__ */
+    }
 
-            }
-            //  There's nothing that can affect outcome of this task
-            __plat._ker.retVal = STATUS_OK;
-        }
-        break;
-    /*
-     * Send data about task scheduler performance and load
-     * args[] = none
-     * retVal STATUS_OK
-     */
-    case PLAT_T_TS_DUMP:
-        {
-            std::string telemetryFrame;
-            uint32_t Ntasks = __plat.ts->NumOfTasks();
+    return STATUS_OK;
+}
+
+/**
+ * Send data about task scheduler performance and load
+ * @return STATUS_OK
+ */
+uint32_t Platform::_TSDump()
+{
+    std::string telemetryFrame;
+    uint32_t Ntasks = ts->NumOfTasks();
+
+    for (uint16_t i = 0; i < Ntasks; i++)
+    {
+        const TaskEntry *task = ts->FetchNextTask(i==0);
+        if (task == 0)
+            break;
+
+        //  Construct standard telemetry frame with event log data, format:
+        //  3*:[time]:uid:task:period:PID:runs:startMissCnt:startMissTot:
+        //  usAcc:accRT:maxRT:prio:deadlineMissCnt:rtP50:rtP99:
+        //  latP50:latP99:latMax:jitMean:skipped:overruns: (run time, latency
+        //  and jitter in us)
+        telemetryFrame =  "3*:";
+        telemetryFrame += "[" + tostr<uint32_t>((uint32_t)task->GetTimeStamp()) + "]:";
+        telemetryFrame += tostr<uint16_t>(task->GetLibUID()) + ":";
+        telemetryFrame += tostr<uint16_t>(task->GetTaskUID()) + ":";
+        telemetryFrame += tostr<int32_t>(task->GetPeriod()) + ":";
+        telemetryFrame += tostr<uint16_t>((uint16_t)task->GetPID()) + ":";
+
+        //  Task performance data
+        telemetryFrame += tostr<uint32_t>((uint32_t)task->Perf.taskRuns) + ":";
+        telemetryFrame += tostr<uint32_t>((uint32_t)task->Perf.startTimeMissCnt) + ":";
+        telemetryFrame += tostr<uint32_t>((uint32_t)task->Perf.startTimeMissTot) + ":";
+        telemetryFrame += tostr<uint32_t>((uint32_t)task->Perf.usAcc) + ":";
+        telemetryFrame += tostr<uint32_t>((uint32_t)task->Perf.accRT) + ":";
+        telemetryFrame += tostr<uint32_t>((uint32_t)task->Perf.runTime.max) + ":";
+        telemetryFrame += tostr<uint16_t>(task->GetPriority()) + ":";
+        telemetryFrame += tostr<uint32_t>((uint32_t)task->Perf.deadlineMissCnt) + ":";
+
+        //  Distribution of run time and start latency
+        telemetryFrame += tostr<uint32_t>(task->Perf.runTime.Percentile(50)) + ":";
+        telemetryFrame += tostr<uint32_t>(task->Perf.runTime.Percentile(99)) + ":";
+        telemetryFrame += tostr<uint32_t>(task->Perf.startLatency.Percentile(50)) + ":";
+        telemetryFrame += tostr<uint32_t>(task->Perf.startLatency.Percentile(99)) + ":";
+        telemetryFrame += tostr<uint32_t>((uint32_t)task->Perf.startLatency.max) + ":";
+        telemetryFrame += tostr<uint32_t>(task->Perf.JitterMean()) + ":";
+        telemetryFrame += tostr<uint32_t>((uint32_t)task->Perf.periodsSkipped) + ":";
+        telemetryFrame += tostr<uint32_t>((uint32_t)task->Perf.overrunCnt) + ":";
+
+        //  Send telemetry frame
+        telemetry.Send((uint8_t*)telemetryFrame.c_str(),
+                       telemetryFrame.length());
+    }
+
+    //  Construct telemetry frame with profile of every service called so far,
+    //  including those called only by one-shot tasks, format:
+    //  3*:S:uid:task:runs:rtP50:rtP99:rtMax:latP50:latP99:latMax:jitMean:
+    //  deadlineMissCnt:overruns: (run time, latency and jitter in us)
+    const volatile ServiceProfile *prof;
+
+    for (uint8_t i = 0; (prof = ts->GetProfile(i)) != 0; i++)
+    {
+        telemetryFrame =  "3*:S:";
+        telemetryFrame += tostr<uint16_t>(prof->libUID) + ":";
+        telemetryFrame += tostr<uint16_t>(prof->taskID) + ":";
+        telemetryFrame += tostr<uint32_t>((uint32_t)prof->runs) + ":";
+        telemetryFrame += tostr<uint32_t>(prof->runTime.Percentile(50)) + ":";
+        telemetryFrame += tostr<uint32_t>(prof->runTime.Percentile(99)) + ":";
+        telemetryFrame += tostr<uint32_t>((uint32_t)prof->runTime.max) + ":";
+        telemetryFrame += tostr<uint32_t>(prof->startLatency.Percentile(50)) + ":";
+        telemetryFrame += tostr<uint32_t>(prof->startLatency.Percentile(99)) + ":";
+        telemetryFrame += tostr<uint32_t>((uint32_t)prof->startLatency.max) + ":";
+        telemetryFrame += tostr<uint32_t>(prof->JitterMean()) + ":";
+        telemetryFrame += tostr<uint32_t>((uint32_t)prof->deadlineMissCnt) + ":";
+        telemetryFrame += tostr<uint32_t>((uint32_t)prof->overrunCnt) + ":";
+
+        telemetry.Send((uint8_t*)telemetryFrame.c_str(),
+                       telemetryFrame.length());
+    }
+
+    //  Construct telemetry frame with usage of task scheduler memory
+    //  pools (nodes, small and large arguments) and of the ring of
+    //  requests deferred from interrupts, format:
+    //  3*:M:[used:peak:overflows] x4
+    MemPool *pools[] = { &TS_NodePool(), &TS_ArgPool(0), &TS_ArgPool(1) };
+
+    telemetryFrame =  "3*:M:";
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        telemetryFrame += tostr<uint16_t>((uint16_t)pools[i]->used) + ":";
+        telemetryFrame += tostr<uint16_t>((uint16_t)pools[i]->peak) + ":";
+        telemetryFrame += tostr<uint32_t>((uint32_t)pools[i]->overflows) + ":";
+    }
+    volatile DeferQueue &deferred = ts->GetDeferQueue();
+    telemetryFrame += tostr<uint16_t>(deferred.Count()) + ":";
+    telemetryFrame += tostr<uint16_t>((uint16_t)deferred.peak) + ":";
+    telemetryFrame += tostr<uint32_t>((uint32_t)deferred.overflows) + ":";
+
+    telemetry.Send((uint8_t*)telemetryFrame.c_str(), telemetryFrame.length());
+
+    //  Construct telemetry frame with number of duplicate tasks
+    //  coalesced for each service that has a coalescing policy, format:
+    //  3*:C:[uid:task:policy:hits:] x number of policies
+    const volatile _coalesceRule *rule;
+
+    telemetryFrame =  "3*:C:";
+    for (uint8_t i = 0; (rule = ts->GetCoalesceRule(i)) != 0; i++)
+    {
+        telemetryFrame += tostr<uint16_t>(rule->libUID) + ":";
+        telemetryFrame += tostr<uint16_t>(rule->taskID) + ":";
+        telemetryFrame += tostr<uint16_t>(rule->policy) + ":";
+        telemetryFrame += tostr<uint32_t>((uint32_t)rule->hits) + ":";
+    }
+
+    telemetry.Send((uint8_t*)telemetryFrame.c_str(), telemetryFrame.length());
+
+    //  Construct telemetry frame with run-time budget overruns of all
+    //  services and the service that went over budget last, format:
+    //  3*:B:overruns:caught:maxExcess:uid:task:PID: (excess in us)
+    volatile BudgetMonitor &budget = ts->GetBudget();
+
+    telemetryFrame =  "3*:B:";
+    telemetryFrame += tostr<uint32_t>((uint32_t)budget.overruns) + ":";
+    telemetryFrame += tostr<uint32_t>((uint32_t)budget.caught) + ":";
+    telemetryFrame += tostr<uint32_t>((uint32_t)budget.maxExcessUS) + ":";
+    telemetryFrame += tostr<uint16_t>(budget.lastLibUID) + ":";
+    telemetryFrame += tostr<uint16_t>(budget.lastTaskID) + ":";
+    telemetryFrame += tostr<uint16_t>((uint16_t)budget.lastPID) + ":";
+
+    telemetry.Send((uint8_t*)telemetryFrame.c_str(), telemetryFrame.length());
+
+    return STATUS_OK;
+}
+
+/**
+ * Send information about engines, current speed, distance traveled
+ * @return STATUS_OK
+ */
+uint32_t Platform::_EngDump()
+{
+    std::string telemetryFrame;
+    float acc[3];
+
+    mpu->Acceleration(acc);
+
+    //Format:
+    //  4*:distanceLeft:distanceRight:speedLeft:speedRight:accX:accY:accZ
+    telemetryFrame =  "4*:";
+    telemetryFrame += tostr<int32_t>((int32_t)eng->wheelCounter[0]) + ":";
+    telemetryFrame += tostr<int32_t>((int32_t)eng->wheelCounter[1]) + ":";
+    telemetryFrame += tostr<int32_t>((float)eng->wheelSpeed[0]) + ":";
+    telemetryFrame += tostr<int32_t>((float)eng->wheelSpeed[1]) + ":";
+    telemetryFrame += tostr<float>(acc[0]) + ":";
+    telemetryFrame += tostr<float>(acc[1]) + ":";
+    telemetryFrame += tostr<float>(acc[2]) + ":";
+
+#ifdef __DEBUG_SESSION__
+    DEBUG_WRITE("\nSending frame, len:%d \n  %s \n", telemetryFrame.length(), \
+                telemetryFrame.c_str());
+#endif
+
+    //  Send telemetry frame
+    telemetry.Send((uint8_t*)telemetryFrame.c_str(), telemetryFrame.length());
 
-            for (uint8_t i = 0; i < Ntasks; i++)
+    return STATUS_OK;
+}
+
+/**
+ * Send content of kernel trace buffer, oldest record first. Recording is
+ * paused while the buffer is being sent so the dump doesn't overwrite it
+ * @return STATUS_OK
+ */
+uint32_t Platform::_TraceDump()
+{
+#if defined(__TS_TRACE__)
+    static const char hex[] = "0123456789ABCDEF";
+    std::string telemetryFrame;
+    uint64_t usNow = TS_GetTimeUS();
+    volatile TraceBuffer &trace = *(KernelContext::Current().trace);
+
+    trace.enabled = false;
+    uint16_t count = trace.Count();
+
+    //  Header frame, cycle counter and time sampled together give a
+    //  reference for converting cycles of records into time, format:
+    //  5*:H:records:lost:cyclesNow:cyclesPerUS:msNow:usFraction:
+    telemetryFrame =  "5*:H:";
+    telemetryFrame += tostr<uint16_t>(count) + ":";
+    telemetryFrame += tostr<uint32_t>(trace.Lost()) + ":";
+    telemetryFrame += tostr<uint32_t>(HAL_TS_GetCycles()) + ":";
+    telemetryFrame += tostr<uint32_t>(HAL_TS_GetCyclesPerUS()) + ":";
+    telemetryFrame += tostr<uint32_t>((uint32_t)(usNow / 1000)) + ":";
+    telemetryFrame += tostr<uint16_t>((uint16_t)(usNow % 1000)) + ":";
+
+    telemetry.Send((uint8_t*)telemetryFrame.c_str(), telemetryFrame.length());
+
+    //  Records are sent in frames of PLAT_TRACE_CHUNK, each record
+    //  as 20 hex digits of its little-endian fields, format:
+    //  5*:index:[cycles(4B)|PID(2B)|type|libUID|taskID|data] x N:
+    for (uint16_t i = 0; i < count; i += PLAT_TRACE_CHUNK)
+    {
+        telemetryFrame =  "5*:" + tostr<uint16_t>(i) + ":";
+
+        for (uint16_t j = i; (j < count) && (j < (i+PLAT_TRACE_CHUNK)); j++)
+        {
+            const volatile _traceRec &rec = trace.At(j);
+            uint8_t raw[10] = { (uint8_t)(rec.cycles),
+                                (uint8_t)(rec.cycles >> 8),
+                                (uint8_t)(rec.cycles >> 16),
+                                (uint8_t)(rec.cycles >> 24),
+                                (uint8_t)(rec.PID),
+                                (uint8_t)(rec.PID >> 8),
+                                rec.type, rec.libUID, rec.taskID,
+                                rec.data };
+
+            for (uint8_t k = 0; k < sizeof(raw); k++)
             {
-                const TaskEntry *task = __plat.ts->FetchNextTask(i==0);
-                if (task == 0)
-                    break;
-
-                //  Construct standard telemetry frame with event log data, format:
-                //  3*:[time]:pendingTasks
-                telemetryFrame =  "3*:";
-                telemetryFrame += "[" + tostr<uint32_t>((uint32_t)task->GetTimeStamp()) + "]:";
-                telemetryFrame += tostr<uint16_t>(task->GetLibUID()) + ":";
-                telemetryFrame += tostr<uint16_t>(task->GetTaskUID()) + ":";
-                telemetryFrame += tostr<int32_t>(task->GetPeriod()) + ":";
-                telemetryFrame += tostr<uint16_t>((uint16_t)task->GetPID()) + ":";
-
-                //  Task performance data
-                telemetryFrame += tostr<uint32_t>((uint32_t)task->Perf.taskRuns) + ":";
-                telemetryFrame += tostr<uint32_t>((uint32_t)task->Perf.startTimeMissCnt) + ":";
-                telemetryFrame += tostr<uint32_t>((uint32_t)task->Perf.startTimeMissTot) + ":";
-                telemetryFrame += tostr<uint16_t>((uint16_t)task->Perf.msAcc) + ":";
-                telemetryFrame += tostr<uint32_t>((uint32_t)task->Perf.accRT) + ":";
-                telemetryFrame += tostr<uint16_t>((uint16_t)task->Perf.maxRT) + ":";
-
-                //  Send telemetry frame
-                __plat.telemetry.Send((uint8_t*)telemetryFrame.c_str(),
-                                               telemetryFrame.length());
+                telemetryFrame += hex[raw[k] >> 4];
+                telemetryFrame += hex[raw[k] & 0x0F];
             }
-            //  Telemetry can't affect status, it's only a best-effort to
-            //  deliver data
-            __plat._ker.retVal = STATUS_OK;
-        }
-        break;
-    /*
-     * Send information about engines, current speed, distance traveled
-     * args[] = none
-     * retVal STATUS_OK
-     */
-    case PLAT_T_ENG_DUMP:
-        {
-            std::string telemetryFrame;
-            float acc[3];
-
-            __plat.mpu->Acceleration(acc);
-
-            //Format:
-            //  4*:distanceLeft:distanceRight:speedLeft:speedRight:accX:accY:accZ
-            telemetryFrame =  "4*:";
-            telemetryFrame += tostr<int32_t>((int32_t)__plat.eng->wheelCounter[0]) + ":";
-            telemetryFrame += tostr<int32_t>((int32_t)__plat.eng->wheelCounter[1]) + ":";
-            telemetryFrame += tostr<int32_t>((float)__plat.eng->wheelSpeed[0]) + ":";
-            telemetryFrame += tostr<int32_t>((float)__plat.eng->wheelSpeed[1]) + ":";
-            telemetryFrame += tostr<float>(acc[0]) + ":";
-            telemetryFrame += tostr<float>(acc[1]) + ":";
-            telemetryFrame += tostr<float>(acc[2]) + ":";
-
-
-            #ifdef __DEBUG_SESSION__
-                                DEBUG_WRITE("\nSending frame(%d), len:%d \n  %s \n",     \
-                                        __plat._ker.retVal, telemetryFrame.length(),   \
-                                        telemetryFrame.c_str());
-            #endif
-
-            //  Send telemetry frame
-            __plat.telemetry.Send((uint8_t*)telemetryFrame.c_str(),
-                                           telemetryFrame.length());
-
-            //  Telemetry can't affect status, it's only a best-effort to
-            //  deliver data
-            __plat._ker.retVal = STATUS_OK;
         }
-        break;
-    default:
-        break;
+        telemetryFrame += ":";
+
+        telemetry.Send((uint8_t*)telemetryFrame.c_str(),
+                       telemetryFrame.length());
     }
 
-    //  Check return-value and emit event based on it
-#ifdef __HAL_USE_EVENTLOG__
-    if (__plat._ker.retVal == STATUS_OK)
-        EMIT_EV(__plat._ker.serviceID, EVENT_OK);
-    else
-        EMIT_EV(__plat._ker.serviceID, EVENT_ERROR);
-#endif  /* __HAL_USE_EVENTLOG__ */
+    trace.enabled = true;
+#endif  /* __TS_TRACE__ */
 
+    return STATUS_OK;
+}
+
+/**
+ * Send snapshot of all registered metrics in binary frame(s), format is given
+ * with PLAT_MET_HEADER in platform.h
+ * @return STATUS_NO_EVENT, snapshot is sent again with the next period
+ */
+uint32_t Platform::_MetricsDump()
+{
+    MetricsRegistry &metrics = MetricsRegistry::GetI();
+    uint32_t msNow = (uint32_t)msSinceStartup;
+    uint16_t index = 0;
+
+    //  Heap isn't tracked as it changes, only sampled for the snapshot
+    uint32_t heapUsed = HAL_BOARD_HeapUsed();
+    if (heapUsed != HAL_HEAP_UNKNOWN)
+        _heapUsed.Set(heapUsed);
+
+    while (index < metrics.Count())
+    {
+        uint16_t first = index;
+        uint16_t len = metrics.Encode(index, _evFrame + PLAT_MET_HEADER,
+                                      PLAT_EVB_SIZE - PLAT_MET_HEADER);
+        uint16_t num = index - first,
+                 frameLen = PLAT_MET_HEADER + len;
+
+        //  Length field counts the bytes after it (start sequence and the
+        //  field itself take 7 bytes)
+        len = frameLen - 7;
+        memcpy((void*)_evFrame, (void*)"6*:M:", 5);
+        _evFrame[5] = (uint8_t)len;
+        _evFrame[6] = (uint8_t)(len >> 8);
+        _evFrame[7] = (uint8_t)msNow;
+        _evFrame[8] = (uint8_t)(msNow >> 8);
+        _evFrame[9] = (uint8_t)(msNow >> 16);
+        _evFrame[10] = (uint8_t)(msNow >> 24);
+        _evFrame[11] = (uint8_t)first;
+        _evFrame[12] = (uint8_t)(first >> 8);
+        _evFrame[13] = (uint8_t)num;
+        _evFrame[14] = (uint8_t)(num >> 8);
+
+        if (telemetry.Post(_evFrame, frameLen) != STATUS_OK)
+            break;
+    }
+
+    return STATUS_NO_EVENT;
 }
 
 ///-----------------------------------------------------------------------------
@@ -323,12 +543,11 @@ void _PLAT_KernelCallback(void)
 
 /**
  * Return reference to a singleton
- * @return reference to an internal static instance
+ * @return reference to the instance owned by current kernel context
  */
 Platform& Platform::GetI()
 {
-    static Platform singletonInstance;
-    return singletonInstance;
+    return *(KernelContext::Current().platform);
 }
 
 /**
@@ -362,14 +581,23 @@ void Platform::InitHW()
         ts->InitHW(1);
 #endif
 
+    //  Recover events and metrics stored before reset, events emitted from
+    //  now on are stored together with them
+#ifdef __HAL_USE_STORAGE__
+    store = EventStore::GetP();
+    store->InitHW();
+#endif  /* __HAL_USE_STORAGE__ */
+
     //  Emit status of platform
 #ifdef __HAL_USE_EVENTLOG__
     EMIT_EV(-1, EVENT_STARTUP);
 #endif  /* __HAL_USE_EVENTLOG__ */
 
     //  Register module services with task scheduler
-    _ker.callBackFunc = _PLAT_KernelCallback;
-    TS_RegCallback(&_ker, PLAT_UID);
+    TS_RegServices(PLAT_UID, TS_SERVICES(_services));
+    //  Heap usage is reported only by boards that can tell it
+    if (HAL_BOARD_HeapUsed() != HAL_HEAP_UNKNOWN)
+        MetricsRegistry::GetI().Register(_heapUsed, PLAT_UID, PLAT_M_HEAP);
 
     //  If using ESP chip, get handle and connect to access point
 #ifdef __HAL_USE_ESP8266__
@@ -413,21 +641,27 @@ void Platform::InitHW()
 }
 
 /**
- * Decode received message which carries a task to be scheduled
- * Function extracts task and its arguments from message and schedules task
- * within task scheduler.
- * Message frame:
- * sender:libUID:serviceID:timestamp:repeats:argLen::args\r\n
+ * Decode received message which carries task(s) to be scheduled
+ * Function extracts tasks and their arguments from message and schedules them
+ * within task scheduler, all at once.
+ * Message frame with a single task:
+ * sender:libUID:serviceID:timestamp:period:repeats:argLen::args\r\n
+ * Message frame with a batch of tasks:
+ * sender:B:count:task1:task2...\r\n
+ * where each task is libUID:serviceID:timestamp:period:repeats:argLen::args
  * (all parts of message except for 'args' are numbers represented as strings,
  * args value is encoded into bit field and needs can be memcpy-ed into variable)
+ * @note Tasks of a batch are either all scheduled or none is, so a single ACK
+ * covers the whole frame. Arguments of all tasks in a batch together can't be
+ * longer than TS_BATCH_ARG_SIZE, single task isn't limited by that
  * @param buf
  * @param len
  */
 void Platform::Execute(const uint8_t* buf, const uint16_t len, int *err)
 {
-    TaskEntry te;
-    int32_t argv[10] = {0},
-            argc = 0;
+    TaskBatch batch;
+    int32_t task[PLAT_TASK_FIELDS];
+    uint8_t count;
 
     //  Set error to 0 -> No error in parsing
     *err = STATUS_OK;
@@ -456,6 +690,78 @@ void Platform::Execute(const uint8_t* buf, const uint16_t len, int *err)
     //  Skip first part of message which is the string identifying the sender
     while (buf[it++] != ':');
 
+    //  Single task is scheduled directly, its arguments are copied straight
+    //  from the message into the task
+    if (buf[it] != 'B')
+    {
+        if (!_ParseTask(buf, len, it, task))
+        {
+            *err = STATUS_ARG_ERR;
+            return;
+        }
+
+        ts->SyncTaskPer(task[0], task[1], task[2], task[3], task[4],
+                        (task[0] == ENGINES_UID) ? T_PRIO_HIGH : T_PRIO_NORMAL);
+        //  Task is dropped if there's no memory for its arguments
+        if ((task[5] > 0) && !ts->AddArgs((void*)(buf+it), task[5]))
+            *err = STATUS_PROG_ERR;
+        return;
+    }
+
+    //  Batch of tasks, read number of tasks in it
+    it += 2;
+    uint16_t start = it;
+    while ((it < len) && (buf[it] != ':'))
+        it++;
+    count = (uint8_t)stoi((uint8_t*)(buf+start), (uint8_t)(it-start));
+
+    //  Extract all tasks into a batch
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (!_ParseTask(buf, len, it, task))
+        {
+            *err = STATUS_ARG_ERR;
+            return;
+        }
+
+        //  Commands for engines are executed ahead of any other task due at
+        //  the same time
+        batch.Add(task[0], task[1], task[2], task[3], task[4],
+                  (task[0] == ENGINES_UID) ? T_PRIO_HIGH : T_PRIO_NORMAL);
+        //  Pass location and size of arguments
+        if (task[5] > 0)
+            batch.AddArgs((void*)(buf+it), task[5]);
+        it += task[5];
+
+        if (!batch.IsValid())
+        {
+            *err = STATUS_ARG_ERR;
+            return;
+        }
+    }
+
+    //  Schedule all tasks at once
+    if ((count == 0) || !ts->SyncBatch(batch))
+        *err = STATUS_PROG_ERR;
+}
+
+/**
+ * Decode a single task from message
+ * Task is in format libUID:serviceID:timestamp:period:repeats:argLen::args
+ * @param buf buffer containing the message
+ * @param len length of the message
+ * @param it [in/out] position in message at which task starts, on exit
+ * position of the first byte of its arguments
+ * @param task [out] PLAT_TASK_FIELDS numbers describing the task, in the order
+ * they appear in message
+ * @return true if task was decoded, false if message is corrupted
+ */
+bool Platform::_ParseTask(const uint8_t* buf, const uint16_t len,
+                          uint16_t &it, int32_t *task)
+{
+    int32_t argv[10] = {0},
+            argc = 0;
+
     //  Go through string and extract all arguments for task scheduling
     //  When finished 'it' points to first position of args
     while((it < (len-1)) && !((buf[it] == ':') && (buf[it+1] == ':')))
@@ -469,19 +775,23 @@ void Platform::Execute(const uint8_t* buf, const uint16_t len, int *err)
             it++;
 
         //  Extract all digits of a number
-        while ((buf[it] != ':') && (it < len))
+        while ((buf[it] != ':') && (it < len) && (tmpLen < sizeof(tmp)))
                 tmp[tmpLen++] = buf[it++];
 
         //  Convert string to int and save it
-        argv[argc++] = stoi((uint8_t*)tmp, tmpLen);
+        if (argc < 10)
+            argv[argc++] = stoi((uint8_t*)tmp, tmpLen);
     }
     //  Skip double colon marking beginning of arguments
     it+=2;
 
+    //  Task needs at least 6 numbers and all of its arguments
+    if ((argc < 6) || (argv[5] < 0) || ((it + argv[5]) > len))
+        return false;
 
 #ifdef __DEBUG_SESSION__
-    DEBUG_WRITE("Task has %d arguments, requests service %d from library %d \nArguments: ", argv[4], argv[1], argv[0]);
-    for (int i = it; i < len; i++)
+    DEBUG_WRITE("Task has %d arguments, requests service %d from library %d \nArguments: ", argv[5], argv[1], argv[0]);
+    for (int i = it; i < (it + argv[5]); i++)
         DEBUG_WRITE("0x%X ", buf[i]);
     DEBUG_WRITE("\n");
 #endif
@@ -493,10 +803,11 @@ void Platform::Execute(const uint8_t* buf, const uint16_t len, int *err)
         argv[3] = 40;
         argv[4] = 160;
     }
-    //  Schedule task based on data provided
-    ts->SyncTaskPer(argv[0], argv[1], argv[2], argv[3], argv[4]);
-    //  Pass location and size of arguments
-    ts->AddArgs((void*)(buf+it), argv[5]);
+
+    for (uint8_t i = 0; i < PLAT_TASK_FIELDS; i++)
+        task[i] = argv[i];
+
+    return true;
 }
 
 /**
@@ -505,22 +816,44 @@ void Platform::Execute(const uint8_t* buf, const uint16_t len, int *err)
  */
 void Platform::_PostInit()
 {
+    //  All periodic tasks are scheduled together, with offsets relative to the
+    //  same moment
+    TaskBatch batch;
+
 #ifdef __HAL_USE_MPU9250__
     //  Create periodic task that will read sensor data
-    ts->SyncTaskPer(MPU_UID, MPU_T_GET_DATA, -50, 10, T_PERIODIC);
+    batch.Add(MPU_UID, MPU_T_GET_DATA, -50, 10, T_PERIODIC, T_PRIO_HIGH);
     #ifdef __HAL_USE_MPU9250_NODMP__
         mpu->SetupAHRS(0.01, 0.9, 0.01);
     #endif
 
 #endif
 
-    //  Schedule periodic telemetry sending every 1s
-    ts->SyncTaskPer(PLAT_UID, PLAT_T_TEL, -1000, 1000, T_PERIODIC);
+    //  Schedule periodic telemetry sending every 1s, control loops go first
+    batch.Add(PLAT_UID, PLAT_T_TEL, -1000, 1000, T_PERIODIC, T_PRIO_LOW);
+    //  Telemetry only reports latest state, missed periods can be skipped
+    ts->SetSheddable(PLAT_UID, PLAT_T_TEL);
+    //  Same for snapshot of metrics, counters carry on in the next one
+    batch.Add(PLAT_UID, PLAT_T_METRICS_DUMP, -PLAT_METRICS_MS, PLAT_METRICS_MS,
+              T_PERIODIC, T_PRIO_LOW);
+    ts->SetSheddable(PLAT_UID, PLAT_T_METRICS_DUMP);
     //  Startup speed loop for the engines
-    ts->SyncTaskPer(ENGINES_UID, ENG_T_SPEEDLOOP, -150, 150, T_PERIODIC);
+    batch.Add(ENGINES_UID, ENG_T_SPEEDLOOP, -150, 150, T_PERIODIC, T_PRIO_HIGH);
+#ifdef __HAL_USE_STORAGE__
+    //  Write staged events and metrics into storage in small pieces, behind
+    //  everything else; stage absorbs periods skipped under overload
+    batch.Add(STORE_UID, STORE_T_FLUSH, -STORE_FLUSH_MS, STORE_FLUSH_MS,
+              T_PERIODIC, T_PRIO_LOW);
+    ts->SetSheddable(STORE_UID, STORE_T_FLUSH);
+#endif  /* __HAL_USE_STORAGE__ */
 
 #ifdef __HAL_USE_EVENTLOG__
-    EMIT_EV(-1, EVENT_OK);
+    if (ts->SyncBatch(batch))
+        EMIT_EV(-1, EVENT_OK);
+    else
+        EMIT_EV(-1, EVENT_ERROR);
+#else
+    ts->SyncBatch(batch);
 #endif  /* __HAL_USE_EVENTLOG__ */
 
 }
@@ -18,6 +18,8 @@
 #include "radar/radarGP2.h"
 #include "mpu9250/mpu9250.h"
 #include "taskScheduler/taskScheduler.h"
+#include "storage/eventStore.h"
+#include "init/metrics.h"
 
 #include "network/dataStream.h"
 
@@ -40,7 +42,8 @@
 /*
  * Commands data stream
  * This stream brings commands from server to rover. On received frame from
- * server rover replies "ACK\r\n"
+ * server rover replies "ACK\r\n". Frame can carry a batch of tasks (see
+ * Platform::Execute), which are then acknowledged with a single ACK
  * Server expects commands stream on TCP port 2701
  */
 #define P_COMMANDS      2701
@@ -60,13 +63,52 @@
     #define PLAT_T_SOFT_REBOOT    3   //  Perform soft reboot, only reset states
     #define PLAT_T_TS_DUMP        4   //  Report task scheduler data
     #define PLAT_T_ENG_DUMP       5   //  Report telemetry from engines
+    #define PLAT_T_TRACE_DUMP     6   //  Report content of kernel trace buffer
+    #define PLAT_T_METRICS_DUMP   7   //  Report snapshot of metrics registry
+    //  Metrics of this module (see init/metrics.h)
+    #define PLAT_M_HEAP           0   //  Bytes in use on the heap (if known)
+
+/*
+ * Frame with a batch of events in binary records (see eventLog.h), all numbers
+ * little-endian:
+ *  "2*:B:"     ASCII start sequence
+ *  len(2B)     number of bytes following this field
+ *  seq(4B)     sequence number of the first event in batch, server confirms
+ *              receiving the batch with EVLOG_ACK(seq + num)
+ *  num(2B)     number of events in batch
+ *  left(2B)    number of events in log after this batch
+ *  records     num event records
+ */
+//  Frames are sent by ESP send service (DataStream::Post()) as arguments of its
+//  task, so they can't be longer than a task can carry
+#define PLAT_EVB_SIZE       DATAS_POST_MAX
+#define PLAT_EVB_HEADER     15
+
+/*
+ * Frame with a snapshot of metrics registry in binary records (see
+ * init/metrics.h), all numbers little-endian:
+ *  "6*:M:"     ASCII start sequence
+ *  len(2B)     number of bytes following this field
+ *  ms(4B)      time of the snapshot (ms since startup)
+ *  first(2B)   index of the first metric in frame; snapshot that doesn't fit
+ *              into one frame is sent in several, all with the same time
+ *  num(2B)     number of metrics in frame
+ *  records     num metric records
+ */
+#define PLAT_MET_HEADER     15
+//  Period (in ms) of sending snapshot of metrics
+#define PLAT_METRICS_MS     5000
+
+//  Numbers describing a task in incoming command:
+//  libUID:serviceID:timestamp:period:repeats:argLen
+#define PLAT_TASK_FIELDS    6
 
 //  ID of this device when exchanging messages
 const char DEVICE_ID[] = {"ROVER1"};
 
 class Platform
 {
-    friend void _PLAT_KernelCallback(void);
+    friend class KernelContext;
     public:
         static Platform& GetI();
         static Platform* GetP();
@@ -91,16 +133,37 @@ class Platform
 #endif
 #ifdef __HAL_USE_RADAR__
         RadarModule *rad;
+#endif
+#ifdef __HAL_USE_STORAGE__
+        EventStore *store;
 #endif
     protected:
         Platform();
         ~Platform();
 
         void    _PostInit();
+        bool    _ParseTask(const uint8_t* buf, const uint16_t len,
+                           uint16_t &it, int32_t *task);
+
+        //  Services provided to task scheduler, indexed by PLAT_T_* IDs
+        static const _tsService _services[];
+        uint32_t    _SendTelemetry();
+        uint32_t    _Reboot(uint8_t rebootCode);
+        uint32_t    _EvlogDump();
+        uint32_t    _SoftReboot(uint8_t rebootCode);
+        uint32_t    _TSDump();
+        uint32_t    _EngDump();
+        uint32_t    _TraceDump();
+        uint32_t    _MetricsDump();
+
+        //  Heap in use, sampled when snapshot of metrics is taken
+        MetricGauge _heapUsed;
 
-        //  Interface with task scheduler - provides memory space and function
-        //  to call in order for task scheduler to request service from this module
-        _kernelEntry _ker;
+#ifdef __HAL_USE_ESP8266__
+        //  Binary frame being sent (batch of events, snapshot of metrics),
+        //  kept here since it's too big to be put on the stack
+        uint8_t     _evFrame[PLAT_EVB_SIZE];
+#endif
 };
 
 
@@ -23,6 +23,8 @@
 
 #include "MahonyAHRS.h"
 #include <math.h>
+#include <stdint.h>
+#include <string.h>
 
 #if defined(__HAL_USE_MPU9250_NODMP__)
 //-------------------------------------------------------------------------------------------
@@ -259,9 +261,11 @@ float Mahony::_InvSqrt(float x)
 {
 	float halfx = 0.5f * x;
 	float y = x;
-	long i = *(long*)&y;
+	//  Bits of float taken as 32-bit integer (long is 64-bit on some hosts)
+	int32_t i;
+	memcpy(&i, &y, sizeof(i));
 	i = 0x5f3759df - (i>>1);
-	y = *(float*)&i;
+	memcpy(&y, &i, sizeof(y));
 	y = y * (1.5f - (halfx * y * y));
 	y = y * (1.5f - (halfx * y * y));
 	return y;
@@ -226,40 +226,47 @@ float getAres()
 /**
  * Read raw accelerometer data into a provided buffer
  * @param destination Buffer to save x, y, z acceleration data (min. size = 3)
+ * @return 0 on success, error returned by HAL otherwise
  */
-void readAccelData(int16_t * destination)
+uint8_t readAccelData(int16_t * destination)
 {
   uint8_t rawData[6];  // x/y/z accel register data stored here
   // Read the six raw data registers into data array
-  HAL_MPU_ReadBytes(MPU9250_ADDRESS, ACCEL_XOUT_H, 6, &rawData[0]);
+  uint8_t err = HAL_MPU_ReadBytes(MPU9250_ADDRESS, ACCEL_XOUT_H, 6, &rawData[0]);
 
   // Turn the MSB and LSB into a signed 16-bit value
   destination[0] = ((int16_t)rawData[0] << 8) | rawData[1] ;
   destination[1] = ((int16_t)rawData[2] << 8) | rawData[3] ;
   destination[2] = ((int16_t)rawData[4] << 8) | rawData[5] ;
+
+  return err;
 }
 
 /**
  * Read raw gyroscope data into a provided buffer
  * @param destination Buffer to save x, y, z gyroscope data (min. size = 3)
+ * @return 0 on success, error returned by HAL otherwise
  */
-void readGyroData(int16_t * destination)
+uint8_t readGyroData(int16_t * destination)
 {
   uint8_t rawData[6];  // x/y/z gyro register data stored here
   // Read the six raw data registers sequentially into data array
-  HAL_MPU_ReadBytes(MPU9250_ADDRESS, GYRO_XOUT_H, 6, &rawData[0]);
+  uint8_t err = HAL_MPU_ReadBytes(MPU9250_ADDRESS, GYRO_XOUT_H, 6, &rawData[0]);
 
   // Turn the MSB and LSB into a signed 16-bit value
   destination[0] = ((int16_t)rawData[0] << 8) | rawData[1] ;
   destination[1] = ((int16_t)rawData[2] << 8) | rawData[3] ;
   destination[2] = ((int16_t)rawData[4] << 8) | rawData[5] ;
+
+  return err;
 }
 
 /**
  * Read raw magnetometer data into a provided buffer
  * @param destination Buffer to save x, y, z magnetometer data (min. size = 3)
+ * @return 0 on success, error returned by HAL otherwise
  */
-void readMagData(int16_t * destination)
+uint8_t readMagData(int16_t * destination)
 {
     // x,y,z gyro register data, ST2 register stored here, must read ST2 at end
     // of data acquisition
@@ -282,7 +289,7 @@ void readMagData(int16_t * destination)
     // Read 7 bytes from I2C slave 0
     HAL_MPU_WriteByte(MPU9250_ADDRESS,  I2C_SLV0_CTRL, 0x87);
     // Move 7 registers from MPU reg to here
-    HAL_MPU_ReadBytes(MPU9250_ADDRESS, EXT_SENS_DATA_00, 7, rawData);
+    uint8_t err = HAL_MPU_ReadBytes(MPU9250_ADDRESS, EXT_SENS_DATA_00, 7, rawData);
 
 
     uint8_t c = 0 & rawData[6]; // End data read by reading ST2 register
@@ -295,6 +302,8 @@ void readMagData(int16_t * destination)
       destination[1] = ((int16_t)rawData[3] << 8) | rawData[2];
       destination[2] = ((int16_t)rawData[5] << 8) | rawData[4];
     }
+
+    return err;
 }
 
 /**
@@ -378,6 +387,18 @@ void calibrateMPU9250(float * gyroBias, float * accelBias)
     // How many sets of full gyro and accelerometer data for averaging
     packet_count = fifo_count/12;
 
+    // Without any samples there are no biases to calculate, leave bias
+    // registers as they are
+    if (packet_count == 0)
+    {
+        for (ii = 0; ii < 3; ii++)
+        {
+            gyroBias[ii] = 0;
+            accelBias[ii] = 0;
+        }
+        return;
+    }
+
     for (ii = 0; ii < packet_count; ii++)
     {
         int16_t accel_temp[3] = {0, 0, 0}, gyro_temp[3] = {0, 0, 0};
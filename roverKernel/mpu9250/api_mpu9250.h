@@ -15,10 +15,14 @@
  *      Changes to original project were made in order to support SPI interface
  *      instead of commonly used I2C.
  *
- *  @version 1.0.0
+ *  @version 1.1.0
  *  V1.0.0
  *  +Creation of file. Tested reading functions for gyro/mag/accel and
  *  initialization. API tested with both SPI & I2C.
+ *  V1.0.1 - 17.10.2026
+ *  +Calibration doesn't divide by zero when FIFO holds no samples
+ *  V1.1.0 - 17.10.2026
+ *  +Functions reading sensor data return status of reading from the bus
  */
 #include "hwconfig.h"
 
@@ -39,9 +43,9 @@ extern "C"
     float   getGres();
     float   getAres();
 
-    void    readAccelData(int16_t *);
-    void    readGyroData(int16_t *);
-    void    readMagData(int16_t *);
+    uint8_t readAccelData(int16_t *);
+    uint8_t readGyroData(int16_t *);
+    uint8_t readMagData(int16_t *);
     int16_t readTempData();
 
 
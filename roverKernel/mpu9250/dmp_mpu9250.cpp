@@ -5,6 +5,7 @@
  *      Author: Vedran
  */
 #include "mpu9250.h"
+#include "init/kernelContext.h"
 
 #if defined(__HAL_USE_MPU9250_DMP__)       //  Compile only if module is enabled
 
@@ -134,62 +135,59 @@ static inline unsigned short inv_orientation_matrix_to_scalar(
 ///         DMP related functions --  End
 ///-----------------------------------------------------------------------------
 
+/*******************************************************************************
+ *******************************************************************************
+ *********              MPU9250 class member functions                 *********
+ *******************************************************************************
+ ******************************************************************************/
+
 #if defined(__USE_TASK_SCHEDULER__)
+///-----------------------------------------------------------------------------
+///                      Services provided to task scheduler         [PROTECTED]
+///-----------------------------------------------------------------------------
 
 /**
- * Callback routine to invoke service offered by this module from task scheduler
- * @note It is assumed that once this function is called task scheduler has
- * already copied required variables into the memory space provided for it.
+ * Services offered by MPU, in the order of MPU_T_* IDs. AHRS configuration is
+ * only available without DMP
  */
-void _MPU_KernelCallback(void)
+const _tsService MPU9250::_services[] =
 {
-    MPU9250 &__mpu = MPU9250::GetI();
-
-    static float sumOfRot = 0;
-
+    //  MPU_T_POWERSW: power state
+    TS_SERVICE1(MPU9250, uint32_t, _PowerSwitch, bool),
+    //  MPU_T_GET_DATA: reading the sensor over I2C and updating orientation
+    TS_SERVICE0_BUDGET(MPU9250, uint32_t, _GetData, 2000),
+    //  MPU_T_REBOOT
+    TS_SERVICE1(MPU9250, uint32_t, _Reboot, uint8_t),
+    //  MPU_T_SOFT_REBOOT
+    TS_SERVICE1(MPU9250, uint32_t, _SoftReboot, uint8_t)
+};
 
-    //  Check for null-pointer
-    if (__mpu._ker.args == 0)
-        return;
+/**
+ * Change state of the power switch. Allows for powering down MPU chip
+ * @param powerState true to power the sensor on, false to power it off
+ * @return one of MPU_* error codes
+ */
+uint32_t MPU9250::_PowerSwitch(bool powerState)
+{
+    HAL_MPU_PowerSwitch(powerState);
 
-    /*
-     *  Data in args[] contains bytes that constitute arguments for function
-     *  calls. The exact representation(i.e. whether bytes represent ints, floats)
-     *  of data is known only to individual blocks of switch() function. There
-     *  is no predefined data separator between arguments inside args[].
-     */
-    switch (__mpu._ker.serviceID)
+    //  If sensor is powering on reset I2C and load DMP firmware
+    if (powerState)
     {
-    /*
-     * Change state of the power switch. Allows for powering down MPU chip
-     * args[] = powerState(bool)
-     * retVal one of MPU_* error codes
-     */
-    case MPU_T_POWERSW:
-        {
-            //  Double negation to convert any non-zero int to bool
-            bool powerState = !(!(__mpu._ker.args[0]));
-
-            HAL_MPU_PowerSwitch(powerState);
+        InitHW();
+        InitSW();
+    }
 
-            //  If sensor is powering on reset I2C and load DMP firmware
-            if (powerState)
-            {
-                __mpu.InitHW();
-                __mpu.InitSW();
-            }
-            __mpu._ker.retVal = MPU_SUCCESS;
-        }
-        break;
+    return MPU_SUCCESS;
+}
 
-    /*
-     *  Once new data is available, read it from FIFO and store in data structure
-     *  args[] = none
-     *  retVal one of MPU_* error codes
-     */
-    case MPU_T_GET_DATA:
-        {
-            static bool suppressError = false;
+/**
+ * Once new data is available, read it from FIFO and store in data structure
+ * @return one of MPU_* error codes
+ */
+uint32_t MPU9250::_GetData()
+{
+    uint32_t status = MPU_SUCCESS;
 
 //#ifdef __DEBUG_SESSION__
 //    DEBUG_WRITE("In ISR\n");
@@ -199,176 +197,156 @@ void _MPU_KernelCallback(void)
 //#endif
 //    return;
 
-            if (__mpu.IsDataReady())
+    if (IsDataReady())
+    {
+        int8_t retVal;
+        short gyro[3], accel[3], sensors;
+        unsigned char more = 1;
+        long quat[4];
+        unsigned long sensor_timestamp;
+
+    #ifdef __USE_TASK_SCHEDULER__
+        //  Calculate dT in seconds!
+        dT = (float)(msSinceStartup-_lastMS)/1000.0f;
+        _lastMS = msSinceStartup;
+    #endif /* __HAL_USE_TASKSCH__ */
+
+        /* This function gets new data from the FIFO when the DMP is in
+         * use. The FIFO can contain any combination of gyro, accel,
+         * quaternion, and gesture data. The sensors parameter tells the
+         * caller which data fields were actually populated with new data.
+         * For example, if sensors == (INV_XYZ_GYRO | INV_WXYZ_QUAT), then
+         * the FIFO isn't being filled with accel data.
+         * The driver parses the gesture data to determine if a gesture
+         * event has occurred; on an event, the application will be notified
+         * via a callback (assuming that a callback function was properly
+         * registered). The more parameter is non-zero if there are
+         * leftover packets in the FIFO.
+         */
+        int cnt = 0;
+        //  Make sure the fifo is empty before leaving this loop, in
+        //  order to prevent fifo overflow on consecutive sensor reading
+        while (cnt < 100)   //Read max 100 packets, if there's more we
+                            //   have a problem
+        {
+            retVal = dmp_read_fifo(gyro, accel, quat, &sensor_timestamp, &sensors, &more);
+            cnt++;
+
+            if (retVal == (-2))
+                DEBUG_WRITE("READ_FIFO returned: %d \n", retVal);
+
+            if (sensors == 0)   //No data available
+                break;
+
+            //  If reading fifo returned error, move to next packet
+            if (retVal)
             {
-                int8_t retVal;
-                short gyro[3], accel[3], sensors;
-                unsigned char more = 1;
-                long quat[4];
-                unsigned long sensor_timestamp;
-
-            #ifdef __USE_TASK_SCHEDULER__
-                //  Calculate dT in seconds!
-                static uint64_t oldms = 0;
-                __mpu.dT = (float)(msSinceStartup-oldms)/1000.0f;
-                oldms = msSinceStartup;
-            #endif /* __HAL_USE_TASKSCH__ */
-
-                /* This function gets new data from the FIFO when the DMP is in
-                 * use. The FIFO can contain any combination of gyro, accel,
-                 * quaternion, and gesture data. The sensors parameter tells the
-                 * caller which data fields were actually populated with new data.
-                 * For example, if sensors == (INV_XYZ_GYRO | INV_WXYZ_QUAT), then
-                 * the FIFO isn't being filled with accel data.
-                 * The driver parses the gesture data to determine if a gesture
-                 * event has occurred; on an event, the application will be notified
-                 * via a callback (assuming that a callback function was properly
-                 * registered). The more parameter is non-zero if there are
-                 * leftover packets in the FIFO.
-                 */
-                int cnt = 0;
-                //  Make sure the fifo is empty before leaving this loop, in
-                //  order to prevent fifo overflow on consecutive sensor reading
-                while (cnt < 100)   //Read max 100 packets, if there's more we
-                                    //   have a problem
-                {
-                    retVal = dmp_read_fifo(gyro, accel, quat, &sensor_timestamp, &sensors, &more);
-                    cnt++;
-
-                    if (retVal == (-2))
-                        DEBUG_WRITE("READ_FIFO returned: %d \n", retVal);
-
-                    if (sensors == 0)   //No data available
-                    {
-                        __mpu._ker.retVal = MPU_SUCCESS;
-                        break;
-                    }
-
-                    //  If reading fifo returned error, move to next packet
-                    if (retVal)
-                        continue;
-
-                    //  If there was no error, extract orientation data
-                    Quaternion qt;
-                    qt.x = (float)quat[0]/QUAT_SENS;
-                    qt.y = (float)quat[1]/QUAT_SENS;
-                    qt.z = (float)quat[2]/QUAT_SENS;
-                    qt.w = (float)quat[3]/QUAT_SENS;
-
-                    VectorFloat v;
-                    dmp_GetGravity(&v, &qt);
-
-                    dmp_GetYawPitchRoll((float*)(__mpu._ypr), &qt, &v);
-
-                    __mpu._quat[0] = qt.x;
-                    __mpu._quat[1] = qt.y;
-                    __mpu._quat[2] = qt.z;
-                    __mpu._quat[3] = qt.w;
-
-                    //  Copy to MPU class
-                    __mpu._gv[0] = v.x;
-                    __mpu._gv[1] = v.y;
-                    __mpu._gv[2] = v.z;
-
-                    __mpu._acc[0] = (float)accel[0]/32767.0;
-                    __mpu._acc[1] = (float)accel[1]/32767.0;
-                    __mpu._acc[2] = (float)accel[2]/32767.0;
-                }
-
-                //  If there was only one packet in FIFO, and it caused error,
-                //  then emit hang
-                if ((retVal != 0) && (cnt == 1) && (sensors != 0))
-                {
-                    //  Use emitting event to also report error code through
-                    //  taskID parameter
-            #ifdef __HAL_USE_EVENTLOG__
-                    EMIT_EV(retVal, EVENT_HANG);
-            #endif  /* __HAL_USE_EVENTLOG__ */
-                    return;
-                }
-
-                //  Do data health-check -> too big change in angle(30° cumulative)
-                //  between consecutive readings points to error
-                if ((fabs(sumOfRot - fabs(__mpu._ypr[0]) - fabs(__mpu._ypr[1]) -
-                          fabs(__mpu._ypr[2])) > 0.5) && (sumOfRot != 0.0))
-                {
-                    //  Emit error event to the system if consecutive sensor
-                    //   readings are too far off and suppress
-                    if (!suppressError)
-                    {
-#ifdef __HAL_USE_EVENTLOG__
-                    EMIT_EV(MPU_T_GET_DATA, EVENT_ERROR);
-#endif  /* __HAL_USE_EVENTLOG__ */
-                    __mpu._ker.retVal = MPU_ERROR;
-                    }
-                }
-                else
-                {
-                    __mpu._ker.retVal = MPU_SUCCESS;
-                }
-
-                //  Update sum of rotations for next function call
-                sumOfRot = fabs(__mpu._ypr[0]) + fabs(__mpu._ypr[1]) + fabs(__mpu._ypr[2]);
-                suppressError = false;
+                _readErrors.Add();
+                continue;
             }
-            else
-                //  When not listening to sensor readings for a while, it is
-                //  possible to have a big change in readings when starting to
-                //  listen again, in that case first error message is suppressed
-                suppressError = true;
 
+            //  If there was no error, extract orientation data
+            Quaternion qt;
+            qt.x = (float)quat[0]/QUAT_SENS;
+            qt.y = (float)quat[1]/QUAT_SENS;
+            qt.z = (float)quat[2]/QUAT_SENS;
+            qt.w = (float)quat[3]/QUAT_SENS;
+
+            VectorFloat v;
+            dmp_GetGravity(&v, &qt);
+
+            dmp_GetYawPitchRoll((float*)(_ypr), &qt, &v);
+
+            _quat[0] = qt.x;
+            _quat[1] = qt.y;
+            _quat[2] = qt.z;
+            _quat[3] = qt.w;
+
+            //  Copy to MPU class
+            _gv[0] = v.x;
+            _gv[1] = v.y;
+            _gv[2] = v.z;
+
+            _acc[0] = (float)accel[0]/32767.0;
+            _acc[1] = (float)accel[1]/32767.0;
+            _acc[2] = (float)accel[2]/32767.0;
         }
-        break;
-        /*
-         * Restart MPU module and reload DMP firmware
-         * args[] = rebootCode(0x17)
-         * retVal one of MPU_* error codes
-         */
-    case MPU_T_REBOOT:
+
+        //  If there was only one packet in FIFO, and it caused error,
+        //  then emit hang
+        if ((retVal != 0) && (cnt == 1) && (sensors != 0))
         {
-            if (__mpu._ker.args[0] == 0x17)
-            {
-                sumOfRot = 0.0; //Prevents error for big change in value after reboot
-                __mpu.Reset();
-                __mpu.InitHW();
-                __mpu._ker.retVal = (int32_t)__mpu.InitSW();
-            }
+            //  Use emitting event to also report error code through
+            //  taskID parameter
+    #ifdef __HAL_USE_EVENTLOG__
+            EMIT_EV(retVal, EVENT_HANG);
+    #endif  /* __HAL_USE_EVENTLOG__ */
+            return STATUS_NO_EVENT;
         }
-        break;
-        /*
-         * Soft reboot of MPU -> only reset status in event logger
-         * args[] = rebootCode(0x17)
-         * retVal one of MPU_* error codes
-         */
-    case MPU_T_SOFT_REBOOT:
+
+        //  Do data health-check -> too big change in angle(30° cumulative)
+        //  between consecutive readings points to error
+        if ((fabs(_sumOfRot - fabs(_ypr[0]) - fabs(_ypr[1]) -
+                  fabs(_ypr[2])) > 0.5) && (_sumOfRot != 0.0))
         {
-            if (__mpu._ker.args[0] == 0x17)
+            //  Emit error event to the system if consecutive sensor
+            //   readings are too far off and suppress
+            if (!_suppressError)
             {
 #ifdef __HAL_USE_EVENTLOG__
-                EventLog::SoftReboot(MPU_UID);
+            EMIT_EV(MPU_T_GET_DATA, EVENT_ERROR);
 #endif  /* __HAL_USE_EVENTLOG__ */
+            status = MPU_ERROR;
             }
         }
-        break;
-    default:
-        break;
+
+        //  Update sum of rotations for next function call
+        _sumOfRot = fabs(_ypr[0]) + fabs(_ypr[1]) + fabs(_ypr[2]);
+        _suppressError = false;
     }
+    else
+        //  When not listening to sensor readings for a while, it is
+        //  possible to have a big change in readings when starting to
+        //  listen again, in that case first error message is suppressed
+        _suppressError = true;
+
+    return status;
+}
+
+/**
+ * Restart MPU module and reload DMP firmware
+ * @param rebootCode has to be 0x17 for reboot to take place
+ * @return one of MPU_* error codes
+ */
+uint32_t MPU9250::_Reboot(uint8_t rebootCode)
+{
+    if (rebootCode != 0x17)
+        return MPU_ERROR;
+
+    _sumOfRot = 0.0; //Prevents error for big change in value after reboot
+    Reset();
+    InitHW();
+
+    return (uint32_t)InitSW();
+}
+
+/**
+ * Soft reboot of MPU -> only reset status in event logger
+ * @param rebootCode has to be 0x17 for reboot to take place
+ * @return one of MPU_* error codes
+ */
+uint32_t MPU9250::_SoftReboot(uint8_t rebootCode)
+{
+    if (rebootCode != 0x17)
+        return MPU_ERROR;
 
-    //  Report outcome to event logger
 #ifdef __HAL_USE_EVENTLOG__
-    if (__mpu._ker.retVal == MPU_SUCCESS)
-        EMIT_EV(__mpu._ker.serviceID, EVENT_OK);
-    else
-        EMIT_EV(__mpu._ker.serviceID, EVENT_ERROR);
+    EventLog::SoftReboot(MPU_UID);
 #endif  /* __HAL_USE_EVENTLOG__ */
-}
-#endif
 
-/*******************************************************************************
- *******************************************************************************
- *********              MPU9250 class member functions                 *********
- *******************************************************************************
- ******************************************************************************/
+    return MPU_SUCCESS;
+}
+#endif  /* __USE_TASK_SCHEDULER__ */
 
 ///-----------------------------------------------------------------------------
 ///         Functions for returning static instance                     [PUBLIC]
@@ -376,12 +354,11 @@ void _MPU_KernelCallback(void)
 
 /**
  * Return reference to a singleton
- * @return reference to an internal static instance
+ * @return reference to the instance owned by current kernel context
  */
 MPU9250& MPU9250::GetI()
 {
-    static MPU9250 singletonInstance;
-    return singletonInstance;
+    return *(KernelContext::Current().mpu);
 }
 
 /**
@@ -417,8 +394,9 @@ int8_t MPU9250::InitHW()
 
 #if defined(__USE_TASK_SCHEDULER__)
     //  Register module services with task scheduler
-    _ker.callBackFunc = _MPU_KernelCallback;
-    TS_RegCallback(&_ker, MPU_UID);
+    TS_RegServices(MPU_UID, TS_SERVICES(_services));
+    //  Register metrics of the module
+    MetricsRegistry::GetI().Register(_readErrors, MPU_UID, MPU_M_READ_ERR);
 #endif
 
     return MPU_SUCCESS;
@@ -614,7 +592,10 @@ int8_t MPU9250::ReadSensorData()
 
          //  If reading fifo returned error, move to next packet
          if (retVal)
+         {
+             _readErrors.Add();
              continue;
+         }
 
          //  If there was no error, extract orientation data
          Quaternion qt;
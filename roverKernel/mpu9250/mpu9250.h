@@ -4,7 +4,7 @@
  *  Created on: 25. 3. 2015.
  *      Author: Vedran Mikov
  *
- *  @version V3.1.0
+ *  @version V3.4.0
  *  V1.0 - 25.3.2016
  *  +MPU9250 library now implemented as a C++ object
  *  V1.1 - 25.6.2016
@@ -40,6 +40,14 @@
  *  V3.1.1 - 9.1.2018
  *  +Created interface to read acceleration/gyro/mag data
  *  +Added Mahony algorithm for attitude estimation from sensor data
+ *  V3.2.0 - 17.10.2026
+ *  +Kernel callback replaced with a table of services (tsService.h)
+ *  V3.3.0 - 17.10.2026
+ *  +Instance is owned by kernel context (init/kernelContext.h), state of data
+ *  reading task is kept in the object. State of DMP in eMPL library is still
+ *  shared by all instances
+ *  V3.4.0 - 17.10.2026
+ *  +Counts failed readings of sensor data (init/metrics.h)
  */
 #include "hwconfig.h"
 
@@ -64,8 +72,12 @@
     #define MPU_T_REBOOT          2
     #define MPU_T_SOFT_REBOOT     3
     #define MPU_T_AHRS_CONFIG     4
+    //  Metrics of this module (see init/metrics.h)
+    #define MPU_M_READ_ERR        0   //  Failed readings of sensor data
 #endif
 
+#include "init/metrics.h"
+
 //  Custom error codes for the library
 #define MPU_SUCCESS             0
 #define MPU_ERROR               2
@@ -81,8 +93,8 @@
  */
 class MPU9250
 {
-    friend void _MPU_KernelCallback(void);
     friend void MPUDataHandler(void);
+    friend class KernelContext;
     public:
         static MPU9250& GetI();
         static MPU9250* GetP();
@@ -106,8 +118,8 @@ class MPU9250
     protected:
         MPU9250();
         ~MPU9250();
-        MPU9250(MPU9250 &arg) {}              //  No definition - forbid this
-        void operator=(MPU9250 const &arg) {} //  No definition - forbid this
+        MPU9250(MPU9250 &) {}                 //  No definition - forbid this
+        void operator=(MPU9250 const &) {}    //  No definition - forbid this
 
         //  Yaw-Pitch-Roll orientation[Y,P,R] in radians
         volatile float _ypr[3];
@@ -119,6 +131,8 @@ class MPU9250
         volatile float _mag[3];
         //  Magnetometer control
         bool _magEn;
+        //  Number of failed readings (bus error, or corrupted FIFO packet)
+        MetricCounter _readErrors;
 
 #if defined(__HAL_USE_MPU9250_NODMP__)
     private:
@@ -132,10 +146,26 @@ class MPU9250
         volatile float _quat[4];
 #endif
 
-        //  Interface with task scheduler - provides memory space and function
-        //  to call in order for task scheduler to request service from this module
+        //  Services provided to task scheduler, indexed by MPU_T_* IDs
 #if defined(__USE_TASK_SCHEDULER__)
-        _kernelEntry _ker;
+    protected:
+        static const _tsService _services[];
+        uint32_t _PowerSwitch(bool powerState);
+        uint32_t _GetData();
+        uint32_t _Reboot(uint8_t rebootCode);
+        uint32_t _SoftReboot(uint8_t rebootCode);
+        //  Sum of absolute rotation around all axes at the last sensor reading,
+        //  used to detect sudden jumps in orientation
+        float _sumOfRot;
+        //  Time stamp (in ms) of the last sensor reading
+        uint64_t _lastMS;
+    #if !defined(__HAL_USE_MPU9250_NODMP__)
+        //  Jump in orientation has already been reported
+        bool _suppressError;
+    #endif
+    #if defined(__HAL_USE_MPU9250_NODMP__)
+        uint32_t _ConfigAHRS(float kp, float ki, bool magEn);
+    #endif
 #endif
 };
 
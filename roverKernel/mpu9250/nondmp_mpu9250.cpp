@@ -5,6 +5,7 @@
  *      Author: Vedran
  */
 #include "mpu9250.h"
+#include "init/kernelContext.h"
 
 #if defined(__HAL_USE_MPU9250_NODMP__)  //  Compile only if module is enabled
 
@@ -34,156 +35,133 @@
 
 
 #if defined(__USE_TASK_SCHEDULER__)
+///-----------------------------------------------------------------------------
+///                      Services provided to task scheduler         [PROTECTED]
+///-----------------------------------------------------------------------------
 
 /**
- * Callback routine to invoke service offered by this module from task scheduler
- * @note It is assumed that once this function is called task scheduler has
- * already copied required variables into the memory space provided for it.
+ * Services offered by MPU, in the order of MPU_T_* IDs
  */
-void _MPU_KernelCallback(void)
+const _tsService MPU9250::_services[] =
 {
-    MPU9250 &__mpu = MPU9250::GetI();
-
-    static float sumOfRot = 0;
-
+    //  MPU_T_POWERSW: power state
+    TS_SERVICE1(MPU9250, uint32_t, _PowerSwitch, bool),
+    //  MPU_T_GET_DATA: reading the sensor over I2C and updating orientation
+    TS_SERVICE0_BUDGET(MPU9250, uint32_t, _GetData, 2000),
+    //  MPU_T_REBOOT
+    TS_SERVICE1(MPU9250, uint32_t, _Reboot, uint8_t),
+    //  MPU_T_SOFT_REBOOT
+    TS_SERVICE1(MPU9250, uint32_t, _SoftReboot, uint8_t),
+    //  MPU_T_AHRS_CONFIG: kp, ki, magnetometer enabled
+    TS_SERVICE3(MPU9250, uint32_t, _ConfigAHRS, float, float, bool)
+};
 
-    //  Check for null-pointer
-    if (__mpu._ker.args == 0)
-        return;
+/**
+ * Change state of the power switch. Allows for powering down MPU chip
+ * @param powerState true to power the sensor on, false to power it off
+ * @return one of MPU_* error codes
+ */
+uint32_t MPU9250::_PowerSwitch(bool powerState)
+{
+    HAL_MPU_PowerSwitch(powerState);
 
-    /*
-     *  Data in args[] contains bytes that constitute arguments for function
-     *  calls. The exact representation(i.e. whether bytes represent ints, floats)
-     *  of data is known only to individual blocks of switch() function. There
-     *  is no predefined data separator between arguments inside args[].
-     */
-    switch (__mpu._ker.serviceID)
+    //  If sensor is powering on reset I2C and load DMP firmware
+    if (powerState)
     {
-    /*
-     * Change state of the power switch. Allows for powering down MPU chip
-     * args[] = powerState(bool)
-     * retVal one of MPU_* error codes
-     */
-    case MPU_T_POWERSW:
-        {
-            //  Double negation to convert any non-zero int to bool
-            bool powerState = !(!(__mpu._ker.args[0]));
+        InitHW();
+     //   InitSW();
+    }
 
-            HAL_MPU_PowerSwitch(powerState);
+    return MPU_SUCCESS;
+}
 
-            //  If sensor is powering on reset I2C and load DMP firmware
-            if (powerState)
-            {
-                __mpu.InitHW();
-             //   __mpu.InitSW();
-            }
-            __mpu._ker.retVal = MPU_SUCCESS;
-        }
-        break;
-
-    /*
-     *  Once new data is available, read it from FIFO and store in data structure
-     *  args[] = none
-     *  retVal one of MPU_* error codes
-     */
-    case MPU_T_GET_DATA:
-        {
-            if (/*HAL_MPU_DataAvail()*/true)
-            {
-            #ifdef __USE_TASK_SCHEDULER__
-                //  Calculate dT in seconds!
-                static uint64_t oldms = 0;
-                __mpu.dT = (float)(msSinceStartup-oldms)/1000.0f;
-                oldms = msSinceStartup;
-            #endif /* __HAL_USE_TASKSCH__ */
+/**
+ * Read new sensor data and update orientation
+ * @return one of MPU_* error codes
+ */
+uint32_t MPU9250::_GetData()
+{
+    if (/*HAL_MPU_DataAvail()*/true)
+    {
+    #ifdef __USE_TASK_SCHEDULER__
+        //  Calculate dT in seconds!
+        dT = (float)(msSinceStartup-_lastMS)/1000.0f;
+        _lastMS = msSinceStartup;
+    #endif /* __HAL_USE_TASKSCH__ */
 
-                __mpu.ReadSensorData();
+        ReadSensorData();
 
 #ifdef __DEBUG_SESSION__
-                DEBUG_WRITE("{%02d.%03d, %02d.%03d, %02d.%03d, ", _FTOI_(__mpu._gyro[0]), _FTOI_(__mpu._gyro[1]), _FTOI_(__mpu._gyro[2]));
-                DEBUG_WRITE("%02d.%03d, %02d.%03d, %02d.%03d, ", _FTOI_(__mpu._acc[0]), _FTOI_(__mpu._acc[1]), _FTOI_(__mpu._acc[2]));
-                DEBUG_WRITE("%02d.%03d, %02d.%03d, %02d.%03d},\n", _FTOI_(__mpu._mag[0]), _FTOI_(__mpu._mag[1]), _FTOI_(__mpu._mag[2]));
+        DEBUG_WRITE("{%02d.%03d, %02d.%03d, %02d.%03d, ", _FTOI_(_gyro[0]), _FTOI_(_gyro[1]), _FTOI_(_gyro[2]));
+        DEBUG_WRITE("%02d.%03d, %02d.%03d, %02d.%03d, ", _FTOI_(_acc[0]), _FTOI_(_acc[1]), _FTOI_(_acc[2]));
+        DEBUG_WRITE("%02d.%03d, %02d.%03d, %02d.%03d},\n", _FTOI_(_mag[0]), _FTOI_(_mag[1]), _FTOI_(_mag[2]));
 #endif  /* __DEBUG_SESSION__ */
-                if ((sumOfRot - (fabs(__mpu._ypr[0])+fabs(__mpu._ypr[1])+fabs(__mpu._ypr[2]))) > 30.0f)
-                {
-                    if (sumOfRot)
-                    {
-                #ifdef __HAL_USE_EVENTLOG__
-                    EMIT_EV(__mpu._ker.serviceID, EVENT_HANG);
-                #endif  /* __HAL_USE_EVENTLOG__ */
-                    }
-                }
-
-                sumOfRot = fabs(__mpu._ypr[0])+fabs(__mpu._ypr[1])+fabs(__mpu._ypr[2]);
-            }
-
-        }
-        break;
-        /*
-         * Restart MPU module and reload DMP firmware
-         * args[] = rebootCode(0x17)
-         * retVal one of MPU_* error codes
-         */
-    case MPU_T_REBOOT:
+        if ((_sumOfRot - (fabs(_ypr[0])+fabs(_ypr[1])+fabs(_ypr[2]))) > 30.0f)
         {
-            if (__mpu._ker.args[0] == 0x17)
+            if (_sumOfRot)
             {
-                sumOfRot = 0.0; //Prevents error for big change in value after reboot
-                __mpu.Reset();
-                __mpu.InitHW();
-                __mpu._ker.retVal = (int32_t)__mpu.InitSW();
-            }
-        }
-        break;
-        /*
-         * Soft reboot of MPU -> only reset status in event logger
-         * args[] = rebootCode(0x17)
-         * retVal one of MPU_* error codes
-         */
-    case MPU_T_SOFT_REBOOT:
-        {
-            if (__mpu._ker.args[0] == 0x17)
-            {
-#ifdef __HAL_USE_EVENTLOG__
-                EventLog::SoftReboot(MPU_UID);
-#endif  /* __HAL_USE_EVENTLOG__ */
+        #ifdef __HAL_USE_EVENTLOG__
+            EMIT_EV(MPU_T_GET_DATA, EVENT_HANG);
+        #endif  /* __HAL_USE_EVENTLOG__ */
             }
         }
-        break;
-        /*
-         * Change configuration of AHRS algorithm
-         * args[] = kp(float)|ki(float)|magnetometerEnable(bool)
-         * retVal one of MPU_* error codes
-         */
-    case MPU_T_AHRS_CONFIG:
-        {
-            float ki, kp;
-
-            memcpy((void*)&kp, (void*)__mpu._ker.args, sizeof(float));
-            memcpy((void*)&ki,
-                   (void*)(__mpu._ker.args+sizeof(float)),
-                   sizeof(float));
 
-            //  Update magnetometer-enabled flag
-            __mpu._magEn = (bool)*(__mpu._ker.args+2*sizeof(float));
-            //  Update settings of the AHRS algorithm
-            __mpu.SetupAHRS(0.0f, kp, ki);
-        }
-        break;
-    default:
-        break;
+        _sumOfRot = fabs(_ypr[0])+fabs(_ypr[1])+fabs(_ypr[2]);
     }
 
-    //  Report outcome to event logger
+    return MPU_SUCCESS;
+}
+
+/**
+ * Restart MPU module
+ * @param rebootCode has to be 0x17 for reboot to take place
+ * @return one of MPU_* error codes
+ */
+uint32_t MPU9250::_Reboot(uint8_t rebootCode)
+{
+    if (rebootCode != 0x17)
+        return MPU_ERROR;
+
+    _sumOfRot = 0.0; //Prevents error for big change in value after reboot
+    Reset();
+    InitHW();
+
+    return (uint32_t)InitSW();
+}
+
+/**
+ * Soft reboot of MPU -> only reset status in event logger
+ * @param rebootCode has to be 0x17 for reboot to take place
+ * @return one of MPU_* error codes
+ */
+uint32_t MPU9250::_SoftReboot(uint8_t rebootCode)
+{
+    if (rebootCode != 0x17)
+        return MPU_ERROR;
+
 #ifdef __HAL_USE_EVENTLOG__
-    if (__mpu._ker.retVal == MPU_SUCCESS)
-        EMIT_EV(__mpu._ker.serviceID, EVENT_OK);
-    else
-        EMIT_EV(__mpu._ker.serviceID, EVENT_ERROR);
+    EventLog::SoftReboot(MPU_UID);
 #endif  /* __HAL_USE_EVENTLOG__ */
+
+    return MPU_SUCCESS;
 }
-#endif
 
+/**
+ * Change configuration of AHRS algorithm
+ * @param kp proportional gain of Mahony filter
+ * @param ki integral gain of Mahony filter
+ * @param magEn true to use magnetometer readings
+ * @return one of MPU_* error codes
+ */
+uint32_t MPU9250::_ConfigAHRS(float kp, float ki, bool magEn)
+{
+    //  Update magnetometer-enabled flag
+    _magEn = magEn;
+
+    //  Update settings of the AHRS algorithm
+    return (uint32_t)SetupAHRS(0.0f, kp, ki);
+}
+#endif  /* __USE_TASK_SCHEDULER__ */
 
 ///-----------------------------------------------------------------------------
 ///         Functions for returning static instance                     [PUBLIC]
@@ -191,12 +169,11 @@ void _MPU_KernelCallback(void)
 
 /**
  * Return reference to a singleton
- * @return reference to an internal static instance
+ * @return reference to the instance owned by current kernel context
  */
 MPU9250& MPU9250::GetI()
 {
-    static MPU9250 singletonInstance;
-    return singletonInstance;
+    return *(KernelContext::Current().mpu);
 }
 
 /**
@@ -230,8 +207,9 @@ int8_t MPU9250::InitHW()
 
 #if defined(__USE_TASK_SCHEDULER__)
     //  Register module services with task scheduler
-    _ker.callBackFunc = _MPU_KernelCallback;
-    TS_RegCallback(&_ker, MPU_UID);
+    TS_RegServices(MPU_UID, TS_SERVICES(_services));
+    //  Register metrics of the module
+    MetricsRegistry::GetI().Register(_readErrors, MPU_UID, MPU_M_READ_ERR);
 #endif
 
     return MPU_SUCCESS;
@@ -343,16 +321,24 @@ uint8_t MPU9250::GetID()
 int8_t MPU9250::ReadSensorData()
 {
     int16_t gyro[3], accel[3], mag[3];
+    uint8_t err;
 
     //  Read sensor data into buffers
-    readAccelData(accel);
-    readGyroData(gyro);
+    err = readAccelData(accel);
+    err |= readGyroData(gyro);
     //  Check if we're asked to read magnetometer
     if (_magEn)
-        readMagData(mag);
+        err |= readMagData(mag);
     else
         memset((void*)mag, 0, 3*sizeof(uint16_t));
 
+    //  Bus failed, data is garbage and mustn't get into attitude estimate
+    if (err != 0)
+    {
+        _readErrors.Add();
+        return MPU_ERROR;
+    }
+
     //  Conversion from digital sensor readings to actual values
     for (uint8_t i = 0; i < 3; i++)
     {
@@ -464,10 +450,10 @@ MPU9250::MPU9250() :  dT(0), _magEn(true), _ahrs()
 #endif  /* __HAL_USE_EVENTLOG__ */
 
     //  Initialize arrays
-    memset((void*)_ypr, 0, 3);
-    memset((void*)_acc, 0, 3);
-    memset((void*)_gyro, 0, 3);
-    memset((void*)_mag, 0, 3);
+    memset((void*)_ypr, 0, sizeof(_ypr));
+    memset((void*)_acc, 0, sizeof(_acc));
+    memset((void*)_gyro, 0, sizeof(_gyro));
+    memset((void*)_mag, 0, sizeof(_mag));
 }
 
 MPU9250::~MPU9250()
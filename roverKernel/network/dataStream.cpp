@@ -28,57 +28,33 @@
 
 
 #if defined(__USE_TASK_SCHEDULER__)
-/*
- * Interface with task scheduler - provides memory space and function to call in
- * order for task scheduler to request service from this module. Not defined
- * within the class as it's enough to have only one of these to check all opened
- * streams.
+/**
+ * Services offered by data stream, in the order of DATAS_T_* IDs. Not bound to
+ * any instance, each task carries the stream it's meant for.
  */
-static _kernelEntry _dsKer;
+const _tsService DataStream::_services[] =
+{
+    //  DATAS_T_KA: pointer to data stream object
+    TS_FUNCTION1(uint32_t, DataStream::_KeepAlive, DataStream*)
+};
 
 /**
- * Callback routine to invoke service offered by this module from task scheduler
- * @note It is assumed that once this function is called task scheduler has
- * already copied required variables into the memory space provided for it.
+ * Keep-alive task, check if the socket is still alive, if not try to reconnect
+ * @param ds data stream whose socket to check
+ * @return STATUS_NO_EVENT, health check isn't reported to event log
  */
-void _DATAS_KernelCallback(void)
+uint32_t DataStream::_KeepAlive(DataStream *ds)
 {
-    //  Check for null-pointer
-    if (_dsKer.args == 0)
-        return;
-    /*
-     *  Data in args[] contains bytes that constitute arguments for function
-     *  calls. The exact representation(i.e. whether bytes represent ints, floats)
-     *  of data is known only to individual blocks of switch() function. There
-     *  is no predefined data separator between arguments inside args[].
-     */
-    switch (_dsKer.serviceID)
-    {
+    _espClient *socket = ESP8266::GetI().GetClientBySockID(ds->socketID);
+
     /*
-     * Keep-alive event, check if the socket is still alive, if not try to reconnect
-     * args[] = pointerToDatastreamObject(DataStream*)
-     * retVal ESP library error code (if > 5); or socket ID (if <=5)
+     * If socket has been closed GetClientBySockID returns 0. To reopen
+     * it we just call BindToScoketID as it already handles that
      */
-    case DATAS_T_KA:
-        {
-            //  Pointer is encoded into integer number
-            uint32_t ptr = 0;
-            memcpy(&ptr, (void*)_dsKer.args, 4);
-            DataStream *ds = (DataStream*)ptr;
-
-            _espClient *socket = ESP8266::GetI().GetClientBySockID(ds->socketID);
-
-            /*
-             * If socket has been closed GetClientBySockID returns 0. To reopen
-             * it we just call BindToScoketID as it already handles that
-             */
-            if (socket == 0)
-                ds->BindToSocketID(ds->socketID);
-        }
-        break;
-    default:
-        break;
-    }
+    if (socket == 0)
+        ds->BindToSocketID(ds->socketID);
+
+    return STATUS_NO_EVENT;
 }
 
 /**
@@ -87,8 +63,7 @@ void _DATAS_KernelCallback(void)
 void DataStream_InitHW()
 {
     //  Register module services with task scheduler
-    _dsKer.callBackFunc = _DATAS_KernelCallback;
-    TS_RegCallback(&_dsKer, DATAS_UID);
+    TS_RegServices(DATAS_UID, TS_SERVICES(DataStream::_services));
 }
 
 #endif  /*__USE_TASK_SCHEDULER__ */
@@ -118,11 +93,16 @@ DataStream::~DataStream()
     if (_keepAlive)
     {
         //  Delete periodic task attempting to reconnect to server
-        uint32_t arg = (uint32_t)this;
-        TaskScheduler::GetP()->RemoveTask(DATAS_UID, DATAS_T_KA, (void*)&arg, sizeof(uint32_t));
+        DataStream *arg = this;
+        TaskScheduler::GetP()->RemoveTask(DATAS_UID, DATAS_T_KA, (void*)&arg, sizeof(arg));
+    }
+    //  Close the socket before deleting data stream, if it's still open
+    if (_socket != 0)
+    {
+        _socket = ESP8266::GetI().GetClientBySockID(socketID);
+        if (_socket != 0)
+            _socket->Close();
     }
-    //  Close the socket before deleting data stream
-    _socket->Close();
 }
 
 ///-----------------------------------------------------------------------------
@@ -147,9 +127,12 @@ uint8_t DataStream::BindToSocketID(uint8_t sockID, bool sched)
     if (!_keepAlive && sched)
     {
     //  Schedule periodic check for health of the underlying socket, period 4s
-    TaskScheduler::GetI().SyncTaskPer(DATAS_UID, DATAS_T_KA, -4000, 4000, T_PERIODIC);
-    TaskScheduler::GetI().AddArg<uint32_t>((uint32_t)this);
+    TaskScheduler::GetI().SyncTaskPer(DATAS_UID, DATAS_T_KA, -4000, 4000,
+                                      T_PERIODIC, T_PRIO_LOW);
+    TaskScheduler::GetI().AddArg<DataStream*>(this);
     _keepAlive = true;
+    MetricsRegistry::GetI().Register(_reopens, DATAS_UID,
+                                     DATAS_M_REOPENS(sockID));
     }
 #endif
 
@@ -180,7 +163,10 @@ uint8_t DataStream::BindToSocketID(uint8_t sockID, bool sched)
         uint32_t status;
         status = ESP8266::GetI().OpenTCPSock((char*)_serverip, _port, 1, sockID);
         if (status < ESP_MAX_CLI)
+        {
             socketID = status;
+            _reopens.Add();
+        }
         else
         {
             //  Save socket ID for next try and return
@@ -205,7 +191,7 @@ uint8_t DataStream::BindToSocketID(uint8_t sockID, bool sched)
  * @param reopen set if true function also tries to reopen socket if it's closed
  * @return error-code, one of STATUS_* macros from myLib.h
  */
-uint32_t DataStream::Send(uint8_t *buffer, uint16_t bufferLen, bool reopen)
+uint32_t DataStream::Send(uint8_t *buffer, uint16_t bufferLen, bool /*reopen*/)
 {
     uint32_t retVal = ESP_STATUS_ERROR;
 
@@ -242,6 +228,40 @@ uint32_t DataStream::Send(uint8_t *buffer, uint16_t bufferLen, bool reopen)
         return STATUS_PROG_ERR;
 }
 
+#if defined(__USE_TASK_SCHEDULER__)
+/**
+ * Queue either a null terminated string with no buffer len, or any string of
+ * a certain length to be sent through the stream by ESP send service
+ * (ESP_T_SENDTCP). Unlike Send(), it doesn't wait for ESP to send the data, the
+ * service yields to other tasks while ESP is busy.
+ * @note Data is copied into arguments of the task, [buffer] can be reused as
+ * soon as this function returns
+ * @param buffer data to send, at most DATAS_POST_MAX bytes
+ * @param bufferLen length of [buffer], 0 if it's a null-terminated string
+ * @return STATUS_OK if data has been queued, STATUS_PROG_ERR if socket isn't
+ * opened or there's no memory for the data
+ */
+uint32_t DataStream::Post(const uint8_t *buffer, uint16_t bufferLen)
+{
+    volatile TaskScheduler *ts = TaskScheduler::GetP();
+
+    if (bufferLen == 0)
+        bufferLen = strlen((const char*)buffer);
+
+    //  Data has to fit into arguments of the task, and socket has to be opened
+    if ((bufferLen > DATAS_POST_MAX) ||
+        (ESP8266::GetI().GetClientBySockID(socketID) == 0))
+        return STATUS_PROG_ERR;
+
+    ts->SyncTask(ESP_UID, ESP_T_SENDTCP, T_ASAP);
+    if (!ts->AddArg<uint8_t>(socketID) ||
+        !ts->AddArgs((void*)buffer, bufferLen))
+        return STATUS_PROG_ERR;
+
+    return STATUS_OK;
+}
+#endif  /*__USE_TASK_SCHEDULER__ */
+
 /**
  * Receive data from the stream (if there's any)
  * @note Wrapper for low-level espClient:: function
@@ -10,7 +10,7 @@
  *  can be integrated with task scheduler to periodically check if the stream is
  *  opened and try to reconnect in case of a failure.
  *
- *  @version 1.3.2
+ *  @version 1.6.0
  *  V1.0 - 17.3.2017
  *  +Created document
  *  +Functionality: Initialize data stream with server IP & port, bind to opened
@@ -36,6 +36,17 @@
  *  V1.3.2 - 2.9.2017
  *  DataStream::Send function now offers user to choose whether to attempt to
  *  rebind closed socket
+ *  V1.4.0 - 17.10.2026
+ *  +Kernel callback replaced with a table of services (tsService.h)
+ *  V1.4.1 - 17.10.2026
+ *  *Bugfix: Destructor no longer closes a socket the stream was never bound
+ *  to, or one that ESP has already deleted
+ *  V1.5.0 - 17.10.2026
+ *  +Counts sockets opened by the stream (init/metrics.h), registered on the
+ *  first bind that schedules keep-alive task
+ *  V1.6.0 - 17.10.2026
+ *  +Added Post(), which queues data to be sent by ESP send service instead of
+ *  waiting for ESP to send it
  *
  */
 #include "hwconfig.h"
@@ -45,6 +56,7 @@
 #define ROVERKERNEL_NETWORK_DATASTREAM_H_
 
 #include "esp8266/espClient.h"
+#include "init/metrics.h"
 
 //  Enable integration of this library with task scheduler but only if task
 //  scheduler is being compiled into this project
@@ -59,6 +71,12 @@
     #define DATAS_UID       4
     //  Definitions of ServiceID for service offered by this module
     #define DATAS_T_KA      0   //  Keep alive socket
+    //  Metrics of this module (see init/metrics.h), one for every stream,
+    //  told apart by socket ID stream was first bound to
+    #define DATAS_M_REOPENS(X)  (X) //  Sockets opened (and reopened) by stream
+    //  Longest message Post() can queue, message is carried in arguments of
+    //  a task (together with socket ID and null-terminator)
+    #define DATAS_POST_MAX  (TS_ARG_LARGE_SIZE - 2)
 
 //  Function to register data stream as a kernel module into the task scheduler,
 //  not implemented within the class because DataStream doesn't follow singleton
@@ -77,7 +95,7 @@ void DataStream_InitHW();
  */
 class DataStream
 {
-    friend void _DATAS_KernelCallback(void);
+    friend void DataStream_InitHW();
     public:
         DataStream();
         DataStream(uint8_t *ip, uint16_t port);
@@ -86,6 +104,9 @@ class DataStream
         uint8_t     BindToSocketID(uint8_t sockID, bool sched = false);
 
         uint32_t    Send(uint8_t *buffer, uint16_t bufferLen = 0, bool reopen = true);
+#if defined(__USE_TASK_SCHEDULER__)
+        uint32_t    Post(const uint8_t *buffer, uint16_t bufferLen = 0);
+#endif
         bool        Receive(uint8_t *buffer, uint16_t *bufferLen);
 
         //  Socket ID as returned from ESP8266
@@ -101,6 +122,14 @@ class DataStream
         //  Turns true once this data stream has scheduled periodic checking
         //  of socket's health (whether we're still connected to the server)
         bool        _keepAlive;
+        //  Number of times stream has opened its socket
+        MetricCounter   _reopens;
+
+        //  Services provided to task scheduler, indexed by DATAS_T_* IDs
+#if defined(__USE_TASK_SCHEDULER__)
+        static const _tsService _services[];
+        static uint32_t _KeepAlive(DataStream *ds);
+#endif
 };
 
 
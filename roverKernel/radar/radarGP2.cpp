@@ -5,6 +5,7 @@
  *      Author: Vedran
  */
 #include "radarGP2.h"
+#include "init/kernelContext.h"
 
 #if defined(__HAL_USE_RADAR__)       //  Compile only if module is enabled
 
@@ -23,151 +24,141 @@
 #endif
 
 #if defined(__USE_TASK_SCHEDULER__)
+///-----------------------------------------------------------------------------
+///                      Services provided to task scheduler         [PROTECTED]
+///-----------------------------------------------------------------------------
+
+/**
+ * Services offered by radar, in the order of RADAR_T_* IDs
+ */
+const _tsService RadarModule::_services[] =
+{
+    //  RADAR_T_SCAN: single step of the scan, reading one ADC sample
+    TS_SERVICE0_BUDGET(RadarModule, uint32_t, _ScanStep, 2000),
+    //  RADAR_T_SETH: angle (0-right, 160-left)
+    TS_SERVICE1(RadarModule, uint32_t, _SetHorAngle, float),
+    //  RADAR_T_SETV: angle (0-up, 160-down)
+    TS_SERVICE1(RadarModule, uint32_t, _SetVerAngle, float),
+    //  RADAR_T_BLOCKINGSCAN
+    TS_SERVICE0(RadarModule, uint32_t, _BlockingScan)
+};
+
 /**
- * Callback routine to invoke service offered by this module from task scheduler
- * @note It is assumed that once this function is called task scheduler has
- * already copied required variables into the memory space provided for it.
+ * Single step of radar scan, rotating horizontal axis from 0 to 160. Each
+ * step takes a measurement and moves radar by 1, task is meant to be
+ * scheduled periodically until the scan is complete.
+ * @return STATUS_OK when scan is complete, STATUS_NO_EVENT otherwise
  */
-void _RADAR_KernelCallback(void)
+uint32_t RadarModule::_ScanStep()
 {
-    RadarModule &__rD = RadarModule::GetI();
-    //  Check for null-pointer
-    if (__rD._ker.args == 0)
-        return;
-
-    /*
-     *  Data in args[] contains bytes that constitute arguments for function
-     *  calls. The exact representation(i.e. whether bytes represent ints, floats)
-     *  of data is known only to individual blocks of switch() function. There
-     *  is no predefined data separator between arguments inside args[].
-     */
-    switch(__rD._ker.serviceID)
+    if (_stepAngle < 160)
     {
-    /*
-     * Request a radar scan by rotating horizontal axis from 0� to 160�. First
-     * data byte is either 1(fine scan) or 0(coarse scan).
-     * args[] = none
-     * retVal one of myLib.h STATUS_* error codes
-     */
-    case RADAR_T_SCAN:
-        {
-            static float horAngle = 0.0;
-            static uint16_t scanLen = 0;
-
-            if (horAngle < 160)
-            {
-                uint32_t dist;
-
-                //  Trigger AD conversion, wait for data-ready flag and read data
-                dist = HAL_RAD_ADCTrigger();
-
-                //  Convert ADC readout to cm (according to datasheet graph)
-                if ( dist>2860 ) dist=10;
-                else if ( (dist<=2860) && (dist>2020) )
-                    dist = interpolate(2860,10,2020,15,dist);
-                else if ( (dist<=2020) && (dist>1610) )
-                    dist = interpolate(2020,15,1610,20,dist);
-                else if ( (dist<=1610) && (dist>1340) )
-                    dist = interpolate(1610,20,1340,25,dist);
-                else if ( (dist<=1340) && (dist>1140) )
-                    dist = interpolate(1340,25,1140,30,dist);
-                else if ( (dist<=1140) && (dist>910) )
-                    dist = interpolate(1140,30,910,40,dist);
-                else if ( (dist<=910) && (dist>757) )
-                    dist = interpolate(910,40,757,50,dist);
-                else if ( (dist<=757) && (dist>640) )
-                    dist = interpolate(757,50,640,60,dist);
-                else if ( (dist<=640) && (dist>540) )
-                    dist = interpolate(640,60,540,70,dist);
-                else if ( (dist<=540) && (dist>508) )
-                    dist = interpolate(540,70,508,80,dist);
-                else if ( (dist<=508)) dist=80;
-
-                __rD._scanData[scanLen] = (uint8_t)(dist & 0xFF);
-
-                scanLen++;
-                horAngle+=1.0;
-            }
-
-            if (horAngle < 160.0)
-            {
-                HAL_RAD_SetHorAngle(horAngle);
-                return; //  Return so we don't emit any event
-            }
-            else
-            {
-                __rD.custHook(__rD._scanData, &scanLen);
-                __rD._scanComplete = true;
-                horAngle = 0.0;
-                scanLen = 0;
-
-                //  Return radar to starting position after completing the scan
-                HAL_RAD_SetHorAngle(horAngle);
-                __rD._ker.retVal = STATUS_OK;
-            }
-        }
-        break;
-        /*
-         * Rotate radar horizontally to a specified angle (0�-right, 160�-left)
-         * args[] = angle(4B)
-         * retVal none
-         */
-    case RADAR_T_SETH:
-        {
-            //  Only allowed to have 4 bytes of data (float)
-            if (__rD._ker.argN == sizeof(float))
-            {
-                float angle;
-                //  Copy data into a float
-                memcpy((void*)&angle,
-                       (void*)( __rD._ker.args),
-                       sizeof(float));
-                __rD.SetHorAngle(angle);
-            }
-        }
-        break;
-        /*
-         * Rotate radar vertically to a specified angle (0�-up, 160�-down)
-         * args[] = angle(4B)
-         * retVal none
-         */
-    case RADAR_T_SETV:
+        _scanData[_stepLen] = (uint8_t)(_ReadDistance() & 0xFF);
+
+        _stepLen++;
+        _stepAngle+=1.0;
+    }
+
+    if (_stepAngle < 160.0)
+    {
+        HAL_RAD_SetHorAngle(_stepAngle);
+        return STATUS_NO_EVENT; //  Scan isn't done yet, don't emit any event
+    }
+
+    custHook(_scanData, &_stepLen);
+    _scanComplete = true;
+    _scans.Add();
+    _stepAngle = 0.0;
+    _stepLen = 0;
+
+    //  Return radar to starting position after completing the scan
+    HAL_RAD_SetHorAngle(_stepAngle);
+
+    return STATUS_OK;
+}
+
+/**
+ * Rotate radar horizontally to a specified angle
+ * @param angle horizontal angle (in degrees)
+ * @return STATUS_OK
+ */
+uint32_t RadarModule::_SetHorAngle(float angle)
+{
+    SetHorAngle(angle);
+
+    return STATUS_OK;
+}
+
+/**
+ * Rotate radar vertically to a specified angle
+ * @param angle vertical angle (in degrees)
+ * @return STATUS_OK
+ */
+uint32_t RadarModule::_SetVerAngle(float angle)
+{
+    SetVerAngle(angle);
+
+    return STATUS_OK;
+}
+
+/**
+ * Perform full scan (same as Scan()) and pass the data to user's hook. Task is
+ * resumed for every measurement, letting other tasks run while the radar is
+ * settling at the next angle
+ * @return one of myLib.h STATUS_* error codes, or TS_YIELD while scanning
+ */
+uint32_t RadarModule::_BlockingScan()
+{
+    uint16_t scanLen;
+
+    TS_CO_BEGIN(_co);
+
+    HAL_RAD_Enable(true);
+    if (HAL_RAD_GetHorAngle() != 0)
+        HAL_RAD_SetHorAngle(0);
+    if (HAL_RAD_GetVerAngle() != 100)
+        HAL_RAD_SetVerAngle(100);
+
+    _scanAngle = 0;
+    _scanSum = 0;
+    _scanCount = 0;
+
+    //  Time for sensor to position itself to starting point
+    TS_CO_SLEEP(_co, 30);
+
+    while (_scanAngle <= 160.0f)
+    {
+        HAL_RAD_SetHorAngle(_scanAngle);
+        //  Settling time
+        TS_CO_SLEEP(_co, 40);
+
+        //  Average 8 measurements into one data point
+        _scanSum += _ReadDistance();
+        _scanCount++;
+        if ((_scanCount % 8) == 0)
         {
-            //  Only allowed to have 4 bytes of data (float)
-            if (__rD._ker.argN == sizeof(float))
-            {
-                float angle;
-                //  Copy data into a float
-                memcpy((void*)&angle,
-                       (void*)( __rD._ker.args),
-                       sizeof(float));
-                __rD.SetVerAngle(angle);
-            }
+            _scanData[(_scanCount/8)-1] = (_scanSum / 8) & 0xFF;
+            _scanSum = 0;
         }
-        break;
-        /*
-         * Measures current distance and sets new angle
-         * args[] = none
-         * retVal one of myLib.h STATUS_* error codes
-         */
-    case RADAR_T_BLOCKINGSCAN:
-    {
-            __rD._ker.retVal = __rD.Scan(true);
+
+        _scanAngle += 0.125f;
     }
-        break;
-    default:
-        break;
+
+    TS_CO_END(_co);
+
+    scanLen = _scanCount / 8;
+    _scanComplete = true;
+    _scans.Add();
+
+    if (custHook != 0)
+    {
+        custHook(_scanData, &scanLen);
+        _scanComplete = false;
     }
 
-    //  Check return-value and emit event based on it
-#ifdef __HAL_USE_EVENTLOG__
-    if (__rD._ker.retVal == STATUS_OK)
-        EMIT_EV(__rD._ker.serviceID, EVENT_OK);
-    else
-        EMIT_EV(__rD._ker.serviceID, EVENT_ERROR);
-#endif  /* __HAL_USE_EVENTLOG__ */
+    return STATUS_OK;
 }
-#endif /* __USE_TASK_SCHEDULER__ */
+#endif  /* __USE_TASK_SCHEDULER__ */
 
 ///-----------------------------------------------------------------------------
 ///         Functions for returning static instance                     [PUBLIC]
@@ -175,12 +166,11 @@ void _RADAR_KernelCallback(void)
 
 /**
  * Return reference to a singleton
- * @return reference to an internal static instance
+ * @return reference to the instance owned by current kernel context
  */
 RadarModule& RadarModule::GetI()
 {
-    static RadarModule singletonInstance;
-    return singletonInstance;
+    return *(KernelContext::Current().radar);
 }
 
 /**
@@ -214,8 +204,9 @@ void RadarModule::InitHW()
 
 #if defined(__USE_TASK_SCHEDULER__)
     //  Register module services with task scheduler
-    _ker.callBackFunc = _RADAR_KernelCallback;
-    TS_RegCallback(&_ker, RADAR_UID);
+    TS_RegServices(RADAR_UID, TS_SERVICES(_services));
+    //  Register metrics of the module
+    MetricsRegistry::GetI().Register(_scans, RADAR_UID, RADAR_M_SCANS);
 #endif
 
 #ifdef __HAL_USE_EVENTLOG__
@@ -281,30 +272,8 @@ uint32_t RadarModule::Scan(uint8_t *data, uint16_t *length)
 	    HAL_RAD_SetHorAngle(angle);
 	    HAL_DelayUS(40000);	//  Settling time 40ms/1deg
 
-		//  Trigger AD conversion, wait for data-ready flag and read data
-	    dist = HAL_RAD_ADCTrigger();
-
-	    //  Convert ADC readout to cm (according to datasheet graph)
-	    if ( dist>2860 ) dist=10;
-	    else if ( (dist<=2860) && (dist>2020) )
-	    	dist = interpolate(2860,10,2020,15,dist);
-	    else if ( (dist<=2020) && (dist>1610) )
-	    	dist = interpolate(2020,15,1610,20,dist);
-	    else if ( (dist<=1610) && (dist>1340) )
-	    	dist = interpolate(1610,20,1340,25,dist);
-	    else if ( (dist<=1340) && (dist>1140) )
-	    	dist = interpolate(1340,25,1140,30,dist);
-	    else if ( (dist<=1140) && (dist>910) )
-	    	dist = interpolate(1140,30,910,40,dist);
-	    else if ( (dist<=910) && (dist>757) )
-	    	dist = interpolate(910,40,757,50,dist);
-	    else if ( (dist<=757) && (dist>640) )
-	    	dist = interpolate(757,50,640,60,dist);
-	    else if ( (dist<=640) && (dist>540) )
-	    	dist = interpolate(640,60,540,70,dist);
-	    else if ( (dist<=540) && (dist>508) )
-	    	dist = interpolate(540,70,508,80,dist);
-	    else if ( (dist<=508)) dist=80;
+	    //  Trigger AD conversion and convert readout to cm
+	    dist = _ReadDistance();
 
 	    //  Sum current distance with previous, to calculate average later
 	    angleAvg += dist;
@@ -325,6 +294,7 @@ uint32_t RadarModule::Scan(uint8_t *data, uint16_t *length)
 
 	//  Set the flag to indicate scan is completed
 	_scanComplete = true;
+	_scans.Add();
 
 	return STATUS_OK;
 }
@@ -402,6 +372,46 @@ void RadarModule::SetVerAngle(float angle)
     HAL_RAD_SetVerAngle(angle); //  Direct call to HAL
 }
 
+///-----------------------------------------------------------------------------
+///                      Miscellaneous functions                     [PROTECTED]
+///-----------------------------------------------------------------------------
+
+/**
+ * Take a single measurement at the current radar position
+ * @return distance (in cm), between 10 and 80
+ */
+uint32_t RadarModule::_ReadDistance()
+{
+    uint32_t dist;
+
+    //  Trigger AD conversion, wait for data-ready flag and read data
+    dist = HAL_RAD_ADCTrigger();
+
+    //  Convert ADC readout to cm (according to datasheet graph)
+    if ( dist>2860 ) dist=10;
+    else if ( (dist<=2860) && (dist>2020) )
+        dist = interpolate(2860,10,2020,15,dist);
+    else if ( (dist<=2020) && (dist>1610) )
+        dist = interpolate(2020,15,1610,20,dist);
+    else if ( (dist<=1610) && (dist>1340) )
+        dist = interpolate(1610,20,1340,25,dist);
+    else if ( (dist<=1340) && (dist>1140) )
+        dist = interpolate(1340,25,1140,30,dist);
+    else if ( (dist<=1140) && (dist>910) )
+        dist = interpolate(1140,30,910,40,dist);
+    else if ( (dist<=910) && (dist>757) )
+        dist = interpolate(910,40,757,50,dist);
+    else if ( (dist<=757) && (dist>640) )
+        dist = interpolate(757,50,640,60,dist);
+    else if ( (dist<=640) && (dist>540) )
+        dist = interpolate(640,60,540,70,dist);
+    else if ( (dist<=540) && (dist>508) )
+        dist = interpolate(540,70,508,80,dist);
+    else if ( (dist<=508)) dist=80;
+
+    return dist;
+}
+
 ///-----------------------------------------------------------------------------
 ///                      Class constructor & destructor              [PROTECTED]
 ///-----------------------------------------------------------------------------
@@ -414,6 +424,8 @@ RadarModule::RadarModule() : _scanComplete(false), _scanData(0), _fineScan(false
 }
 
 RadarModule::~RadarModule()
-{}
+{
+    delete[] _scanData;
+}
 
 #endif  /* __HAL_USE_RADAR__ */
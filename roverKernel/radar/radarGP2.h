@@ -6,7 +6,7 @@
  *
  *  IR-sensor based radar (on 2D gimbal)
  *  (library Infrared Proximity Sensor, Sharp GP2Y0A21YK)
- *  @version 1.3.0
+ *  @version 1.7.0
  *  v1.1
  *  +Packed sensor functions and data into a C++ object
  *  V1.2
@@ -24,6 +24,16 @@
  *  -Removed fine scanning option
  *  *Radar scan implemented through series of periodic tasks in task scheduler
  *  in order to avoid long hangs while scanning
+ *  V1.4.0 - 17.10.2026
+ *  +Kernel callback replaced with a table of services (tsService.h)
+ *  V1.5.0 - 17.10.2026
+ *  +Full scan requested through task scheduler yields while the radar is
+ *  settling instead of blocking for the whole scan (tsCoroutine.h)
+ *  V1.6.0 - 17.10.2026
+ *  +Instance is owned by kernel context (init/kernelContext.h), progress of
+ *  the periodic scan is kept in the object
+ *  V1.7.0 - 17.10.2026
+ *  +Counts completed scans (init/metrics.h)
  */
 #include "hwconfig.h"
 
@@ -47,9 +57,13 @@
     #define RADAR_T_SETH            1   //  Set horizontal angle for radar
     #define RADAR_T_SETV            2   //  Set vertical angle of radar
     #define RADAR_T_BLOCKINGSCAN    3   //  Change of angle and measurement
+    //  Metrics of this module (see init/metrics.h)
+    #define RADAR_M_SCANS           0   //  Completed scans, of any kind
 
 #endif /* __USE_TASK_SCHEDULER__ */
 
+#include "init/metrics.h"
+
 /**
  * Class object representing IR radar module
  * Provides a high-level interface to a radar module. Supports repositioning the
@@ -59,7 +73,7 @@
  */
 class RadarModule
 {
-    friend void _RADAR_KernelCallback(void);
+    friend class KernelContext;
 	public:
         static RadarModule& GetI();
         static RadarModule* GetP();
@@ -80,13 +94,13 @@ class RadarModule
          * @param uint8_t* Buffer holding distance from performed scan(in cm)
          * @param uint16_t* Length of buffer (either 160(coarse) or 1280(fine))
          */
-        void    ((*custHook)(uint8_t*, uint16_t*));
+        void    (*custHook)(uint8_t*, uint16_t*);
 
 	protected:
         RadarModule();
         ~RadarModule();
-        RadarModule(RadarModule &arg) {}          //  No definition - forbid this
-        void operator=(RadarModule const &arg) {} //  No definition - forbid this
+        RadarModule(RadarModule &) {}             //  No definition - forbid this
+        void operator=(RadarModule const &) {}    //  No definition - forbid this
 
         //  Flag to signal scan being completed
 		bool    _scanComplete;
@@ -94,10 +108,26 @@ class RadarModule
 		uint8_t *_scanData;
 		//  Flag for user to request fine scan
 		bool    _fineScan;
-		//  Interface with task scheduler - provides memory space and function
-		//  to call in order for task scheduler to request service from this module
+		//  Number of completed scans
+		MetricCounter   _scans;
+
+		uint32_t    _ReadDistance();
+		//  Services provided to task scheduler, indexed by RADAR_T_* IDs
 #if defined(__USE_TASK_SCHEDULER__)
-		_kernelEntry _ker;
+		static const _tsService _services[];
+		uint32_t    _ScanStep();
+		//  Angle and number of measurements of the periodic scan
+		float       _stepAngle;
+		uint16_t    _stepLen;
+		uint32_t    _SetHorAngle(float angle);
+		uint32_t    _SetVerAngle(float angle);
+		uint32_t    _BlockingScan();
+		//  Full scan in progress, its current angle, sum of measurements to
+		//  average and total number of measurements
+		Coroutine   _co;
+		float       _scanAngle;
+		uint32_t    _scanSum;
+		uint32_t    _scanCount;
 #endif
 };
 
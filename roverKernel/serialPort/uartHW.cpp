@@ -5,7 +5,9 @@
  *      Author: Vedran
  */
 #include "libs/myLib.h"
+#include "hwconfig.h"
 
+#if defined(__BOARD_TM4C1294NCPDT__)
 #include "inc/hw_memmap.h"
 #include "inc/hw_ints.h"
 #include "inc/hw_gpio.h"
@@ -16,6 +18,10 @@
 #include "driverlib/rom_map.h"
 #include "driverlib/uart.h"
 #include "utils/uartstdio.h"
+#elif defined(__BOARD_POSIX__)
+#include <stdio.h>
+#include <stdarg.h>
+#endif
 
 #include "uartHW.h"
 
@@ -53,7 +59,13 @@ void SerialPort::Send(const char* arg, ...)
     //	Start the varargs processing.
     va_start(vaArgP, arg);
 
+#if defined(__BOARD_TM4C1294NCPDT__)
     UARTvprintf(arg, vaArgP);
+#elif defined(__BOARD_POSIX__)
+    //  On the host debug port is the standard output of the process
+    vprintf(arg, vaArgP);
+    fflush(stdout);
+#endif
 
     //	We're finished with the varargs now.
     va_end(vaArgP);
@@ -64,6 +76,7 @@ void SerialPort::Send(const char* arg, ...)
  */
 int8_t SerialPort::InitHW()
 {
+#if defined(__BOARD_TM4C1294NCPDT__)
 	uint32_t refClock, refClockHz;
 
 	/*
@@ -103,6 +116,7 @@ int8_t SerialPort::InitHW()
    	IntEnable(INT_UART0);
 
     IntMasterEnable();
+#endif
 
 	return STATUS_OK;
 }
@@ -121,6 +135,7 @@ void UART0RxIntHandler(void)
 	static uint8_t txBuffer[TX_BUF_LEN];
 	static uint16_t txBufLen = 0;
 
+#if defined(__BOARD_TM4C1294NCPDT__)
 	//Clear interrupt flag
 	UARTIntClear(UART0_BASE, UART_INT_RX);
 
@@ -131,6 +146,7 @@ void UART0RxIntHandler(void)
 		//	Add echo fo debugging purpose
 		UARTCharPut(UART0_BASE, txBuffer[ txBufLen-1 ]);
 	}
+#endif
 
 	if (SerialPort::GetP()->custHook != 0)
 	    SerialPort::GetP()->custHook(txBuffer, &txBufLen);
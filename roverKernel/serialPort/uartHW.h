@@ -36,7 +36,7 @@ class SerialPort
 		void	Send(const char* arg, ...);
 		void	AddHook(void((*custHook)(uint8_t*, uint16_t*)));
 
-		void	((*custHook)(uint8_t*, uint16_t*));  // Hook to user routine
+		void	(*custHook)(uint8_t*, uint16_t*);  // Hook to user routine
 	protected:
 		SerialPort();
         ~SerialPort();
@@ -0,0 +1,727 @@
+/**
+ * eventStore.cpp
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran
+ */
+#include "eventStore.h"
+#include "init/kernelContext.h"
+
+#if defined(__HAL_USE_STORAGE__)     //  Compile only if module is enabled
+
+#include "libs/myLib.h"
+
+//  Integration with event log, if it's present
+#ifdef __HAL_USE_EVENTLOG__
+    #include "init/eventLog.h"
+    //  Simplify emitting events
+    #define EMIT_EV(X, Y)  EventLog::EmitEvent(STORE_UID, X, Y)
+#endif  /* __HAL_USE_EVENTLOG__ */
+
+//  Marks a valid sector header
+#define STORE_MAGIC         0x53455652
+//  Size of sector header and of record header (in bytes)
+#define STORE_SEC_HDR       16
+#define STORE_REC_HDR       12
+//  Size of a record with given length of payload, aligned to 4 bytes
+#define STORE_REC_SIZE(X)   ((STORE_REC_HDR + (X) + 3) & ~3)
+
+//  Outcomes of reading a record from storage
+#define STORE_RD_OK         0   //  Valid record
+#define STORE_RD_END        1   //  Erased storage, end of records in sector
+#define STORE_RD_BAD        2   //  Record cut short or corrupted
+
+/**
+ * Update CRC-16/CCITT (polynomial 0x1021) with a block of data, 4 bits at a
+ * time
+ * @param crc CRC so far, 0xFFFF for the first block
+ * @param buf data
+ * @param len length of data (in bytes)
+ * @return updated CRC
+ */
+static uint16_t _CRC16(uint16_t crc, const uint8_t *buf, uint16_t len)
+{
+    static const uint16_t table[16] =
+    {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+    };
+
+    for (uint16_t i = 0; i < len; i++)
+    {
+        crc = (crc << 4) ^ table[(crc >> 12) ^ (buf[i] >> 4)];
+        crc = (crc << 4) ^ table[(crc >> 12) ^ (buf[i] & 0x0F)];
+    }
+
+    return crc;
+}
+
+/**
+ * Compute CRC of a record, see format in eventStore.h
+ * @param rec record as laid out in storage, header followed by payload
+ * @return CRC of the record
+ */
+static uint16_t _RecordCRC(const uint8_t *rec)
+{
+    uint16_t crc = _CRC16(0xFFFF, rec + 4, 8);
+
+    crc = _CRC16(crc, rec, 2);
+
+    return _CRC16(crc, rec + STORE_REC_HDR, rec[1]);
+}
+
+/**
+ * Check whether time (boot, ms) comes before another one
+ * @return true if first time is earlier
+ */
+static inline bool _Before(uint32_t boot1, uint32_t ms1, uint32_t boot2,
+                           uint32_t ms2)
+{
+    return (boot1 < boot2) || ((boot1 == boot2) && (ms1 < ms2));
+}
+
+#if defined(__USE_TASK_SCHEDULER__)
+///-----------------------------------------------------------------------------
+///                      Services provided to task scheduler         [PROTECTED]
+///-----------------------------------------------------------------------------
+
+/**
+ * Services offered by event store, in the order of STORE_T_* IDs
+ */
+const _tsService EventStore::_services[] =
+{
+    //  STORE_T_FLUSH: single flash operation, erase or programming
+    TS_SERVICE0_BUDGET(EventStore, uint32_t, _Flush, 2000),
+    //  STORE_T_FORMAT: accessCode(0x17)
+    TS_SERVICE1(EventStore, uint32_t, _Format, uint8_t)
+};
+
+/**
+ * Pull events and metrics into stage once they're due and start the next flash
+ * operation needed to write them, if storage isn't busy with the previous one.
+ * Meant to be scheduled periodically
+ * @return STATUS_NO_EVENT, store reports only when records don't fit into stage
+ * (counted in EventStore::dropped)
+ */
+uint32_t EventStore::_Flush()
+{
+    _Collect(false);
+    _Step();
+
+    return STATUS_NO_EVENT;
+}
+
+/**
+ * Erase all records in storage
+ * @param accessCode has to be 0x17 for records to be erased
+ * @return one of myLib.h STATUS_* error codes
+ */
+uint32_t EventStore::_Format(uint8_t accessCode)
+{
+    if (accessCode != 0x17)
+        return STATUS_ARG_ERR;
+
+    return Format();
+}
+#endif  /* __USE_TASK_SCHEDULER__ */
+
+///-----------------------------------------------------------------------------
+///         Functions for returning static instance                     [PUBLIC]
+///-----------------------------------------------------------------------------
+
+/**
+ * Return reference to a singleton
+ * @return reference to the instance owned by current kernel context
+ */
+EventStore& EventStore::GetI()
+{
+    return *(KernelContext::Current().store);
+}
+
+/**
+ * Return pointer to a singleton
+ * @return pointer to a internal static instance
+ */
+EventStore* EventStore::GetP()
+{
+    return &(EventStore::GetI());
+}
+
+///-----------------------------------------------------------------------------
+///                      Class member function definitions              [PUBLIC]
+///-----------------------------------------------------------------------------
+
+/**
+ * Initialize storage, recover records written before reset and (if using task
+ * scheduler) register services of the store. Boot record is put as the first
+ * record of this boot
+ */
+void EventStore::InitHW()
+{
+#ifdef __HAL_USE_EVENTLOG__
+    EMIT_EV(-1, EVENT_STARTUP);
+#endif  /* __HAL_USE_EVENTLOG__ */
+
+    _ready = HAL_STOR_Init();
+    if (_ready)
+    {
+        _Scan();
+        Put(STORE_REC_BOOT, 0, 0);
+    }
+
+#if defined(__USE_TASK_SCHEDULER__)
+    //  Register module services with task scheduler
+    TS_RegServices(STORE_UID, TS_SERVICES(_services));
+#endif
+
+#ifdef __HAL_USE_EVENTLOG__
+    if (!_ready)
+        EMIT_EV(-1, EVENT_ERROR);
+    else if (torn > 0)
+        EMIT_EV(-1, EVENT_HANG);
+    else
+        EMIT_EV(-1, EVENT_INITIALIZED);
+#endif  /* __HAL_USE_EVENTLOG__ */
+}
+
+/**
+ * Stage a record to be written into storage, stamped with current boot and
+ * time. Mustn't be called from interrupts
+ * @param type type of the record, one of STORE_REC_*
+ * @param payload payload of the record
+ * @param len length of payload (in bytes), up to STORE_PAYLOAD_MAX
+ * @return one of myLib.h STATUS_* error codes, STATUS_PROG_ERR if stage is
+ * full
+ */
+uint32_t EventStore::Put(uint8_t type, const void *payload, uint8_t len)
+{
+    uint16_t size = STORE_REC_SIZE(len);
+
+    if ((len > STORE_PAYLOAD_MAX) || (type == 0xFF))
+        return STATUS_ARG_ERR;
+    if ((_stageLen + size) > STORE_STAGE_SIZE)
+    {
+        dropped++;
+        return STATUS_PROG_ERR;
+    }
+
+    uint8_t *rec = (uint8_t*)_stage + _stageLen;
+    struct _storeRecord hdr;
+
+    hdr.type = type;
+    hdr.len = len;
+    hdr.crc = 0;
+    hdr.boot = _boot;
+    hdr.ms = (uint32_t)msSinceStartup;
+
+    //  Padding is left as erased flash
+    memset((void*)rec, 0xFF, size);
+    memcpy((void*)rec, (void*)&hdr, STORE_REC_HDR);
+    if (len > 0)
+        memcpy((void*)(rec + STORE_REC_HDR), payload, len);
+    hdr.crc = _RecordCRC(rec);
+    memcpy((void*)(rec + 2), (void*)&hdr.crc, 2);
+
+    _stageLen += size;
+
+    return STATUS_OK;
+}
+
+/**
+ * Pull events and metrics, and write everything staged into storage before
+ * returning (e.g. before a planned reboot). Blocks for as long as it takes
+ * @return one of myLib.h STATUS_* error codes
+ */
+uint32_t EventStore::Sync()
+{
+    if (!_ready)
+        return STATUS_PROG_ERR;
+
+    _Collect(true);
+
+    while ((_stageLen > 0) || (_erasing != HAL_STOR_SECTORS))
+    {
+        if (HAL_STOR_Busy())
+            HAL_DelayUS(100);
+        else if (!_Step())
+            return STATUS_PROG_ERR;
+    }
+    while (HAL_STOR_Busy())
+        HAL_DelayUS(100);
+
+    return STATUS_OK;
+}
+
+/**
+ * Erase all sectors of storage, dropping all records. Records staged but not
+ * yet written are kept. Blocks until all sectors are erased
+ * @return one of myLib.h STATUS_* error codes
+ */
+uint32_t EventStore::Format()
+{
+    if (!_ready)
+        return STATUS_PROG_ERR;
+
+    for (uint16_t i = 0; i < HAL_STOR_SECTORS; i++)
+    {
+        while (HAL_STOR_Busy())
+            HAL_DelayUS(100);
+
+        _secSeq[i] = 0;
+        _secBoot[i] = 0;
+        if (HAL_STOR_Erase(i) != HAL_OK)
+            return STATUS_PROG_ERR;
+        _secErases[i]++;
+    }
+    while (HAL_STOR_Busy())
+        HAL_DelayUS(100);
+
+    //  Sector 0 is opened next, record being programmed starts over there
+    _head = HAL_STOR_SECTORS - 1;
+    _headEnd = HAL_STOR_SECTOR_SIZE;
+    _recDone = 0;
+    _erasing = HAL_STOR_SECTORS;
+
+    return STATUS_OK;
+}
+
+/**
+ * Place cursor at the oldest record in storage
+ * @param cur [out] cursor
+ * @return true if storage has any records (sectors) at all
+ */
+bool EventStore::First(struct _storeCursor &cur)
+{
+    //  Sectors are written in order, the oldest one is the first valid one
+    //  after the sector being written
+    for (uint16_t i = 1; i <= HAL_STOR_SECTORS; i++)
+    {
+        uint16_t sector = (_head + i) % HAL_STOR_SECTORS;
+
+        if (_secSeq[sector] == 0)
+            continue;
+
+        cur.seq = _secSeq[sector];
+        cur.sector = sector;
+        cur.offset = STORE_SEC_HDR;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Place cursor at the first record written at or after given time. Sector is
+ * found from the index of sectors, the record by reading through the sector
+ * @param cur [out] cursor
+ * @param boot number of boot
+ * @param ms time (in ms) since that boot
+ * @return true if record has been found, false if there's no such record
+ * (cursor is then after the newest record, Next() returns records written
+ * from now on)
+ */
+bool EventStore::Find(struct _storeCursor &cur, uint32_t boot, uint32_t ms)
+{
+    struct _storeCursor prev;
+    struct _storeRecord rec;
+
+    if (!First(cur))
+        return false;
+
+    //  Start from the newest sector whose first record isn't after given time
+    prev = cur;
+    for (uint16_t i = 0; i < HAL_STOR_SECTORS; i++)
+    {
+        uint16_t sector = (prev.sector + i) % HAL_STOR_SECTORS;
+
+        if (_secSeq[sector] != (prev.seq + i))
+            break;
+        if ((_secBoot[sector] != 0) &&
+            !_Before(boot, ms, _secBoot[sector], _secMS[sector]))
+        {
+            cur.seq = _secSeq[sector];
+            cur.sector = sector;
+        }
+    }
+
+    while (true)
+    {
+        prev = cur;
+        if (!Next(cur, rec, 0))
+            return false;
+        if (!_Before(rec.boot, rec.ms, boot, ms))
+        {
+            cur = prev;
+            return true;
+        }
+    }
+}
+
+/**
+ * Read record at cursor and move cursor to the next one
+ * @param cur cursor, from First() or Find()
+ * @param rec [out] header of the record
+ * @param payload [out] buffer of at least STORE_PAYLOAD_MAX bytes receiving
+ * payload of the record, 0 to skip copying it
+ * @return true if record has been read, false if there are no more records or
+ * the sector cursor was in has been erased in the meantime
+ */
+bool EventStore::Next(struct _storeCursor &cur, struct _storeRecord &rec,
+                      uint8_t *payload)
+{
+    while ((cur.sector < HAL_STOR_SECTORS) &&
+           (_secSeq[cur.sector] == cur.seq))
+    {
+        //  Sector being written has complete records only up to _headEnd
+        uint16_t end = (cur.sector == _head) ? _headEnd : HAL_STOR_SECTOR_SIZE;
+
+        if (((cur.offset + STORE_REC_HDR) <= end) &&
+            (_ReadRecord(cur.sector, cur.offset, rec) == STORE_RD_OK) &&
+            ((cur.offset + STORE_REC_SIZE(rec.len)) <= end))
+        {
+            if (payload != 0)
+                memcpy((void*)payload,
+                       (void*)HAL_STOR_Address((uint32_t)cur.sector *
+                                               HAL_STOR_SECTOR_SIZE +
+                                               cur.offset + STORE_REC_HDR),
+                       rec.len);
+            cur.offset += STORE_REC_SIZE(rec.len);
+            return true;
+        }
+
+        //  End of sector, continue in the next one if it follows this one
+        uint16_t next = (cur.sector + 1) % HAL_STOR_SECTORS;
+        if ((cur.sector == _head) || (_secSeq[next] != (cur.seq + 1)))
+            break;
+        cur.seq++;
+        cur.sector = next;
+        cur.offset = STORE_SEC_HDR;
+    }
+
+    return false;
+}
+
+/**
+ * Get number of the current boot
+ * @return number of boot, starting from 1 on empty storage
+ */
+uint32_t EventStore::Boot()
+{
+    return _boot;
+}
+
+/**
+ * Get number of times the most worn sector has been erased
+ * @return number of erases
+ */
+uint32_t EventStore::MaxErases()
+{
+    uint32_t maxErases = 0;
+
+    for (uint16_t i = 0; i < HAL_STOR_SECTORS; i++)
+        if (_secErases[i] > maxErases)
+            maxErases = _secErases[i];
+
+    return maxErases;
+}
+
+///-----------------------------------------------------------------------------
+///                      Class member function definitions           [PROTECTED]
+///-----------------------------------------------------------------------------
+
+/**
+ * Read all records in storage, sector after sector in the order they were
+ * written. Rebuilds state of the store: sequence numbers and erase counts of
+ * sectors, index of sectors by time, end of the log and number of this boot
+ */
+void EventStore::_Scan()
+{
+    uint32_t maxSeq = 0, maxErases = 0, hdr[4];
+
+    _head = HAL_STOR_SECTORS - 1;
+    _boot = 0;
+    for (uint16_t i = 0; i < HAL_STOR_SECTORS; i++)
+    {
+        memcpy((void*)hdr,
+               (void*)HAL_STOR_Address((uint32_t)i * HAL_STOR_SECTOR_SIZE),
+               STORE_SEC_HDR);
+
+        _secBoot[i] = 0;
+        if ((hdr[0] == STORE_MAGIC) && (hdr[1] != 0) &&
+            (hdr[3] == ~(hdr[0] ^ hdr[1] ^ hdr[2])))
+        {
+            _secSeq[i] = hdr[1];
+            _secErases[i] = hdr[2];
+            if (hdr[2] > maxErases)
+                maxErases = hdr[2];
+            if (hdr[1] > maxSeq)
+            {
+                maxSeq = hdr[1];
+                _head = i;
+            }
+        }
+        else
+            _secSeq[i] = 0;
+    }
+    //  Erase count of a sector without valid header is lost, it can't have
+    //  been erased much more than the others
+    for (uint16_t i = 0; i < HAL_STOR_SECTORS; i++)
+        if (_secSeq[i] == 0)
+            _secErases[i] = maxErases;
+    _nextSeq = maxSeq + 1;
+
+    //  Writing starts in a new sector unless the last one ends cleanly
+    _headEnd = HAL_STOR_SECTOR_SIZE;
+
+    struct _storeCursor cur;
+    struct _storeRecord rec;
+    if (!First(cur))
+    {
+        _boot = 1;
+        return;
+    }
+
+    for (uint16_t i = 0; i < HAL_STOR_SECTORS; i++)
+    {
+        uint16_t sector = (cur.sector + i) % HAL_STOR_SECTORS,
+                 offset = STORE_SEC_HDR;
+        uint8_t status;
+
+        if (_secSeq[sector] != (cur.seq + i))
+            break;
+
+        while ((status = _ReadRecord(sector, offset, rec)) == STORE_RD_OK)
+        {
+            if (offset == STORE_SEC_HDR)
+            {
+                _secBoot[sector] = rec.boot;
+                _secMS[sector] = rec.ms;
+            }
+            if (rec.boot > _boot)
+                _boot = rec.boot;
+            recovered++;
+            offset += STORE_REC_SIZE(rec.len);
+        }
+        if (status == STORE_RD_BAD)
+            torn++;
+
+        if (sector != _head)
+            continue;
+
+        //  Everything after the last record has to be erased, otherwise a
+        //  record was cut short before its header got written
+        const uint8_t *rest = HAL_STOR_Address((uint32_t)sector *
+                                               HAL_STOR_SECTOR_SIZE);
+        uint32_t j = offset;
+        while ((j < HAL_STOR_SECTOR_SIZE) && (rest[j] == 0xFF))
+            j++;
+        if ((status == STORE_RD_END) && (j == HAL_STOR_SECTOR_SIZE))
+            _headEnd = offset;
+        else if (status == STORE_RD_END)
+            torn++;
+    }
+
+    _boot++;
+}
+
+/**
+ * Read and validate header of a record in storage
+ * @param sector index of the sector
+ * @param offset offset of the record within sector
+ * @param rec [out] header of the record
+ * @return one of STORE_RD_* outcomes
+ */
+uint8_t EventStore::_ReadRecord(uint16_t sector, uint16_t offset,
+                                struct _storeRecord &rec)
+{
+    const uint8_t *addr = HAL_STOR_Address((uint32_t)sector *
+                                           HAL_STOR_SECTOR_SIZE + offset);
+
+    if ((offset + STORE_REC_HDR) > HAL_STOR_SECTOR_SIZE)
+        return STORE_RD_END;
+
+    memcpy((void*)&rec, (void*)addr, STORE_REC_HDR);
+
+    //  Erased header, no more records in this sector
+    if ((addr[0] == 0xFF) && (addr[1] == 0xFF) && (addr[2] == 0xFF) &&
+        (addr[3] == 0xFF))
+        return STORE_RD_END;
+    if ((offset + STORE_REC_SIZE(rec.len)) > HAL_STOR_SECTOR_SIZE)
+        return STORE_RD_BAD;
+    if (_RecordCRC(addr) != rec.crc)
+        return STORE_RD_BAD;
+
+    return STORE_RD_OK;
+}
+
+/**
+ * Start the next flash operation needed to write staged records: erase of the
+ * next sector, its header, or (a part of) the oldest staged record
+ * @return true if operation has been started, false if there's nothing to do,
+ * storage is busy or operation failed to start
+ */
+bool EventStore::_Step()
+{
+    if (!_ready || HAL_STOR_Busy())
+        return false;
+
+    //  Sector has been erased, open it by writing its header
+    if (_erasing != HAL_STOR_SECTORS)
+    {
+        uint32_t hdr[4];
+
+        hdr[0] = STORE_MAGIC;
+        hdr[1] = _nextSeq;
+        hdr[2] = _secErases[_erasing] + 1;
+        hdr[3] = ~(hdr[0] ^ hdr[1] ^ hdr[2]);
+        if (HAL_STOR_Program((uint32_t)_erasing * HAL_STOR_SECTOR_SIZE, hdr, 4)
+                != HAL_OK)
+            return false;
+
+        _secErases[_erasing] = hdr[2];
+        _secSeq[_erasing] = _nextSeq++;
+        _head = _erasing;
+        _headEnd = STORE_SEC_HDR;
+        _erasing = HAL_STOR_SECTORS;
+        return true;
+    }
+
+    if (_stageLen == 0)
+        return false;
+
+    const uint8_t *rec = (const uint8_t*)_stage;
+    uint16_t size = STORE_REC_SIZE(rec[1]);
+
+    //  Record doesn't fit into the rest of the sector, erase the next one
+    //  (the oldest), its records are gone from now on
+    if ((_recDone == 0) && ((_headEnd + size) > HAL_STOR_SECTOR_SIZE))
+    {
+        uint16_t next = (_head + 1) % HAL_STOR_SECTORS;
+
+        _secSeq[next] = 0;
+        _secBoot[next] = 0;
+        if (HAL_STOR_Erase(next) != HAL_OK)
+            return false;
+
+        _erasing = next;
+        return true;
+    }
+
+    //  Program as much of the record as fits into one block of flash
+    uint32_t offset = (uint32_t)_head * HAL_STOR_SECTOR_SIZE + _headEnd +
+                      _recDone;
+    uint16_t chunk = size - _recDone;
+    if (chunk > (HAL_STOR_WRITE_MAX - (offset % HAL_STOR_WRITE_MAX)))
+        chunk = HAL_STOR_WRITE_MAX - (offset % HAL_STOR_WRITE_MAX);
+
+    if (HAL_STOR_Program(offset, _stage + _recDone / 4, chunk / 4) != HAL_OK)
+        return false;
+    _recDone += chunk;
+
+    if (_recDone < size)
+        return true;
+
+    //  Whole record is in storage, first record of a sector goes into index
+    if (_headEnd == STORE_SEC_HDR)
+    {
+        struct _storeRecord hdr;
+
+        memcpy((void*)&hdr, (void*)rec, STORE_REC_HDR);
+        _secBoot[_head] = hdr.boot;
+        _secMS[_head] = hdr.ms;
+    }
+    _headEnd += size;
+    _recDone = 0;
+    written++;
+
+    _stageLen -= size;
+    memmove((void*)_stage, (void*)((uint8_t*)_stage + size), _stageLen);
+
+    return true;
+}
+
+/**
+ * Stage events emitted since they were last pulled from event log, and a
+ * snapshot of kernel metrics, once they're due
+ * @param force true to pull them regardless of the time
+ */
+void EventStore::_Collect(bool force)
+{
+    uint64_t now = msSinceStartup;
+
+#ifdef __HAL_USE_EVENTLOG__
+    if (force || (now >= _evDue))
+    {
+        EventLog &evLog = EventLog::GetI();
+        uint32_t lastSeq = evLog.NextSeq();
+        uint8_t payload[STORE_PAYLOAD_MAX];
+
+        _evDue = now + STORE_EVENTS_MS;
+
+        //  Events overwritten before being pulled are counted by event log
+        if ((int32_t)(_evSeq - evLog.FirstSeq()) < 0)
+            _evSeq = evLog.FirstSeq();
+
+        //  Events that don't fit into stage stay in event log until next time
+        while ((_evSeq != lastSeq) &&
+               ((_stageLen + STORE_REC_SIZE(STORE_PAYLOAD_MAX)) <=
+                STORE_STAGE_SIZE))
+        {
+            uint32_t firstSeq = _evSeq;
+            uint16_t len;
+
+            memcpy((void*)payload, (void*)&firstSeq, 4);
+            len = evLog.EncodeEvents(_evSeq, lastSeq, payload + 4,
+                                     STORE_PAYLOAD_MAX - 4);
+            if (_evSeq == firstSeq)
+                break;
+
+            Put(STORE_REC_EVENTS, payload, (uint8_t)(len + 4));
+        }
+    }
+#endif  /* __HAL_USE_EVENTLOG__ */
+
+    if (force || (now >= _metricsDue))
+    {
+        uint32_t metrics[STORE_METRICS] = { 0 };
+
+        _metricsDue = now + STORE_METRICS_MS;
+
+#if defined(__USE_TASK_SCHEDULER__)
+        volatile TaskScheduler *ts = TaskScheduler::GetP();
+        metrics[STORE_M_OVERRUNS] = ts->GetBudget().overruns;
+        metrics[STORE_M_SHED] = ts->GetLoad().shed;
+#endif  /* __USE_TASK_SCHEDULER__ */
+#ifdef __HAL_USE_EVENTLOG__
+        metrics[STORE_M_EVLOST] = EventLog::GetI().Lost();
+#endif  /* __HAL_USE_EVENTLOG__ */
+        metrics[STORE_M_DROPPED] = dropped;
+
+        Put(STORE_REC_METRICS, metrics, sizeof(metrics));
+    }
+}
+
+///-----------------------------------------------------------------------------
+///                      Class constructor & destructor              [PROTECTED]
+///-----------------------------------------------------------------------------
+
+EventStore::EventStore() : recovered(0), torn(0), written(0), dropped(0),
+                           _head(HAL_STOR_SECTORS - 1),
+                           _headEnd(HAL_STOR_SECTOR_SIZE), _recDone(0),
+                           _erasing(HAL_STOR_SECTORS), _nextSeq(1), _boot(0),
+                           _stageLen(0), _evSeq(0), _evDue(0), _metricsDue(0),
+                           _ready(false)
+{
+    for (uint16_t i = 0; i < HAL_STOR_SECTORS; i++)
+    {
+        _secSeq[i] = 0;
+        _secErases[i] = 0;
+        _secBoot[i] = 0;
+        _secMS[i] = 0;
+    }
+}
+
+EventStore::~EventStore()
+{}
+
+#endif  /* __HAL_USE_STORAGE__ */
@@ -0,0 +1,199 @@
+/**
+ *  eventStore.h
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran Mikov
+ *
+ *  Persistent store of events and key metrics, kept in storage of the board
+ *  (on-chip flash, see HAL_STOR_*) so that they outlive a reboot or a fault
+ *  reset. Store is an append-only log of records, each one stamped with the
+ *  number of the boot it was written in and time since that boot:
+ *   -Records are first staged in RAM by Put(), and programmed into storage by
+ *  a periodic low-priority task a piece at a time (one flash operation per
+ *  run), so writing never blocks the code putting them or the control loops
+ *   -Storage is used as a ring of sectors, written one after another. Once the
+ *  last one is full the oldest sector is erased and reused, so all sectors are
+ *  erased equally often. Each sector begins with a header holding its sequence
+ *  number and the number of times it has been erased
+ *   -Every record carries a CRC. Record cut short by a reset while it was
+ *  being programmed fails the check, it and everything after it in the sector
+ *  is ignored and writing continues in a fresh sector
+ *   -On boot, all records are read once in order, which validates them, finds
+ *  the end of the log and the number of the last boot, and builds index of
+ *  sectors by time of their first record. Records are read back with First(),
+ *  Find() (indexed lookup by time) and Next()
+ *  Events are pulled from event log every STORE_EVENTS_MS, encoded as binary
+ *  records of EventLog::EncodeEvents(). Snapshot of kernel metrics is written
+ *  every STORE_METRICS_MS.
+ *
+ *  Storage layout (all numbers little-endian, records aligned to 4 bytes):
+ *  sector:     header(16B) record record ... (0xFF until the end)
+ *  header:     magic(4B) seq(4B) erases(4B) check(4B), check = ~(magic^seq^erases)
+ *  record:     type(1B) len(1B) crc(2B) boot(4B) ms(4B) payload(len B)
+ *              crc is CRC-16/CCITT of boot, ms, type, len and payload
+ *  STORE_REC_BOOT payload:     none, first record of every boot
+ *  STORE_REC_EVENTS payload:   seq(4B) of the first event, then event records
+ *  STORE_REC_METRICS payload:  uint32_t value of each of STORE_M_*, in order
+ *
+ *  @version 1.0
+ *  V1.0 - 17.10.2026
+ *  +Creation of file, log-structured store with batched non-blocking writes,
+ *  recovery on boot and lookup by time
+ */
+#include "hwconfig.h"
+
+//  Compile following section only if hwconfig.h says to include this module
+#if !defined(ROVERKERNEL_STORAGE_EVENTSTORE_H_) && defined(__HAL_USE_STORAGE__)
+#define ROVERKERNEL_STORAGE_EVENTSTORE_H_
+
+#include "HAL/hal.h"
+
+//  Enable integration of this library with task scheduler but only if task
+//  scheduler is being compiled into this project
+#if defined(__HAL_USE_TASKSCH__)
+#define __USE_TASK_SCHEDULER__
+#endif  /* __HAL_USE_TASKSCH__ */
+
+//  Check if this library is set to use task scheduler
+#if defined(__USE_TASK_SCHEDULER__)
+    #include "taskScheduler/taskScheduler.h"
+    //  Unique identifier of this module as registered in task scheduler
+    #define STORE_UID           8
+    //  Definitions of ServiceID for service offered by this module
+    #define STORE_T_FLUSH       0   //  Write staged records into storage
+    #define STORE_T_FORMAT      1   //  Erase all records in storage
+#endif /* __USE_TASK_SCHEDULER__ */
+
+//  Period (in ms) of the task writing staged records into storage
+#define STORE_FLUSH_MS      20
+//  Period (in ms) of pulling events from event log, events are no longer
+//  aggregated (see EventLog::EncodeEvents()) once they're pulled
+#define STORE_EVENTS_MS     1000
+//  Period (in ms) of snapshots of kernel metrics
+#define STORE_METRICS_MS    10000
+//  Size of RAM buffer records are staged in (in bytes)
+#define STORE_STAGE_SIZE    1024
+
+//  Types of records
+#define STORE_REC_BOOT      1
+#define STORE_REC_EVENTS    2
+#define STORE_REC_METRICS   3
+
+//  Metrics in STORE_REC_METRICS record
+#define STORE_M_OVERRUNS    0   //  Services that went over their budget
+#define STORE_M_SHED        1   //  Tasks skipped while scheduler was overloaded
+#define STORE_M_EVLOST      2   //  Events overwritten before being dropped
+#define STORE_M_DROPPED     3   //  Records that didn't fit into stage of store
+#define STORE_METRICS       4
+
+//  Longest payload of a record (in bytes)
+#define STORE_PAYLOAD_MAX   240
+
+/**
+ * Header of a record, followed by its payload
+ */
+struct _storeRecord
+{
+        uint8_t     type;   //  One of STORE_REC_*, 0xFF in erased storage
+        uint8_t     len;    //  Length of payload (in bytes)
+        uint16_t    crc;    //  CRC of the record, see format above
+        uint32_t    boot;   //  Number of boot record was written in
+        uint32_t    ms;     //  Time (in ms) since that boot
+};
+
+/**
+ * Position of a record in storage, used when reading records back
+ */
+struct _storeCursor
+{
+        uint32_t    seq;    //  Sequence number of the sector
+        uint16_t    sector; //  Index of the sector
+        uint16_t    offset; //  Offset of the record within sector
+};
+
+/**
+ * EventStore class definition
+ * Persistent log of records in storage of the board, see description at the
+ * top of the file
+ */
+class EventStore
+{
+    friend class KernelContext;
+    public:
+        static EventStore& GetI();
+        static EventStore* GetP();
+
+        void        InitHW();
+
+        uint32_t    Put(uint8_t type, const void *payload, uint8_t len);
+        uint32_t    Sync();
+        uint32_t    Format();
+
+        bool        First(struct _storeCursor &cur);
+        bool        Find(struct _storeCursor &cur, uint32_t boot, uint32_t ms);
+        bool        Next(struct _storeCursor &cur, struct _storeRecord &rec,
+                         uint8_t *payload);
+
+        uint32_t    Boot();
+        uint32_t    MaxErases();
+
+        //  Number of valid records found on boot
+        uint32_t    recovered;
+        //  Number of records cut short found on boot
+        uint32_t    torn;
+        //  Number of records written into storage since boot
+        uint32_t    written;
+        //  Number of records that didn't fit into stage
+        uint32_t    dropped;
+
+    protected:
+        EventStore();
+        ~EventStore();
+        EventStore(EventStore &) {}                 //  No definition - forbid this
+        void operator=(EventStore const &) {}       //  No definition - forbid this
+
+        void        _Scan();
+        uint8_t     _ReadRecord(uint16_t sector, uint16_t offset,
+                                struct _storeRecord &rec);
+        bool        _Step();
+        void        _Collect(bool force);
+
+        //  Sequence number (0 if sector holds no valid data), erase count and
+        //  time of the first record (index by time) of every sector
+        uint32_t    _secSeq[HAL_STOR_SECTORS];
+        uint32_t    _secErases[HAL_STOR_SECTORS];
+        uint32_t    _secBoot[HAL_STOR_SECTORS];
+        uint32_t    _secMS[HAL_STOR_SECTORS];
+        //  Sector being written and offset after its last complete record,
+        //  HAL_STOR_SECTOR_SIZE if writing has to move to the next sector
+        uint16_t    _head;
+        uint16_t    _headEnd;
+        //  Bytes of the record being programmed already in storage
+        uint16_t    _recDone;
+        //  Sector being erased, HAL_STOR_SECTORS if none
+        uint16_t    _erasing;
+        //  Sequence number given to the next sector
+        uint32_t    _nextSeq;
+        //  Number of current boot
+        uint32_t    _boot;
+        //  Records staged in RAM, bytes up to _stageLen; the first one is
+        //  being programmed
+        uint32_t    _stage[STORE_STAGE_SIZE / 4];
+        uint16_t    _stageLen;
+        //  Sequence number of the first event not yet pulled from event log,
+        //  and time (in ms) events and metrics are due next
+        uint32_t    _evSeq;
+        uint64_t    _evDue;
+        uint64_t    _metricsDue;
+        //  True once storage has been initialized
+        bool        _ready;
+
+        //  Services provided to task scheduler, indexed by STORE_T_* IDs
+#if defined(__USE_TASK_SCHEDULER__)
+        static const _tsService _services[];
+        uint32_t    _Flush();
+        uint32_t    _Format(uint8_t accessCode);
+#endif
+};
+
+#endif /* ROVERKERNEL_STORAGE_EVENTSTORE_H_ */
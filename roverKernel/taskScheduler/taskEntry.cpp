@@ -5,38 +5,41 @@
  *      Author: Vedran
  */
 #include "taskEntry.h"
+#include "tsPool.h"
 
 
 ///-----------------------------------------------------------------------------
 ///                      Class constructors & destructor                [PUBLIC]
 ///-----------------------------------------------------------------------------
 TaskEntry::TaskEntry() : _libuid(0), _task(0), _argN(0), _timestamp(0),
-        _args(0), _PID(0)
+        _args(0), _period(0), _repeats(0), _PID(0), _prio(T_PRIO_NORMAL),
+        _deadline(0), _suspended(false), _catchUp(T_CATCHUP_SKIP), _release(0)
 {
 }
 
 TaskEntry::TaskEntry(uint8_t uid, uint8_t task, uint32_t time,
                      int32_t period, int32_t repeats)
-            :_libuid(uid), _task(task), _timestamp(time),
-             _argN(0), _args(0), _period(period), _repeats(repeats), _PID(0)
+            :_libuid(uid), _task(task), _argN(0), _timestamp(time),
+             _args(0), _period(period), _repeats(repeats), _PID(0),
+             _prio(T_PRIO_NORMAL), _deadline(0), _suspended(false),
+             _catchUp(T_CATCHUP_SKIP), _release(time)
 {
 }
 
 TaskEntry::TaskEntry(const TaskEntry& arg) :  _argN(0), _args(0)
 {
-    *this = (const TaskEntry&)arg;
+    _CopyFrom(arg);
 }
 
 TaskEntry::TaskEntry(const volatile TaskEntry& arg) :  _argN(0), _args(0)
 {
-    *this = (const volatile TaskEntry&)arg;
+    _CopyFrom(arg);
 }
 
 TaskEntry::~TaskEntry()
 {
-    //  If there's any dynamically allocated data release it
-    if (_args != 0)
-        delete [] _args;
+    //  If there's any allocated data release it
+    _FreeArgs();
 }
 
 ///-----------------------------------------------------------------------------
@@ -47,30 +50,42 @@ TaskEntry::~TaskEntry()
  * Add argument(s) stored in a byte array [arg] of length [argLen]. Byte array
  * may contain data of any type, as long as receiver of that data knows how to
  * interpret bytes stored in the field.
- * Size of internal array holding bytes is dynamically reallocated every time
- * this function is called in order to ensure there's enough space for all args.
- * @note This function doesn't have overflow protection. It will try to save all
- * provided arguments into and array, allocating as much space as it needs.
+ * Short argument lists are kept in a buffer inside of the object, longer ones
+ * are moved to memory taken from argument pools (see tsPool.h). Arguments are
+ * appended in place as long as there's space left in the current array.
  * @param arg byte array of data to pass to the function
  * @param argLen length of byte array [arg] (in bytes)
+ * @return true if arguments were added, false if there's no memory for them
+ * (arguments added before are kept as they were)
  */
-void TaskEntry::AddArg(void* arg, uint16_t argLen) volatile
+bool TaskEntry::AddArg(void* arg, uint16_t argLen) volatile
 {
-    //  Allocate new memory to fit all the arguments +1 space because argument
-    //  array has to be null-terminated
-    uint8_t *temp = new uint8_t[_argN+argLen+1];
+    //  Space needed for all the arguments +1 space because argument array has
+    //  to be null-terminated
+    uint16_t newLen = _argN + argLen + 1;
+    volatile uint8_t *temp = _args;
 
-    //  Copy existing arguments from _args into a new memory location
-    memcpy((void*)temp, (void*)_args, _argN);
-    //  Delete data currently stored in pointer _args
-    delete [] _args;
-    //  Append new arguments to the new array of arguments
+    //  Get a new array only if the current one can't fit all the arguments
+    if ((temp == 0) || (newLen > _ArgCapacity()))
+    {
+        temp = _ArgSpace(newLen);
+        if (temp == 0)
+            return false;
+        //  Copy existing arguments from _args into a new memory location
+        if (_argN > 0)
+            memcpy((void*)temp, (void*)_args, _argN);
+        //  Release memory currently used by _args
+        _FreeArgs();
+    }
+    //  Append new arguments to the array of arguments
     memcpy((void*)(temp+_argN), arg, argLen);
     _argN += argLen;
     //  Null-terminate array
     temp[_argN] = 0;
     //  Save new array into a pointer in this object
     _args = temp;
+
+    return true;
 }
 
 uint8_t TaskEntry::GetLibUID() const volatile
@@ -93,6 +108,45 @@ uint32_t TaskEntry::GetTimeStamp() const volatile
 {
     return (uint32_t)_timestamp;
 }
+uint8_t TaskEntry::GetPriority() const volatile
+{
+    return (uint8_t)_prio;
+}
+/**
+ * Get deadline of the task, relative to its time stamp
+ * @return explicitly set deadline, or period for periodic tasks without one.
+ * 0 if task has no deadline (it's expected to run as soon as it's due)
+ */
+int32_t TaskEntry::GetDeadline() const volatile
+{
+    if (_deadline != 0)
+        return _deadline;
+
+    return labs(_period);
+}
+
+/**
+ * Check whether this task should be executed before [arg], if both are due.
+ * Tasks are ordered by priority class, then by their deadline (earliest
+ * deadline first) and lastly by their time stamp.
+ * @param arg task to compare with
+ * @return true if this task goes first, false if [arg] goes first or if their
+ * order can't be decided (caller should then keep the order they were added in)
+ */
+bool TaskEntry::DispatchBefore(const volatile TaskEntry& arg) const volatile
+{
+    if (_prio != arg._prio)
+        return (_prio < arg._prio);
+
+    //  Compare in a way that survives overflow of time stamps
+    uint32_t deadline = _timestamp + GetDeadline(),
+             argDeadline = arg._timestamp + arg.GetDeadline();
+
+    if (deadline != argDeadline)
+        return ((int32_t)(deadline - argDeadline) < 0);
+
+    return ((int32_t)(_timestamp - arg._timestamp) < 0);
+}
 
 ///-----------------------------------------------------------------------------
 ///                 Class operator definitions                          [PUBLIC]
@@ -100,42 +154,100 @@ uint32_t TaskEntry::GetTimeStamp() const volatile
 
 /**
  * Class assignment operators for various combinations of data types
+ * Arguments are deep-copied, any arguments this object held before are released
  * @param arg right side of equal-sign
  * @return
  */
 TaskEntry& TaskEntry::operator= (const TaskEntry& arg)
 {
-    _libuid = arg._libuid;
-    _task = arg._task;
-    _argN = arg._argN;
-    _timestamp = arg._timestamp;
-    _period = arg._period;
-    _repeats = arg._repeats;
-    _PID = arg._PID;
-    Perf = arg.Perf;
-
-    _args = new uint8_t[_argN];
-    memcpy((void*)_args, (void*)(arg._args), _argN);
+    _CopyFrom(arg);
     return *this;
 }
 
 volatile TaskEntry& TaskEntry::operator= (const volatile TaskEntry& arg)
 {
-    _libuid = arg._libuid;
-    _task = arg._task;
-    _argN = arg._argN;
-    _timestamp = arg._timestamp;
-    _period = arg._period;
-    _repeats = arg._repeats;
-    _PID = arg._PID;
-    Perf = arg.Perf;
-
-    _args = new uint8_t[_argN];
-    memcpy((void*)_args, (void*)(arg._args), _argN);
+    _CopyFrom(arg);
     return *this;
 }
 
 volatile TaskEntry& TaskEntry::operator= (volatile TaskEntry& arg) volatile
+{
+    _CopyFrom(arg);
+    return (volatile TaskEntry&) *this;
+}
+
+/**
+ * Move content of [arg] into this object without copying its arguments (unless
+ * they're stored inline). Any arguments this object held before are released.
+ * @note [arg] is left without arguments, but remains a valid object
+ * @param arg object to take the content from
+ */
+void TaskEntry::MoveFrom(volatile TaskEntry& arg) volatile
+{
+    if (&arg == this)
+        return;
+
+    _FreeArgs();
+    _CopyMembers(arg);
+
+    //  Inline arguments have to be copied, others just change the owner
+    if (arg._args == arg._argBuf)
+    {
+        memcpy((void*)_argBuf, (void*)arg._argBuf, _argN+1);
+        _args = _argBuf;
+    }
+    else
+        _args = arg._args;
+
+    arg._args = 0;
+    arg._argN = 0;
+}
+
+///-----------------------------------------------------------------------------
+///                 Managing memory for arguments                      [PRIVATE]
+///-----------------------------------------------------------------------------
+
+/**
+ * Get memory space for an array of arguments. If array fits into the internal
+ * buffer of this object, no memory is allocated.
+ * @param len size of array (in bytes)
+ * @return pointer to the memory space for arguments, 0 if there's no memory
+ */
+volatile uint8_t* TaskEntry::_ArgSpace(uint16_t len) volatile
+{
+    if (len <= TS_ARG_INLINE_SIZE)
+        return _argBuf;
+
+    return TS_ArgAlloc(len);
+}
+
+/**
+ * Get size of memory space currently used for arguments
+ * @return capacity of _args array (in bytes)
+ */
+uint16_t TaskEntry::_ArgCapacity() const volatile
+{
+    if (_args == _argBuf)
+        return TS_ARG_INLINE_SIZE;
+
+    return TS_ArgCapacity(_args);
+}
+
+/**
+ * Release memory space used for arguments, unless it's the internal buffer
+ */
+void TaskEntry::_FreeArgs() volatile
+{
+    if (_args != _argBuf)
+        TS_ArgFree(_args);
+    _args = 0;
+}
+
+/**
+ * Copy all members other than arguments from [arg] into this object
+ * @param arg object to copy members from
+ */
+void TaskEntry::_CopyMembers(const volatile TaskEntry& arg) volatile
 {
     _libuid = arg._libuid;
     _task = arg._task;
@@ -144,9 +256,63 @@ volatile TaskEntry& TaskEntry::operator= (volatile TaskEntry& arg) volatile
     _period = arg._period;
     _repeats = arg._repeats;
     _PID = arg._PID;
+    _prio = arg._prio;
+    _deadline = arg._deadline;
+    _suspended = arg._suspended;
+    _catchUp = arg._catchUp;
+    _release = arg._release;
     Perf = arg.Perf;
+}
 
-    _args = new uint8_t[_argN];
-    memcpy((void*)_args, (void*)(arg._args), _argN);
-    return (volatile TaskEntry&) *this;
+/**
+ * Make a deep copy of [arg], releasing arguments this object held before
+ * @note If there's no memory for arguments, copy is left without them
+ * @param arg object to copy
+ */
+void TaskEntry::_CopyFrom(const volatile TaskEntry& arg) volatile
+{
+    if (&arg == this)
+        return;
+
+    _FreeArgs();
+    _CopyMembers(arg);
+
+    _args = _ArgSpace(_argN+1);
+    if (_args == 0)
+    {
+        _argN = 0;
+        return;
+    }
+    if (_argN > 0)
+        memcpy((void*)_args, (void*)(arg._args), _argN);
+    _args[_argN] = 0;
+}
+
+///-----------------------------------------------------------------------------
+///                 Periodic release                                   [PRIVATE]
+///-----------------------------------------------------------------------------
+
+/**
+ * Apply catch-up policy to nominal release time of the next period. If the
+ * task is running so late that the next release (or more of them) is already
+ * due, those periods are dropped and the run in progress stands in for them,
+ * keeping the phase of the task. Bursting task instead executes up to
+ * TS_BURST_MAX of them back to back and drops only the older ones.
+ * @param now current time (in ms)
+ */
+void TaskEntry::_CatchUp(uint32_t now) volatile
+{
+    uint32_t period = labs(_period);
+    uint32_t keep = (_catchUp == T_CATCHUP_BURST) ? TS_BURST_MAX : 0;
+
+    if ((period == 0) || ((int32_t)(now - _release) < 0))
+        return;
+
+    //  Number of releases that are already due
+    uint32_t due = (now - _release) / period + 1;
+    if (due > keep)
+    {
+        _release += (due - keep) * period;
+        Perf.periodsSkipped += due - keep;
+    }
 }
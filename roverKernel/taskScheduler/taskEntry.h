@@ -7,9 +7,23 @@
 #ifndef ROVERKERNEL_TASKSCHEDULER_TASKENTRY_C_
 #define ROVERKERNEL_TASKSCHEDULER_TASKENTRY_C_
 
+#include "hwconfig.h"
 #include "libs/myLib.h"
 #include "tsProfiler.h"
 
+//  Priority classes of tasks. When more tasks are due at the same time, tasks
+//  of higher priority class are executed first
+#define T_PRIO_HIGH     0   //  Control loops, time-critical commands
+#define T_PRIO_NORMAL   1   //  Default priority class
+#define T_PRIO_LOW      2   //  Telemetry, bulk data transfer
+
+//  Catch-up policies of a periodic task that has fallen more than a period
+//  behind its nominal release times
+#define T_CATCHUP_SKIP  0   //  Missed periods are dropped (default)
+#define T_CATCHUP_BURST 1   //  Missed periods are executed back to back
+//  Most missed periods a bursting task executes, older ones are dropped
+#define TS_BURST_MAX    4
+
 /**
  * _taksEntry class - object wrapper for tasks handled by TaskScheduler class
  */
@@ -18,7 +32,9 @@ class TaskEntry
     // Functions & classes needing direct access to all members
     friend class TaskScheduler;
     friend void TS_GlobalCheck(void);
-    friend class LinkedList;
+    friend class TaskHeap;
+    friend class TaskWheel;
+    friend class TaskIndex;
     public:
         TaskEntry();
         TaskEntry(const TaskEntry& arg);
@@ -27,13 +43,18 @@ class TaskEntry
                   int32_t period = 0, int32_t repeats = 0);
         ~TaskEntry();
 
-        void        AddArg(void* arg, uint16_t argLen) volatile;
+        bool        AddArg(void* arg, uint16_t argLen) volatile;
+        void        MoveFrom(volatile TaskEntry& arg) volatile;
 
         uint8_t     GetLibUID() const volatile;
         uint8_t     GetTaskUID() const volatile;
         uint16_t    GetPID() const volatile;
         int32_t     GetPeriod() const volatile;
         uint32_t    GetTimeStamp() const volatile;
+        uint8_t     GetPriority() const volatile;
+        int32_t     GetDeadline() const volatile;
+
+        bool        DispatchBefore(const volatile TaskEntry& arg) const volatile;
 
                  TaskEntry& operator= (const TaskEntry& arg);
         volatile TaskEntry& operator= (const volatile TaskEntry& arg);
@@ -43,6 +64,13 @@ class TaskEntry
         Performance        Perf;
 
     protected:
+        volatile uint8_t*   _ArgSpace(uint16_t len) volatile;
+        uint16_t            _ArgCapacity() const volatile;
+        void                _FreeArgs() volatile;
+        void                _CopyMembers(const volatile TaskEntry& arg) volatile;
+        void                _CopyFrom(const volatile TaskEntry& arg) volatile;
+        void                _CatchUp(uint32_t now) volatile;
+
         //  Unique identifier for library to request service from
         volatile uint8_t    _libuid;
         //  Service ID to execute
@@ -51,9 +79,12 @@ class TaskEntry
         volatile uint16_t    _argN;
         //  Time at which to exec. service (in ms from start-up of task scheduler)
         volatile uint32_t   _timestamp;
-        //  Arguments used when calling service - array that is dynamically
-        //  allocated in AddArg function depending on the number of arguments
+        //  Arguments used when calling service - points either to _argBuf or
+        //  to array taken from argument pools, depending on the number of
+        //  arguments
         volatile uint8_t    *_args;
+        //  Internal storage for short argument lists (including null-terminator)
+        volatile uint8_t    _argBuf[TS_ARG_INLINE_SIZE];
         //  Period at which to execute this task (0 for non-periodic tasks)
         int32_t             _period;
         //  Number of times to repeat the task. When positive, defines how
@@ -62,6 +93,18 @@ class TaskEntry
         int32_t             _repeats;
         //  Unique process ID
         volatile uint16_t   _PID;
+        //  Priority class of the task (one of T_PRIO_* macros)
+        volatile uint8_t    _prio;
+        //  Time (in ms, relative to _timestamp) by which task has to be
+        //  executed. When 0, period is used as deadline for periodic tasks
+        int32_t             _deadline;
+        //  True while service has yielded and task is waiting to resume it
+        volatile bool       _suspended;
+        //  What to do with periods missed by periodic task (T_CATCHUP_*)
+        volatile uint8_t    _catchUp;
+        //  Nominal release time (in ms) of the next period of periodic task.
+        //  Periods are anchored to the first release, not to the actual start
+        volatile uint32_t   _release;
 };
 
 #endif /* ROVERKERNEL_TASKSCHEDULER_TASKENTRY_C_ */
@@ -0,0 +1,491 @@
+/**
+ * taskHeap.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran
+ */
+#include "taskHeap.h"
+#include "tsPool.h"
+#include "init/kernelContext.h"
+
+#if !defined(__TS_USE_TIMING_WHEEL__)  //  Compile only if heap is selected
+
+#ifdef __DEBUG_SESSION__
+#include "serialPort/uartHW.h"
+#endif
+
+/*******************************************************************************
+  *********         Task queue node - member functions                 *********
+ ******************************************************************************/
+_tqnode::_tqnode() : data(), _pos(0)
+{
+    _idx.pidNext = 0;
+    _idx.svcPrev = 0;
+    _idx.svcNext = 0;
+};
+
+/**
+ * Memory pool holding all nodes of the task queue of current kernel context
+ * @return reference to the pool
+ */
+MemPool& TS_NodePool()
+{
+    return *(KernelContext::Current().nodePool);
+}
+
+void* _tqnode::operator new(size_t size) throw()
+{
+    return TS_NodePool().Alloc(size);
+}
+
+void _tqnode::operator delete(void *ptr)
+{
+    TS_NodePool().Free(ptr);
+}
+
+
+/*******************************************************************************
+ *********          TaskHeap  member functions                         *********
+ ******************************************************************************/
+TaskHeap::TaskHeap() : _idle(0, 0, 0xFFFFFFFF), size(0), _seqCount(0),
+                       _pidCount(1) {}
+
+TaskHeap::~TaskHeap()
+{
+    //  Delete any data in the queue when it goes out of scope
+    if (size > 0)
+        Drop();
+}
+
+/**
+ * Add argument into the heap by keeping it sorted. Heap is sorted in an
+ * ascending order by the TaskEntry._timestamp parameter. Essentially tasks
+ * that need to executed sooner are closer to the root of the heap.
+ * @note If new task has same _timestamp value (time to be executed at) as the
+ * task already in the queue, new task is executed after the existing one
+ * @note Arguments of [arg] are moved into the queue, [arg] is left without them
+ * @param arg task to add to the queue
+ * @return pointer to the instance of task inside the queue, 0 if queue is full
+ */
+volatile _tqnode* TaskHeap::AddSort(TaskEntry &arg) volatile
+{
+    //  Check if there's space left in the heap array
+    if (size >= TS_MAX_TASKS)
+        return 0;
+
+    _tqnode *tmp = NewNode(arg);
+    if (tmp == 0)
+        return 0;
+
+    PushNode(tmp);
+
+    return tmp;
+}
+
+/**
+ * Create a node holding a given task, without putting it into the heap
+ * Task gets a new PID unless it already has one
+ * @note Arguments of [arg] are moved into the node, [arg] is left without them
+ * @param arg task to place in the node
+ * @return new node, 0 if node pool is empty
+ */
+_tqnode* TaskHeap::NewNode(TaskEntry &arg) volatile
+{
+    _tqnode *tmp = new _tqnode();       //  Take new node from the node pool
+    if (tmp == 0)
+        return 0;
+
+    tmp->data.MoveFrom(arg);
+
+    //  Update PID of a task -> only if it doesn't already have one
+    if (tmp->data._PID == 0)
+    {
+        tmp->data._PID = _pidCount;
+        _pidCount++;
+    }
+
+    return tmp;
+}
+
+/**
+ * Find and delete from the queue a task passed as an argument
+ * @note task in arg has valid libUID, taskID and arguments
+ * @param arg
+ * @return true if task was found and deleted, false otherwise
+ */
+bool TaskHeap::RemoveEntry(TaskEntry &arg) volatile
+{
+    //  Only tasks requesting the same service need to be compared
+    _tqnode *node = _index.Find(arg);
+
+    //  Node wasn't found in the queue, return false
+    if (node == 0)
+        return false;
+
+    delete _Detach(node->_pos);
+    return true;
+}
+
+/**
+ * Find and delete from the queue a task with given PID
+ * @param PIDarg PID of task to delete
+ * @return true if task was found and deleted, false otherwise
+ */
+bool TaskHeap::RemoveEntry(uint16_t PIDarg) volatile
+{
+    _tqnode *node = _index.Find(PIDarg);
+
+    //  Node wasn't found in the queue, return false
+    if (node == 0)
+        return false;
+
+    delete _Detach(node->_pos);
+    return true;
+}
+
+
+/**
+ * Delete content of the queue.
+ * Traverses all nodes in the heap and returns them to the node pool.
+ * @return false: success
+ *          true: otherwise
+ */
+bool TaskHeap::Drop() volatile
+{
+    //  Check if queue is already empty
+    if (TaskHeap::IsEmpty())
+        return false;
+
+    _index.Clear();
+
+    //  Delete node by node, order doesn't matter here
+    while (size > 0)
+    {
+        size--;
+        delete _heap[size].node;
+        _heap[size].node = 0;
+    }
+    return (size != 0);
+}
+
+/**
+ * Take node of the task to execute next out of the queue without releasing it.
+ * Out of all tasks that are due, the one with the highest priority class and
+ * earliest deadline is taken (see TaskEntry::DispatchBefore()). Node can be put
+ * back into the queue with PushNode() or released with FreeNode()
+ * @param now current time (in ms)
+ * @return node of the task to execute, 0 if no task is due
+ */
+_tqnode* TaskHeap::PopNode(uint32_t now) volatile
+{
+    //  Check if there's any task due
+    if (TaskHeap::IsEmpty() || !_Due(0, now))
+        return 0;
+
+    //  Due tasks form a subtree at the root of the heap (children of a task
+    //  that's not due can't be due either), so only that subtree is searched
+    uint16_t *stack = (uint16_t*)_walk, top = 0, best = 0;
+
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        uint16_t index = stack[--top],
+                 left = 2 * index + 1,
+                 right = 2 * index + 2;
+
+        if (!_Due(index, now))
+            continue;
+
+        if (_DispatchFirst(index, best))
+            best = index;
+
+        if (left < size)
+            stack[top++] = left;
+        if (right < size)
+            stack[top++] = right;
+    }
+
+    //  Remove selected node from the heap and restore heap property
+    return _Detach(best);
+}
+
+/**
+ * Count tasks that are due but haven't been executed yet
+ * @param now current time (in ms)
+ * @param oldest [out] time stamp of the oldest due task, [now] if none is due
+ * @return number of due tasks
+ */
+uint16_t TaskHeap::CountDue(uint32_t now, uint32_t &oldest) volatile
+{
+    uint16_t *stack = (uint16_t*)_walk, top = 0, count = 0;
+
+    oldest = now;
+    if (TaskHeap::IsEmpty() || !_Due(0, now))
+        return 0;
+
+    //  Root is the oldest task, due tasks form a subtree at the root
+    oldest = _heap[0].timestamp;
+
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        uint16_t index = stack[--top],
+                 left = 2 * index + 1,
+                 right = 2 * index + 2;
+
+        if (!_Due(index, now))
+            continue;
+
+        count++;
+        if (left < size)
+            stack[top++] = left;
+        if (right < size)
+            stack[top++] = right;
+    }
+
+    return count;
+}
+
+/**
+ * Put existing node into the queue, sorted by its time stamp. Node is treated
+ * as newly added when resolving ties in time stamp.
+ * @param node node to insert (not a member of the queue)
+ * @return true if node was inserted, false if queue is full
+ */
+bool TaskHeap::PushNode(_tqnode *node) volatile
+{
+    //  Check if there's space left in the heap array
+    if (size >= TS_MAX_TASKS)
+        return false;
+
+    //  Place node at the bottom of the heap and sift it up to its place
+    _heap[size].timestamp = node->data._timestamp;
+    _heap[size].seq = _seqCount++;
+    _heap[size].node = node;
+    node->_pos = size;
+    size++;
+
+    _index.Insert(node);
+    _SiftUp(size - 1);
+
+    return true;
+}
+
+/**
+ * Put a group of nodes into the heap at once. Nodes are placed at the bottom of
+ * the heap in the given order and heap property is then restored either by
+ * sifting each of them up, or by rebuilding the whole heap when that takes
+ * fewer steps (many nodes added to a small heap).
+ * @note Nodes are added either all or none
+ * @param nodes array of nodes to insert (not members of the queue)
+ * @param num number of nodes in [nodes]
+ * @return true if nodes were inserted, false if there's not enough space
+ */
+bool TaskHeap::PushBatch(_tqnode **nodes, uint16_t num) volatile
+{
+    //  Check if there's space left in the heap array for all nodes
+    if ((size + num) > TS_MAX_TASKS)
+        return false;
+
+    uint16_t first = size;
+
+    for (uint16_t i = 0; i < num; i++)
+    {
+        _heap[size].timestamp = nodes[i]->data._timestamp;
+        _heap[size].seq = _seqCount++;
+        _heap[size].node = nodes[i];
+        nodes[i]->_pos = size;
+        size++;
+
+        _index.Insert(nodes[i]);
+    }
+
+    //  Sifting up costs up to log2(size) steps per node, rebuilding the heap
+    //  is linear in its size
+    uint16_t depth = 0;
+    while ((1UL << depth) < size)
+        depth++;
+
+    if (((uint32_t)num * depth) > (2 * size))
+        _Heapify();
+    else
+        for (uint16_t i = first; i < size; i++)
+            _SiftUp(i);
+
+    return true;
+}
+
+/**
+ * Return node stored at a given position of the heap array
+ * @note Heap array is only partially sorted; iterating with increasing index
+ * visits every pending task once, but not necessarily in order of execution
+ * @param index position in the heap array
+ * @return pointer to the node at [index], 0 if index is out of boundaries
+ */
+volatile _tqnode* TaskHeap::PeekAt(uint32_t index) volatile
+{
+    if (index >= size)
+        return 0;
+
+    return _heap[index].node;
+}
+
+///-----------------------------------------------------------------------------
+///                      Heap maintenance                              [PRIVATE]
+///-----------------------------------------------------------------------------
+
+/**
+ * Remove node from a given position in the heap array (doesn't free its memory).
+ * Last node in the heap is moved into the empty slot and sifted to its place
+ * @param index position of the node in heap array
+ * @return removed node
+ */
+_tqnode* TaskHeap::_Detach(uint16_t index) volatile
+{
+    _tqnode *retVal = _heap[index].node;
+    _index.Remove(retVal);
+    size--;
+
+    //  Removed the last slot, nothing to rebalance
+    if (index == size)
+    {
+        _heap[size].node = 0;
+        return retVal;
+    }
+
+    //  Move last node into the free slot
+    _heap[index].timestamp = _heap[size].timestamp;
+    _heap[index].seq = _heap[size].seq;
+    _heap[index].node = _heap[size].node;
+    _heap[index].node->_pos = index;
+    _heap[size].node = 0;
+
+    //  Moved node might belong either above or below its new position
+    if ((index > 0) && _Less(index, (index - 1) / 2))
+        _SiftUp(index);
+    else
+        _SiftDown(index);
+
+    return retVal;
+}
+
+/**
+ * Restore heap property of the whole heap array, bottom-up
+ */
+void TaskHeap::_Heapify() volatile
+{
+    for (uint16_t i = size / 2; i > 0; i--)
+        _SiftDown(i - 1);
+}
+
+/**
+ * Move node at [index] towards the root until its parent is smaller than it
+ * @param index position of the node in heap array
+ */
+void TaskHeap::_SiftUp(uint16_t index) volatile
+{
+    while (index > 0)
+    {
+        uint16_t parent = (index - 1) / 2;
+
+        if (!_Less(index, parent))
+            break;
+
+        _Swap(index, parent);
+        index = parent;
+    }
+}
+
+/**
+ * Move node at [index] towards the leaves until both its children are bigger
+ * @param index position of the node in heap array
+ */
+void TaskHeap::_SiftDown(uint16_t index) volatile
+{
+    while (true)
+    {
+        uint16_t smallest = index,
+                 left = 2 * index + 1,
+                 right = 2 * index + 2;
+
+        if ((left < size) && _Less(left, smallest))
+            smallest = left;
+        if ((right < size) && _Less(right, smallest))
+            smallest = right;
+
+        if (smallest == index)
+            break;
+
+        _Swap(index, smallest);
+        index = smallest;
+    }
+}
+
+/**
+ * Compare two slots of the heap array
+ * Slots are compared by their time stamp, in case of a tie the one added first
+ * is considered smaller (FIFO). Both are compared in a way that survives their
+ * overflow (same as in TaskEntry::DispatchBefore()).
+ * @return true if slot [a] needs to be executed before slot [b]
+ */
+bool TaskHeap::_Less(uint16_t a, uint16_t b) volatile
+{
+    if (_heap[a].timestamp != _heap[b].timestamp)
+        return ((int32_t)(_heap[a].timestamp - _heap[b].timestamp) < 0);
+
+    return ((int32_t)(_heap[a].seq - _heap[b].seq) < 0);
+}
+
+/**
+ * Check whether task in a slot of the heap array is due, in a way that survives
+ * overflow of time stamps
+ * @param index position of the slot in heap array
+ * @param now current time (in ms)
+ * @return true if task had to be executed by [now]
+ */
+bool TaskHeap::_Due(uint16_t index, uint32_t now) volatile
+{
+    return ((int32_t)(_heap[index].timestamp - now) <= 0);
+}
+
+/**
+ * Compare two due tasks in the heap array
+ * Tasks are compared by TaskEntry::DispatchBefore(), if it can't decide the
+ * one that would be executed first by the time stamp is taken.
+ * @return true if task in slot [a] should be dispatched before task in slot [b]
+ */
+bool TaskHeap::_DispatchFirst(uint16_t a, uint16_t b) volatile
+{
+    volatile TaskEntry &taskA = _heap[a].node->data,
+                       &taskB = _heap[b].node->data;
+
+    if (taskA.DispatchBefore(taskB))
+        return true;
+    if (taskB.DispatchBefore(taskA))
+        return false;
+
+    return _Less(a, b);
+}
+
+/**
+ * Swap content of two slots in the heap array
+ */
+void TaskHeap::_Swap(uint16_t a, uint16_t b) volatile
+{
+    uint32_t timestamp = _heap[a].timestamp,
+             seq = _heap[a].seq;
+    _tqnode  *node = _heap[a].node;
+
+    _heap[a].timestamp = _heap[b].timestamp;
+    _heap[a].seq = _heap[b].seq;
+    _heap[a].node = _heap[b].node;
+
+    _heap[b].timestamp = timestamp;
+    _heap[b].seq = seq;
+    _heap[b].node = node;
+
+    _heap[a].node->_pos = a;
+    _heap[b].node->_pos = b;
+}
+
+#endif  /* !__TS_USE_TIMING_WHEEL__ */
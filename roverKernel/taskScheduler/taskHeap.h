@@ -0,0 +1,203 @@
+/**
+ * taskHeap.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ *
+ *  Priority queue of pending tasks, implemented as a binary min-heap. Replaces
+ *  the sorted doubly-linked list which required walking the whole list on every
+ *  insert (with interrupts disabled). Heap keeps the same ordering as the list:
+ *  ascending by task time stamp, and tasks sharing the same time stamp are
+ *  executed in the order they were added (FIFO).
+ */
+#include "hwconfig.h"
+
+//  Compile following section only if hwconfig.h doesn't select timing wheel
+#if !defined(ROVERKERNEL_TASKSCHEDULER_TASKHEAP_H_) \
+    && !defined(__TS_USE_TIMING_WHEEL__)
+#define ROVERKERNEL_TASKSCHEDULER_TASKHEAP_H_
+
+#include "taskEntry.h"
+#include "tsIndex.h"
+
+/**
+ * Node holding a single task (of type TaskEntry) in the task queue
+ * Nodes are allocated once when task is added and don't move in memory for as
+ * long as task is pending, which allows task scheduler to keep a pointer to
+ * the last added task (to append arguments to it). Only pointers to the nodes
+ * get shuffled around inside the heap.
+ * All member functions & constructors are private as this class shouldn't be
+ * used outside the TaskScheduler object
+ */
+class _tqnode
+{
+    friend class TaskHeap;
+    friend class TaskIndex;
+    friend class TaskScheduler;
+    friend void TS_GlobalCheck(void);
+
+    private:
+        _tqnode();
+
+        //  Nodes are allocated from a memory pool, see TS_NodePool()
+        static void*    operator new(size_t size) throw();
+        static void     operator delete(void *ptr);
+
+        volatile TaskEntry   data;
+        _tsIndexLink    _idx;   //  Links into index of pending tasks
+        uint16_t        _pos;   //  Position of the node in the heap array
+};
+
+/**
+ * Single slot of the heap array
+ * Sorting keys are duplicated from the node into the slot so that comparisons
+ * while sifting only touch the contiguous heap array, not the nodes themselves
+ */
+struct _heapSlot
+{
+    uint32_t    timestamp;  //  Time at which to execute the task
+    uint32_t    seq;        //  Insertion order, resolves ties in timestamp
+    _tqnode     *node;      //  Node with task data
+};
+
+/**
+ * Binary min-heap of TaskEntry objects
+ * Array-based priority queue of TaskEntry objects sorted by their time stamp.
+ * Insertion, removal of the first element and removal of an arbitrary element
+ * are all O(log n). Tasks are found through an index (see tsIndex.h), each node
+ * knows its position in the heap array. Used only in TaskScheduler class to keep
+ * all pending task requests ergo everything is private.
+ */
+class TaskHeap
+{
+    friend class TaskScheduler;
+    friend void TS_GlobalCheck(void);
+
+    public:
+        ~TaskHeap();
+    private:
+        TaskHeap();
+
+        volatile _tqnode*   AddSort(TaskEntry &arg) volatile;
+        _tqnode*            NewNode(TaskEntry &arg) volatile;
+        bool                PushBatch(_tqnode **nodes, uint16_t num) volatile;
+        bool                RemoveEntry(TaskEntry &arg) volatile;
+        bool                RemoveEntry(uint16_t PIDarg) volatile;
+        bool                Drop() volatile;
+        _tqnode*            PopNode(uint32_t now) volatile;
+        bool                PushNode(_tqnode *node) volatile;
+        volatile _tqnode*   PeekAt(uint32_t index) volatile;
+        uint16_t            CountDue(uint32_t now, uint32_t &oldest) volatile;
+
+        _tqnode*            _Detach(uint16_t index) volatile;
+        void                _Heapify() volatile;
+        void                _SiftUp(uint16_t index) volatile;
+        void                _SiftDown(uint16_t index) volatile;
+        bool                _Less(uint16_t a, uint16_t b) volatile;
+        bool                _Due(uint16_t index, uint32_t now) volatile;
+        bool                _DispatchFirst(uint16_t a, uint16_t b) volatile;
+        void                _Swap(uint16_t a, uint16_t b) volatile;
+
+        ///---------------------------------------------------------------------
+        ///                      Inline functions                       [PUBLIC]
+        ///---------------------------------------------------------------------
+        /**
+         * Check whether the task queue is empty
+         * @return true: queue is empty
+         *        false: queue contains data
+         */
+        inline bool IsEmpty() volatile
+        {
+            return (size == 0);
+        }
+        /**
+         * Returns reference to the ->data content of first element of the queue
+         * but it remains in the queue (it's not taken out as with PopNode)
+         * @note If queue is empty, returns a placeholder task with time stamp
+         * far in the future
+         * @return reference to ->data content of first object of the queue
+         */
+        inline volatile TaskEntry& PeekFront() volatile
+        {
+            if (IsEmpty())
+                return _idle;
+
+            return _heap[0].node->data;
+        }
+        /**
+         * Move time of the queue forward. Heap is always fully sorted so there's
+         * nothing to do here, kept for compatibility with TaskWheel
+         * @param now current time (in ms)
+         */
+        inline void Advance(uint32_t /*now*/) volatile {}
+        /**
+         * Get time stamp of the task that's due first, used to decide how long
+         * task scheduler can sleep for
+         * @param timestamp [out] time stamp of the first task
+         * @return true if queue contains tasks, false if it's empty
+         */
+        inline bool NextDue(uint32_t &timestamp) volatile
+        {
+            if (IsEmpty())
+                return false;
+
+            timestamp = _heap[0].timestamp;
+            return true;
+        }
+        /**
+         * Release node previously taken out of the queue by PopNode()
+         * @param node node to release
+         */
+        inline void FreeNode(_tqnode *node) volatile
+        {
+            delete node;
+        }
+        /**
+         * Find pending task with a given PID
+         * @param PIDarg PID of the task
+         * @return pointer to the node of the task, 0 if it's not in the queue
+         */
+        inline volatile _tqnode* Find(uint16_t PIDarg) volatile
+        {
+            return _index.Find(PIDarg);
+        }
+        /**
+         * Find any pending task requesting a given service
+         * @return pointer to the node of the task, 0 if there's none
+         */
+        inline volatile _tqnode* FindService(uint8_t libUID,
+                                             uint8_t taskID) volatile
+        {
+            return _index.FindService(libUID, taskID);
+        }
+        /**
+         * Find another pending task equivalent to the one in [node]
+         * @return pointer to the node of the task, 0 if there's none
+         */
+        inline _tqnode* FindEquivalent(_tqnode *node, uint16_t keyLen) volatile
+        {
+            return _index.FindEquivalent(node, keyLen);
+        }
+
+    private:
+        //  Heap array, _heap[0] holds the task to be executed first
+        volatile _heapSlot   _heap[TS_MAX_TASKS];
+        //  Index of tasks in the heap by their PID and service
+        volatile TaskIndex   _index;
+        //  Placeholder returned by PeekFront() when heap is empty
+        volatile TaskEntry   _idle;
+        //  Stack for walking the subtree of due tasks (PopNode(), CountDue()),
+        //  kept here so that it isn't on the stack of every TS_GlobalCheck
+        //  call. Only used with interrupts disabled
+        uint16_t             _walk[TS_MAX_TASKS];
+        volatile uint32_t    size;
+        //  Ever increasing counter, used to keep FIFO order of tasks with the
+        //  same time stamp
+        volatile uint32_t    _seqCount;
+        //  Ever increasing variable, counts number of created tasks in order to
+        //  uniquely identify each task (never decreases, overflows at 65536)
+        volatile uint16_t    _pidCount;
+};
+
+
+#endif /* ROVERKERNEL_TASKSCHEDULER_TASKHEAP_H_ */
@@ -28,94 +28,78 @@
 #endif
 
 /**
- * Callback vector for all available kernel modules
- * Once a new kernel module is initialized it has a possibility to register its
- * service in task scheduler by providing designated callback function to be
- * called when requesting a service, and memory space for arguments to be
- * transfered to module when requesting a service
+ * Register services of a kernel module
+ * Once a kernel module is initialized it registers a constant table of the
+ * services it provides (see tsService.h) with the current kernel context.
+ * Tasks requesting a module without a table are dropped.
+ * @param uid Unique identifier of kernel module, has to be smaller than
+ * NUM_OF_MODULES
+ * @param services table of services, indexed by service ID
+ * @param num number of services in the table
  */
-static volatile struct _kernelEntry *__kernelVector[NUM_OF_MODULES] = {0};
+void TS_RegServices(uint8_t uid, const _tsService *services, uint8_t num)
+{
+    if (uid >= NUM_OF_MODULES)
+        return;
 
+    KernelContext::Current().services[uid].services = services;
+    KernelContext::Current().services[uid].num = num;
+}
 
 /**
- * Register services for a kernel modules into a callback vector
- * @param arg structure with parameters for callback action
- * @param uid Unique identifier of kernel module
+ * Get PID of the task being executed (used by coroutines to tell which task
+ * is resuming them)
+ * @return PID of the task, 0 when called outside of task execution
  */
-void TS_RegCallback(struct _kernelEntry *arg, uint8_t uid)
+uint16_t TS_CurrentPID(void)
 {
-    __kernelVector[uid] = arg;
+    return KernelContext::Current().curPID;
 }
 
 //  Function prototype of an interrupt handler counting milliseconds since
 //  startup(declared at the bottom)
 void _TSSyncCallback();
 
+///-----------------------------------------------------------------------------
+///                      Services provided to other modules          [PRIVATE]
+///-----------------------------------------------------------------------------
+
 /**
- * Callback routine to invoke service offered by this module from task scheduler
- * @note It is assumed that once this function is called task scheduler has
- * already copied required variables into the memory space provided for it.
+ * Services offered by task scheduler, in the order of TASKSCHED_T_* IDs
  */
-void _TS_KernelCallback(void)
+const _tsService TaskScheduler::_services[] =
 {
-    volatile TaskScheduler  &__ts = TaskScheduler::GetI();
-
-    //  Check for null-pointer
-    if (__ts._ker.args == 0)
-        return;
-
-    /*
-     *  Data in args[] contains bytes that constitute arguments for function
-     *  calls. The exact representation(i.e. whether bytes represent ints, floats)
-     *  of data is known only to individual blocks of switch() function. There
-     *  is no predefined data separator between arguments inside args[].
-     */
-    switch (__ts._ker.serviceID)
-    {
-    /*
-     *  Enable/disable time ticking on internal timer
-     *  args[] = enable(bool)
-     *  retVal on of myLib.h STATUS_* macros
-     */
-    case TASKSCHED_T_ENABLE:
-        {
-            bool enable = (__ts._ker.args[0] == 1);
-
-            if (enable)
-                HAL_TS_StartSysTick();
-            else
-                HAL_TS_StopSysTick();
+    //  TASKSCHED_T_ENABLE
+    TS_SERVICE1(TaskScheduler, uint32_t, _Enable, bool),
+    //  TASKSCHED_T_KILL
+    TS_SERVICE1(TaskScheduler, uint32_t, _Kill, uint16_t)
+};
 
-            __ts._ker.retVal = STATUS_OK;
-        }
-        break;
-    /*
-     *  Delete task by its PID
-     *  args[] = taskPID(uint16_t)
-     *  retVal on of myLib.h STATUS_* macros
-     */
-    case TASKSCHED_T_KILL:
-        {
-            uint16_t PIDarg;
-
-            memcpy(&PIDarg, __ts._ker.args, sizeof(uint16_t));
+/**
+ * Enable/disable time ticking on internal timer
+ * @param enable true to start the timer, false to stop it
+ * @return STATUS_OK
+ */
+uint32_t TaskScheduler::_Enable(bool enable)
+{
+    if (enable)
+        HAL_TS_StartSysTick();
+    else
+        HAL_TS_StopSysTick();
 
-            __ts.RemoveTask(PIDarg);
+    return STATUS_OK;
+}
 
-            __ts._ker.retVal = STATUS_OK;
-        }
-        break;
-    default:
-        break;
-    }
+/**
+ * Delete task by its PID
+ * @param PIDarg PID of the task to delete
+ * @return STATUS_OK
+ */
+uint32_t TaskScheduler::_Kill(uint16_t PIDarg)
+{
+    RemoveTask(PIDarg);
 
-    //  Check return-value and emit event based on it
-#ifdef __HAL_USE_EVENTLOG__
-    if (__ts._ker.retVal == STATUS_OK)
-        EMIT_EV(__ts._ker.serviceID, EVENT_OK);
-    else
-        EMIT_EV(__ts._ker.serviceID, EVENT_ERROR);
-#endif  /* __HAL_USE_EVENTLOG__ */
+    return STATUS_OK;
 }
 
 ///-----------------------------------------------------------------------------
@@ -124,12 +108,11 @@ void _TS_KernelCallback(void)
 
 /**
  * Return reference to a singleton
- * @return reference to an internal static instance
+ * @return reference to the instance owned by current kernel context
  */
- volatile TaskScheduler& TaskScheduler::GetI()
+volatile TaskScheduler& TaskScheduler::GetI()
 {
-    static volatile TaskScheduler singletonInstance;
-    return singletonInstance;
+    return *(KernelContext::Current().taskSch);
 }
 
 /**
@@ -152,7 +135,10 @@ volatile TaskScheduler* TaskScheduler::GetP()
  */
 bool TaskScheduler::ValidKernModule(uint8_t libUID)
 {
-    return (__kernelVector[libUID] != 0);
+    if (libUID >= NUM_OF_MODULES)
+        return false;
+
+    return (KernelContext::Current().services[libUID].services != 0);
 }
 
 /**
@@ -168,13 +154,23 @@ void TaskScheduler::InitHW(uint32_t timeStepMS) volatile
     EMIT_EV(-1, EVENT_STARTUP);
 #endif  /* __HAL_USE_EVENTLOG__ */
 
+    //  Initialize time base with microsecond resolution
+    HAL_TS_InitTimeBase();
+#if defined(__TS_TICKLESS__)
+    //  Initialize timer waking up the scheduler when the next task is due. It's
+    //  only armed when going idle, so sleeping is enabled by default
+    HAL_TS_InitWakeup(_TSSyncCallback);
+    _idleHook = HAL_TS_Sleep;
+    //  Time is read from time base, there's no fixed time step
+    (void)timeStepMS;
+#else
     //  Initialize & start systick => keeps internal time reference
     HAL_TS_InitSysTick(timeStepMS, _TSSyncCallback);
     HAL_TS_StartSysTick();
+#endif
 
     //  Register module services with task scheduler
-    _ker.callBackFunc = _TS_KernelCallback;
-    TS_RegCallback((struct _kernelEntry*)&_ker, TASKSCHED_UID);
+    TS_RegServices(TASKSCHED_UID, TS_SERVICES(_services));
 
 #ifdef __HAL_USE_EVENTLOG__
     EMIT_EV(-1, EVENT_INITIALIZED);
@@ -191,14 +187,14 @@ void TaskScheduler::InitHW(uint32_t timeStepMS) volatile
 void TaskScheduler::Reset() volatile
 {
     //  Sensitive task, disable all interrupts
-    HAL_BOARD_InterruptEnable(false);
+    bool intState = HAL_BOARD_InterruptSuspend();
 
     //  If Drop() return true, there was an error deleting tasks
     if (_taskLog.Drop())
         EMIT_EV(-1, EVENT_ERROR);
 
-    //  Sensitive task done, enable interrupts again
-    HAL_BOARD_InterruptEnable(true);
+    //  Sensitive task done, restore interrupts to their previous state
+    HAL_BOARD_InterruptRestore(intState);
 }
 
 /**
@@ -214,24 +210,26 @@ uint32_t TaskScheduler::NumOfTasks() volatile
  * This is implemented solely for the purpose of printing out task in task
  * scheduler. First call should be made with argument true and all consecutive
  * calls with arg false in order to get all tasks on the list out.
- * @param fromStart True to start returning from head of linked list, false to
+ * @note Tasks are returned in the order they're stored in the heap array, which
+ * is not necessarily the order in which they will be executed
+ * @param fromStart True to start returning from root of the heap, false to
  * return next element
- * @return TaskEntry element from the list; index corresponds to a number of
+ * @return TaskEntry element from the queue; index corresponds to a number of
  * calls to this function since last fromStart was 'true'. If index is out of
  * boundaries, 0 (check for null pointer on exit)
  */
 const TaskEntry* TaskScheduler::FetchNextTask(bool fromStart) volatile
 {
-    static _llnode *task = 0;
+    volatile _tqnode *task;
 
-
-    //
     if (fromStart)
-        task = (_llnode*)(_taskLog.head);
-    else if (task->_next != 0)
-        task = (_llnode*)(task->_next);
-//    else
-//        return 0;
+        _fetchIndex = 0;
+    else
+        _fetchIndex++;
+
+    task = _taskLog.PeekAt(_fetchIndex);
+    if (task == 0)
+        return 0;
 
     return (TaskEntry*)(&(task->data));
 }
@@ -255,7 +253,7 @@ void TaskScheduler::SyncTask(uint8_t libUID, uint8_t taskID,
                              int64_t time, bool periodic, int32_t rep) volatile
 {
     //  Sensitive task, disable all interrupts
-    HAL_BOARD_InterruptEnable(false);
+    bool intState = HAL_BOARD_InterruptSuspend();
 
     int32_t period = (int32_t)time;
     /*
@@ -280,6 +278,15 @@ void TaskScheduler::SyncTask(uint8_t libUID, uint8_t taskID,
         volatile uint32_t siz = _taskLog.size;
 #endif
     _lastIndex = _taskLog.AddSort(teTemp);
+    if (_lastIndex != 0)
+        TS_TRACE(TR_SYNC, libUID, taskID, _lastIndex->data._PID, 0);
+    _lastRule = _FindRule(libUID, taskID);
+    _Coalesce();
+    //  Task queue is full, task couldn't be added
+#ifdef __HAL_USE_EVENTLOG__
+    if (_lastIndex == 0)
+        EMIT_EV(-1, EVENT_ERROR);
+#endif  /* __HAL_USE_EVENTLOG__ */
 #if defined(__DEBUG_SESSION2__)
         if ((_taskLog.size-siz) != 1)
         {
@@ -301,8 +308,8 @@ void TaskScheduler::SyncTask(uint8_t libUID, uint8_t taskID,
             EMIT_EV(-1, EVENT_ERROR);
         }
 #endif
-        //  Sensitive task done, enable interrupts again
-        HAL_BOARD_InterruptEnable(true);
+        //  Sensitive task done, restore interrupts to their previous state
+        HAL_BOARD_InterruptRestore(intState);
 }
 
 /**
@@ -318,12 +325,17 @@ void TaskScheduler::SyncTask(uint8_t libUID, uint8_t taskID,
  * @param rep repeat counter. Number of times to repeat the periodic task before
  * killing it. Set to a negative number for indefinite repeat. When scheduled,
  * task WILL BE repeated at least once.
+ * @param prio priority class of the task (T_PRIO_HIGH, T_PRIO_NORMAL or
+ * T_PRIO_LOW), decides which task is executed first when more tasks are due
+ * @param deadline time (in ms) after the time-stamp by which task has to finish
+ * its execution. If 0, period of the task is used as its deadline
  */
 void TaskScheduler::SyncTaskPer(uint8_t libUID, uint8_t taskID, int64_t time,
-                      int32_t period, int32_t rep) volatile
+                      int32_t period, int32_t rep, uint8_t prio,
+                      int32_t deadline) volatile
 {
     //  Sensitive task, disable all interrupts
-    HAL_BOARD_InterruptEnable(false);
+    bool intState = HAL_BOARD_InterruptSuspend();
     /*
      * If time is a positive number it represent time in milliseconds from
      * start-up of the microcontroller. If time is a negative number or 0 it
@@ -342,10 +354,21 @@ void TaskScheduler::SyncTaskPer(uint8_t libUID, uint8_t taskID, int64_t time,
     //  Save pointer to newly added task so additional arguments can be appended
     //  to it through AddArgs function call
     TaskEntry teTemp(libUID, taskID, time, period, rep);
+    teTemp._prio = prio;
+    teTemp._deadline = deadline;
 #if defined(__DEBUG_SESSION2__)
         volatile uint32_t siz = _taskLog.size;
 #endif
     _lastIndex = _taskLog.AddSort(teTemp);
+    if (_lastIndex != 0)
+        TS_TRACE(TR_SYNC, libUID, taskID, _lastIndex->data._PID, 0);
+    _lastRule = _FindRule(libUID, taskID);
+    _Coalesce();
+    //  Task queue is full, task couldn't be added
+#ifdef __HAL_USE_EVENTLOG__
+    if (_lastIndex == 0)
+        EMIT_EV(-1, EVENT_ERROR);
+#endif  /* __HAL_USE_EVENTLOG__ */
 #if defined(__DEBUG_SESSION2__)
         if ((_taskLog.size-siz) != 1)
         {
@@ -367,8 +390,8 @@ void TaskScheduler::SyncTaskPer(uint8_t libUID, uint8_t taskID, int64_t time,
             EMIT_EV(-1, EVENT_ERROR);
         }
 #endif
-        //  Sensitive task done, enable interrupts again
-        HAL_BOARD_InterruptEnable(true);
+        //  Sensitive task done, restore interrupts to their previous state
+        HAL_BOARD_InterruptRestore(intState);
 }
 
 /**
@@ -376,12 +399,13 @@ void TaskScheduler::SyncTaskPer(uint8_t libUID, uint8_t taskID, int64_t time,
  * need to be executed sooner appear at the beginning of the list. If new task
  * has the same execution time as the task already in the list, it's placed
  * behind the existing task.
- * @param te TaskEntry object to add the the list
+ * @param te TaskEntry object to add the the list, its arguments are moved into
+ * the list (not copied) and [te] is left without them
  */
-void TaskScheduler::SyncTask(TaskEntry te) volatile
+void TaskScheduler::SyncTask(TaskEntry &te) volatile
 {
     //  Sensitive task, disable all interrupts
-    HAL_BOARD_InterruptEnable(false);
+    bool intState = HAL_BOARD_InterruptSuspend();
 
 #if defined(__DEBUG_SESSION2__)
         volatile uint32_t siz = _taskLog.size;
@@ -389,6 +413,15 @@ void TaskScheduler::SyncTask(TaskEntry te) volatile
         //  Save pointer to newly added task so additional arguments can be
         //  appended to it through AddArgs function call
         _lastIndex = _taskLog.AddSort(te);
+        if (_lastIndex != 0)
+            TS_TRACE(TR_SYNC, te._libuid, te._task, _lastIndex->data._PID, 0);
+        _lastRule = _FindRule(te._libuid, te._task);
+        _Coalesce();
+        //  Task queue is full, task couldn't be added
+#ifdef __HAL_USE_EVENTLOG__
+        if (_lastIndex == 0)
+            EMIT_EV(-1, EVENT_ERROR);
+#endif  /* __HAL_USE_EVENTLOG__ */
 #if defined(__DEBUG_SESSION2__)
         if ((_taskLog.size-siz) != 1)
         {
@@ -410,8 +443,116 @@ void TaskScheduler::SyncTask(TaskEntry te) volatile
             EMIT_EV(-1, EVENT_ERROR);
         }
 #endif
-        //  Sensitive task done, enable interrupts again
-        HAL_BOARD_InterruptEnable(true);
+        //  Sensitive task done, restore interrupts to their previous state
+        HAL_BOARD_InterruptRestore(intState);
+}
+
+/**
+ * Add all tasks from a batch to the task list, within a single critical section
+ * Time stamp, period, repeats, priority and deadline of each task are treated
+ * the same way as in SyncTaskPer(). Relative time stamps are relative to the
+ * moment batch is added, so tasks in the batch keep their offsets.
+ * @note Batch is added either as a whole or not at all. Arguments can't be
+ * appended with AddArgs() after this call.
+ * @param batch tasks to add
+ * @return true if all tasks were added, false if none were (batch is invalid,
+ * task queue or memory pools don't have enough space)
+ */
+bool TaskScheduler::SyncBatch(const TaskBatch &batch) volatile
+{
+    _tqnode *nodes[TS_BATCH_SIZE];
+    uint8_t num = 0;
+    bool retVal = false;
+
+    //  Sensitive task, disable all interrupts
+    bool intState = HAL_BOARD_InterruptSuspend();
+
+    //  Check for space first, so that nothing has to be undone in a full queue
+    if (batch.IsValid() && ((_taskLog.size + batch.Count()) <= TS_MAX_TASKS))
+    {
+        //  All relative times are taken from the same moment
+        uint32_t now = (uint32_t)msSinceStartup;
+
+        for (num = 0; num < batch.Count(); num++)
+        {
+            const _batchItem &item = batch._items[num];
+            uint32_t time = (item.time <= 0) ?
+                            (uint32_t)(-item.time) + now : (uint32_t)item.time;
+            int32_t rep = item.rep;
+
+            //  0 counts as actual repetition, same as in SyncTaskPer()
+            if (rep > 0) rep--;
+
+            TaskEntry teTemp(item.libUID, item.taskID, time, item.period, rep);
+            teTemp._prio = item.prio;
+            teTemp._deadline = item.deadline;
+            if ((item.argN > 0) &&
+                !teTemp.AddArg((void*)(batch._args + item.argOff), item.argN))
+                break;
+
+            nodes[num] = _taskLog.NewNode(teTemp);
+            if (nodes[num] == 0)
+                break;
+        }
+
+        //  Insert nodes only if all of them were created, release them
+        //  otherwise
+        if ((num == batch.Count()) && _taskLog.PushBatch(nodes, num))
+            retVal = true;
+        else
+            while (num > 0)
+                _taskLog.FreeNode(nodes[--num]);
+    }
+
+    //  Batch doesn't belong to a single task, nothing to append arguments to
+    _lastIndex = 0;
+
+#if defined(__TS_TRACE__)
+    for (uint8_t i = 0; retVal && (i < num); i++)
+        TS_TRACE(TR_SYNC, nodes[i]->data._libuid, nodes[i]->data._task,
+                 nodes[i]->data._PID, 0);
+#endif
+#ifdef __HAL_USE_EVENTLOG__
+    if (!retVal)
+        EMIT_EV(-1, EVENT_ERROR);
+#endif  /* __HAL_USE_EVENTLOG__ */
+
+    //  Sensitive task done, restore interrupts to their previous state
+    HAL_BOARD_InterruptRestore(intState);
+    return retVal;
+}
+
+/**
+ * Set function to be called when there's no task to execute at the moment,
+ * usually to put the processor to sleep until the next task is due
+ * @note Hook is called with interrupts disabled, it has to return once an
+ * interrupt is pending (as sleeping with WFI instruction does) and must not
+ * enable interrupts itself
+ * @param idleHook pointer to function to call, 0 to spin without idling
+ */
+void TaskScheduler::SetIdleHook(void((*idleHook)(void))) volatile
+{
+    _idleHook = idleHook;
+}
+
+/**
+ * Request execution of a task from within an interrupt (or from code that can
+ * run in one). Task isn't added to the queue straight away but is posted to
+ * a ring of deferred requests, from which it's added next time TS_GlobalCheck
+ * runs and is executed as soon as possible. Doesn't allocate memory, interrupts
+ * are disabled only while the request is copied into the ring.
+ * @param libUID UID of library to call
+ * @param taskID task ID within the library to execute
+ * @param args pointer to arguments of the task
+ * @param argLen length of arguments (in bytes), at most TS_ARG_INLINE_SIZE
+ * @return true if request was posted, false if ring is full or arguments are
+ * too long (request is dropped)
+ */
+bool TaskScheduler::SyncTaskISR(uint8_t libUID, uint8_t taskID,
+                                const void *args, uint8_t argLen) volatile
+{
+    TS_TRACE(TR_SYNC, libUID, taskID, 0, 1);
+    return _deferred.Push(libUID, taskID, args, argLen);
 }
 
 /**
@@ -422,17 +563,44 @@ void TaskScheduler::SyncTask(TaskEntry te) volatile
  * new arguments (because it's unknown if the _lastIndex node got deleted or not)
  * @param arg byte array of data to append (regardless of data type)
  * @param argLen size of byte array [arg]
+ * @return false if argument pools had no memory for the arguments, in which
+ * case the task is removed from the queue (it can't run without them) and
+ * further arguments are dropped. True otherwise
+ */
+bool TaskScheduler::AddArgs(void* arg, uint16_t argLen) volatile
+{
+    bool retVal = true;
+    //  Sensitive task, disable all interrupts
+    bool intState = HAL_BOARD_InterruptSuspend();
+
+    if ((_lastIndex != 0) && !_lastIndex->data.AddArg(arg, argLen))
+    {
+        _taskLog.RemoveEntry((uint16_t)_lastIndex->data._PID);
+        _lastIndex = 0;
+        retVal = false;
+    }
+    _Coalesce();
+
+    //  Sensitive task done, restore interrupts to their previous state
+    HAL_BOARD_InterruptRestore(intState);
+    return retVal;
+}
+
+/**
+ * Set what happens to periods missed by the last pushed task when it falls
+ * behind its nominal release times. By default missed periods are dropped.
+ * @param policy T_CATCHUP_SKIP or T_CATCHUP_BURST
  */
-void TaskScheduler::AddArgs(void* arg, uint16_t argLen) volatile
+void TaskScheduler::SetCatchUp(uint8_t policy) volatile
 {
     //  Sensitive task, disable all interrupts
-    HAL_BOARD_InterruptEnable(false);
+    bool intState = HAL_BOARD_InterruptSuspend();
 
     if (_lastIndex != 0)
-        _lastIndex->data.AddArg(arg, argLen);
+        _lastIndex->data._catchUp = policy;
 
-    //  Sensitive task done, enable interrupts again
-    HAL_BOARD_InterruptEnable(true);
+    //  Sensitive task done, restore interrupts to their previous state
+    HAL_BOARD_InterruptRestore(intState);
 }
 
 /**
@@ -446,14 +614,14 @@ void TaskScheduler::RemoveTask(uint8_t libUID, uint8_t taskID,
                                void* arg, uint16_t argLen) volatile
 {
     //  Sensitive task, disable all interrupts
-    HAL_BOARD_InterruptEnable(false);
+    bool intState = HAL_BOARD_InterruptSuspend();
 
     TaskEntry delT(libUID, taskID, 0);
-    delT.AddArg(arg, argLen);
-    _taskLog.RemoveEntry(delT);
+    if (delT.AddArg(arg, argLen))
+        _taskLog.RemoveEntry(delT);
 
-    //  Sensitive task done, enable interrupts again
-    HAL_BOARD_InterruptEnable(true);
+    //  Sensitive task done, restore interrupts to their previous state
+    HAL_BOARD_InterruptRestore(intState);
 }
 
 /**
@@ -473,20 +641,413 @@ bool TaskScheduler::RemoveTask(uint16_t PIDarg) volatile
 {
     bool retVal;
     //  Sensitive task, disable all interrupts
-    HAL_BOARD_InterruptEnable(false);
+    bool intState = HAL_BOARD_InterruptSuspend();
 
     retVal = _taskLog.RemoveEntry(PIDarg);
 
-    //  Sensitive task done, enable interrupts again
-    HAL_BOARD_InterruptEnable(true);
+    //  Sensitive task done, restore interrupts to their previous state
+    HAL_BOARD_InterruptRestore(intState);
+    return retVal;
+}
+
+/**
+ * Find pending task with a given PID
+ * @note Task stays in the queue and can be executed or removed at any point, so
+ * returned pointer should only be used right away
+ * @param PIDarg PID (Unique process ID) of task to find
+ * @return pointer to the task in the queue, 0 if no pending task has that PID
+ */
+const TaskEntry* TaskScheduler::FindTask(uint16_t PIDarg) volatile
+{
+    volatile _tqnode *task;
+    //  Sensitive task, disable all interrupts
+    bool intState = HAL_BOARD_InterruptSuspend();
+
+    task = _taskLog.Find(PIDarg);
+
+    //  Sensitive task done, restore interrupts to their previous state
+    HAL_BOARD_InterruptRestore(intState);
+
+    if (task == 0)
+        return 0;
+
+    return (TaskEntry*)(&(task->data));
+}
+
+/**
+ * Check whether there's a task requesting given service pending in the queue
+ * @note Task currently being executed is not in the queue
+ * @param libUID UID of library
+ * @param taskID task ID within the library
+ * @return true if at least one such task is pending, false otherwise
+ */
+bool TaskScheduler::IsPending(uint8_t libUID, uint8_t taskID) volatile
+{
+    bool retVal;
+    //  Sensitive task, disable all interrupts
+    bool intState = HAL_BOARD_InterruptSuspend();
+
+    retVal = (_taskLog.FindService(libUID, taskID) != 0);
+
+    //  Sensitive task done, restore interrupts to their previous state
+    HAL_BOARD_InterruptRestore(intState);
+    return retVal;
+}
+
+/**
+ * Set policy for combining new tasks requesting a service with equivalent
+ * tasks of the same service already pending in the queue. Tasks are equivalent
+ * if the first [keyLen] bytes of their arguments are the same. Policy is
+ * applied as soon as new task has at least [keyLen] bytes of arguments.
+ * T_COALESCE_REPLACE - pending task is removed, new one is added
+ * T_COALESCE_KEEP    - pending task is kept, new one (including any arguments
+ *                      appended to it later) is dropped
+ * T_COALESCE_MERGE   - arguments of new task following the first [keyLen]
+ *                      bytes (and any appended later) are appended to the
+ *                      pending task, new task is dropped
+ * @note Tasks added through SyncBatch() are never coalesced
+ * @param libUID UID of library
+ * @param taskID task ID within the library
+ * @param policy one of T_COALESCE_* macros, T_COALESCE_NONE removes the policy
+ * @param keyLen number of bytes at the start of arguments that identify a task
+ * @return true if policy was set, false if there's no space for a new policy
+ */
+bool TaskScheduler::SetCoalescing(uint8_t libUID, uint8_t taskID,
+                                  uint8_t policy, uint8_t keyLen) volatile
+{
+    bool retVal = true;
+    //  Sensitive task, disable all interrupts
+    bool intState = HAL_BOARD_InterruptSuspend();
+
+    int8_t i = _FindRule(libUID, taskID);
+
+    if (policy == T_COALESCE_NONE)
+    {
+        //  Move last rule in place of the removed one
+        if (i >= 0)
+        {
+            _numRules--;
+            _rules[i].libUID = _rules[_numRules].libUID;
+            _rules[i].taskID = _rules[_numRules].taskID;
+            _rules[i].policy = _rules[_numRules].policy;
+            _rules[i].keyLen = _rules[_numRules].keyLen;
+            _rules[i].hits = _rules[_numRules].hits;
+        }
+    }
+    else if ((i < 0) && (_numRules >= TS_COALESCE_RULES))
+        retVal = false;
+    else
+    {
+        //  New rule starts counting from 0, existing one keeps its count
+        if (i < 0)
+        {
+            i = _numRules++;
+            _rules[i].libUID = libUID;
+            _rules[i].taskID = taskID;
+            _rules[i].hits = 0;
+        }
+        _rules[i].policy = policy;
+        _rules[i].keyLen = keyLen;
+    }
+
+    //  Last added task might refer to a rule that has been moved
+    _lastRule = -1;
+
+    //  Sensitive task done, restore interrupts to their previous state
+    HAL_BOARD_InterruptRestore(intState);
+    return retVal;
+}
+
+/**
+ * Mark service whose periodic tasks can be skipped while scheduler is
+ * overloaded, see LoadMonitor::SetSheddable()
+ * @param libUID UID of library
+ * @param taskID task ID within the library
+ * @param enable true to allow skipping, false to always execute
+ */
+void TaskScheduler::SetSheddable(uint8_t libUID, uint8_t taskID,
+                                 bool enable) volatile
+{
+    //  Sensitive task, disable all interrupts
+    bool intState = HAL_BOARD_InterruptSuspend();
+
+    _load.SetSheddable(libUID, taskID, enable);
+
+    //  Sensitive task done, restore interrupts to their previous state
+    HAL_BOARD_InterruptRestore(intState);
+}
+
+/**
+ * Get coalescing policy of a service, together with number of tasks coalesced
+ * under it so far
+ * @param index index of the policy, starting from 0
+ * @return pointer to the policy, 0 if index is out of boundaries
+ */
+const volatile _coalesceRule* TaskScheduler::GetCoalesceRule(uint8_t index) volatile
+{
+    if (index >= _numRules)
+        return 0;
+
+    return &(_rules[index]);
+}
+
+#ifdef _TS_PERF_ANALYSIS_
+/**
+ * Get profile of a service called by task scheduler so far
+ * @param index index of the profile, starting from 0
+ * @return pointer to the profile, 0 if index is out of boundaries
+ */
+const volatile ServiceProfile* TaskScheduler::GetProfile(uint8_t index) volatile
+{
+    if (index >= _numProfiles)
+        return 0;
+
+    return &(_profiles[index]);
+}
+#endif
+
+///-----------------------------------------------------------------------------
+///                      Executing tasks from the queue                [PRIVATE]
+///-----------------------------------------------------------------------------
+
+/**
+ * Take the task to execute next out of the queue, without copying it. Out of
+ * all tasks due at [now], the one with the highest priority class and earliest
+ * deadline is taken
+ * @note Once this function is called, _lastIndex pointer, that points to last
+ * added task is set to 0 (task might get deleted before AddArgs is called)
+ * @param now current time (in ms)
+ * @return node holding the task, 0 if there are no tasks to execute. Node has
+ * to be given back with either _Reschedule() or _FreeNode()
+ */
+_tqnode* TaskScheduler::_PopNode(uint32_t now) volatile
+{
+    _tqnode *retVal;
+
+    //  Sensitive task, disable all interrupts
+    bool intState = HAL_BOARD_InterruptSuspend();
+
+#if defined(__DEBUG_SESSION2__)
+        volatile uint32_t siz = _taskLog.size;
+#endif
+    retVal = _taskLog.PopNode(now);
+#if defined(__DEBUG_SESSION2__)
+        if ((siz-_taskLog.size) != 1)
+        {
+            DEBUG_WRITE("\nNow is %d, POP\n", msSinceStartup);
+            DEBUG_WRITE("  Size before %d \n", siz);
+            DEBUG_WRITE("  Size after %d \n  TL dump: \n", _taskLog.size);
+
+            int i = 0;
+            while(i < _taskLog.size)
+            {
+                const TaskEntry *task = FetchNextTask(i==0);
+                if (task == 0)
+                    break;
+                DEBUG_WRITE("    %d.[%u]: %d(%d)\n", i,(uint32_t)task->_timestamp, task->_libuid, task->_task);
+
+                i++;
+            }
+        }
+#endif
+    _lastIndex = 0;
+
+    //  Sensitive task done, restore interrupts to their previous state
+    HAL_BOARD_InterruptRestore(intState);
     return retVal;
 }
 
+/**
+ * Put node taken out by _PopNode() back into the queue, at the position given
+ * by its (updated) time stamp. Task keeps its PID, arguments and performance
+ * data.
+ * @param node node to put back into the queue
+ */
+void TaskScheduler::_Reschedule(_tqnode *node) volatile
+{
+    //  Sensitive task, disable all interrupts
+    bool intState = HAL_BOARD_InterruptSuspend();
+
+    //  Queue might have been filled up while task was executing
+    if (!_taskLog.PushNode(node))
+    {
+        _taskLog.FreeNode(node);
+#ifdef __HAL_USE_EVENTLOG__
+        EMIT_EV(-1, EVENT_ERROR);
+#endif  /* __HAL_USE_EVENTLOG__ */
+    }
+
+    //  Sensitive task done, restore interrupts to their previous state
+    HAL_BOARD_InterruptRestore(intState);
+}
+
+/**
+ * Release node taken out by _PopNode(), once its task won't be repeated
+ * @param node node to release
+ */
+void TaskScheduler::_FreeNode(_tqnode *node) volatile
+{
+    //  Sensitive task, disable all interrupts
+    bool intState = HAL_BOARD_InterruptSuspend();
+
+    _taskLog.FreeNode(node);
+
+    //  Sensitive task done, restore interrupts to their previous state
+    HAL_BOARD_InterruptRestore(intState);
+}
+
+/**
+ * Find coalescing policy of a service
+ * @param libUID UID of library
+ * @param taskID task ID within the library
+ * @return index of the policy in _rules, -1 if service has no policy
+ */
+int8_t TaskScheduler::_FindRule(uint8_t libUID, uint8_t taskID) volatile
+{
+    for (uint8_t i = 0; i < _numRules; i++)
+        if ((_rules[i].libUID == libUID) && (_rules[i].taskID == taskID))
+            return i;
+
+    return -1;
+}
+
+#ifdef _TS_PERF_ANALYSIS_
+/**
+ * Find profile of a service, adding a new one for it if there's none yet
+ * @param libUID UID of library
+ * @param taskID task ID within the library
+ * @return pointer to the profile, 0 if service has none and table is full
+ */
+ServiceProfile* TaskScheduler::_Profile(uint8_t libUID, uint8_t taskID) volatile
+{
+    for (uint8_t i = 0; i < _numProfiles; i++)
+        if ((_profiles[i].libUID == libUID) && (_profiles[i].taskID == taskID))
+            return (ServiceProfile*)&(_profiles[i]);
+
+    if (_numProfiles >= TS_PROFILE_SERVICES)
+        return 0;
+
+    volatile ServiceProfile &prof = _profiles[_numProfiles++];
+    prof.libUID = libUID;
+    prof.taskID = taskID;
+
+    return (ServiceProfile*)&prof;
+}
+#endif
+
+/**
+ * Apply coalescing policy to the last added task, once it has enough
+ * arguments to compare it with pending tasks. Called with interrupts disabled
+ * every time a task is added or arguments are appended to it.
+ * @note _lastIndex is redirected to the task that further arguments belong to,
+ * or set to 0 if they should be dropped
+ */
+void TaskScheduler::_Coalesce() volatile
+{
+    if ((_lastIndex == 0) || (_lastRule < 0))
+        return;
+
+    volatile _coalesceRule &rule = _rules[_lastRule];
+    _tqnode *node = (_tqnode*)_lastIndex;
+
+    //  Not enough arguments yet to tell which task this is equivalent to
+    if (node->data._argN < rule.keyLen)
+        return;
+
+    //  Policy is applied only once per task
+    _lastRule = -1;
+
+    _tqnode *pending = _taskLog.FindEquivalent(node, rule.keyLen);
+    if (pending == 0)
+        return;
+
+    rule.hits++;
+
+    switch (rule.policy)
+    {
+    case T_COALESCE_REPLACE:
+        _taskLog.RemoveEntry((uint16_t)pending->data._PID);
+        break;
+    case T_COALESCE_KEEP:
+        _taskLog.RemoveEntry((uint16_t)node->data._PID);
+        _lastIndex = 0;
+        break;
+    case T_COALESCE_MERGE:
+        //  Without memory for merged arguments both tasks are kept
+        if ((node->data._argN > rule.keyLen) &&
+            !pending->data.AddArg((void*)(node->data._args + rule.keyLen),
+                                  node->data._argN - rule.keyLen))
+            break;
+        _taskLog.RemoveEntry((uint16_t)node->data._PID);
+        _lastIndex = pending;
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * Move all requests posted from interrupts into the task queue
+ */
+void TaskScheduler::_DrainDeferred() volatile
+{
+    _deferItem item;
+
+    while (_deferred.Pop(item))
+    {
+        SyncTask(item.libUID, item.taskID, T_ASAP);
+        if (item.argN > 0)
+            AddArgs((void*)item.args, item.argN);
+    }
+}
+
+/**
+ * Run idle hook if there's no task to execute at the moment. In tickless mode
+ * wake-up timer is first programmed to expire when the next task is due.
+ */
+void TaskScheduler::_Idle() volatile
+{
+    uint32_t next;
+    int32_t wait = TS_TICKLESS_MAX_SLEEP;
+
+    //  Interrupts stay disabled until the idle hook returns, so that a request
+    //  posted from interrupt can't slip in between the check and going to sleep
+    bool intState = HAL_BOARD_InterruptSuspend();
+
+#if defined(__TS_TICKLESS__)
+    uint64_t nowUS = HAL_TS_GetTimeUS();
+    uint32_t now = (uint32_t)(nowUS / 1000);
+#else
+    uint32_t now = (uint32_t)msSinceStartup;
+#endif
+
+    if (_taskLog.NextDue(next))
+        wait = (int32_t)(next - now);
+
+    if ((wait > 0) && (_deferred.Count() == 0))
+    {
+#if defined(__TS_TICKLESS__)
+        if (wait > TS_TICKLESS_MAX_SLEEP)
+            wait = TS_TICKLESS_MAX_SLEEP;
+        //  Wake up right at the start of the millisecond the task is due
+        HAL_TS_SetWakeup((uint32_t)wait * 1000 - (uint32_t)(nowUS % 1000));
+#endif
+        _idleHook();
+    }
+
+    //  Sensitive task done, restore interrupts to their previous state
+    HAL_BOARD_InterruptRestore(intState);
+}
+
 ///-----------------------------------------------------------------------------
 ///                      Class constructor & destructor              [PROTECTED]
 ///-----------------------------------------------------------------------------
-TaskScheduler::TaskScheduler() : _lastIndex(0)
+TaskScheduler::TaskScheduler() : _lastIndex(0), _lastRule(-1), _numRules(0),
+                                 _idleHook(0), _fetchIndex(0)
 {
+#ifdef _TS_PERF_ANALYSIS_
+    _numProfiles = 0;
+#endif
 #ifdef __HAL_USE_EVENTLOG__
     EMIT_EV(-1, EVENT_UNINITIALIZED);
 #endif  /* __HAL_USE_EVENTLOG__ */
@@ -503,17 +1064,54 @@ TaskScheduler::~TaskScheduler()
  *******************************************************************************
  ******************************************************************************/
 
-/// Internal time since TaskScheduler startup (in ms) - updated in SysTick ISR
-volatile uint64_t msSinceStartup = 0;
-
 /**
- * SysTick interrupt
+ * SysTick interrupt (wake-up timer interrupt in tickless mode)
  * Used to keep internal track of time either as number of milliseconds passed
  * from start-up of task scheduler or acquired UTC time
  */
 void _TSSyncCallback(void)
 {
+#if defined(__TS_TICKLESS__)
+    TS_TRACE(TR_ISR, TASKSCHED_UID, TR_ISR_TS_WAKEUP, 0, 0);
+    //  Stop the timer, it's armed again next time scheduler goes idle
+    HAL_TS_SetWakeup(0);
+    msSinceStartup = HAL_TS_GetTimeUS() / 1000;
+#else
     msSinceStartup += HAL_TS_GetTimeStepMS();
+#endif
+
+#if defined(__TS_BUDGET_WATCHDOG__)
+    //  Task that's been running for longer than its budget might never return,
+    //  count it now. It's reported to event log once it returns
+    volatile BudgetMonitor &budget = TaskScheduler::GetI()._budget;
+    if (budget.Check(HAL_TS_GetTimeUS()))
+        TS_TRACE(TR_OVERRUN, budget.lastLibUID, budget.lastTaskID,
+                 budget.lastPID, 1);
+#endif  /* __TS_BUDGET_WATCHDOG__ */
+}
+
+/**
+ * Get time since startup of task scheduler with microsecond resolution
+ * @note In tickless mode msSinceStartup is derived from this time, otherwise
+ * the two are kept separately and can differ by up to one time step
+ * @return time in microseconds
+ */
+uint64_t TS_GetTimeUS(void)
+{
+    return HAL_TS_GetTimeUS();
+}
+
+/**
+ * Bring internal time up to date in tickless mode, where there's no periodic
+ * interrupt doing so (SysTick keeps it up to date otherwise)
+ */
+static inline void _TSUpdateTime(void)
+{
+#if defined(__TS_TICKLESS__)
+    bool intState = HAL_BOARD_InterruptSuspend();
+    msSinceStartup = HAL_TS_GetTimeUS() / 1000;
+    HAL_BOARD_InterruptRestore(intState);
+#endif
 }
 
 /**
@@ -528,31 +1126,107 @@ void TS_GlobalCheck(void)
     //  Grab reference to singleton
     volatile TaskScheduler &__taskSch = TaskScheduler::GetI();
 
+    //  Add tasks requested from interrupts since the last check
+    __taskSch._DrainDeferred();
+
+    //  Move time of the task queue forward so that all tasks that had to be
+    //  executed by now are at its front
+    _TSUpdateTime();
+    uint32_t oldest;
+    bool intState = HAL_BOARD_InterruptSuspend();
+    __taskSch._taskLog.Advance((uint32_t)msSinceStartup);
+    uint16_t due = __taskSch._taskLog.CountDue((uint32_t)msSinceStartup, oldest);
+    HAL_BOARD_InterruptRestore(intState);
+
+    //  Check how far behind the scheduler is before executing anything
+    if (__taskSch._load.Update(due, (uint32_t)msSinceStartup - oldest))
+    {
+#ifdef __HAL_USE_EVENTLOG__
+        EMIT_EV(TASKSCHED_E_OVERLOAD,
+                __taskSch._load.overloaded ? EVENT_HANG : EVENT_OK);
+#endif  /* __HAL_USE_EVENTLOG__ */
+    }
+
     //  Check if there is task scheduled to execute
     if (!__taskSch.IsEmpty())
-        //  Check if the first task had to be executed already
-        while((__taskSch.PeekFront()._timestamp <= msSinceStartup) &&
-              (!__taskSch.IsEmpty()))
+        //  Check if the first task had to be executed already, in a way
+        //  that survives overflow of 32-bit time stamps
+        while((!__taskSch.IsEmpty()) &&
+              ((int32_t)(__taskSch.PeekFront()._timestamp -
+                         (uint32_t)msSinceStartup) <= 0))
         {
-            // Take out first entry to process it
-            TaskEntry tE(__taskSch.PopFront());
-            uint64_t tStart = (uint64_t)msSinceStartup;
-
-            //  If we're going to repeat this task then it makes sense to
-            //  measure its performance, run task-start hook  and calculate new
-            //  starting time for this task
-            if ((tE._period != 0) && (tE._repeats != 0))
+            //  Take out the most urgent of due tasks to process it. Task is
+            //  executed directly from its node and the same node is put back
+            //  into the queue if task needs to be repeated
+            _tqnode *node = __taskSch._PopNode((uint32_t)msSinceStartup);
+            if (node == 0)
+                break;
+            TaskEntry &tE = (TaskEntry&)node->data;
+            //  Task resuming a service that has yielded has already been
+            //  accounted for as started when the service was first called
+            bool resumed = tE._suspended;
+
+            //  When overloaded, periodic task of a sheddable service is moved
+            //  to its next period without being executed
+            if (!resumed && __taskSch._load.overloaded && (tE._period != 0) &&
+                (tE._repeats != 0) &&
+                __taskSch._load.Sheddable(tE._libuid, tE._task))
             {
+                tE._release = tE._timestamp + labs(tE._period);
+                tE._CatchUp((uint32_t)msSinceStartup);
+                tE._timestamp = tE._release;
+                __taskSch._load.shed++;
+#ifdef __HAL_USE_EVENTLOG__
+                EMIT_EV(TASKSCHED_E_SHED, EVENT_ERROR);
+#endif  /* __HAL_USE_EVENTLOG__ */
+                __taskSch._Reschedule(node);
+                continue;
+            }
 #ifdef _TS_PERF_ANALYSIS_
-                tE.Perf.TaskStartHook((uint64_t)msSinceStartup, tE._timestamp, HAL_TS_GetTimeStepMS());
+            //  Absolute deadline of this execution, before time stamp changes
+            uint64_t deadline = 0;
+            if (!resumed && (tE.GetDeadline() > 0))
+                deadline = (uint64_t)tE._timestamp + tE.GetDeadline();
+
+            //  Measure performance of every task, periodic or not, run
+            //  task-start hook (or resume hook if service has yielded)
+            //  Sub-millisecond part of latency comes from the time base
+            uint32_t latency = 0;
+            ServiceProfile *prof = 0;
+            if (!resumed)
+            {
+                latency = (uint32_t)(TS_GetTimeUS() % 1000) +
+                        ((uint32_t)msSinceStartup - tE._timestamp) * 1000;
+                tE.Perf.TaskStartHook((uint64_t)msSinceStartup, tE._timestamp,
+                                      HAL_TS_GetTimeStepMS(), latency,
+                                      HAL_TS_GetCycles());
+            }
+            else
+                tE.Perf.TaskResumeHook(HAL_TS_GetCycles());
 #endif
-                //  Change time of execution based on period (for next execution)
-                tE._timestamp = msSinceStartup + labs(tE._period);
+
+            //  If we're going to repeat this task calculate new starting time
+            //  for this task
+            if (!resumed && (tE._period != 0) && (tE._repeats != 0))
+            {
+                //  Next execution is one period after the nominal time of this
+                //  one (not after its actual start, so that a late start
+                //  doesn't shift all following ones)
+                tE._release = tE._timestamp + labs(tE._period);
+                tE._CatchUp((uint32_t)msSinceStartup);
+                tE._timestamp = tE._release;
             }
 
-            // Check if module is registered in task scheduler
-            if ((__kernelVector[tE._libuid]) == 0)
-                return;
+            // Check if module is registered in task scheduler (libUID of
+            // a task coming from outside, e.g. a network frame, can be
+            // anything)
+            if (!TaskScheduler::ValidKernModule(tE._libuid))
+            {
+                __taskSch._FreeNode(node);
+                continue;
+            }
+            KernelContext &ctx = KernelContext::Current();
+            const _tsModule &module = ctx.services[tE._libuid];
 
 #if defined(__DEBUG_SESSION__)
             DEBUG_WRITE("Now is %d \n", msSinceStartup);
@@ -561,29 +1235,129 @@ void TS_GlobalCheck(void)
             DEBUG_WRITE("-(%d)> %s\n", tE._argN, tE._args);
 #endif
 
-            // Make task data available to kernel
-            __kernelVector[tE._libuid]->serviceID = tE._task;
-            __kernelVector[tE._libuid]->argN = tE._argN;
-            __kernelVector[tE._libuid]->args = (uint8_t*)tE._args;
+            // Call kernel module to execute task, unless the module doesn't
+            // provide the service or task doesn't carry enough arguments for it
+            uint32_t retVal = STATUS_ARG_ERR, budgetUS = 0;
+            uint64_t startUS = TS_GetTimeUS();
+            TS_TRACE(TR_TASK_START, tE._libuid, tE._task, tE._PID, 0);
+            ctx.curPID = tE._PID;
+            if ((tE._task < module.num) &&
+                (tE._argN >= module.services[tE._task].argLen))
+            {
+                const _tsService &service = module.services[tE._task];
+
+                budgetUS = service.budgetUS;
+                __taskSch._budget.Start(tE._libuid, tE._task, tE._PID,
+                                        budgetUS, startUS);
+#if defined(__TS_TICKLESS__) && defined(__TS_BUDGET_WATCHDOG__)
+                //  No periodic interrupt in tickless mode, wake-up timer has
+                //  to fire if the task is still running once budget runs out
+                if (budgetUS != 0)
+                    HAL_TS_SetWakeup(budgetUS + 1);
+#endif
+#ifdef _TS_PERF_ANALYSIS_
+                //  Profile of the service, 0 if there's no room for it
+                prof = __taskSch._Profile(tE._libuid, tE._task);
+                if ((prof != 0) && !resumed)
+                    prof->AddStart(latency);
+#endif
+                retVal = service.handler((const uint8_t*)tE._args, tE._argN);
+            }
+            ctx.curPID = 0;
+            TS_TRACE(TR_TASK_END, tE._libuid, tE._task, tE._PID,
+                     TS_IS_YIELD(retVal));
+
+            //  Check the time the service took against its budget, slice of
+            //  a service that yields is checked on its own
+            uint8_t budget = __taskSch._budget.End(TS_GetTimeUS());
+#if defined(__TS_TICKLESS__) && defined(__TS_BUDGET_WATCHDOG__)
+            if (budgetUS != 0)
+                HAL_TS_SetWakeup(0);
+#endif
+            if (budget == TS_BUDGET_OVERRUN)
+                TS_TRACE(TR_OVERRUN, tE._libuid, tE._task, tE._PID, 0);
+#ifdef _TS_PERF_ANALYSIS_
+            if (budget != TS_BUDGET_OK)
+            {
+                tE.Perf.overrunCnt++;
+                if (prof != 0)
+                    prof->overrunCnt++;
+            }
+#endif
+            _TSUpdateTime();
+
+            //  Service isn't done yet, put task back into the queue to resume
+            //  the service after the time it asked for (at least 1ms, so that
+            //  the loop doesn't keep resuming it without time passing)
+            if (TS_IS_YIELD(retVal))
+            {
+                uint32_t delay = retVal & TS_YIELD_MAX_MS;
 
-            // Call kernel module to execute task
-            __kernelVector[tE._libuid]->callBackFunc();
+                tE._suspended = true;
+                tE._timestamp = msSinceStartup + ((delay > 0) ? delay : 1);
+#ifdef _TS_PERF_ANALYSIS_
+                tE.Perf.TaskYieldHook(HAL_TS_GetCycles(),
+                                      HAL_TS_GetCyclesPerUS());
+#endif
+#ifdef __HAL_USE_EVENTLOG__
+                if (budget != TS_BUDGET_OK)
+                    EventLog::EmitEvent(tE._libuid, tE._task, EVENT_OVERRUN);
+#endif  /* __HAL_USE_EVENTLOG__ */
 
-            //  If there's a period specified, reschedule task
+                uint64_t endUS = TS_GetTimeUS();
+                __taskSch._load.AddBusy((uint32_t)(endUS - startUS), endUS);
+                __taskSch._Reschedule(node);
+                continue;
+            }
+            tE._suspended = false;
+
+#ifdef __HAL_USE_EVENTLOG__
+            //  Report outcome of the service on behalf of the module, service
+            //  that did its job but took too long reports overrun instead
+            if ((budget != TS_BUDGET_OK) &&
+                ((retVal == STATUS_OK) || (retVal == STATUS_NO_EVENT)))
+                EventLog::EmitEvent(tE._libuid, tE._task, EVENT_OVERRUN);
+            else if (retVal != STATUS_NO_EVENT)
+                EventLog::EmitEvent(tE._libuid, tE._task,
+                        (retVal == STATUS_OK) ? EVENT_OK : EVENT_ERROR);
+#endif  /* __HAL_USE_EVENTLOG__ */
+
+            uint64_t endUS = TS_GetTimeUS();
+            __taskSch._load.AddBusy((uint32_t)(endUS - startUS), endUS);
+
+#ifdef _TS_PERF_ANALYSIS_
             //  Run post-execution hook for calculating performance
+            uint32_t rt = tE.Perf.TaskEndHook((uint64_t)msSinceStartup, deadline,
+                                HAL_TS_GetCycles(), HAL_TS_GetCyclesPerUS());
+            if (prof != 0)
+                prof->AddRun(rt, (deadline != 0) && (msSinceStartup > deadline));
+#endif
+
+            //  If there's a period specified, reschedule task
             if ((tE._period != 0) && (tE._repeats != 0))
             {
-#ifdef _TS_PERF_ANALYSIS_
-                tE.Perf.TaskEndHook((uint64_t)msSinceStartup);
-#endif
                 //  If using repeat counter decrease it
                 if (tE._repeats > 0)
                     tE._repeats--;
+                //  Time stamp of resumed task is the time it was resumed at,
+                //  restore release of the next period (possibly missed while
+                //  service was suspended)
+                if (resumed)
+                {
+                    tE._CatchUp((uint32_t)msSinceStartup);
+                    tE._timestamp = tE._release;
+                }
                 //  Reschedule the task
-                __taskSch.SyncTask(tE);
+                __taskSch._Reschedule(node);
             }
+            else
+                __taskSch._FreeNode(node);
         }
-}
 
+    //  Nothing to execute at the moment, let the idle hook run (e.g. sleep)
+    //  until the next task is due or an interrupt comes in
+    if (__taskSch._idleHook != 0)
+        __taskSch._Idle();
+}
 
 #endif  /* __HAL_USE_TASKSCH__ */
@@ -5,7 +5,7 @@
  *      Author: Vedran Mikov
  *
  *  Task scheduler library
- *  @version 2.8.0
+ *  @version 2.26.0
  *  V1.1
  *  +Implementation of queue of tasks with various parameters. Tasks identified
  *      by unique integer number (defined by higher level library)
@@ -54,6 +54,85 @@
  *  +Periodically called functions switched to inline, declared in header
  *  +Implemented kernel callback for TS, allowing enable/disable signal for
  *  SysTick timer to be sent remotely
+ *  V2.9.0 - 17.10.2026
+ *  +Sorted linked list replaced by an array-based binary min-heap as internal
+ *  container for tasks. Adding and popping a task are now O(log n) instead of
+ *  walking the list with interrupts disabled. Tasks with the same time stamp
+ *  keep their FIFO order. Capacity of task queue is set by TS_MAX_TASKS
+ *  V2.10.0 - 17.10.2026
+ *  +Added hierarchical timing wheel as an alternative container for tasks,
+ *  selected by __TS_USE_TIMING_WHEEL__ in hwconfig.h. Adding and rescheduling
+ *  tasks is O(1), tasks are sorted only once they become due
+ *  V2.11.0 - 17.10.2026
+ *  +Queue nodes and task arguments are allocated from static memory pools
+ *  (tsPool.h) instead of the free store. Pool overflow is reported to event log
+ *  V2.12.0 - 17.10.2026
+ *  +Arguments shorter than TS_ARG_INLINE_SIZE are stored inside of TaskEntry,
+ *  adding and copying such tasks doesn't allocate any memory
+ *  V2.13.0 - 17.10.2026
+ *  +Periodic tasks are executed directly from their queue node and the same
+ *  node is put back into the queue, arguments and performance data are no longer
+ *  copied on every execution. Tasks are moved (not copied) into the queue
+ *  V2.14.0 - 17.10.2026
+ *  +Tasks have a priority class and an optional deadline (set in SyncTaskPer).
+ *  Out of all due tasks, the one with highest priority and earliest deadline
+ *  is executed first. Deadline misses are counted in task Performance data
+ *  V2.15.0 - 17.10.2026
+ *  +Interrupts request tasks through SyncTaskISR(), which posts the request
+ *  into a lock-free ring (tsDefer.h) drained by TS_GlobalCheck
+ *  +Critical sections restore previous interrupt state instead of enabling
+ *  interrupts, so scheduler functions no longer enable interrupts inside ISRs
+ *  V2.16.0 - 17.10.2026
+ *  +Tickless mode (__TS_TICKLESS__ in hwconfig.h), SysTick is replaced by
+ *  a timer programmed to expire when the next task is due
+ *  +Added idle hook, called when there's nothing to execute (e.g. to sleep)
+ *  +Added time source with microsecond resolution, TS_GetTimeUS()
+ *  V2.17.0 - 17.10.2026
+ *  +Task requests and task runs are recorded into trace buffer (tsTrace.h)
+ *  V2.18.0 - 17.10.2026
+ *  +Pending tasks are indexed by PID and by service (tsIndex.h). Killing a task
+ *  and looking it up no longer searches the whole queue
+ *  +Added FindTask() and IsPending() for looking up pending tasks
+ *  V2.19.0 - 17.10.2026
+ *  +Added SyncBatch() for adding a group of tasks (tsBatch.h) within a single
+ *  critical section, either all of them or none
+ *  V2.20.0 - 17.10.2026
+ *  +Opt-in coalescing of duplicate tasks per service: new task can replace an
+ *  equivalent pending task, be dropped in its favor or have its arguments
+ *  merged into it. Number of coalesced tasks is counted per service
+ *  V2.21.0 - 17.10.2026
+ *  +Scheduler tracks backlog of due tasks, lateness and load (tsLoad.h). When
+ *  overloaded, periodic tasks of sheddable services are skipped instead of
+ *  being executed back to back. Overload and skipped tasks are reported to
+ *  event log
+ *  V2.22.0 - 17.10.2026
+ *  +Kernel modules register a constant table of typed services (tsService.h)
+ *  instead of a callback with a switch on service ID. Scheduler checks length
+ *  of arguments, calls the service and reports its outcome to event log
+ *  V2.23.0 - 17.10.2026
+ *  +Resumable tasks: service can yield (tsCoroutine.h) and its task is put back
+ *  into the queue to be resumed later, instead of blocking all other tasks
+ *  while it waits for something
+ *  V2.24.0 - 17.10.2026
+ *  +Periodic tasks are released at fixed multiples of their period instead of
+ *  one period after their actual start, so late starts no longer accumulate
+ *  into drift. Periods missed while running late are dropped or executed back
+ *  to back, as set for each task (SetCatchUp())
+ *  V2.25.0 - 17.10.2026
+ *  +Scheduler instance, service table, PID of the running task and time base
+ *  belong to the current kernel context (init/kernelContext.h) instead of
+ *  being globals, msSinceStartup is now a macro reading context's time
+ *  V2.26.0 - 17.10.2026
+ *  +Services can have a run-time budget, checked when a task returns and from
+ *  SysTick (wake-up timer in tickless mode) while it runs (tsBudget.h).
+ *  Overrun is reported as EVENT_OVERRUN and counted in profile of the task
+ *  V2.27.0 - 17.10.2026
+ *  +Start latency, run time and jitter are measured for every task, not only
+ *  periodic ones, and kept in a profile of each called service (GetProfile())
+ *  +SyncTask(TaskEntry&) and PopFront(TaskEntry&) move the task in and out of
+ *  the queue instead of passing it by value (copying its arguments)
+ *  +Task whose arguments don't fit into argument pools is removed from the
+ *  queue, AddArgs() reports it
  *
  *  TODO:
  *  Implement UTC clock feature. If at some point program finds out what the
@@ -68,25 +147,41 @@
     && defined(__HAL_USE_TASKSCH__)
 #define ROVERKERNEL_TASKSCHEDULER_TASKSCHEDULER_H_
 
-#include "linkedList.h"
 #include "HAL/hal.h"
+#include "init/kernelContext.h"
+#include "tsPool.h"
+#include "tsDefer.h"
+#include "tsTrace.h"
+#include "tsBatch.h"
+#include "tsLoad.h"
+#include "tsBudget.h"
+#include "tsService.h"
+#include "tsCoroutine.h"
+
+//  Container for pending tasks, selected in hwconfig.h
+#if defined(__TS_USE_TIMING_WHEEL__)
+    #include "taskWheel.h"
+    typedef TaskWheel   TaskQueue;
+#else
+    #include "taskHeap.h"
+    typedef TaskHeap    TaskQueue;
+#endif
 
 /**
- * Callback entry into the Task scheduler from individual kernel module
- * Once initialized, each kernel module registers the services it provides into
- * a vector by inserting CallBackEntry into a global vector (handled by
- * TS_RegCallback function). CallBackEntry holds: a) Function to be called when
- * someone requests a service from kernel module; b) ServiceID of service to be
- * executed; c)Memory space used for arguments for callback function; d) Return
- * variable of the service execution
+ * Coalescing policy of a single service
+ * When a new task requests a service that has a policy set and an equivalent
+ * task is already pending, the two are combined based on the policy instead
+ * of adding a duplicate. Tasks are equivalent if the first keyLen bytes of
+ * their arguments match (e.g. socket ID), keyLen of 0 matches any task of the
+ * service.
  */
-struct _kernelEntry
+struct _coalesceRule
 {
-    void((*callBackFunc)(void));    // Pointer to callback function
-    uint8_t serviceID;              // Requested service
-    uint8_t *args;                  // Arguments for service execution
-    uint16_t argN;                  // Length of *args array
-    int32_t  retVal;                // (Optional) Return variable of service exec
+    uint8_t  libUID;                // UID of library providing the service
+    uint8_t  taskID;                // Service ID within the library
+    uint8_t  policy;                // One of T_COALESCE_* macros
+    uint8_t  keyLen;                // Length of arguments identifying a task
+    uint32_t hits;                  // Number of tasks coalesced so far
 };
 
 
@@ -95,11 +190,24 @@ struct _kernelEntry
 //  Pass to 'time' for execution as-soon-as-possible
 #define T_ASAP      (0)
 
+//  Coalescing policies, see TaskScheduler::SetCoalescing()
+#define T_COALESCE_NONE     0   //  Always add a new task
+#define T_COALESCE_REPLACE  1   //  New task takes place of the pending one
+#define T_COALESCE_KEEP     2   //  Pending task is kept, new one is dropped
+#define T_COALESCE_MERGE    3   //  Arguments of new task go to the pending one
+
 //  Unique identifier of this module as registered in task scheduler
     #define TASKSCHED_UID           7
     //  Definitions of ServiceID for service offered by this module
     #define TASKSCHED_T_ENABLE      0
     #define TASKSCHED_T_KILL        1
+    //  Task ID reported to event log when memory pool runs out of space
+    #define TASKSCHED_E_POOL        (-2)
+    //  Task ID reported to event log when a task is skipped due to overload
+    #define TASKSCHED_E_SHED        (-3)
+    //  Task ID reported to event log when scheduler becomes overloaded
+    //  (EVENT_HANG) and when it recovers (EVENT_OK)
+    #define TASKSCHED_E_OVERLOAD    (-4)
 
 //  Enable debug information printed on serial port
 //#define __DEBUG_SESSION2__
@@ -119,8 +227,12 @@ struct _kernelEntry
 //  Internal time since TaskScheduler startup (in ms); Increased by SysTick
 //  interrupt. Every tick increases this variable by value passed as argument to
 //  TaskScheduler::InitHW() function. Can be as little as 1ms, but can be also
-//  be more, depending on system requirements
-extern volatile uint64_t msSinceStartup;
+//  be more, depending on system requirements. In tickless mode it's instead
+//  updated from TS_GetTimeUS() every time task scheduler wakes up. Each kernel
+//  context keeps its own time
+#define msSinceStartup  (KernelContext::Current().timeMS)
+//  Time since TaskScheduler startup with microsecond resolution
+extern uint64_t TS_GetTimeUS(void);
 
 /**
  * Task scheduler class implementation
@@ -138,9 +250,9 @@ extern volatile uint64_t msSinceStartup;
 class TaskScheduler
 {
     //  Functions & classes needing direct access to all members
-    friend void _TS_KernelCallback(void);
     friend void _TSSyncCallback(void);
     friend void TS_GlobalCheck(void);
+    friend class KernelContext;
 
 	public:
         volatile static TaskScheduler& GetI();
@@ -158,17 +270,45 @@ class TaskScheduler
 		void SyncTask(uint8_t libUID, uint8_t taskID, int64_t time,
 		              bool periodic = false, int32_t rep = 0) volatile;
 		void SyncTaskPer(uint8_t libUID, uint8_t taskID, int64_t time,
-		                 int32_t period, int32_t rep) volatile;
-		void SyncTask(TaskEntry te) volatile;
+		                 int32_t period, int32_t rep,
+		                 uint8_t prio = T_PRIO_NORMAL,
+		                 int32_t deadline = 0) volatile;
+		void SyncTask(TaskEntry &te) volatile;
+		bool SyncBatch(const TaskBatch &batch) volatile;
+		//  Adding new tasks from within interrupts
+		bool SyncTaskISR(uint8_t libUID, uint8_t taskID,
+		                 const void *args = 0, uint8_t argLen = 0) volatile;
 
 		//  Add arguments for the last task added
-		void AddArgs(void* arg, uint16_t argLen) volatile;
+		bool AddArgs(void* arg, uint16_t argLen) volatile;
+		//  Set catch-up policy of the last task added
+		void SetCatchUp(uint8_t policy) volatile;
 
 		//  Remove task for task list
 		void RemoveTask(uint8_t libUID, uint8_t taskID,
 		                void* arg, uint16_t argLen) volatile;
 		bool RemoveTask(uint16_t PIDarg) volatile;
 
+		//  Look up pending tasks
+		const TaskEntry* FindTask(uint16_t PIDarg) volatile;
+		bool IsPending(uint8_t libUID, uint8_t taskID) volatile;
+
+		//  Combining duplicate tasks
+		bool SetCoalescing(uint8_t libUID, uint8_t taskID, uint8_t policy,
+		                   uint8_t keyLen = 0) volatile;
+		const volatile _coalesceRule* GetCoalesceRule(uint8_t index) volatile;
+#ifdef _TS_PERF_ANALYSIS_
+		//  Profiles of called services
+		const volatile ServiceProfile* GetProfile(uint8_t index) volatile;
+#endif
+
+		//  Skipping tasks when overloaded
+		void SetSheddable(uint8_t libUID, uint8_t taskID,
+		                  bool enable = true) volatile;
+
+		//  Function to run when there's nothing to execute
+		void SetIdleHook(void((*idleHook)(void))) volatile;
+
 		///---------------------------------------------------------------------
 		///                      Inline functions                       [PUBLIC]
 		///---------------------------------------------------------------------
@@ -188,63 +328,39 @@ class TaskScheduler
 		 * @note Once PopFront() function has been called it's not possible to append
 		 * new arguments (because it's unknown if the _lastIndex node got deleted or not)
 		 * @param arg data argument to append to the current task argument list
+		 * @return false if there was no memory for the argument and the task
+		 * has been removed, true otherwise (see AddArgs())
 		 */
 		template<typename T>
-		void AddArg(T arg) volatile
+		bool AddArg(T arg) volatile
 		{
-            //  Sensitive task, disable all interrupts
-		    HAL_BOARD_InterruptEnable(false);
-
-		    if (_lastIndex != 0)
-		        _lastIndex->data.AddArg((void*)&arg, sizeof(arg));
-
-		    //  Sensitive task done, enable interrupts again
-		    HAL_BOARD_InterruptEnable(true);
+		    return AddArgs((void*)&arg, sizeof(arg));
 		}
 		/**
-		 * Return first element from task queue
+		 * Return first element from task queue (out of the tasks with the
+		 * earliest time stamp, the one with the highest priority)
 		 * @note Once this function is called, _lastIndex pointer, that points to last
 		 * added task is set to 0 (because it's not possible to know whether that task
 		 * got deleted or no). This prevents calling AddArgs function until new task
 		 * is added
-		 * @return first element from task queue and delete it (by moving iterators).
-		 *          If the queue is empty it resets the queue.
+		 * @note Task is removed from the queue, periodic tasks taken out this way
+		 * are not rescheduled
+		 * @param task [out] first element from task queue, its arguments are
+		 * moved into it (not copied)
+		 * @return true if a task was taken out, false if there's no task to
+		 *          execute and [task] is left unchanged
 		 */
-		TaskEntry PopFront() volatile
+		bool PopFront(TaskEntry &task) volatile
         {
-            //  Sensitive task, disable all interrupts
-            HAL_BOARD_InterruptEnable(false);
+            _tqnode *node = _PopNode(_taskLog.PeekFront()._timestamp);
 
-            TaskEntry retVal;
+            if (node == 0)
+                return false;
 
+            task.MoveFrom(node->data);
+            _FreeNode(node);
 
-#if defined(__DEBUG_SESSION2__)
-        volatile uint32_t siz = _taskLog.size;
-#endif
-        //TaskEntry retVal(_taskLog.PopFront());
-        retVal = _taskLog.PopFront();
-#if defined(__DEBUG_SESSION2__)
-        if ((siz-_taskLog.size) != 1)
-        {
-            DEBUG_WRITE("\nNow is %d, POP\n", msSinceStartup);
-            DEBUG_WRITE("  Size before %d \n", siz);
-            DEBUG_WRITE("  Size after %d \n  TL dump: \n", _taskLog.size);
-
-            int i = 0;
-            while(i < _taskLog.size)
-            {
-                const TaskEntry *task = FetchNextTask(i==0);
-                if (task == 0)
-                    break;
-                DEBUG_WRITE("    %d.[%u]: %d(%d)\n", i,(uint32_t)task->_timestamp, task->_libuid, task->_task);
-
-                i++;
-            }
-        }
-#endif
-            _lastIndex = 0;
-            HAL_BOARD_InterruptEnable(true);
-            return retVal;
+            return true;
         }
 
 		/**
@@ -253,33 +369,94 @@ class TaskScheduler
 		 */
 		volatile TaskEntry&  PeekFront() volatile
         {
-            return _taskLog.head->data;
+            return _taskLog.PeekFront();
         }
+		/**
+		 * Get ring of requests posted from interrupts (for its statistics)
+		 * @return reference to ring of deferred requests
+		 */
+		volatile DeferQueue& GetDeferQueue() volatile
+		{
+		    return _deferred;
+		}
+		/**
+		 * Get load statistics and overload state of the scheduler
+		 * @return reference to load monitor
+		 */
+		volatile LoadMonitor& GetLoad() volatile
+		{
+		    return _load;
+		}
+		/**
+		 * Get run-time budget statistics of services
+		 * @return reference to budget monitor
+		 */
+		volatile BudgetMonitor& GetBudget() volatile
+		{
+		    return _budget;
+		}
 
 	private:
         TaskScheduler();
         ~TaskScheduler();
-        TaskScheduler(TaskScheduler &arg) {}        //  No definition - forbid this
-        void operator=(TaskScheduler const &arg) {} //  No definition - forbid this
+        TaskScheduler(TaskScheduler &) {}           //  No definition - forbid this
+        void operator=(TaskScheduler const &) {}    //  No definition - forbid this
+
+        //  Taking task out of the queue and putting it back without a copy
+        _tqnode*    _PopNode(uint32_t now) volatile;
+        void        _Reschedule(_tqnode *node) volatile;
+        void        _FreeNode(_tqnode *node) volatile;
+        void        _DrainDeferred() volatile;
+        int8_t      _FindRule(uint8_t libUID, uint8_t taskID) volatile;
+        void        _Coalesce() volatile;
+        void        _Idle() volatile;
+#ifdef _TS_PERF_ANALYSIS_
+        ServiceProfile* _Profile(uint8_t libUID, uint8_t taskID) volatile;
+#endif
 
 
-		//  Queue of tasks to be executed, implemented as doubly linked list
-		volatile LinkedList	_taskLog;
+		//  Queue of tasks to be executed, implemented either as binary min-heap
+		//  or as hierarchical timing wheel (see TaskQueue typedef)
+		volatile TaskQueue	_taskLog;
+		//  Requests posted from interrupts, waiting to be added to _taskLog
+		volatile DeferQueue _deferred;
+		//  Backlog and load statistics, overload state
+		volatile LoadMonitor _load;
+		//  Budget of the task being executed, overrun statistics
+		volatile BudgetMonitor _budget;
 		/*
 		 *  Pointer to last added item (to be able to append arguments to it)
-		 *  ->Is being reset to zero after calling PopFront() function
+		 *  ->Is being reset to zero once a task is taken out of the queue
 		 *  ->volatile pointer (because it can change from within interrupt) to
 		 *  a volatile object (object can be removed from within interrupt)
 		 */
-		volatile _llnode* volatile _lastIndex;
-
-        //  Interface with task scheduler - provides memory space and function
-        //  to call in order for task scheduler to request service from this module
-        struct _kernelEntry _ker;
+		volatile _tqnode* volatile _lastIndex;
+		//  Coalescing policy of the last added task, -1 if it has none or it
+		//  has already been applied
+		volatile int8_t _lastRule;
+		//  Coalescing policies of services
+		volatile _coalesceRule _rules[TS_COALESCE_RULES];
+		volatile uint8_t _numRules;
+#ifdef _TS_PERF_ANALYSIS_
+		//  Profiles of services called so far
+		volatile ServiceProfile _profiles[TS_PROFILE_SERVICES];
+		volatile uint8_t _numProfiles;
+#endif
+		//  Function called when no task is due, 0 if not used
+		void (*_idleHook)(void);
+		//  Position of the last task returned by FetchNextTask()
+		uint32_t _fetchIndex;
+
+		//  Services provided by task scheduler, indexed by TASKSCHED_T_*
+		static const _tsService _services[];
+		uint32_t _Enable(bool enable);
+		uint32_t _Kill(uint16_t PIDarg);
 };
 
 extern void TS_GlobalCheck(void);
-extern void TS_RegCallback(struct _kernelEntry *arg, uint8_t uid);
+extern uint16_t TS_CurrentPID(void);
+extern void TS_RegServices(uint8_t uid, const _tsService *services,
+                           uint8_t num);
 
 
 #endif /* TASKSCHEDULER_H_ */
@@ -0,0 +1,513 @@
+/**
+ * taskWheel.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran
+ */
+#include "taskWheel.h"
+#include "tsPool.h"
+#include "init/kernelContext.h"
+
+#if defined(__TS_USE_TIMING_WHEEL__)   //  Compile only if wheel is selected
+
+#ifdef __DEBUG_SESSION__
+#include "serialPort/uartHW.h"
+#endif
+
+//  Indexes of lists inside the wheel
+#define TW_DUE              0
+#define TW_SLOT(L, I)       (1 + (L) * TS_WHEEL_SLOTS + (I))
+#define TW_OVERFLOW         (TS_WHEEL_LISTS - 1)
+
+//  Index of the slot on level L in which time stamp T falls
+#define TW_INDEX(T, L)      (((T) >> (TS_WHEEL_BITS * (L))) & (TS_WHEEL_SLOTS - 1))
+
+/*******************************************************************************
+  *********         Task queue node - member functions                 *********
+ ******************************************************************************/
+_tqnode::_tqnode() : data(), _prev(0), _next(0), _list(0), _seq(0)
+{
+    _idx.pidNext = 0;
+    _idx.svcPrev = 0;
+    _idx.svcNext = 0;
+};
+
+/**
+ * Memory pool holding all nodes of the task queue of current kernel context
+ * @return reference to the pool
+ */
+MemPool& TS_NodePool()
+{
+    return *(KernelContext::Current().nodePool);
+}
+
+void* _tqnode::operator new(size_t size) throw()
+{
+    return TS_NodePool().Alloc(size);
+}
+
+void _tqnode::operator delete(void *ptr)
+{
+    TS_NodePool().Free(ptr);
+}
+
+
+/*******************************************************************************
+ *********          TaskWheel  member functions                        *********
+ ******************************************************************************/
+TaskWheel::TaskWheel() : _idle(0, 0, 0xFFFFFFFF), size(0), _seqCount(0), _pidCount(1),
+                         _time(0)
+{
+    for (uint16_t i = 0; i < TS_WHEEL_LISTS; i++)
+    {
+        _lists[i].head = 0;
+        _lists[i].tail = 0;
+    }
+}
+
+TaskWheel::~TaskWheel()
+{
+    //  Delete any data in the queue when it goes out of scope
+    if (size > 0)
+        Drop();
+}
+
+/**
+ * Add argument into the wheel. Task is placed in a slot based on its
+ * TaskEntry._timestamp parameter, or straight into the list of due tasks if
+ * its time has already come.
+ * @note If new task has same _timestamp value (time to be executed at) as the
+ * task already in the queue, new task is executed after the existing one
+ * @note Arguments of [arg] are moved into the queue, [arg] is left without them
+ * @param arg task to add to the queue
+ * @return pointer to the instance of task inside the queue, 0 if queue is full
+ */
+volatile _tqnode* TaskWheel::AddSort(TaskEntry &arg) volatile
+{
+    //  Keep the same limit on number of pending tasks as the heap has
+    if (size >= TS_MAX_TASKS)
+        return 0;
+
+    _tqnode *tmp = NewNode(arg);
+    if (tmp == 0)
+        return 0;
+
+    PushNode(tmp);
+
+    return tmp;
+}
+
+/**
+ * Create a node holding a given task, without putting it into the wheel
+ * Task gets a new PID unless it already has one
+ * @note Arguments of [arg] are moved into the node, [arg] is left without them
+ * @param arg task to place in the node
+ * @return new node, 0 if node pool is empty
+ */
+_tqnode* TaskWheel::NewNode(TaskEntry &arg) volatile
+{
+    _tqnode *tmp = new _tqnode();       //  Take new node from the node pool
+    if (tmp == 0)
+        return 0;
+
+    tmp->data.MoveFrom(arg);
+
+    //  Update PID of a task -> only if it doesn't already have one
+    if (tmp->data._PID == 0)
+    {
+        tmp->data._PID = _pidCount;
+        _pidCount++;
+    }
+
+    return tmp;
+}
+
+/**
+ * Find and delete from the queue a task passed as an argument
+ * @note task in arg has valid libUID, taskID and arguments
+ * @param arg
+ * @return true if task was found and deleted, false otherwise
+ */
+bool TaskWheel::RemoveEntry(TaskEntry &arg) volatile
+{
+    //  Only tasks requesting the same service need to be compared
+    _tqnode *node = _index.Find(arg);
+
+    //  Node wasn't found in the queue, return false
+    if (node == 0)
+        return false;
+
+    _Delete(node);
+    return true;
+}
+
+/**
+ * Find and delete from the queue a task with given PID
+ * @param PIDarg PID of task to delete
+ * @return true if task was found and deleted, false otherwise
+ */
+bool TaskWheel::RemoveEntry(uint16_t PIDarg) volatile
+{
+    _tqnode *node = _index.Find(PIDarg);
+
+    //  Node wasn't found in the queue, return false
+    if (node == 0)
+        return false;
+
+    _Delete(node);
+    return true;
+}
+
+/**
+ * Delete content of the queue.
+ * Traverses all lists in the wheel and returns their nodes to the node pool.
+ * @return false: success
+ *          true: otherwise
+ */
+bool TaskWheel::Drop() volatile
+{
+    //  Check if queue is already empty
+    if (TaskWheel::IsEmpty())
+        return false;
+
+    for (uint16_t i = 0; i < TS_WHEEL_LISTS; i++)
+        while (_lists[i].head != 0)
+            _Delete(_lists[i].head);
+
+    return (size != 0);
+}
+
+/**
+ * Take node of the task to execute next out of the queue without releasing it.
+ * Out of all tasks that are due, the one with the highest priority class and
+ * earliest deadline is taken (see TaskEntry::DispatchBefore()). Node can be put
+ * back into the queue with PushNode() or released with FreeNode()
+ * @param now current time (in ms), unused as list of due tasks is already
+ * up to date after calling Advance()
+ * @return node of the task to execute, 0 if no task is due
+ */
+_tqnode* TaskWheel::PopNode(uint32_t /*now*/) volatile
+{
+    _tqnode *best = _lists[TW_DUE].head;
+
+    //  Check if there are tasks to execute
+    if (best == 0)
+        return 0;
+
+    //  List of due tasks is sorted by time stamp and insertion order, so only
+    //  a task that strictly goes before keeps the FIFO order of the rest
+    for (_tqnode *node = best->_next; node != 0; node = node->_next)
+        if (node->data.DispatchBefore(best->data))
+            best = node;
+
+    _Unlink(best);
+    _index.Remove(best);
+    size--;
+
+    return best;
+}
+
+/**
+ * Count tasks that are due but haven't been executed yet
+ * @note Only list of due tasks is counted, call Advance() first
+ * @param now current time (in ms), unused
+ * @param oldest [out] time stamp of the oldest due task, [now] if none is due
+ * @return number of due tasks
+ */
+uint16_t TaskWheel::CountDue(uint32_t now, uint32_t &oldest) volatile
+{
+    uint16_t count = 0;
+
+    oldest = now;
+    //  List of due tasks is sorted, head is the oldest
+    if (_lists[TW_DUE].head != 0)
+        oldest = _lists[TW_DUE].head->data._timestamp;
+
+    for (_tqnode *node = _lists[TW_DUE].head; node != 0; node = node->_next)
+        count++;
+
+    return count;
+}
+
+/**
+ * Put existing node into the wheel, based on its time stamp. Node is treated
+ * as newly added when resolving ties in time stamp.
+ * @param node node to insert (not a member of the queue)
+ * @return true if node was inserted, false if queue is full
+ */
+bool TaskWheel::PushNode(_tqnode *node) volatile
+{
+    //  Keep the same limit on number of pending tasks as the heap has
+    if (size >= TS_MAX_TASKS)
+        return false;
+
+    node->_seq = _seqCount++;
+    size++;
+
+    _Place(node);
+    _index.Insert(node);
+
+    return true;
+}
+
+/**
+ * Put a group of nodes into the wheel at once. Placing a node in the wheel
+ * doesn't depend on other nodes, so they're simply placed one by one.
+ * @note Nodes are added either all or none
+ * @param nodes array of nodes to insert (not members of the queue)
+ * @param num number of nodes in [nodes]
+ * @return true if nodes were inserted, false if there's not enough space
+ */
+bool TaskWheel::PushBatch(_tqnode **nodes, uint16_t num) volatile
+{
+    //  Keep the same limit on number of pending tasks as the heap has
+    if ((size + num) > TS_MAX_TASKS)
+        return false;
+
+    for (uint16_t i = 0; i < num; i++)
+        PushNode(nodes[i]);
+
+    return true;
+}
+
+/**
+ * Return node at a given position when traversing all lists of the wheel
+ * @note Due tasks are visited first and in order of execution, the rest are
+ * visited slot by slot and are only roughly sorted
+ * @param index position of the node
+ * @return pointer to the node at [index], 0 if index is out of boundaries
+ */
+volatile _tqnode* TaskWheel::PeekAt(uint32_t index) volatile
+{
+    _tqnode *node = _Next(0);
+
+    while ((node != 0) && (index > 0))
+    {
+        node = _Next(node);
+        index--;
+    }
+
+    return node;
+}
+
+/**
+ * Move time of the wheel forward up to [now]. On every ms tasks are cascaded
+ * from higher levels into lower ones and tasks due at that ms are moved to the
+ * list of due tasks.
+ * @param now current time (in ms)
+ */
+void TaskWheel::Advance(uint32_t now) volatile
+{
+    while (_time < now)
+    {
+        //  Nothing in the wheel to cascade, jump directly to current time
+        if (size == 0)
+        {
+            _time = now;
+            break;
+        }
+
+        _time++;
+
+        //  Time has wrapped around the whole wheel, re-examine overflow list
+        if ((_time & ((1UL << (TS_WHEEL_BITS * TS_WHEEL_LEVELS)) - 1)) == 0)
+            _Replace(TW_OVERFLOW);
+
+        //  Cascade from the top level down, so that tasks cascaded from level L
+        //  end up in the right slot before level L-1 is cascaded
+        for (uint8_t L = TS_WHEEL_LEVELS - 1; L > 0; L--)
+            if ((_time & ((1UL << (TS_WHEEL_BITS * L)) - 1)) == 0)
+                _Replace(TW_SLOT(L, TW_INDEX(_time, L)));
+
+        //  All tasks in current slot of level 0 are now due
+        _Replace(TW_SLOT(0, TW_INDEX(_time, 0)));
+    }
+}
+
+/**
+ * Get the earliest time at which a task might become due, used to decide how
+ * long task scheduler can sleep for
+ * @note Only level 0 of the wheel is searched. Tasks on higher levels can't
+ * become due before the start of the next level-0 round, when they're cascaded,
+ * so that time is returned instead (never later than the actual time stamp)
+ * @param timestamp [out] earliest time (in ms) at which a task can be due
+ * @return true if wheel contains tasks, false if it's empty
+ */
+bool TaskWheel::NextDue(uint32_t &timestamp) volatile
+{
+    if (size == 0)
+        return false;
+
+    if (_lists[TW_DUE].head != 0)
+    {
+        timestamp = _lists[TW_DUE].head->data._timestamp;
+        return true;
+    }
+
+    //  Look through the rest of the current round of level 0
+    uint32_t time = _time + 1;
+    for (; (time & (TS_WHEEL_SLOTS - 1)) != 0; time++)
+        if (_lists[TW_SLOT(0, TW_INDEX(time, 0))].head != 0)
+            break;
+
+    timestamp = time;
+    return true;
+}
+
+///-----------------------------------------------------------------------------
+///                      Wheel maintenance                             [PRIVATE]
+///-----------------------------------------------------------------------------
+
+/**
+ * Put node into the list matching its time stamp, relative to current time of
+ * the wheel. Task is placed on the lowest level whose slot covers both current
+ * time and the task's time stamp.
+ * @param node node to place (not a member of any list)
+ */
+void TaskWheel::_Place(_tqnode *node) volatile
+{
+    uint32_t ts = node->data._timestamp;
+
+    //  Task is already due
+    if (ts <= _time)
+    {
+        _Link(TW_DUE, node, true);
+        return;
+    }
+
+    for (uint8_t L = 0; L < TS_WHEEL_LEVELS; L++)
+        if (((ts ^ _time) >> (TS_WHEEL_BITS * (L + 1))) == 0)
+        {
+            //  All tasks in a slot on level 0 share the same time stamp, keep
+            //  them in FIFO order. Other levels are sorted when cascaded.
+            _Link(TW_SLOT(L, TW_INDEX(ts, L)), node, (L == 0));
+            return;
+        }
+
+    //  Too far in the future for the wheel to cover
+    _Link(TW_OVERFLOW, node, false);
+}
+
+/**
+ * Empty a list and place all of its nodes again based on current time
+ * @param list index of the list to re-place
+ */
+void TaskWheel::_Replace(uint16_t list) volatile
+{
+    _tqnode *node = _lists[list].head;
+
+    _lists[list].head = 0;
+    _lists[list].tail = 0;
+
+    while (node != 0)
+    {
+        _tqnode *next = node->_next;
+        _Place(node);
+        node = next;
+    }
+}
+
+/**
+ * Insert node into a list
+ * @param list index of the list to insert node into
+ * @param node node to insert (not a member of any list)
+ * @param sorted if true node is inserted so that list remains sorted by time
+ * stamp and insertion order, otherwise it's appended at the end
+ */
+void TaskWheel::_Link(uint16_t list, _tqnode *node, bool sorted) volatile
+{
+    //  Find node after which to insert, starting from the tail as new tasks
+    //  usually go at the end
+    _tqnode *pos = _lists[list].tail;
+
+    if (sorted)
+        while ((pos != 0) && _Before(node, pos))
+            pos = pos->_prev;
+
+    node->_prev = pos;
+    node->_next = (pos == 0) ? _lists[list].head : pos->_next;
+    node->_list = list;
+
+    if (node->_next != 0)
+        node->_next->_prev = node;
+    else
+        _lists[list].tail = node;
+
+    if (pos != 0)
+        pos->_next = node;
+    else
+        _lists[list].head = node;
+}
+
+/**
+ * Remove node from the list it's in (doesn't free its memory)
+ * @param node node to remove
+ */
+void TaskWheel::_Unlink(_tqnode *node) volatile
+{
+    if (node->_prev != 0)
+        node->_prev->_next = node->_next;
+    else
+        _lists[node->_list].head = node->_next;
+
+    if (node->_next != 0)
+        node->_next->_prev = node->_prev;
+    else
+        _lists[node->_list].tail = node->_prev;
+
+    node->_prev = 0;
+    node->_next = 0;
+}
+
+/**
+ * Remove node from the wheel and free its memory
+ * @param node node to delete
+ */
+void TaskWheel::_Delete(_tqnode *node) volatile
+{
+    _Unlink(node);
+    _index.Remove(node);
+    delete node;
+    size--;
+}
+
+/**
+ * Iterate over all nodes in the wheel
+ * @param node current node, 0 to get the first node
+ * @return next node after [node], 0 if there are no more nodes
+ */
+_tqnode* TaskWheel::_Next(_tqnode *node) volatile
+{
+    uint16_t list = 0;
+
+    if (node != 0)
+    {
+        if (node->_next != 0)
+            return node->_next;
+        list = node->_list + 1;
+    }
+
+    //  Find next non-empty list
+    for (; list < TS_WHEEL_LISTS; list++)
+        if (_lists[list].head != 0)
+            return _lists[list].head;
+
+    return 0;
+}
+
+/**
+ * Compare two nodes
+ * Nodes are compared by their time stamp, in case of a tie the one added first
+ * is considered smaller (FIFO). Insertion counter is compared in a way that
+ * survives its overflow.
+ * @return true if node [a] needs to be executed before node [b]
+ */
+bool TaskWheel::_Before(_tqnode *a, _tqnode *b) volatile
+{
+    if (a->data._timestamp != b->data._timestamp)
+        return (a->data._timestamp < b->data._timestamp);
+
+    return ((int32_t)(a->_seq - b->_seq) < 0);
+}
+
+#endif  /* __TS_USE_TIMING_WHEEL__ */
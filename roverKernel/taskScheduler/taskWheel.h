@@ -0,0 +1,204 @@
+/**
+ * taskWheel.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ *
+ *  Hierarchical timing wheel used as an alternative container of pending tasks
+ *  (selected by defining __TS_USE_TIMING_WHEEL__ in hwconfig.h). Most of the
+ *  tasks in the kernel are periodic with periods of few ms up to few seconds,
+ *  so instead of keeping all tasks sorted, tasks are dropped into time slots
+ *  and only sorted once they become due. Adding, rescheduling and removing a
+ *  known task is O(1) regardless of the number of pending tasks.
+ *
+ *  Wheel has TS_WHEEL_LEVELS levels of TS_WHEEL_SLOTS slots each. Slots on
+ *  level 0 are 1ms wide, each next level has slots TS_WHEEL_SLOTS times wider.
+ *  Tasks further in the future than the whole wheel covers are kept in an
+ *  overflow list. As time advances, tasks are moved (cascaded) from higher
+ *  levels into lower ones and finally into a list of due tasks, which is kept
+ *  sorted by the time stamp. Tasks with the same time stamp are executed in
+ *  the order they were added (FIFO), same as with the heap.
+ */
+#include "hwconfig.h"
+
+//  Compile following section only if hwconfig.h says to use timing wheel
+#if !defined(ROVERKERNEL_TASKSCHEDULER_TASKWHEEL_H_) \
+    && defined(__TS_USE_TIMING_WHEEL__)
+#define ROVERKERNEL_TASKSCHEDULER_TASKWHEEL_H_
+
+#include "taskEntry.h"
+#include "tsIndex.h"
+
+//  Number of levels in the wheel
+#define TS_WHEEL_LEVELS     4
+//  Number of slots on each level, as a power of 2 (2^6 = 64 slots)
+#define TS_WHEEL_BITS       6
+#define TS_WHEEL_SLOTS      (1 << TS_WHEEL_BITS)
+//  Total number of lists in the wheel: list of due tasks, all the slots and
+//  list of tasks overflowing the wheel
+#define TS_WHEEL_LISTS      (TS_WHEEL_LEVELS * TS_WHEEL_SLOTS + 2)
+
+/**
+ * Node holding a single task (of type TaskEntry) in the task queue
+ * Nodes are allocated once when task is added and don't move in memory for as
+ * long as task is pending, which allows task scheduler to keep a pointer to
+ * the last added task (to append arguments to it). Each node is a member of
+ * exactly one doubly-linked list in the wheel.
+ * All member functions & constructors are private as this class shouldn't be
+ * used outside the TaskScheduler object
+ */
+class _tqnode
+{
+    friend class TaskWheel;
+    friend class TaskIndex;
+    friend class TaskScheduler;
+    friend void TS_GlobalCheck(void);
+
+    private:
+        _tqnode();
+
+        //  Nodes are allocated from a memory pool, see TS_NodePool()
+        static void*    operator new(size_t size) throw();
+        static void     operator delete(void *ptr);
+
+        volatile TaskEntry   data;
+        _tqnode     *_prev;     //  Previous node in the same list
+        _tqnode     *_next;     //  Next node in the same list
+        uint16_t    _list;      //  Index of the list this node is in
+        uint32_t    _seq;       //  Insertion order, resolves ties in timestamp
+        _tsIndexLink _idx;      //  Links into index of pending tasks
+};
+
+/**
+ * Doubly-linked list of nodes, used for every slot of the wheel
+ */
+struct _twList
+{
+    _tqnode *head;
+    _tqnode *tail;
+};
+
+/**
+ * Hierarchical timing wheel of TaskEntry objects
+ * Offers the same interface to TaskScheduler as TaskHeap so the two can be
+ * swapped at compile time. Used only in TaskScheduler class to keep all
+ * pending task requests ergo everything is private.
+ */
+class TaskWheel
+{
+    friend class TaskScheduler;
+    friend void TS_GlobalCheck(void);
+
+    public:
+        ~TaskWheel();
+    private:
+        TaskWheel();
+
+        volatile _tqnode*   AddSort(TaskEntry &arg) volatile;
+        _tqnode*            NewNode(TaskEntry &arg) volatile;
+        bool                PushBatch(_tqnode **nodes, uint16_t num) volatile;
+        bool                RemoveEntry(TaskEntry &arg) volatile;
+        bool                RemoveEntry(uint16_t PIDarg) volatile;
+        bool                Drop() volatile;
+        _tqnode*            PopNode(uint32_t now) volatile;
+        bool                PushNode(_tqnode *node) volatile;
+        volatile _tqnode*   PeekAt(uint32_t index) volatile;
+        uint16_t            CountDue(uint32_t now, uint32_t &oldest) volatile;
+        void                Advance(uint32_t now) volatile;
+        bool                NextDue(uint32_t &timestamp) volatile;
+
+        void                _Place(_tqnode *node) volatile;
+        void                _Replace(uint16_t list) volatile;
+        void                _Link(uint16_t list, _tqnode *node, bool sorted) volatile;
+        void                _Unlink(_tqnode *node) volatile;
+        void                _Delete(_tqnode *node) volatile;
+        _tqnode*            _Next(_tqnode *node) volatile;
+        bool                _Before(_tqnode *a, _tqnode *b) volatile;
+
+        ///---------------------------------------------------------------------
+        ///                      Inline functions                       [PUBLIC]
+        ///---------------------------------------------------------------------
+        /**
+         * Check whether the task queue is empty
+         * @return true: queue is empty
+         *        false: queue contains data
+         */
+        inline bool IsEmpty() volatile
+        {
+            return (size == 0);
+        }
+        /**
+         * Returns reference to the ->data content of first due task but it
+         * remains in the queue (it's not taken out as with PopNode)
+         * @note If no task is due yet, returns a placeholder task with time stamp
+         * right after current time of the wheel (not due when compared in a way
+         * that survives overflow of time stamps)
+         * @return reference to ->data content of first due task
+         */
+        inline volatile TaskEntry& PeekFront() volatile
+        {
+            if (_lists[0].head == 0)
+            {
+                _idle._timestamp = _time + 1;
+                return _idle;
+            }
+
+            return _lists[0].head->data;
+        }
+        /**
+         * Release node previously taken out of the queue by PopNode()
+         * @param node node to release
+         */
+        inline void FreeNode(_tqnode *node) volatile
+        {
+            delete node;
+        }
+        /**
+         * Find pending task with a given PID
+         * @param PIDarg PID of the task
+         * @return pointer to the node of the task, 0 if it's not in the queue
+         */
+        inline volatile _tqnode* Find(uint16_t PIDarg) volatile
+        {
+            return _index.Find(PIDarg);
+        }
+        /**
+         * Find any pending task requesting a given service
+         * @return pointer to the node of the task, 0 if there's none
+         */
+        inline volatile _tqnode* FindService(uint8_t libUID,
+                                             uint8_t taskID) volatile
+        {
+            return _index.FindService(libUID, taskID);
+        }
+        /**
+         * Find another pending task equivalent to the one in [node]
+         * @return pointer to the node of the task, 0 if there's none
+         */
+        inline _tqnode* FindEquivalent(_tqnode *node, uint16_t keyLen) volatile
+        {
+            return _index.FindEquivalent(node, keyLen);
+        }
+
+    private:
+        //  All lists of the wheel: [0] is list of due tasks, followed by slots
+        //  of each level and lastly the overflow list
+        volatile _twList    _lists[TS_WHEEL_LISTS];
+        //  Index of tasks in the wheel by their PID and service
+        volatile TaskIndex  _index;
+        //  Placeholder returned by PeekFront() when no task is due
+        volatile TaskEntry  _idle;
+        volatile uint32_t   size;
+        //  Ever increasing counter, used to keep FIFO order of tasks with the
+        //  same time stamp
+        volatile uint32_t   _seqCount;
+        //  Ever increasing variable, counts number of created tasks in order to
+        //  uniquely identify each task (never decreases, overflows at 65536)
+        volatile uint16_t   _pidCount;
+        //  Current time of the wheel (in ms), all tasks with time stamp smaller
+        //  or equal to this are in the list of due tasks
+        volatile uint32_t   _time;
+};
+
+
+#endif /* ROVERKERNEL_TASKSCHEDULER_TASKWHEEL_H_ */
@@ -0,0 +1,90 @@
+/**
+ * tsBatch.cpp
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran
+ */
+#include "tsBatch.h"
+
+///-----------------------------------------------------------------------------
+///                      Class constructor                              [PUBLIC]
+///-----------------------------------------------------------------------------
+
+TaskBatch::TaskBatch() : _count(0), _argUsed(0), _overflow(false)
+{
+}
+
+///-----------------------------------------------------------------------------
+///                      Class member functions                         [PUBLIC]
+///-----------------------------------------------------------------------------
+
+/**
+ * Add task to the batch, parameters have the same meaning as in
+ * TaskScheduler::SyncTaskPer()
+ * @param libUID UID of library to call
+ * @param taskID task ID within the library to execute
+ * @param time time-stamp at which to execute the task. If >0 its absolute time
+ * in ms since startup of task scheduler. If <=0 its relative time from the
+ * moment batch is added to task scheduler
+ * @param period period at which to repeat task, 0 for non-periodic task
+ * @param rep repeat counter, negative number for indefinite repeat
+ * @param prio priority class of the task
+ * @param deadline time (in ms) after the time-stamp by which task has to finish
+ * @return true if task was added, false if batch is full
+ */
+bool TaskBatch::Add(uint8_t libUID, uint8_t taskID, int64_t time,
+                    int32_t period, int32_t rep, uint8_t prio, int32_t deadline)
+{
+    if (_count >= TS_BATCH_SIZE)
+    {
+        _overflow = true;
+        return false;
+    }
+
+    _batchItem &item = _items[_count++];
+    item.libUID = libUID;
+    item.taskID = taskID;
+    item.time = time;
+    item.period = period;
+    item.rep = rep;
+    item.prio = prio;
+    item.deadline = deadline;
+    item.argOff = _argUsed;
+    item.argN = 0;
+
+    return true;
+}
+
+/**
+ * Append arguments to the last task added to the batch
+ * @param arg pointer to arguments
+ * @param argLen length of arguments (in bytes)
+ * @return true if arguments were appended, false if there's no task to append
+ * them to or they don't fit into the batch
+ */
+bool TaskBatch::AddArgs(const void *arg, uint16_t argLen)
+{
+    if ((_count == 0) || ((_argUsed + argLen) > TS_BATCH_ARG_SIZE))
+    {
+        _overflow = true;
+        return false;
+    }
+
+    //  Arguments of the last task are at the end of the buffer, so appending
+    //  keeps them contiguous
+    memcpy((void*)(_args + _argUsed), arg, argLen);
+    _argUsed += argLen;
+    _items[_count - 1].argN += argLen;
+
+    return true;
+}
+
+/**
+ * Remove all tasks from the batch so it can be reused
+ */
+void TaskBatch::Clear()
+{
+    _count = 0;
+    _argUsed = 0;
+    _overflow = false;
+}
@@ -0,0 +1,100 @@
+/**
+ *  tsBatch.h
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran Mikov
+ *
+ *  Task scheduler extension for adding several tasks at once. Every call to
+ *  SyncTask/AddArgs is a separate critical section, so scheduling a group of
+ *  tasks (a mission received from the server, periodic tasks on startup)
+ *  disables interrupts over and over and can leave only part of the group
+ *  scheduled if the queue fills up half way through. TaskBatch collects tasks
+ *  and their arguments in a small buffer outside of the scheduler, which are
+ *  then added to the task queue together by TaskScheduler::SyncBatch(), within
+ *  a single critical section. Batch is added either as a whole or not at all.
+ *  @version 1.0
+ *  V1.0 - 17.10.2026
+ *  +Creation of file, builder of a group of tasks
+ */
+
+#ifndef ROVERKERNEL_TASKSCHEDULER_TSBATCH_H_
+#define ROVERKERNEL_TASKSCHEDULER_TSBATCH_H_
+
+#include "hwconfig.h"
+#include "taskEntry.h"
+
+/**
+ * Single task in the batch, holds parameters as passed to SyncTaskPer()
+ */
+struct _batchItem
+{
+    int64_t     time;       //  Time stamp, absolute if >0, relative otherwise
+    int32_t     period;     //  Period of task, 0 if task isn't periodic
+    int32_t     rep;        //  Number of repeats, negative for indefinite
+    int32_t     deadline;   //  Deadline relative to time stamp, 0 for none
+    uint16_t    argOff;     //  Offset of arguments in the argument buffer
+    uint16_t    argN;       //  Length of arguments
+    uint8_t     libUID;
+    uint8_t     taskID;
+    uint8_t     prio;
+};
+
+/**
+ * Builder of a group of tasks to be added to the task scheduler together
+ * @note Same as with task scheduler, task is added first and its arguments are
+ * appended with AddArgs() or AddArg<T>() afterwards
+ * If any task or argument doesn't fit into the batch, the whole batch is
+ * marked invalid and task scheduler will refuse it.
+ */
+class TaskBatch
+{
+    friend class TaskScheduler;
+
+    public:
+        TaskBatch();
+        ~TaskBatch() {};
+
+        bool    Add(uint8_t libUID, uint8_t taskID, int64_t time,
+                    int32_t period = 0, int32_t rep = 0,
+                    uint8_t prio = T_PRIO_NORMAL, int32_t deadline = 0);
+        bool    AddArgs(const void *arg, uint16_t argLen);
+        void    Clear();
+
+        /**
+         * Append a single argument of any basic type to the last added task
+         * @param arg data argument to append
+         * @return true if argument was added, false otherwise
+         */
+        template<typename T>
+        bool AddArg(T arg)
+        {
+            return AddArgs((void*)&arg, sizeof(arg));
+        }
+        /**
+         * Get number of tasks in the batch
+         */
+        inline uint8_t Count() const
+        {
+            return _count;
+        }
+        /**
+         * Check whether all tasks and their arguments fit into the batch
+         * @return true if batch can be added to task scheduler
+         */
+        inline bool IsValid() const
+        {
+            return !_overflow;
+        }
+
+    private:
+        //  Tasks in the order they were added
+        _batchItem  _items[TS_BATCH_SIZE];
+        //  Arguments of all tasks, placed one after the other
+        uint8_t     _args[TS_BATCH_ARG_SIZE];
+        uint8_t     _count;
+        uint16_t    _argUsed;
+        //  Set when something didn't fit into the batch
+        bool        _overflow;
+};
+
+#endif /* ROVERKERNEL_TASKSCHEDULER_TSBATCH_H_ */
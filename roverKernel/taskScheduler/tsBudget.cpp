@@ -0,0 +1,110 @@
+/**
+ * tsBudget.cpp
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran
+ */
+#include "tsBudget.h"
+
+///-----------------------------------------------------------------------------
+///                      Class constructor                              [PUBLIC]
+///-----------------------------------------------------------------------------
+
+BudgetMonitor::BudgetMonitor() : overruns(0), caught(0), maxExcessUS(0),
+                                 lastLibUID(0), lastTaskID(0), lastPID(0),
+                                 _libUID(0), _taskID(0), _PID(0), _budgetUS(0),
+                                 _startUS(0), _running(false), _flagged(false)
+{}
+
+///-----------------------------------------------------------------------------
+///                      Class member functions                         [PUBLIC]
+///-----------------------------------------------------------------------------
+
+/**
+ * Task is about to be executed, start measuring its budget
+ * @param libUID UID of library providing the service
+ * @param taskID task ID within the library
+ * @param PID PID of the task
+ * @param budgetUS budget (in us) of the service, 0 if it has none
+ * @param nowUS current time (in us)
+ */
+void BudgetMonitor::Start(uint8_t libUID, uint8_t taskID, uint16_t PID,
+                          uint32_t budgetUS, uint64_t nowUS) volatile
+{
+    _libUID = libUID;
+    _taskID = taskID;
+    _PID = PID;
+    _budgetUS = budgetUS;
+    _startUS = nowUS;
+    _flagged = false;
+    //  Set last, interrupt only looks at the task once all of the above is set
+    _running = (budgetUS != 0);
+}
+
+/**
+ * Check task being executed against its budget. Called from the interrupt, so
+ * a task that doesn't return at all is still caught
+ * @param nowUS current time (in us)
+ * @return true if task has just gone over its budget (only the first time it's
+ * found to be over it)
+ */
+bool BudgetMonitor::Check(uint64_t nowUS) volatile
+{
+    if (!_running || _flagged || ((nowUS - _startUS) <= _budgetUS))
+        return false;
+
+    _flagged = true;
+    caught++;
+    _Overrun(nowUS);
+
+    return true;
+}
+
+/**
+ * Task has returned, check the time it took against its budget
+ * @param nowUS current time (in us)
+ * @return one of TS_BUDGET_* macros
+ */
+uint8_t BudgetMonitor::End(uint64_t nowUS) volatile
+{
+    //  Clear first, interrupt coming after this no longer checks the task and
+    //  the one coming before it has already set _flagged
+    bool running = _running;
+    _running = false;
+
+    if (!running || ((nowUS - _startUS) <= _budgetUS))
+        return TS_BUDGET_OK;
+
+    if (_flagged)
+    {
+        //  Already counted, only the excess has grown since
+        uint32_t excess = (uint32_t)(nowUS - _startUS) - _budgetUS;
+        if (excess > maxExcessUS)
+            maxExcessUS = excess;
+        return TS_BUDGET_CAUGHT;
+    }
+
+    _Overrun(nowUS);
+
+    return TS_BUDGET_OVERRUN;
+}
+
+///-----------------------------------------------------------------------------
+///                      Class member functions                        [PRIVATE]
+///-----------------------------------------------------------------------------
+
+/**
+ * Count overrun of the task being executed
+ * @param nowUS current time (in us)
+ */
+void BudgetMonitor::_Overrun(uint64_t nowUS) volatile
+{
+    uint32_t excess = (uint32_t)(nowUS - _startUS) - _budgetUS;
+
+    overruns++;
+    if (excess > maxExcessUS)
+        maxExcessUS = excess;
+    lastLibUID = _libUID;
+    lastTaskID = _taskID;
+    lastPID = _PID;
+}
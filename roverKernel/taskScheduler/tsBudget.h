@@ -0,0 +1,76 @@
+/**
+ *  tsBudget.h
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran Mikov
+ *
+ *  Task scheduler extension for enforcing run-time budgets of services. Service
+ *  can be given a budget (longest time, in us, a single call of it is expected
+ *  to take) in the table it registers with task scheduler. Task scheduler then
+ *  checks the time each call took once it returns, and its periodic interrupt
+ *  (SysTick, or wake-up timer in tickless mode) checks the task still running,
+ *  so that a task stuck in a loop is caught while it's stuck instead of only
+ *  once it (if ever) returns. Every call going over budget is an overrun: it's
+ *  counted here and in the profile of the task, recorded into trace and
+ *  reported to event log as EVENT_OVERRUN on behalf of the offending service.
+ *  @version 1.0
+ *  V1.0 - 17.10.2026
+ *  +Creation of file, per-call budget check at the end of a task and from the
+ *  interrupt of task scheduler, overrun statistics
+ */
+
+#ifndef ROVERKERNEL_TASKSCHEDULER_TSBUDGET_H_
+#define ROVERKERNEL_TASKSCHEDULER_TSBUDGET_H_
+
+#include "hwconfig.h"
+
+//  Outcomes of BudgetMonitor::End()
+#define TS_BUDGET_OK        0   //  Task finished within its budget (or had none)
+#define TS_BUDGET_OVERRUN   1   //  Task went over budget
+#define TS_BUDGET_CAUGHT    2   //  Task went over budget, and was already caught
+                                //  by the interrupt while still running
+
+/**
+ * Budget of the task being executed and overrun statistics
+ * Start()/End() are called from TS_GlobalCheck (main loop) around every task,
+ * Check() from the interrupt of task scheduler.
+ */
+class BudgetMonitor
+{
+    public:
+        BudgetMonitor();
+        ~BudgetMonitor() {};
+
+        void        Start(uint8_t libUID, uint8_t taskID, uint16_t PID,
+                          uint32_t budgetUS, uint64_t nowUS) volatile;
+        bool        Check(uint64_t nowUS) volatile;
+        uint8_t     End(uint64_t nowUS) volatile;
+
+        //  Number of task calls that went over their budget
+        volatile uint32_t   overruns;
+        //  Number of those caught by the interrupt while task was still running
+        volatile uint32_t   caught;
+        //  Longest time (in us) a task has spent over its budget
+        volatile uint32_t   maxExcessUS;
+        //  Service and PID of the task that went over budget last
+        volatile uint8_t    lastLibUID;
+        volatile uint8_t    lastTaskID;
+        volatile uint16_t   lastPID;
+
+    private:
+        void        _Overrun(uint64_t nowUS) volatile;
+
+        //  Task being executed and its budget (in us), 0 if it has none
+        volatile uint8_t    _libUID;
+        volatile uint8_t    _taskID;
+        volatile uint16_t   _PID;
+        volatile uint32_t   _budgetUS;
+        //  Time (in us) task started at
+        volatile uint64_t   _startUS;
+        //  True while task with a budget is being executed
+        volatile bool       _running;
+        //  True once overrun of the task being executed has been counted
+        volatile bool       _flagged;
+};
+
+#endif /* ROVERKERNEL_TASKSCHEDULER_TSBUDGET_H_ */
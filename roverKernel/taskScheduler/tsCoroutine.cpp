@@ -0,0 +1,73 @@
+/**
+ * tsCoroutine.cpp
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran
+ */
+#include "tsCoroutine.h"
+#include "taskScheduler.h"
+
+#if defined(__HAL_USE_TASKSCH__)
+
+///-----------------------------------------------------------------------------
+///                      Class member functions                         [PUBLIC]
+///-----------------------------------------------------------------------------
+
+/**
+ * Claim coroutine for the task currently being executed
+ * @return true if task can run the coroutine, false if it's in use by another
+ * task that's still pending
+ */
+bool Coroutine::Enter()
+{
+    uint16_t pid = TS_CurrentPID();
+
+    //  Coroutine is free, or task is resuming it
+    if ((line == 0) || (owner == pid))
+    {
+        owner = pid;
+        return true;
+    }
+
+    //  Task which started the coroutine has been killed while it was waiting
+    //  to be resumed, start over for the new one
+    if (TaskScheduler::GetI().FindTask(owner) == 0)
+    {
+        line = 0;
+        owner = pid;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Release coroutine, next task starts it from the beginning
+ */
+void Coroutine::Exit()
+{
+    line = 0;
+    owner = 0;
+}
+
+/**
+ * Start timer used for delays and timeouts
+ * @param ms time (in ms) from now at which timer expires
+ */
+void Coroutine::SetTimer(uint32_t ms)
+{
+    until = (uint32_t)msSinceStartup + ms;
+}
+
+/**
+ * Get time until timer expires
+ * @return time (in ms) left, 0 if timer has already expired
+ */
+uint32_t Coroutine::Remaining() const
+{
+    int32_t left = (int32_t)(until - (uint32_t)msSinceStartup);
+
+    return (left > 0) ? (uint32_t)left : 0;
+}
+
+#endif  /* __HAL_USE_TASKSCH__ */
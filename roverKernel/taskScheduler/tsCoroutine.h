@@ -0,0 +1,138 @@
+/**
+ *  tsCoroutine.h
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran Mikov
+ *
+ *  Task scheduler extension for services that take long to complete (driving
+ *  to a point, radar scan, waiting on ESP reply). Instead of blocking in a
+ *  delay loop, such service returns TS_YIELD(ms) and scheduler puts the same
+ *  task back into the queue to be resumed after the given time, executing
+ *  other tasks in the meantime. Coroutine keeps track of where the service
+ *  stopped so that it can continue from that point once resumed (stackless,
+ *  implemented on top of switch statement):
+ *
+ *      uint32_t Module::_Service()
+ *      {
+ *          TS_CO_BEGIN(_co);
+ *          StartSomething();
+ *          TS_CO_AWAIT(_co, SomethingDone(), 10, 5000);
+ *          if (!SomethingDone())
+ *              TS_CO_RETURN(_co, STATUS_PROG_ERR);
+ *          TS_CO_END(_co);
+ *          return STATUS_OK;
+ *      }
+ *
+ *  @note Local variables of the service are lost every time it yields, state
+ *  that's needed after resuming has to be kept in member variables. Two TS_CO_
+ *  macros can't be used on the same line, and none can be used inside of
+ *  another switch statement
+ *  @note Arguments of the task are passed again every time it's resumed,
+ *  pointers to them mustn't be kept between yields
+ *  @version 1.0
+ *  V1.0 - 17.10.2026
+ *  +Creation of file, yield status code, coroutine with awaiting a delay or
+ *  a condition (with timeout)
+ */
+
+#ifndef ROVERKERNEL_TASKSCHEDULER_TSCOROUTINE_H_
+#define ROVERKERNEL_TASKSCHEDULER_TSCOROUTINE_H_
+
+#include "hwconfig.h"
+
+//  Returned by a service that isn't done yet and wants to be called again,
+//  lower 30 bits hold time (in ms) after which to call it. Top two bits tell
+//  it apart from STATUS_NO_EVENT and from sign-extended negative error codes
+#define STATUS_YIELD        0x40000000
+#define TS_YIELD_MAX_MS     0x3FFFFFFF
+#define TS_YIELD(ms)        (STATUS_YIELD | ((uint32_t)(ms) & TS_YIELD_MAX_MS))
+#define TS_IS_YIELD(ret)    (((ret) & ~TS_YIELD_MAX_MS) == STATUS_YIELD)
+
+//  Time (in ms) after which a task retries a coroutine that's in use by
+//  another task
+#define TS_CO_BUSY_MS       10
+//  Pass as timeout to TS_CO_AWAIT to wait without time limit
+#define TS_CO_FOREVER       0x7FFFFFFF
+
+/**
+ * Point at which a service stopped, and a timer for delays and timeouts
+ * One coroutine is run by one task at a time. Another task requesting the same
+ * service waits until the first one is done, unless the first one has been
+ * killed in the meantime, in which case coroutine is restarted for the new one.
+ */
+class Coroutine
+{
+    public:
+        Coroutine() : line(0), owner(0), until(0) {};
+        ~Coroutine() {};
+
+        bool        Enter();
+        void        Exit();
+        void        SetTimer(uint32_t ms);
+        uint32_t    Remaining() const;
+
+        /**
+         * Check whether a task is in the middle of the coroutine
+         * @return true if coroutine has been started but not finished
+         */
+        inline bool Running() const
+        {
+            return (line != 0);
+        }
+
+        //  Line (in source) at which to resume, 0 if not started
+        uint16_t    line;
+        //  PID of the task running the coroutine
+        uint16_t    owner;
+        //  Time stamp (in ms) at which current delay or timeout expires
+        uint32_t    until;
+};
+
+///-----------------------------------------------------------------------------
+///                 Coroutine statements
+///-----------------------------------------------------------------------------
+
+//  Start (or resume) coroutine, has to be the first statement of a service
+#define TS_CO_BEGIN(co)                                                         \
+    if (!(co).Enter())                                                          \
+        return TS_YIELD(TS_CO_BUSY_MS);                                         \
+    switch ((co).line) { case 0:
+
+//  End of coroutine, service returns its outcome after it
+#define TS_CO_END(co)                                                           \
+    } (co).Exit()
+
+//  Finish coroutine early, returning one of myLib.h STATUS_* macros
+#define TS_CO_RETURN(co, retVal)                                                \
+    do { (co).Exit(); return (retVal); } while (0)
+
+//  Let other tasks run, continue after at least [ms] milliseconds
+#define TS_CO_YIELD(co, ms)                                                     \
+    do { (co).line = __LINE__; return TS_YIELD(ms);                             \
+         case __LINE__:; } while (0)
+
+//  Statements above run into the case label of each yield point, tell the
+//  compiler that's intended (-Wimplicit-fallthrough)
+#if defined(__GNUC__) && (__GNUC__ >= 7)
+#define _TS_CO_FALLTHROUGH  __attribute__((fallthrough))
+#else
+#define _TS_CO_FALLTHROUGH
+#endif
+
+//  Continue once [ms] milliseconds have passed
+#define TS_CO_SLEEP(co, ms)                                                     \
+    do { (co).SetTimer(ms); (co).line = __LINE__; _TS_CO_FALLTHROUGH;          \
+         case __LINE__:                                                         \
+         if ((co).Remaining() > 0) return TS_YIELD((co).Remaining());           \
+    } while (0)
+
+//  Continue once [cond] is true, or [timeoutMS] milliseconds have passed.
+//  Condition is checked every [pollMS] milliseconds, check it again after
+//  this statement to tell whether it timed out
+#define TS_CO_AWAIT(co, cond, pollMS, timeoutMS)                                \
+    do { (co).SetTimer(timeoutMS); (co).line = __LINE__; _TS_CO_FALLTHROUGH;   \
+         case __LINE__:                                                         \
+         if (!(cond) && ((co).Remaining() > 0)) return TS_YIELD(pollMS);        \
+    } while (0)
+
+#endif /* ROVERKERNEL_TASKSCHEDULER_TSCOROUTINE_H_ */
@@ -0,0 +1,96 @@
+/**
+ * tsDefer.cpp
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran
+ */
+#include "tsDefer.h"
+#include "HAL/hal.h"
+
+///-----------------------------------------------------------------------------
+///                      Class constructor                              [PUBLIC]
+///-----------------------------------------------------------------------------
+
+DeferQueue::DeferQueue() : peak(0), overflows(0), _head(0), _tail(0)
+{
+}
+
+///-----------------------------------------------------------------------------
+///                      Class member functions                         [PUBLIC]
+///-----------------------------------------------------------------------------
+
+/**
+ * Post a request at the end of the ring (producer side, called from interrupt
+ * or main loop)
+ * @param libUID UID of library to call
+ * @param taskID task ID within the library to execute
+ * @param args pointer to arguments of the task, can be 0 if argLen is 0
+ * @param argLen length of arguments, at most TS_ARG_INLINE_SIZE bytes
+ * @return true if request was posted, false if it was dropped
+ */
+bool DeferQueue::Push(uint8_t libUID, uint8_t taskID,
+                      const void *args, uint8_t argLen) volatile
+{
+    //  Another producer mustn't take the same place while this one fills it
+    bool intState = HAL_BOARD_InterruptSuspend();
+    uint16_t tail = _tail;
+
+    //  Ring is full or arguments don't fit in the request
+    if (((uint16_t)(tail - _head) >= TS_DEFER_SIZE)
+        || (argLen > TS_ARG_INLINE_SIZE))
+    {
+        overflows++;
+        HAL_BOARD_InterruptRestore(intState);
+        return false;
+    }
+
+    volatile _deferItem &item = _items[tail & (TS_DEFER_SIZE - 1)];
+    item.libUID = libUID;
+    item.taskID = taskID;
+    item.argN = argLen;
+    for (uint8_t i = 0; i < argLen; i++)
+        item.args[i] = ((const uint8_t*)args)[i];
+
+    //  Request is complete, only now make it visible to the consumer
+    _tail = tail + 1;
+
+    if ((uint16_t)(tail + 1 - _head) > peak)
+        peak = (uint16_t)(tail + 1 - _head);
+
+    HAL_BOARD_InterruptRestore(intState);
+    return true;
+}
+
+/**
+ * Take the oldest request out of the ring (consumer side, called from main loop)
+ * @param item [out] copy of the request
+ * @return true if request was taken out, false if ring is empty
+ */
+bool DeferQueue::Pop(_deferItem &item) volatile
+{
+    uint16_t head = _head;
+
+    if (head == _tail)
+        return false;
+
+    volatile _deferItem &slot = _items[head & (TS_DEFER_SIZE - 1)];
+    item.libUID = slot.libUID;
+    item.taskID = slot.taskID;
+    item.argN = slot.argN;
+    for (uint8_t i = 0; i < item.argN; i++)
+        item.args[i] = slot.args[i];
+
+    //  Request copied, producer can now reuse its place
+    _head = head + 1;
+
+    return true;
+}
+
+/**
+ * Get number of requests waiting in the ring
+ * @return number of requests
+ */
+uint16_t DeferQueue::Count() const volatile
+{
+    return (uint16_t)(_tail - _head);
+}
@@ -0,0 +1,82 @@
+/**
+ *  tsDefer.h
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran Mikov
+ *
+ *  Task scheduler extension for requesting tasks from within interrupts.
+ *  Adding a task to the task queue has to be done with interrupts disabled and
+ *  can take a while with many pending tasks, which is not something an
+ *  interrupt routine should do. Instead, interrupts put a small request into
+ *  a fixed-size ring buffer and the task scheduler moves requests into the task
+ *  queue next time TS_GlobalCheck runs. Posting a request doesn't allocate
+ *  memory and takes the same time regardless of the task queue.
+ *  @version 1.1
+ *  V1.0 - 17.10.2026
+ *  +Creation of file, single-producer/single-consumer ring of deferred requests
+ *  V1.1 - 17.10.2026
+ *  +Requests can be posted from any context (interrupts of any priority and
+ *  main loop), posting disables interrupts while it fills the request
+ */
+
+#ifndef ROVERKERNEL_TASKSCHEDULER_TSDEFER_H_
+#define ROVERKERNEL_TASKSCHEDULER_TSDEFER_H_
+
+#include "hwconfig.h"
+
+#if ((TS_DEFER_SIZE & (TS_DEFER_SIZE - 1)) != 0)
+    #error "TS_DEFER_SIZE has to be a power of 2"
+#endif
+
+/**
+ * Request for a task to be executed as soon as possible, posted from interrupt
+ * Arguments are kept inside the request, so they are limited to the size of
+ * arguments stored inline in TaskEntry.
+ */
+struct _deferItem
+{
+    uint8_t libUID;
+    uint8_t taskID;
+    uint8_t argN;
+    uint8_t args[TS_ARG_INLINE_SIZE];
+};
+
+/**
+ * Multi-producer/single-consumer ring buffer of deferred requests
+ * Producers only ever write _tail and consumer (main loop) only ever writes
+ * _head. Indices run freely and are wrapped only when accessing the array.
+ * Producer can be preempted by another one (main loop by an interrupt, or an
+ * interrupt by one of higher priority), so Push() fills the request with
+ * interrupts disabled, which takes at most TS_ARG_INLINE_SIZE byte copies.
+ * Consumer is the only one taking requests out and never has to disable
+ * interrupts.
+ */
+class DeferQueue
+{
+    public:
+        DeferQueue();
+        ~DeferQueue() {};
+
+        bool        Push(uint8_t libUID, uint8_t taskID,
+                         const void *args, uint8_t argLen) volatile;
+        bool        Pop(_deferItem &item) volatile;
+        uint16_t    Count() const volatile;
+
+        //  Highest number of requests waiting at the same time since startup
+        volatile uint16_t   peak;
+        //  Number of requests dropped because the ring was full or arguments
+        //  were too long
+        volatile uint32_t   overflows;
+
+    private:
+        DeferQueue(DeferQueue &) {}                 //  No definition - forbid this
+        void operator=(DeferQueue const &) {}       //  No definition - forbid this
+
+        volatile _deferItem _items[TS_DEFER_SIZE];
+        //  Index of the next request to take out, written only by consumer
+        volatile uint16_t   _head;
+        //  Index of the next free place, written only by producer
+        volatile uint16_t   _tail;
+};
+
+#endif /* ROVERKERNEL_TASKSCHEDULER_TSDEFER_H_ */
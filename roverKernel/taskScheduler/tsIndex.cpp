@@ -0,0 +1,188 @@
+/**
+ * tsIndex.cpp
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran
+ */
+#include "tsIndex.h"
+//  Only the container selected in hwconfig.h defines _tqnode
+#include "taskHeap.h"
+#include "taskWheel.h"
+
+///-----------------------------------------------------------------------------
+///                      Class constructor                              [PUBLIC]
+///-----------------------------------------------------------------------------
+
+TaskIndex::TaskIndex()
+{
+    Clear();
+}
+
+///-----------------------------------------------------------------------------
+///                      Class member functions                         [PUBLIC]
+///-----------------------------------------------------------------------------
+
+/**
+ * Add node into the index
+ * @note Node's PID, libUID and taskID must not change while it's in the index
+ * @param node node that has just entered the task queue
+ */
+void TaskIndex::Insert(_tqnode *node) volatile
+{
+    uint16_t bucket = _PIDHash(node->data._PID);
+
+    node->_idx.pidNext = _pid[bucket];
+    _pid[bucket] = node;
+
+    //  Service chain is kept newest-first, inserting at its head is O(1)
+    bucket = _SvcHash(node->data._libuid, node->data._task);
+    node->_idx.svcPrev = 0;
+    node->_idx.svcNext = _svc[bucket];
+    if (_svc[bucket] != 0)
+        _svc[bucket]->_idx.svcPrev = node;
+    _svc[bucket] = node;
+}
+
+/**
+ * Take node out of the index
+ * @param node node that's about to leave the task queue
+ */
+void TaskIndex::Remove(_tqnode *node) volatile
+{
+    //  PID chains are short, walk it to find the link pointing to the node
+    uint16_t bucket = _PIDHash(node->data._PID);
+
+    if (_pid[bucket] == node)
+        _pid[bucket] = node->_idx.pidNext;
+    else
+        for (_tqnode *it = _pid[bucket]; it != 0; it = it->_idx.pidNext)
+            if (it->_idx.pidNext == node)
+            {
+                it->_idx.pidNext = node->_idx.pidNext;
+                break;
+            }
+
+    //  Service chain is doubly-linked, node unlinks itself
+    if (node->_idx.svcPrev != 0)
+        node->_idx.svcPrev->_idx.svcNext = node->_idx.svcNext;
+    else
+        _svc[_SvcHash(node->data._libuid, node->data._task)] = node->_idx.svcNext;
+
+    if (node->_idx.svcNext != 0)
+        node->_idx.svcNext->_idx.svcPrev = node->_idx.svcPrev;
+
+    node->_idx.pidNext = 0;
+    node->_idx.svcPrev = 0;
+    node->_idx.svcNext = 0;
+}
+
+/**
+ * Forget all nodes in the index (nodes themselves are left untouched)
+ */
+void TaskIndex::Clear() volatile
+{
+    for (uint16_t i = 0; i < TS_INDEX_BUCKETS; i++)
+    {
+        _pid[i] = 0;
+        _svc[i] = 0;
+    }
+}
+
+/**
+ * Find node of pending task with a given PID
+ * @param PIDarg PID of the task
+ * @return pointer to the node, 0 if no pending task has that PID
+ */
+_tqnode* TaskIndex::Find(uint16_t PIDarg) volatile
+{
+    for (_tqnode *it = _pid[_PIDHash(PIDarg)]; it != 0; it = it->_idx.pidNext)
+        if (it->data._PID == PIDarg)
+            return it;
+
+    return 0;
+}
+
+/**
+ * Find node of pending task requesting the same service with the same
+ * arguments as the task passed as an argument
+ * @note task in arg has valid libUID, taskID and arguments
+ * @param arg task to look for
+ * @return pointer to the node (one added first if there's more), 0 if there's
+ * no such task in the queue
+ */
+_tqnode* TaskIndex::Find(const TaskEntry &arg) volatile
+{
+    //  Chain is kept newest-first, keep the last match to get the oldest task
+    _tqnode *retVal = 0;
+
+    for (_tqnode *it = _svc[_SvcHash(arg._libuid, arg._task)]; it != 0;
+         it = it->_idx.svcNext)
+    {
+        volatile TaskEntry &te = it->data;
+
+        //  Check for matching libUID, taskID and length of arguments
+        if ((te._libuid != arg._libuid) || (te._task != arg._task) ||
+            (te._argN != arg._argN))
+            continue;
+
+        //  Check if arguments match
+        if ((arg._argN > 0) &&
+            (memcmp((void*)te._args, (void*)arg._args, arg._argN) != 0))
+            continue;
+
+        retVal = it;
+    }
+
+    return retVal;
+}
+
+/**
+ * Find node of any pending task requesting a given service, regardless of its
+ * arguments
+ * @param libUID UID of the library
+ * @param taskID task ID within the library
+ * @return pointer to the node, 0 if service has no pending tasks
+ */
+_tqnode* TaskIndex::FindService(uint8_t libUID, uint8_t taskID) volatile
+{
+    for (_tqnode *it = _svc[_SvcHash(libUID, taskID)]; it != 0;
+         it = it->_idx.svcNext)
+        if ((it->data._libuid == libUID) && (it->data._task == taskID))
+            return it;
+
+    return 0;
+}
+
+/**
+ * Find another pending task equivalent to the one in a given node. Tasks are
+ * equivalent if they request the same service and the first [keyLen] bytes of
+ * their arguments match. Task that has started and is waiting to resume its
+ * service is not equivalent to any other.
+ * @param node node of the task to compare others to (can be in the index)
+ * @param keyLen number of bytes at the start of arguments to compare
+ * @return pointer to the node of equivalent task (one added first if there's
+ * more), 0 if there's none
+ */
+_tqnode* TaskIndex::FindEquivalent(_tqnode *node, uint16_t keyLen) volatile
+{
+    volatile TaskEntry &te = node->data;
+    //  Chain is kept newest-first, keep the last match to get the oldest task
+    _tqnode *retVal = 0;
+
+    for (_tqnode *it = _svc[_SvcHash(te._libuid, te._task)]; it != 0;
+         it = it->_idx.svcNext)
+    {
+        if ((it == node) || it->data._suspended ||
+            (it->data._libuid != te._libuid) ||
+            (it->data._task != te._task) || (it->data._argN < keyLen))
+            continue;
+
+        if ((keyLen > 0) &&
+            (memcmp((void*)it->data._args, (void*)te._args, keyLen) != 0))
+            continue;
+
+        retVal = it;
+    }
+
+    return retVal;
+}
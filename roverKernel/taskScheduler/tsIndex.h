@@ -0,0 +1,94 @@
+/**
+ *  tsIndex.h
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran Mikov
+ *
+ *  Task scheduler extension for finding pending tasks without searching the
+ *  task queue. Queue (heap or wheel) keeps tasks ordered by time, which makes
+ *  finding a task by its PID or by the service it requests a walk through all
+ *  pending tasks. Index is kept next to the queue and is updated whenever a
+ *  node enters or leaves it, it holds two hash tables of intrusive chains:
+ *   -by PID, used to kill a task or look it up
+ *   -by service (libUID and taskID), used to find a task with given arguments
+ *    or to check whether a service already has a request pending
+ *  Both tables use links stored inside the queue nodes, so index never
+ *  allocates memory. With PIDs being handed out sequentially and only a handful
+ *  of services in the kernel, chains are rarely longer than one node.
+ *  @version 1.1
+ *  V1.0 - 17.10.2026
+ *  +Creation of file, PID and service index of nodes in the task queue
+ *  V1.1 - 17.10.2026
+ *  +Added search for a task equivalent to a given one, used for coalescing
+ */
+
+#ifndef ROVERKERNEL_TASKSCHEDULER_TSINDEX_H_
+#define ROVERKERNEL_TASKSCHEDULER_TSINDEX_H_
+
+#include "hwconfig.h"
+
+#if ((TS_INDEX_BUCKETS & (TS_INDEX_BUCKETS - 1)) != 0)
+    #error "TS_INDEX_BUCKETS has to be a power of 2"
+#endif
+
+//  Node of the task queue, defined by the container in use (heap or wheel)
+class _tqnode;
+class TaskEntry;
+
+/**
+ * Links of a single node into the index, member of every queue node
+ */
+struct _tsIndexLink
+{
+    _tqnode *pidNext;   //  Next node in the same PID chain
+    _tqnode *svcPrev;   //  Previous node in the same service chain
+    _tqnode *svcNext;   //  Next node in the same service chain
+};
+
+/**
+ * Index of nodes currently in the task queue
+ * Nodes are added with Insert() once they enter the queue and taken out with
+ * Remove() before they leave it (popped for execution or deleted). Used only by
+ * the task queue containers, with interrupts already disabled.
+ */
+class TaskIndex
+{
+    public:
+        TaskIndex();
+        ~TaskIndex() {};
+
+        void        Insert(_tqnode *node) volatile;
+        void        Remove(_tqnode *node) volatile;
+        void        Clear() volatile;
+
+        _tqnode*    Find(uint16_t PIDarg) volatile;
+        _tqnode*    Find(const TaskEntry &arg) volatile;
+        _tqnode*    FindService(uint8_t libUID, uint8_t taskID) volatile;
+        _tqnode*    FindEquivalent(_tqnode *node, uint16_t keyLen) volatile;
+
+    private:
+        /**
+         * Get bucket of PID hash table
+         * PIDs are sequential so their lowest bits are already well spread
+         */
+        inline uint16_t _PIDHash(uint16_t PIDarg) const volatile
+        {
+            return (PIDarg & (TS_INDEX_BUCKETS - 1));
+        }
+        /**
+         * Get bucket of service hash table
+         * UIDs of modules are small numbers and so are IDs of their services,
+         * so low bits of both are interleaved
+         */
+        inline uint16_t _SvcHash(uint8_t libUID, uint8_t taskID) const volatile
+        {
+            return ((((uint16_t)libUID << 3) ^ taskID) & (TS_INDEX_BUCKETS - 1));
+        }
+
+        //  Heads of PID chains (singly-linked)
+        _tqnode * volatile  _pid[TS_INDEX_BUCKETS];
+        //  Heads of service chains (doubly-linked)
+        _tqnode * volatile  _svc[TS_INDEX_BUCKETS];
+};
+
+#endif /* ROVERKERNEL_TASKSCHEDULER_TSINDEX_H_ */
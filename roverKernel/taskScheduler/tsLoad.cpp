@@ -0,0 +1,98 @@
+/**
+ * tsLoad.cpp
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran
+ */
+#include "tsLoad.h"
+
+///-----------------------------------------------------------------------------
+///                      Class constructor                              [PUBLIC]
+///-----------------------------------------------------------------------------
+
+LoadMonitor::LoadMonitor() : overloadMS(TS_OVERLOAD_MS), overloaded(false),
+                             backlog(0), peakBacklog(0), lateness(0),
+                             maxLateness(0), overloads(0), shed(0), load(0),
+                             _busyUS(0), _windowUS(0)
+{
+    for (uint8_t i = 0; i < NUM_OF_MODULES; i++)
+        _shedMask[i] = 0;
+}
+
+///-----------------------------------------------------------------------------
+///                      Class member functions                         [PUBLIC]
+///-----------------------------------------------------------------------------
+
+/**
+ * Update backlog statistics and overload state. Scheduler becomes overloaded
+ * once the oldest due task is later than overloadMS and stays overloaded until
+ * it's back under half of that, so that state doesn't flip on every check.
+ * @param due number of tasks that are due but haven't been executed
+ * @param late lateness (in ms) of the oldest due task, 0 if none is due
+ * @return true if overload state has changed
+ */
+bool LoadMonitor::Update(uint16_t due, uint32_t late) volatile
+{
+    bool prev = overloaded;
+
+    backlog = due;
+    lateness = late;
+    if (due > peakBacklog)
+        peakBacklog = due;
+    if (late > maxLateness)
+        maxLateness = late;
+
+    if (overloadMS == 0)
+        overloaded = false;
+    else if (late > overloadMS)
+        overloaded = true;
+    else if (late <= (overloadMS / 2))
+        overloaded = false;
+
+    if (overloaded && !prev)
+        overloads++;
+
+    return (overloaded != prev);
+}
+
+/**
+ * Account for time spent executing a task. Load is recalculated once every
+ * TS_LOAD_WINDOW_MS.
+ * @param busyUS time (in us) the task took to execute
+ * @param nowUS current time (in us)
+ */
+void LoadMonitor::AddBusy(uint32_t busyUS, uint64_t nowUS) volatile
+{
+    uint64_t window = nowUS - _windowUS;
+
+    _busyUS += busyUS;
+
+    if (window >= (TS_LOAD_WINDOW_MS * 1000ULL))
+    {
+        uint32_t pct = (uint32_t)(((uint64_t)_busyUS * 100) / window);
+        load = (pct > 100) ? 100 : (uint8_t)pct;
+        _busyUS = 0;
+        _windowUS = nowUS;
+    }
+}
+
+/**
+ * Mark service as sheddable. Periodic tasks of a sheddable service are skipped
+ * (rescheduled without being executed) while scheduler is overloaded, which
+ * is only fine for services where running the next period makes up for the
+ * skipped one (e.g. sending latest telemetry).
+ * @param libUID UID of library
+ * @param taskID task ID within the library, has to be smaller than 32
+ * @param enable true to mark service as sheddable, false to clear it
+ */
+void LoadMonitor::SetSheddable(uint8_t libUID, uint8_t taskID,
+                               bool enable) volatile
+{
+    if ((libUID >= NUM_OF_MODULES) || (taskID >= 32))
+        return;
+
+    if (enable)
+        _shedMask[libUID] |= (1UL << taskID);
+    else
+        _shedMask[libUID] &= ~(1UL << taskID);
+}
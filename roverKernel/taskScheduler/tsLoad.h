@@ -0,0 +1,83 @@
+/**
+ *  tsLoad.h
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran Mikov
+ *
+ *  Task scheduler extension for detecting overload and shedding load. Task
+ *  scheduler keeps executing due tasks for as long as there are any, so when a
+ *  task blocks for a while (e.g. waiting on ESP reply) tasks pile up and are
+ *  then executed back to back, delaying everything else even more. Monitor
+ *  keeps track of how many tasks are due but not yet executed (backlog), how
+ *  late the oldest of them is and how much of the time is spent executing
+ *  tasks. Once the oldest due task is later than a set threshold scheduler is
+ *  overloaded, and periodic tasks of services marked as sheddable (idempotent,
+ *  e.g. telemetry) are skipped until backlog clears.
+ *  @version 1.0
+ *  V1.0 - 17.10.2026
+ *  +Creation of file, load statistics, overload detection with hysteresis and
+ *  per-service shedding mask
+ */
+
+#ifndef ROVERKERNEL_TASKSCHEDULER_TSLOAD_H_
+#define ROVERKERNEL_TASKSCHEDULER_TSLOAD_H_
+
+#include "hwconfig.h"
+
+/**
+ * Load statistics and overload state of task scheduler
+ * Updated only from TS_GlobalCheck (main loop), read by anyone.
+ */
+class LoadMonitor
+{
+    public:
+        LoadMonitor();
+        ~LoadMonitor() {};
+
+        bool        Update(uint16_t due, uint32_t late) volatile;
+        void        AddBusy(uint32_t busyUS, uint64_t nowUS) volatile;
+        void        SetSheddable(uint8_t libUID, uint8_t taskID,
+                                 bool enable) volatile;
+
+        /**
+         * Check whether tasks of a service can be skipped when overloaded
+         * @return true if service is marked as sheddable
+         */
+        inline bool Sheddable(uint8_t libUID, uint8_t taskID) const volatile
+        {
+            if ((libUID >= NUM_OF_MODULES) || (taskID >= 32))
+                return false;
+
+            return ((_shedMask[libUID] >> taskID) & 1);
+        }
+
+        //  Lateness (in ms) of the oldest due task after which scheduler is
+        //  considered overloaded, 0 disables overload detection
+        volatile uint32_t   overloadMS;
+        //  True while scheduler is overloaded
+        volatile bool       overloaded;
+        //  Number of due tasks not yet executed, at the last check
+        volatile uint16_t   backlog;
+        //  Highest backlog since startup
+        volatile uint16_t   peakBacklog;
+        //  Lateness (in ms) of the oldest due task, at the last check
+        volatile uint32_t   lateness;
+        //  Highest lateness since startup
+        volatile uint32_t   maxLateness;
+        //  Number of times scheduler became overloaded
+        volatile uint32_t   overloads;
+        //  Number of task executions skipped
+        volatile uint32_t   shed;
+        //  Percentage of time spent executing tasks over the last full window
+        volatile uint8_t    load;
+
+    private:
+        //  Bit-mask of sheddable services (bit taskID) of each module
+        volatile uint32_t   _shedMask[NUM_OF_MODULES];
+        //  Time spent executing tasks in current window (in us)
+        volatile uint32_t   _busyUS;
+        //  Start of current window (in us)
+        volatile uint64_t   _windowUS;
+};
+
+#endif /* ROVERKERNEL_TASKSCHEDULER_TSLOAD_H_ */
@@ -0,0 +1,195 @@
+/**
+ * tsPool.cpp
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran
+ */
+#include "tsPool.h"
+#include "HAL/hal.h"
+#include "init/kernelContext.h"
+
+//  Integration with event log, if it's present
+#ifdef __HAL_USE_EVENTLOG__
+    #include "init/eventLog.h"
+#endif  /* __HAL_USE_EVENTLOG__ */
+
+///-----------------------------------------------------------------------------
+///                      Class constructor                              [PUBLIC]
+///-----------------------------------------------------------------------------
+
+/**
+ * Split provided memory space into blocks and link them in a list of free blocks
+ * @param storage memory space for the pool, has to have at least
+ * MEMPOOL_STORAGE(blockSize, blockNum) elements
+ * @param blockSize size of a single block (in bytes)
+ * @param blockNum number of blocks in the pool
+ */
+MemPool::MemPool(uint64_t *storage, uint16_t blockSize, uint16_t blockNum)
+    : used(0), peak(0), overflows(0), _storage((uint8_t*)storage),
+      _blockSize(((blockSize + 7) / 8) * 8), _blockNum(blockNum), _freeHead(0)
+{
+    //  Build the list of free blocks starting from the last one, so that
+    //  blocks are handed out in order of their addresses
+    for (uint16_t i = _blockNum; i > 0; i--)
+    {
+        void **block = (void**)(_storage + (i - 1) * _blockSize);
+        *block = _freeHead;
+        _freeHead = (void*)block;
+    }
+}
+
+///-----------------------------------------------------------------------------
+///                      Class member functions                         [PUBLIC]
+///-----------------------------------------------------------------------------
+
+/**
+ * Take a free block from the pool
+ * @param size number of bytes needed, has to fit in a single block
+ * @param count false if caller has another pool to try, so that failing to
+ * serve the request isn't counted as overflow of this one
+ * @return pointer to a free block, 0 if pool is empty or size is too big
+ */
+void* MemPool::Alloc(size_t size, bool count)
+{
+    void *retVal = 0;
+    bool intState = HAL_BOARD_InterruptSuspend();
+
+    if ((size <= _blockSize) && (_freeHead != 0))
+    {
+        retVal = _freeHead;
+        _freeHead = *((void**)retVal);
+
+        used++;
+        if (used > peak)
+            peak = used;
+    }
+    else if (count)
+        overflows++;
+
+    HAL_BOARD_InterruptRestore(intState);
+    return retVal;
+}
+
+/**
+ * Return a block to the pool
+ * @param ptr pointer to the block previously returned by Alloc()
+ * @return true if block belongs to this pool and was released, false otherwise
+ */
+bool MemPool::Free(void *ptr)
+{
+    if (!Owns(ptr))
+        return false;
+
+    bool intState = HAL_BOARD_InterruptSuspend();
+
+    *((void**)ptr) = _freeHead;
+    _freeHead = ptr;
+    used--;
+
+    HAL_BOARD_InterruptRestore(intState);
+    return true;
+}
+
+/**
+ * Check whether the pointer points into the memory space of this pool
+ * @param ptr pointer to check
+ * @return true if pointer belongs to this pool, false otherwise
+ */
+bool MemPool::Owns(const void *ptr) const
+{
+    return (((const uint8_t*)ptr >= _storage) &&
+            ((const uint8_t*)ptr < (_storage + _blockNum * _blockSize)));
+}
+
+/**
+ * Get size of a single block in the pool
+ * @return size of a block (in bytes)
+ */
+uint16_t MemPool::BlockSize() const
+{
+    return _blockSize;
+}
+
+/**
+ * Get number of blocks in the pool
+ * @return number of blocks
+ */
+uint16_t MemPool::BlockNum() const
+{
+    return _blockNum;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+ *********                Memory pools for task arguments              *********
+ *******************************************************************************
+ ******************************************************************************/
+
+/**
+ * Return pool for task arguments
+ * Arguments are stored either in a small or in a large block, depending on
+ * their size. Each kernel context has its own pools.
+ * @param index 0 for pool of small blocks, 1 for pool of large blocks
+ * @return reference to the pool
+ */
+MemPool& TS_ArgPool(uint8_t index)
+{
+    return *(KernelContext::Current().argPool[(index == 0) ? 0 : 1]);
+}
+
+/**
+ * Allocate memory for task arguments
+ * Memory is taken from the smallest pool it fits in. If it doesn't fit in any
+ * pool (or pools are empty) the overflow is counted in the large pool and
+ * reported to event log. Memory is never taken from the free store, this is
+ * called with interrupts disabled.
+ * @param size number of bytes to allocate
+ * @return pointer to allocated memory, 0 if no pool can serve the request
+ */
+uint8_t* TS_ArgAlloc(uint16_t size)
+{
+    uint8_t *retVal = 0;
+
+    if (size <= TS_ArgPool(0).BlockSize())
+        retVal = (uint8_t*)TS_ArgPool(0).Alloc(size, false);
+    //  Small pool might be exhausted, large pool can serve the request as well
+    if (retVal == 0)
+        retVal = (uint8_t*)TS_ArgPool(1).Alloc(size);
+
+    if (retVal == 0)
+    {
+#ifdef __HAL_USE_EVENTLOG__
+        EventLog::EmitEvent(TASKSCHED_UID, TASKSCHED_E_POOL, EVENT_ERROR);
+#endif  /* __HAL_USE_EVENTLOG__ */
+    }
+
+    return retVal;
+}
+
+/**
+ * Release memory allocated by TS_ArgAlloc()
+ * @param ptr pointer to memory to release, can be 0
+ */
+void TS_ArgFree(volatile uint8_t *ptr)
+{
+    if (ptr == 0)
+        return;
+
+    for (uint8_t i = 0; i < TS_ARG_POOLS; i++)
+        if (TS_ArgPool(i).Free((void*)ptr))
+            return;
+}
+
+/**
+ * Get number of bytes available at memory allocated by TS_ArgAlloc()
+ * @param ptr pointer to allocated memory
+ * @return size of block if memory belongs to one of the pools, 0 otherwise
+ */
+uint16_t TS_ArgCapacity(const volatile uint8_t *ptr)
+{
+    for (uint8_t i = 0; i < TS_ARG_POOLS; i++)
+        if (TS_ArgPool(i).Owns((const void*)ptr))
+            return TS_ArgPool(i).BlockSize();
+
+    return 0;
+}
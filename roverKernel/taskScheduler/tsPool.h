@@ -0,0 +1,89 @@
+/**
+ *  tsPool.h
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran Mikov
+ *
+ *  Task scheduler extension providing fixed-size memory pools. Nodes of the task
+ *  queue and task arguments used to be allocated on the free store every time
+ *  a task was added, copied or executed. Over days of uptime this fragments the
+ *  small heap of the microcontroller, so all of that memory is now taken from
+ *  statically allocated pools sized at compile time (see hwconfig.h).
+ *  @version 1.2
+ *  V1.0 - 17.10.2026
+ *  +Creation of file, pool of fixed-size blocks with usage statistics
+ *  +Pools for task queue nodes and two sizes of task arguments
+ *  V1.1 - 17.10.2026
+ *  +Added function to get capacity of allocated arguments, allowing them to
+ *  grow in place
+ *  V1.2 - 17.10.2026
+ *  +Arguments that don't fit in any pool are refused instead of being
+ *  allocated on the free store. Overflow of the small pool is counted only if
+ *  large pool can't serve the request either
+ */
+
+#ifndef ROVERKERNEL_TASKSCHEDULER_TSPOOL_H_
+#define ROVERKERNEL_TASKSCHEDULER_TSPOOL_H_
+
+#include "hwconfig.h"
+#include <stddef.h>
+
+//  Size of storage (in number of uint64_t elements) needed for a memory pool
+//  with [NUM] blocks of [SIZE] bytes. Blocks are aligned to 8 bytes.
+#define MEMPOOL_STORAGE(SIZE, NUM)  ((((SIZE) + 7) / 8) * (NUM))
+
+//  Number of pools used for storing task arguments
+#define TS_ARG_POOLS        2
+
+/**
+ * Pool of fixed-size memory blocks
+ * Storage is provided by the user of the pool (usually a static array) and is
+ * split into blocks of the same size. Free blocks are kept in a singly-linked
+ * list threaded through the blocks themselves so there's no overhead in memory
+ * other than rounding blocks to 8 bytes. Allocation and release are O(1) and
+ * are safe to call from within interrupts.
+ */
+class MemPool
+{
+    public:
+        MemPool(uint64_t *storage, uint16_t blockSize, uint16_t blockNum);
+        ~MemPool() {};
+
+        void*       Alloc(size_t size, bool count = true);
+        bool        Free(void *ptr);
+        bool        Owns(const void *ptr) const;
+
+        uint16_t    BlockSize() const;
+        uint16_t    BlockNum() const;
+
+        //  Number of blocks currently in use
+        volatile uint16_t   used;
+        //  Highest number of blocks in use at the same time since startup
+        volatile uint16_t   peak;
+        //  Number of allocations that couldn't be served from the pool (either
+        //  pool was empty or requested size was bigger than the block)
+        volatile uint32_t   overflows;
+
+    private:
+        MemPool(MemPool &) {}                   //  No definition - forbid this
+        void operator=(MemPool const &) {}      //  No definition - forbid this
+
+        //  Memory space split into blocks
+        uint8_t             *_storage;
+        //  Size of a single block (rounded up to 8 bytes)
+        uint16_t            _blockSize;
+        //  Number of blocks in the pool
+        uint16_t            _blockNum;
+        //  First free block, each free block holds pointer to the next free one
+        void * volatile     _freeHead;
+};
+
+//  Pool for nodes of task queue, defined by the queue in use (heap or wheel)
+extern MemPool&     TS_NodePool();
+//  Pools for arguments of tasks
+extern MemPool&     TS_ArgPool(uint8_t index);
+extern uint8_t*     TS_ArgAlloc(uint16_t size);
+extern void         TS_ArgFree(volatile uint8_t *ptr);
+extern uint16_t     TS_ArgCapacity(const volatile uint8_t *ptr);
+
+#endif /* ROVERKERNEL_TASKSCHEDULER_TSPOOL_H_ */
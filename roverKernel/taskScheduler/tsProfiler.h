@@ -5,28 +5,146 @@
  *      Author: Vedran Mikov
  *
  *  Task scheduler extension for profiling of tasks (measuring run-time statistics)
- *  @version 1.0
+ *  @version 1.7
  *  V1.0
  *  +Creation of file, definition of class object for holding task-performance data
  *  V1.1
  *  +Added ability to measure average task runtime by accumulating all run times
  *  into a 32-bit counter and dividing by number of runs
+ *  V1.2 - 17.10.2026
+ *  +Added counter of deadline misses (task finished after its deadline)
+ *  V1.3 - 17.10.2026
+ *  +Run time is measured in CPU cycles instead of milliseconds, so tasks shorter
+ *  than 1ms are no longer recorded as 0. Accumulated runtime and max run time
+ *  are now kept in microseconds
+ *  +Added log-bucketed histograms of run time and start latency, providing
+ *  p50/p99/max of each
+ *  V1.4 - 17.10.2026
+ *  +Periodic tasks are released at nominal times (multiples of period from
+ *  the first release), so start latency is deviation from the nominal time.
+ *  Added mean of it (jitter) and counter of periods dropped by catch-up
+ *  V1.5 - 17.10.2026
+ *  +Added counter of runs that went over run-time budget of the service
+ *  V1.6 - 17.10.2026
+ *  +Run time of a task whose service yields is the sum of its slices, time it
+ *  spends suspended is no longer counted
+ *  V1.7 - 17.10.2026
+ *  +Added profile of a service, kept by task scheduler for every service it
+ *  calls so services called by one-shot tasks are profiled as well.
+ *  TaskEndHook returns run time of the task
  */
 
 #ifndef ROVERKERNEL_TASKSCHEDULER_TSPROFILER_H_
 #define ROVERKERNEL_TASKSCHEDULER_TSPROFILER_H_
 
+//  Number of buckets in a histogram. Bucket 0 counts values of 0, bucket i
+//  counts values in range [2^(i-1), 2^i - 1] and the last bucket counts
+//  everything bigger than that (values are in us, so above ~0.26s)
+#define PERF_HIST_BUCKETS   20
+
+/**
+ * Histogram with logarithmic (power of 2) buckets
+ * Keeps distribution of values using very little memory, at the cost of
+ * percentiles being known only up to the bucket a value fell into. Once
+ * a bucket fills up, all buckets are halved so histogram keeps the shape of
+ * distribution over any uptime (older samples weigh less).
+ */
+class PerfHistogram
+{
+    public:
+        PerfHistogram(): max(0)
+        {
+            for (uint8_t i = 0; i < PERF_HIST_BUCKETS; i++)
+                bucket[i] = 0;
+        };
+        ~PerfHistogram() {};
+
+        void Add(uint32_t value)
+        {
+            uint8_t i = 0;
+
+            //  Find bucket index as the number of significant bits in value
+            while ((value >> i) && (i < (PERF_HIST_BUCKETS - 1)))
+                i++;
+
+            //  Bucket full, halve all of them to make room
+            if (bucket[i] == 0xFFFF)
+                for (uint8_t j = 0; j < PERF_HIST_BUCKETS; j++)
+                    bucket[j] >>= 1;
+
+            bucket[i]++;
+
+            if (value > max)
+                max = value;
+        }
+        /**
+         * Estimate percentile of values in histogram
+         * @param pct percentile to get (0-100)
+         * @return upper limit of the bucket where percentile falls, capped to
+         * max value seen so far
+         */
+        uint32_t Percentile(uint8_t pct) const volatile
+        {
+            uint32_t total = 0, acc = 0;
+
+            for (uint8_t i = 0; i < PERF_HIST_BUCKETS; i++)
+                total += bucket[i];
+
+            if (total == 0)
+                return 0;
+
+            uint8_t i;
+            for (i = 0; i < (PERF_HIST_BUCKETS - 1); i++)
+            {
+                acc += bucket[i];
+                //  Compare as acc/total >= pct/100, rounding in favor of bucket
+                if ((acc * 100) >= (total * pct))
+                    break;
+            }
+
+            //  Last bucket has no upper limit
+            if (i == (PERF_HIST_BUCKETS - 1))
+                return max;
+
+            uint32_t limit = (1UL << i) - 1;
+            return ((limit < max) ? limit : (uint32_t)max);
+        }
+
+        void operator= (const volatile PerfHistogram &arg) volatile
+        {
+            for (uint8_t i = 0; i < PERF_HIST_BUCKETS; i++)
+                bucket[i] = arg.bucket[i];
+            max = arg.max;
+        }
+
+    public:
+        //  Number of values in each bucket
+        uint16_t bucket[PERF_HIST_BUCKETS];
+        //  Biggest value added to the histogram
+        uint32_t max;
+};
 
 class Performance
 {
     public:
         Performance(): startTimeMissTot(0), startTimeMissCnt(0), taskRuns(0),
-                       maxRT(0), _lastStartT(0), msAcc(0), accRT(0) {};
+                       usAcc(0), accRT(0), deadlineMissCnt(0),
+                       jitterSum(0), periodsSkipped(0), overrunCnt(0),
+                       _lastStartC(0), _sliceUS(0) {};
         ~Performance() {};
 
+        /**
+         * Hook to be called right before task is executed
+         * @param timestamp current time (in ms)
+         * @param taskStartTime time (in ms) at which task was supposed to start
+         * @param timeStep time step of task scheduler (in ms)
+         * @param latency time (in us) from when task was due to now
+         * @param cycles current value of CPU cycle counter
+         */
         void TaskStartHook(const uint64_t &timestamp,
                            const uint64_t &taskStartTime,
-                           const uint64_t &timeStep)
+                           const uint64_t &timeStep,
+                           uint32_t latency, uint32_t cycles)
         {
             //  If we missed starting time of the task for more than 1 time-step
             //  calculate for how much was the deadline missed and increase count
@@ -36,23 +154,80 @@ class Performance
                 startTimeMissCnt++;
                 startTimeMissTot += (uint32_t)(timestamp - taskStartTime);
             }
+            startLatency.Add(latency);
+            jitterSum += latency;
 
-            //  Save timestamp for calculating execution time
-            _lastStartT = timestamp;
+            //  Save cycle counter for calculating execution time
+            _lastStartC = cycles;
+            _sliceUS = 0;
             taskRuns++;
         }
-        void TaskEndHook(const uint64_t &timestamp)
+        /**
+         * Hook to be called right after service of the task has yielded
+         * @param cycles current value of CPU cycle counter
+         * @param cyclesPerUs number of CPU cycles in a microsecond
+         */
+        void TaskYieldHook(uint32_t cycles, uint32_t cyclesPerUs)
         {
-            //  Calculate run-time of task once it's finished
-            uint16_t rt = (uint16_t)(timestamp - _lastStartT);
+            //  Keep run time of the slice, time until the task is resumed
+            //  isn't part of its run time
+            _sliceUS += (cycles - _lastStartC) / cyclesPerUs;
+        }
+        /**
+         * Hook to be called right before service of the task is resumed
+         * @param cycles current value of CPU cycle counter
+         */
+        void TaskResumeHook(uint32_t cycles)
+        {
+            _lastStartC = cycles;
+        }
+        /**
+         * Hook to be called right after task has been executed
+         * @param timestamp current time (in ms)
+         * @param deadline time (in ms) by which task had to finish, 0 if none
+         * @param cycles current value of CPU cycle counter
+         * @param cyclesPerUs number of CPU cycles in a microsecond
+         * @return run time of the task (in us)
+         */
+        uint32_t TaskEndHook(const uint64_t &timestamp, const uint64_t &deadline,
+                         uint32_t cycles, uint32_t cyclesPerUs)
+        {
+            //  Task that has a deadline has to be finished by then
+            if ((deadline != 0) && (timestamp > deadline))
+                deadlineMissCnt++;
+
+            //  Calculate run-time of task once it's finished, difference of
+            //  cycles is correct even if counter overflowed in between. Add
+            //  slices before the last one if service has yielded
+            uint32_t rt = _sliceUS + (cycles - _lastStartC) / cyclesPerUs;
+
+            runTime.Add(rt);
+
+            //  Update microsecond accumulator and accumulated runtime
+            accRT += (usAcc+rt) / 1000000;
+            usAcc = (usAcc+rt) % 1000000;
+
+            return rt;
+        }
 
-            //  Check if we have new maximum run time
-            if (rt > maxRT)
-                maxRT = rt;
+        /**
+         * Mean deviation of start time from nominal release time
+         * @return jitter (in us) averaged over all runs
+         */
+        uint32_t JitterMean() const volatile
+        {
+            if (taskRuns == 0)
+                return 0;
 
-            //  Update millisecond accumulator and accumulated runtime
-            accRT += (msAcc+rt) / 1000;
-            msAcc = (msAcc+rt) % 1000;
+            return (uint32_t)(jitterSum / taskRuns);
+        }
+        /**
+         * Biggest deviation of start time from nominal release time
+         * @return jitter (in us)
+         */
+        uint32_t JitterMax() const volatile
+        {
+            return startLatency.max;
         }
 
         //  TODO: Make sure to include all new variables in these assignments
@@ -61,9 +236,14 @@ class Performance
             startTimeMissTot = arg.startTimeMissTot;
             startTimeMissCnt = arg.startTimeMissCnt;
             taskRuns = arg.taskRuns;
-            maxRT = arg.maxRT;
-            msAcc = arg.msAcc;
+            usAcc = arg.usAcc;
             accRT = arg.accRT;
+            deadlineMissCnt = arg.deadlineMissCnt;
+            runTime = arg.runTime;
+            startLatency = arg.startLatency;
+            jitterSum = arg.jitterSum;
+            periodsSkipped = arg.periodsSkipped;
+            overrunCnt = arg.overrunCnt;
 
             return *this;
         }
@@ -74,9 +254,14 @@ class Performance
             startTimeMissTot = arg.startTimeMissTot;
             startTimeMissCnt = arg.startTimeMissCnt;
             taskRuns = arg.taskRuns;
-            maxRT = arg.maxRT;
-            msAcc = arg.msAcc;
+            usAcc = arg.usAcc;
             accRT = arg.accRT;
+            deadlineMissCnt = arg.deadlineMissCnt;
+            runTime = arg.runTime;
+            startLatency = arg.startLatency;
+            jitterSum = arg.jitterSum;
+            periodsSkipped = arg.periodsSkipped;
+            overrunCnt = arg.overrunCnt;
 
             return *this;
         }
@@ -86,9 +271,14 @@ class Performance
             startTimeMissTot = arg.startTimeMissTot;
             startTimeMissCnt = arg.startTimeMissCnt;
             taskRuns = arg.taskRuns;
-            maxRT = arg.maxRT;
-            msAcc = arg.msAcc;
+            usAcc = arg.usAcc;
             accRT = arg.accRT;
+            deadlineMissCnt = arg.deadlineMissCnt;
+            runTime = arg.runTime;
+            startLatency = arg.startLatency;
+            jitterSum = arg.jitterSum;
+            periodsSkipped = arg.periodsSkipped;
+            overrunCnt = arg.overrunCnt;
 
             return *this;
         }
@@ -98,9 +288,14 @@ class Performance
             startTimeMissTot = arg.startTimeMissTot;
             startTimeMissCnt = arg.startTimeMissCnt;
             taskRuns = arg.taskRuns;
-            maxRT = arg.maxRT;
-            msAcc = arg.msAcc;
+            usAcc = arg.usAcc;
             accRT = arg.accRT;
+            deadlineMissCnt = arg.deadlineMissCnt;
+            runTime = arg.runTime;
+            startLatency = arg.startLatency;
+            jitterSum = arg.jitterSum;
+            periodsSkipped = arg.periodsSkipped;
+            overrunCnt = arg.overrunCnt;
         }
 
     public:
@@ -110,17 +305,94 @@ class Performance
         uint32_t startTimeMissCnt;
         //  Number of times the task has run
         uint32_t taskRuns;
-        //  Max run-time
-        uint16_t maxRT;
-        //  MS accumulator -> hold milliseconds until they can be transformed
-        //  into a second (used only for short tasks)
-        uint16_t msAcc;
+        //  US accumulator -> hold microseconds until they can be transformed
+        //  into a second
+        uint32_t usAcc;
         //  Accumulated task runtime in seconds
         uint32_t accRT;
+        //  Number of times the task has finished after its deadline
+        uint32_t deadlineMissCnt;
+        //  Distribution of run time (in us), max run time is runTime.max
+        PerfHistogram runTime;
+        //  Distribution of time (in us) from when task was due to its start
+        PerfHistogram startLatency;
+        //  Sum of start latencies (in us), for mean jitter
+        uint64_t jitterSum;
+        //  Number of periods dropped because task was running late
+        uint32_t periodsSkipped;
+        //  Number of runs longer than budget of the service (see tsBudget.h)
+        uint32_t overrunCnt;
 
     protected:
-        //  Last start time of the task -> used to calculate runtime
-        uint64_t _lastStartT;
+        //  CPU cycle counter at last start of the task -> used to calculate runtime
+        uint32_t _lastStartC;
+        //  Run time (in us) of slices of the current run, if service yields
+        uint32_t _sliceUS;
+};
+
+/**
+ * Profile of a service, over all tasks that called it
+ * Performance of a task lives only as long as the task is in the queue, so
+ * a service called by one-shot tasks (e.g. sending a TCP packet) never shows
+ * up in it. Task scheduler keeps one of these for every service it calls.
+ */
+class ServiceProfile
+{
+    public:
+        ServiceProfile(): libUID(0), taskID(0), runs(0), deadlineMissCnt(0),
+                          overrunCnt(0), jitterSum(0) {};
+        ~ServiceProfile() {};
+
+        /**
+         * Add start of a task calling this service
+         * @param latency time (in us) from when task was due to its start
+         */
+        void AddStart(uint32_t latency)
+        {
+            startLatency.Add(latency);
+            jitterSum += latency;
+            runs++;
+        }
+        /**
+         * Add run of a task calling this service, once the task is finished
+         * @param rt run time (in us), sum of slices if service has yielded
+         * @param late true if task finished after its deadline
+         */
+        void AddRun(uint32_t rt, bool late)
+        {
+            runTime.Add(rt);
+            if (late)
+                deadlineMissCnt++;
+        }
+
+        /**
+         * Mean start latency of tasks calling this service
+         * @return jitter (in us) averaged over all runs
+         */
+        uint32_t JitterMean() const volatile
+        {
+            if (runs == 0)
+                return 0;
+
+            return (uint32_t)(jitterSum / runs);
+        }
+
+    public:
+        //  UID of library and task ID of the service
+        uint8_t libUID;
+        uint8_t taskID;
+        //  Number of times the service has been called
+        uint32_t runs;
+        //  Number of times a task finished after its deadline
+        uint32_t deadlineMissCnt;
+        //  Number of runs longer than budget of the service (see tsBudget.h)
+        uint32_t overrunCnt;
+        //  Distribution of run time (in us)
+        PerfHistogram runTime;
+        //  Distribution of time (in us) from when task was due to its start
+        PerfHistogram startLatency;
+        //  Sum of start latencies (in us), for mean jitter
+        uint64_t jitterSum;
 };
 
 
@@ -0,0 +1,217 @@
+/**
+ *  tsService.h
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran Mikov
+ *
+ *  Task scheduler extension for declaring services of kernel modules. Each
+ *  module used to provide a callback with a switch on service ID, copying its
+ *  arguments out of a byte array at offsets written by hand. Now each service
+ *  is a member function of the module, and the module lists its services in a
+ *  constant table indexed by service ID. Table entries are generated by
+ *  templates from the signature of the member function: the stub unpacking
+ *  arguments is made by the compiler (offsets and sizes known at compile time)
+ *  and so is the number of bytes of arguments the service expects. Task
+ *  scheduler checks the length of arguments before calling the service, so a
+ *  task with too few arguments is refused instead of reading garbage.
+ *  @version 1.1
+ *  V1.0 - 17.10.2026
+ *  +Creation of file, service table entries for member functions (singleton
+ *  modules) and free functions with up to 3 arguments, or raw arguments
+ *  V1.1 - 17.10.2026
+ *  +Service can be given a run-time budget, see tsBudget.h (*_BUDGET variants
+ *  of table entries)
+ */
+
+#ifndef ROVERKERNEL_TASKSCHEDULER_TSSERVICE_H_
+#define ROVERKERNEL_TASKSCHEDULER_TSSERVICE_H_
+
+#include "hwconfig.h"
+#include "libs/myLib.h"
+
+//  Returned by a service when its outcome shouldn't be reported to event log
+//  (e.g. only part of the job is done, or failure isn't important). Chosen so
+//  that no sign-extended negative error code of a narrower type matches it
+#define STATUS_NO_EVENT     0x80000000
+
+/**
+ * Single service provided by a kernel module
+ * Entries are created with TS_SERVICEx/TS_FUNCTIONx macros below, never by hand
+ */
+struct _tsService
+{
+    //  Stub that unpacks arguments and calls the service, returns one of
+    //  myLib.h STATUS_* macros
+    uint32_t    (*handler)(const uint8_t *args, uint16_t argN);
+    //  Minimal number of bytes of arguments expected by the service
+    uint16_t    argLen;
+    //  Longest time (in us) a single call of the service is expected to take,
+    //  0 if service has no budget
+    uint32_t    budgetUS;
+};
+
+/**
+ * Services registered by a kernel module, table is indexed by service ID
+ */
+struct _tsModule
+{
+    const _tsService    *services;
+    uint8_t             num;
+};
+
+///-----------------------------------------------------------------------------
+///                 Argument unpacking
+///-----------------------------------------------------------------------------
+
+/**
+ * Read argument of a given type at a given offset. Arguments are packed one
+ * after another, so they're not aligned; copy of a size known at compile time
+ * is turned into plain loads by the compiler.
+ */
+template<typename T>
+inline T _tsArg(const uint8_t *args, uint16_t offset)
+{
+    T retVal;
+    memcpy((void*)&retVal, (const void*)(args + offset), sizeof(T));
+    return retVal;
+}
+//  Any non-zero byte is true
+template<>
+inline bool _tsArg<bool>(const uint8_t *args, uint16_t offset)
+{
+    return (args[offset] != 0);
+}
+
+/**
+ * Get instance of a module providing the service, kernel modules are singletons
+ * @note const_cast also strips volatile from modules returning volatile instance
+ */
+template<class C>
+inline C& _tsSelf()
+{
+    return const_cast<C&>(C::GetI());
+}
+
+///-----------------------------------------------------------------------------
+///                 Stubs calling member function of a singleton
+///-----------------------------------------------------------------------------
+
+template<class C, typename R, R (C::*F)()>
+struct _tsMember0
+{
+    static uint32_t Call(const uint8_t*, uint16_t)
+    {
+        return (uint32_t)(_tsSelf<C>().*F)();
+    }
+};
+
+template<class C, typename R, typename A1, R (C::*F)(A1)>
+struct _tsMember1
+{
+    static uint32_t Call(const uint8_t *args, uint16_t)
+    {
+        return (uint32_t)(_tsSelf<C>().*F)(_tsArg<A1>(args, 0));
+    }
+};
+
+template<class C, typename R, typename A1, typename A2, R (C::*F)(A1, A2)>
+struct _tsMember2
+{
+    static uint32_t Call(const uint8_t *args, uint16_t)
+    {
+        return (uint32_t)(_tsSelf<C>().*F)(_tsArg<A1>(args, 0),
+                                           _tsArg<A2>(args, sizeof(A1)));
+    }
+};
+
+template<class C, typename R, typename A1, typename A2, typename A3,
+         R (C::*F)(A1, A2, A3)>
+struct _tsMember3
+{
+    static uint32_t Call(const uint8_t *args, uint16_t)
+    {
+        return (uint32_t)(_tsSelf<C>().*F)(
+                                _tsArg<A1>(args, 0),
+                                _tsArg<A2>(args, sizeof(A1)),
+                                _tsArg<A3>(args, sizeof(A1) + sizeof(A2)));
+    }
+};
+
+//  Service parsing arguments on its own (e.g. variable length data)
+template<class C, typename R, R (C::*F)(const uint8_t*, uint16_t)>
+struct _tsMemberRaw
+{
+    static uint32_t Call(const uint8_t *args, uint16_t argN)
+    {
+        return (uint32_t)(_tsSelf<C>().*F)(args, argN);
+    }
+};
+
+///-----------------------------------------------------------------------------
+///                 Stubs calling free (or static member) function
+///-----------------------------------------------------------------------------
+
+template<typename R, R (*F)()>
+struct _tsFunction0
+{
+    static uint32_t Call(const uint8_t*, uint16_t)
+    {
+        return (uint32_t)F();
+    }
+};
+
+template<typename R, typename A1, R (*F)(A1)>
+struct _tsFunction1
+{
+    static uint32_t Call(const uint8_t *args, uint16_t)
+    {
+        return (uint32_t)F(_tsArg<A1>(args, 0));
+    }
+};
+
+///-----------------------------------------------------------------------------
+///                 Table entries
+///-----------------------------------------------------------------------------
+//  Return type (R) and argument types have to match the signature of the
+//  function exactly, otherwise the table doesn't compile. Returned value is
+//  taken as one of myLib.h STATUS_* macros. *_BUDGET variants take budget of
+//  the service (in us) as the last parameter
+
+#define TS_SERVICE0_BUDGET(C, R, F, us)                                         \
+    { &_tsMember0<C, R, &C::F>::Call, 0, us }
+#define TS_SERVICE1_BUDGET(C, R, F, A1, us)                                     \
+    { &_tsMember1<C, R, A1, &C::F>::Call, sizeof(A1), us }
+#define TS_SERVICE2_BUDGET(C, R, F, A1, A2, us)                                 \
+    { &_tsMember2<C, R, A1, A2, &C::F>::Call, sizeof(A1) + sizeof(A2), us }
+#define TS_SERVICE3_BUDGET(C, R, F, A1, A2, A3, us)                             \
+    { &_tsMember3<C, R, A1, A2, A3, &C::F>::Call,                               \
+      sizeof(A1) + sizeof(A2) + sizeof(A3), us }
+//  Raw service, minLen is the minimal number of bytes it accepts
+#define TS_SERVICE_RAW_BUDGET(C, R, F, minLen, us)                              \
+    { &_tsMemberRaw<C, R, &C::F>::Call, minLen, us }
+
+#define TS_FUNCTION0_BUDGET(R, F, us)                                           \
+    { &_tsFunction0<R, &F>::Call, 0, us }
+#define TS_FUNCTION1_BUDGET(R, F, A1, us)                                       \
+    { &_tsFunction1<R, A1, &F>::Call, sizeof(A1), us }
+
+#define TS_SERVICE0(C, R, F)                                                    \
+    TS_SERVICE0_BUDGET(C, R, F, 0)
+#define TS_SERVICE1(C, R, F, A1)                                                \
+    TS_SERVICE1_BUDGET(C, R, F, A1, 0)
+#define TS_SERVICE2(C, R, F, A1, A2)                                            \
+    TS_SERVICE2_BUDGET(C, R, F, A1, A2, 0)
+#define TS_SERVICE3(C, R, F, A1, A2, A3)                                        \
+    TS_SERVICE3_BUDGET(C, R, F, A1, A2, A3, 0)
+#define TS_SERVICE_RAW(C, R, F, minLen)                                         \
+    TS_SERVICE_RAW_BUDGET(C, R, F, minLen, 0)
+
+#define TS_FUNCTION0(R, F)                                                      \
+    TS_FUNCTION0_BUDGET(R, F, 0)
+#define TS_FUNCTION1(R, F, A1)                                                  \
+    TS_FUNCTION1_BUDGET(R, F, A1, 0)
+
+//  Expands to table and its length, as expected by TS_RegServices()
+#define TS_SERVICES(table)  table, (sizeof(table) / sizeof(table[0]))
+
+#endif /* ROVERKERNEL_TASKSCHEDULER_TSSERVICE_H_ */
@@ -0,0 +1,54 @@
+/**
+ * tsTrace.cpp
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran
+ */
+#include "tsTrace.h"
+
+#if defined(__TS_TRACE__) && defined(__HAL_USE_TASKSCH__)
+
+///-----------------------------------------------------------------------------
+///                      Class constructor                              [PUBLIC]
+///-----------------------------------------------------------------------------
+
+TraceBuffer::TraceBuffer() : enabled(true), _head(0)
+{
+}
+
+///-----------------------------------------------------------------------------
+///                      Class member functions                         [PUBLIC]
+///-----------------------------------------------------------------------------
+
+/**
+ * Get number of records currently in the buffer
+ * @return number of records, at most TS_TRACE_SIZE
+ */
+uint16_t TraceBuffer::Count() const volatile
+{
+    if (_head < TS_TRACE_SIZE)
+        return (uint16_t)_head;
+
+    return TS_TRACE_SIZE;
+}
+
+/**
+ * Get number of records overwritten since startup
+ * @return number of records no longer in the buffer
+ */
+uint32_t TraceBuffer::Lost() const volatile
+{
+    return _head - Count();
+}
+
+/**
+ * Access record in the buffer
+ * @param index index of the record, 0 being the oldest one in the buffer
+ * @return reference to the record
+ */
+const volatile _traceRec& TraceBuffer::At(uint16_t index) const volatile
+{
+    return _recs[(Lost() + index) & (TS_TRACE_SIZE - 1)];
+}
+
+#endif  /* __TS_TRACE__ && __HAL_USE_TASKSCH__ */
@@ -0,0 +1,130 @@
+/**
+ *  tsTrace.h
+ *
+ *  Created on: 17.10.2026.
+ *      Author: Vedran Mikov
+ *
+ *  Task scheduler extension for recording a trace of kernel activity. Every
+ *  task run (start & end), task request, interrupt and event emitted to event
+ *  log leaves a small binary record in a fixed-size ring buffer in RAM, time
+ *  stamped with CPU cycle counter. Recording a single record takes about a
+ *  dozen of instructions, doesn't disable interrupts and can be done from
+ *  interrupts, so unlike printing debug messages it doesn't change timing of
+ *  what's being observed. Oldest records are overwritten once buffer is full.
+ *  Buffer is dumped on request through PLAT_T_TRACE_DUMP service.
+ *  @version 1.2
+ *  V1.0 - 17.10.2026
+ *  +Creation of file, ring buffer of trace records
+ *  V1.1 - 17.10.2026
+ *  +Trace buffer is owned by kernel context instead of being a global
+ *  V1.2 - 17.10.2026
+ *  +Added record of a task going over its run-time budget
+ */
+
+#ifndef ROVERKERNEL_TASKSCHEDULER_TSTRACE_H_
+#define ROVERKERNEL_TASKSCHEDULER_TSTRACE_H_
+
+#include "hwconfig.h"
+#include "HAL/hal.h"
+#include "init/kernelContext.h"
+
+#if defined(__TS_TRACE__) && defined(__HAL_USE_TASKSCH__)
+
+#if ((TS_TRACE_SIZE & (TS_TRACE_SIZE - 1)) != 0)
+    #error "TS_TRACE_SIZE has to be a power of 2"
+#endif
+
+//  Types of trace records
+#define TR_TASK_START   1   //  Task started executing
+#define TR_TASK_END     2   //  Task finished executing, data=1 if it yielded
+#define TR_SYNC         3   //  Task added to task queue, data=1 if deferred
+                            //  from interrupt (PID not known yet)
+#define TR_ISR          4   //  Interrupt entered, libUID is module handling it
+#define TR_EVENT        5   //  Event emitted to event log, data is event type
+#define TR_OVERRUN      6   //  Task went over its run-time budget, data=1 if
+                            //  caught from interrupt while still running
+
+//  Interrupts, recorded as taskID of TR_ISR record
+#define TR_ISR_TS_WAKEUP    0   //  TASKSCHED_UID, wake-up timer (tickless)
+#define TR_ISR_ESP_RX       0   //  ESP_UID, data received from ESP chip
+#define TR_ISR_ESP_WD       1   //  ESP_UID, watchdog of ESP communication
+#define TR_ISR_ENC_LEFT     0   //  ENGINES_UID, left wheel encoder
+#define TR_ISR_ENC_RIGHT    1   //  ENGINES_UID, right wheel encoder
+
+/**
+ * Single trace record
+ */
+struct _traceRec
+{
+    //  Value of CPU cycle counter when record was made
+    uint32_t    cycles;
+    //  PID of the task, 0 if not related to a task in the queue
+    uint16_t    PID;
+    //  Type of the record, one of TR_* macros
+    uint8_t     type;
+    uint8_t     libUID;
+    uint8_t     taskID;
+    //  Additional data, depends on type of the record
+    uint8_t     data;
+};
+
+/**
+ * Ring buffer of trace records
+ * Index of the next record is taken before the record is written. If an
+ * interrupt makes a record in between reading and incrementing the index, the
+ * two records end up in the same slot and one of them is lost. That window is
+ * a few instructions wide and losing a record in a diagnostic trace is cheaper
+ * than disabling interrupts for every record.
+ */
+class TraceBuffer
+{
+    public:
+        TraceBuffer();
+        ~TraceBuffer() {};
+
+        /**
+         * Add a record to the trace
+         * @param type type of the record, one of TR_* macros
+         * @param libUID UID of the library
+         * @param taskID task ID (or interrupt ID) within the library
+         * @param PID PID of the task, 0 if none
+         * @param data additional data, depends on type
+         */
+        inline void Record(uint8_t type, uint8_t libUID, uint8_t taskID,
+                           uint16_t PID, uint8_t data) volatile
+        {
+            if (!enabled)
+                return;
+
+            volatile _traceRec &rec = _recs[(_head++) & (TS_TRACE_SIZE - 1)];
+
+            rec.cycles = HAL_TS_CYCLES();
+            rec.PID = PID;
+            rec.type = type;
+            rec.libUID = libUID;
+            rec.taskID = taskID;
+            rec.data = data;
+        }
+
+        uint16_t                    Count() const volatile;
+        uint32_t                    Lost() const volatile;
+        const volatile _traceRec&   At(uint16_t index) const volatile;
+
+        //  Recording can be paused (e.g. while dumping the buffer)
+        bool    enabled;
+
+    private:
+        volatile _traceRec  _recs[TS_TRACE_SIZE];
+        //  Total number of records made since startup, runs freely
+        uint32_t            _head;
+};
+
+//  Record into trace buffer of current kernel context
+#define TS_TRACE(TYPE, UID, ID, PID, DATA)  \
+                            KernelContext::Current().trace->Record((TYPE),    \
+                                        (UID), (ID), (PID), (DATA))
+#else
+#define TS_TRACE(TYPE, UID, ID, PID, DATA)  ((void)0)
+#endif  /* __TS_TRACE__ && __HAL_USE_TASKSCH__ */
+
+#endif /* ROVERKERNEL_TASKSCHEDULER_TSTRACE_H_ */
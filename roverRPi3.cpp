@@ -24,6 +24,12 @@ int main(void)
     //  Run initialization sequence for all modules of rover
     rover.InitHW();
 
+#if defined(__BOARD_POSIX__)
+    //  Simulated board moves its clock forward only when processor waits for
+    //  something, so put it to sleep whenever scheduler has nothing to run
+    TaskScheduler::GetP()->SetIdleHook(HAL_TS_Sleep);
+#endif
+
 #ifdef __FAULT_STARTUP_DEBUG__
     DEBUG_WRITE("Board initialized!\r\n");
 #endif
@@ -44,7 +44,9 @@
 MEMORY
 {
     /* Application stored in and executes from internal flash */
-    FLASH (RX) : origin = APP_BASE, length = 0x00100000
+    FLASH (RX) : origin = APP_BASE, length = 0x000F0000
+    /* Last 64kB of flash hold persistent event store (HAL_STOR_BASE) */
+    STORAGE (R) : origin = 0x000F0000, length = 0x00010000
     /* Application uses internal RAM for data */
     SRAM (RWX) : origin = 0x20000000, length = 0x00040000
 }
@@ -0,0 +1,142 @@
+/**
+ * bench_args.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ *
+ *  Microbenchmark of the path every task takes through the task scheduler:
+ *  SyncTask + AddArg<T> + PopFront. Arguments that fit into the task entry
+ *  (TS_ARG_INLINE_SIZE) mustn't take any memory, neither from the free store
+ *  nor from argument pools. Longer ones are taken from pools, and task with
+ *  arguments bigger than the large pool block is refused instead of taking
+ *  them from the free store.
+ */
+#include "simTest.h"
+#include "taskScheduler/tsPool.h"
+#include <string.h>
+#include <new>
+
+#define BENCH_UID       9
+#define BENCH_ITER      100000
+
+//  Count allocations made on the free store while benchmark is running
+static bool     counting = false;
+static uint32_t allocs = 0;
+
+void* operator new(size_t size) throw(std::bad_alloc)
+{
+    if (counting)
+        allocs++;
+    void *ptr = malloc(size ? size : 1);
+    if (ptr == 0)
+        throw std::bad_alloc();
+    return ptr;
+}
+void* operator new[](size_t size) throw(std::bad_alloc)
+{
+    return operator new(size);
+}
+void operator delete(void *ptr) throw()
+{
+    free(ptr);
+}
+void operator delete[](void *ptr) throw()
+{
+    free(ptr);
+}
+
+//  Argument of [N] bytes
+template<int N>
+struct Arg
+{
+    uint8_t data[N];
+};
+
+struct Result
+{
+    uint32_t allocs;
+    uint32_t poolBlocks;
+    uint32_t refused;
+    uint32_t nsPerTask;
+};
+
+/**
+ * Schedule, add two arguments to and take out BENCH_ITER tasks
+ * @return allocations per task and average time of one task
+ */
+template<typename T>
+static Result Run()
+{
+    volatile TaskScheduler &ts = TaskScheduler::GetI();
+    T arg;
+    uint64_t start;
+    uint32_t poolBlocks = 0, refused = 0;
+
+    memset(&arg, 0x5A, sizeof(arg));
+    allocs = 0;
+    counting = true;
+    start = NowNS();
+
+    for (uint32_t i = 0; i < BENCH_ITER; i++)
+    {
+        ts.SyncTask(BENCH_UID, 0, -1000);
+        //  Task is removed from the queue if its arguments don't fit
+        if (!ts.AddArg<T>(arg) || !ts.AddArg<uint32_t>(i))
+        {
+            refused++;
+            continue;
+        }
+        //  Blocks taken from argument pools by this task
+        poolBlocks += TS_ArgPool(0).used + TS_ArgPool(1).used;
+
+        TaskEntry task;
+        CHECK(ts.PopFront(task));
+        CHECK_EQ(task.GetLibUID(), BENCH_UID);
+    }
+
+    uint64_t elapsed = NowNS() - start;
+    counting = false;
+
+    Result res;
+    res.allocs = allocs;
+    res.poolBlocks = poolBlocks;
+    res.refused = refused;
+    res.nsPerTask = (uint32_t)(elapsed / BENCH_ITER);
+    return res;
+}
+
+static void Report(const char *name, uint16_t argLen, const Result &res)
+{
+    printf("%-8s %4dB args: %6u allocs, %6u pool blocks, %6u refused, "
+           "%5u ns/task\n", name, argLen, res.allocs, res.poolBlocks,
+           res.refused, res.nsPerTask);
+}
+
+int main()
+{
+    HAL_BOARD_CLOCK_Init();
+    TaskScheduler::GetI().InitHW(1);
+
+    //  Inline: argument and 4B counter fit into the task entry
+    Result inl = Run< Arg<TS_ARG_INLINE_SIZE - 5> >();
+    Report("inline", TS_ARG_INLINE_SIZE - 1, inl);
+    CHECK_EQ(inl.allocs, 0);
+    CHECK_EQ(inl.poolBlocks, 0);
+
+    //  Pool: arguments are taken from a pool, still nothing on free store
+    Result pool = Run< Arg<TS_ARG_SMALL_SIZE - 5> >();
+    Report("pool", TS_ARG_SMALL_SIZE - 1, pool);
+    CHECK_EQ(pool.allocs, 0);
+    CHECK_EQ(pool.poolBlocks, BENCH_ITER);
+    CHECK_EQ(pool.refused, 0);
+
+    //  Refused: arguments don't fit into any pool block, task is removed
+    //  without touching the free store
+    Result big = Run< Arg<TS_ARG_LARGE_SIZE> >();
+    Report("refused", TS_ARG_LARGE_SIZE + 4, big);
+    CHECK_EQ(big.allocs, 0);
+    CHECK_EQ(big.refused, BENCH_ITER);
+    CHECK(TaskScheduler::GetI().IsEmpty());
+
+    return 0;
+}
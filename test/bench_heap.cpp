@@ -0,0 +1,77 @@
+/**
+ * bench_heap.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ *
+ *  Benchmark of the task queue (binary heap, or timing wheel if the kernel is
+ *  built with __TS_USE_TIMING_WHEEL__) with 10, 100 and 1000 tasks pending.
+ *  Queue is kept at the same size by adding a task at a random time and taking
+ *  out the first one, measuring time of each and the longest time interrupts
+ *  were kept disabled while doing so. Numbers are host time, useful only for
+ *  comparison with each other.
+ */
+#include "simTest.h"
+
+#if (TS_MAX_TASKS < 1001)
+#error Benchmark needs kernel built with TS_MAX_TASKS bigger than 1000
+#endif
+
+#define BENCH_UID       9
+#define BENCH_ITER      20000
+
+static void Run(uint16_t pending)
+{
+    volatile TaskScheduler &ts = TaskScheduler::GetI();
+    uint32_t base = (uint32_t)msSinceStartup + 1000;
+    uint64_t insertNS = 0, popNS = 0;
+    uint32_t insertOff = 0, popOff = 0;
+
+    for (uint16_t i = 0; i < pending; i++)
+        ts.SyncTask(BENCH_UID, 0, base + Random() % BENCH_SPAN);
+    CHECK_EQ(ts.NumOfTasks(), pending);
+
+    for (uint32_t i = 0; i < BENCH_ITER; i++)
+    {
+        uint64_t start;
+
+        HAL_SIM_Stats.maxIntOffNS = 0;
+        start = NowNS();
+        ts.SyncTask(BENCH_UID, 0, base + Random() % BENCH_SPAN);
+        insertNS += NowNS() - start;
+        if (HAL_SIM_Stats.maxIntOffNS > insertOff)
+            insertOff = HAL_SIM_Stats.maxIntOffNS;
+
+        HAL_SIM_Stats.maxIntOffNS = 0;
+        start = NowNS();
+        TaskEntry task;
+        CHECK(ts.PopFront(task));
+        popNS += NowNS() - start;
+        if (HAL_SIM_Stats.maxIntOffNS > popOff)
+            popOff = HAL_SIM_Stats.maxIntOffNS;
+
+        CHECK_EQ(task.GetLibUID(), BENCH_UID);
+    }
+    CHECK_EQ(ts.NumOfTasks(), pending);
+
+    printf("%4d pending: insert %5u ns (%6u ns max int-off), "
+           "pop %5u ns (%6u ns max int-off)\n", pending,
+           (uint32_t)(insertNS / BENCH_ITER), insertOff,
+           (uint32_t)(popNS / BENCH_ITER), popOff);
+
+    //  Empty the queue for the next run
+    TaskEntry task;
+    while (ts.PopFront(task));
+}
+
+int main()
+{
+    HAL_BOARD_CLOCK_Init();
+    TaskScheduler::GetI().InitHW(1);
+
+    Run(10);
+    Run(100);
+    Run(1000);
+
+    return 0;
+}
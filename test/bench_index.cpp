@@ -0,0 +1,114 @@
+/**
+ * bench_index.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ *
+ *  Benchmark of looking up pending tasks through the index (tsIndex.h) with 10,
+ *  100 and 1000 tasks pending: finding a task by PID, checking whether
+ *  a service has a pending task and removing a task by PID. Lookup by PID is
+ *  compared with scanning the whole queue, which is what removing a task used
+ *  to take. Numbers are host time, useful only for comparison with each other.
+ */
+#include "simTest.h"
+
+#if (TS_MAX_TASKS < 1000) || (TS_INDEX_BUCKETS < 1000)
+#error Benchmark needs kernel built with more than 1000 tasks and index buckets
+#endif
+
+//  Services tasks are spread over
+#define BENCH_UIDS      10
+#define BENCH_TASKIDS   16
+#define BENCH_LOOKUPS   20000
+
+static uint16_t pids[TS_MAX_TASKS];
+
+/**
+ * Find task by PID going through all pending tasks
+ */
+static const TaskEntry* Scan(uint16_t PID)
+{
+    volatile TaskScheduler &ts = TaskScheduler::GetI();
+    const TaskEntry *task = ts.FetchNextTask(true);
+
+    while ((task != 0) && (task->GetPID() != PID))
+        task = ts.FetchNextTask(false);
+
+    return task;
+}
+
+static void Run(uint16_t pending)
+{
+    volatile TaskScheduler &ts = TaskScheduler::GetI();
+    uint32_t base = (uint32_t)msSinceStartup + 1000;
+    uint64_t findNS, scanNS, serviceNS, removeNS, start;
+    uint32_t found = 0;
+
+    for (uint16_t i = 0; i < pending; i++)
+        ts.SyncTask(Random() % BENCH_UIDS, Random() % BENCH_TASKIDS,
+                    base + Random() % BENCH_SPAN);
+    CHECK_EQ(ts.NumOfTasks(), pending);
+
+    //  Collect PIDs of all pending tasks
+    for (uint16_t i = 0; i < pending; i++)
+    {
+        const TaskEntry *task = ts.FetchNextTask(i == 0);
+        CHECK(task != 0);
+        pids[i] = task->GetPID();
+    }
+
+    start = NowNS();
+    for (uint32_t i = 0; i < BENCH_LOOKUPS; i++)
+    {
+        uint16_t PID = pids[Random() % pending];
+        const TaskEntry *task = ts.FindTask(PID);
+        CHECK((task != 0) && (task->GetPID() == PID));
+    }
+    findNS = NowNS() - start;
+
+    start = NowNS();
+    for (uint32_t i = 0; i < BENCH_LOOKUPS; i++)
+    {
+        uint16_t PID = pids[Random() % pending];
+        const TaskEntry *task = Scan(PID);
+        CHECK((task != 0) && (task->GetPID() == PID));
+    }
+    scanNS = NowNS() - start;
+
+    start = NowNS();
+    for (uint32_t i = 0; i < BENCH_LOOKUPS; i++)
+        found += ts.IsPending(Random() % BENCH_UIDS, Random() % BENCH_TASKIDS);
+    serviceNS = NowNS() - start;
+    CHECK(found > 0);
+
+    //  Remove all tasks, in random order
+    for (uint16_t i = pending - 1; i > 0; i--)
+    {
+        uint16_t j = Random() % (i + 1), tmp = pids[i];
+        pids[i] = pids[j];
+        pids[j] = tmp;
+    }
+    start = NowNS();
+    for (uint16_t i = 0; i < pending; i++)
+        CHECK(ts.RemoveTask(pids[i]));
+    removeNS = NowNS() - start;
+    CHECK(ts.IsEmpty());
+
+    printf("%4d pending: find %4u ns (scan %6u ns), service %4u ns, "
+           "remove %4u ns\n", pending, (uint32_t)(findNS / BENCH_LOOKUPS),
+           (uint32_t)(scanNS / BENCH_LOOKUPS),
+           (uint32_t)(serviceNS / BENCH_LOOKUPS),
+           (uint32_t)(removeNS / pending));
+}
+
+int main()
+{
+    HAL_BOARD_CLOCK_Init();
+    TaskScheduler::GetI().InitHW(1);
+
+    Run(10);
+    Run(100);
+    Run(1000);
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+/**
+ * simTest.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ *
+ *  Helpers shared by host tests: checks that end the test on failure, running
+ *  the kernel for a given time of the virtual clock, pseudo-random numbers and
+ *  host time for benchmarks
+ */
+#ifndef TEST_SIMTEST_H_
+#define TEST_SIMTEST_H_
+
+#include "HAL/hal.h"
+#include "HAL/posix/hal_sim_posix.h"
+#include "taskScheduler/taskScheduler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+//  Range of time stamps (in ms) benchmarks spread pending tasks over
+#define BENCH_SPAN      100000
+
+//  Fail the test if condition doesn't hold
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond))                                                        \
+        {                                                                   \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);   \
+            fflush(stdout);                                                 \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+//  Fail the test if two integers differ, printing both of them
+#define CHECK_EQ(a, b)                                                      \
+    do {                                                                    \
+        long long _a = (long long)(a), _b = (long long)(b);                 \
+        if (_a != _b)                                                       \
+        {                                                                   \
+            printf("%s:%d: check failed: %s == %s (%lld != %lld)\n",         \
+                   __FILE__, __LINE__, #a, #b, _a, _b);                     \
+            fflush(stdout);                                                 \
+            exit(EXIT_FAILURE);                                             \
+        }                                                                   \
+    } while (0)
+
+/**
+ * Run task scheduler of the selected board for given time of virtual clock
+ * @param us time to run for (in us)
+ */
+static inline void SimRunFor(uint64_t us)
+{
+    uint64_t end = HAL_SIM_GetTimeUS() + us;
+
+    while (HAL_SIM_GetTimeUS() < end)
+        TS_GlobalCheck();
+}
+
+/**
+ * Deterministic pseudo-random numbers, so every run of a test or benchmark
+ * goes through the same workload
+ * @return next number of the sequence
+ */
+static inline uint32_t Random()
+{
+    static uint32_t seed = 1;
+
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 8);
+}
+
+/**
+ * Host time, benchmarks measure with it as virtual clock doesn't move while
+ * kernel code runs
+ * @return monotonic time (in ns)
+ */
+static inline uint64_t NowNS()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+#endif /* TEST_SIMTEST_H_ */
@@ -0,0 +1,49 @@
+/**
+ * test_boot.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ *
+ *  Boots the whole platform on the simulated board, the same way roverRPi3.cpp
+ *  does, and checks that the kernel keeps running and moves the rover
+ */
+#include "simTest.h"
+#include "init/platform.h"
+#include "init/metrics.h"
+#include "engines/engines.h"
+
+int main()
+{
+    HAL_BOARD_CLOCK_Init();
+    Platform::GetI().InitHW();
+    TaskScheduler::GetP()->SetIdleHook(HAL_TS_Sleep);
+
+    //  Initialization waits on ESP chip and calibrates MPU sensor
+    CHECK(HAL_SIM_GetTimeUS() > 0);
+    //  Every module registered its metrics
+    CHECK(MetricsRegistry::GetI().Count() >= 10);
+    CHECK_EQ(MetricsRegistry::GetI().overflows, 0);
+
+    SimRunFor(5000000);
+    CHECK(HAL_SIM_Stats.wakeups > 0);
+
+    //  Drive forward for 10cm and let the speed loop finish the move
+    CHECK_EQ(EngineData::GetI().StartEngines(ENG_DIR_FW, 10, false), STATUS_OK);
+    SimRunFor(5000000);
+    CHECK(EngineData::GetI().encoderISR[0].value > 0);
+    CHECK(EngineData::GetI().encoderISR[1].value > 0);
+    CHECK(EngineData::GetI().wheelCounter[0] > 0);
+    CHECK(EngineData::GetI().wheelCounter[1] > 0);
+
+    //  Rover has stopped at the end of the move
+    int32_t left = EngineData::GetI().wheelCounter[0];
+    SimRunFor(1000000);
+    CHECK_EQ(EngineData::GetI().wheelCounter[0], left);
+
+    printf("booted in %.3fs, drove L=%d R=%d\n",
+           HAL_SIM_GetTimeUS() / 1e6 - 11.0,
+           (int)EngineData::GetI().wheelCounter[0],
+           (int)EngineData::GetI().wheelCounter[1]);
+
+    return 0;
+}
@@ -0,0 +1,195 @@
+/**
+ * test_contexts.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ *
+ *  Runs hundreds of rovers, each in its own kernel context (init/kernelContext.h),
+ *  on a small work-stealing pool of threads. Every rover boots the platform,
+ *  drives a distance picked by its number and is run in short slices of virtual
+ *  time, taken by whichever thread gets to it first. Each rover has to end up
+ *  exactly where the same rover run alone on one thread does, i.e. contexts
+ *  share nothing with each other nor with the thread running them.
+ */
+#include "simTest.h"
+#include "init/kernelContext.h"
+#include "init/platform.h"
+#include "engines/engines.h"
+#include <pthread.h>
+#include <sched.h>
+
+#define TEST_ROVERS     200
+#define TEST_THREADS    4
+//  Number of different distances rovers drive
+#define TEST_VARIANTS   4
+//  Slice of virtual time a rover runs for before going back to the pool (in us)
+#define TEST_SLICE      1000000
+//  Slices to run before and after starting engines
+#define TEST_SLICES     6
+
+/**
+ * Rover and where it got to, once it's done
+ */
+struct Rover
+{
+    KernelContext   *ctx;
+    uint16_t        number;
+    uint8_t         step;
+    int32_t         wheels[2];
+    uint32_t        timeMS;
+};
+
+/**
+ * Rovers waiting to be run by one of the threads. Owner takes them from the
+ * back, other threads steal from the front
+ */
+struct Deque
+{
+    pthread_mutex_t lock;
+    Rover           *items[TEST_ROVERS];
+    uint16_t        head;
+    uint16_t        count;
+};
+
+static Rover rovers[TEST_ROVERS];
+static Rover reference[TEST_VARIANTS];
+static Deque deques[TEST_THREADS];
+static volatile uint32_t remaining = TEST_ROVERS;
+static volatile uint32_t steals = 0;
+
+static void Push(Deque &dq, Rover *rover)
+{
+    pthread_mutex_lock(&dq.lock);
+    dq.items[(dq.head + dq.count) % TEST_ROVERS] = rover;
+    dq.count++;
+    pthread_mutex_unlock(&dq.lock);
+}
+
+static Rover* Take(Deque &dq, bool steal)
+{
+    Rover *rover = 0;
+
+    pthread_mutex_lock(&dq.lock);
+    if (dq.count > 0)
+    {
+        dq.count--;
+        if (steal)
+        {
+            rover = dq.items[dq.head];
+            dq.head = (dq.head + 1) % TEST_ROVERS;
+        }
+        else
+            rover = dq.items[(dq.head + dq.count) % TEST_ROVERS];
+    }
+    pthread_mutex_unlock(&dq.lock);
+
+    return rover;
+}
+
+/**
+ * Run next slice of the rover in its context
+ * @return true if rover is done and its context destroyed
+ */
+static bool Step(Rover &rover)
+{
+    rover.ctx->Enter();
+
+    if (rover.step == 0)
+    {
+        HAL_BOARD_CLOCK_Init();
+        Platform::GetI().InitHW();
+        TaskScheduler::GetP()->SetIdleHook(HAL_TS_Sleep);
+    }
+    else if (rover.step == TEST_SLICES)
+    {
+        CHECK_EQ(EngineData::GetI().StartEngines(ENG_DIR_FW,
+                         10 + 5 * (rover.number % TEST_VARIANTS), false),
+                 STATUS_OK);
+    }
+    SimRunFor(TEST_SLICE);
+
+    if (++rover.step < 2 * TEST_SLICES)
+        return false;
+
+    rover.wheels[0] = EngineData::GetI().wheelCounter[0];
+    rover.wheels[1] = EngineData::GetI().wheelCounter[1];
+    rover.timeMS = (uint32_t)msSinceStartup;
+    KernelContext::Destroy(rover.ctx);
+    rover.ctx = 0;
+
+    return true;
+}
+
+static void* Worker(void *arg)
+{
+    uint32_t self = (uint32_t)(uintptr_t)arg;
+
+    while (remaining > 0)
+    {
+        Rover *rover = Take(deques[self], false);
+
+        for (uint32_t i = 1; (rover == 0) && (i < TEST_THREADS); i++)
+        {
+            rover = Take(deques[(self + i) % TEST_THREADS], true);
+            if (rover != 0)
+                __sync_fetch_and_add(&steals, 1);
+        }
+
+        if (rover == 0)
+            sched_yield();
+        else if (Step(*rover))
+            __sync_fetch_and_sub(&remaining, 1);
+        else
+            Push(deques[self], rover);
+    }
+
+    return 0;
+}
+
+int main()
+{
+    pthread_t threads[TEST_THREADS];
+
+    //  Reference runs, one rover at a time on the main thread
+    for (uint16_t i = 0; i < TEST_VARIANTS; i++)
+    {
+        reference[i].ctx = KernelContext::Create();
+        reference[i].number = i;
+        CHECK(reference[i].ctx != 0);
+        while (!Step(reference[i]));
+        CHECK(reference[i].wheels[0] > 0);
+    }
+    //  Rovers driving longer get further
+    for (uint16_t i = 1; i < TEST_VARIANTS; i++)
+        CHECK(reference[i].wheels[0] > reference[i-1].wheels[0]);
+
+    //  All rovers start on the first thread, the rest have to steal them
+    for (uint16_t i = 0; i < TEST_THREADS; i++)
+        pthread_mutex_init(&deques[i].lock, 0);
+    for (uint16_t i = 0; i < TEST_ROVERS; i++)
+    {
+        rovers[i].ctx = KernelContext::Create();
+        rovers[i].number = i;
+        CHECK(rovers[i].ctx != 0);
+        Push(deques[0], &rovers[i]);
+    }
+
+    for (uint32_t i = 0; i < TEST_THREADS; i++)
+        CHECK_EQ(pthread_create(&threads[i], 0, Worker, (void*)(uintptr_t)i), 0);
+    for (uint32_t i = 0; i < TEST_THREADS; i++)
+        CHECK_EQ(pthread_join(threads[i], 0), 0);
+
+    for (uint16_t i = 0; i < TEST_ROVERS; i++)
+    {
+        Rover &ref = reference[i % TEST_VARIANTS];
+
+        CHECK_EQ(rovers[i].step, 2 * TEST_SLICES);
+        CHECK_EQ(rovers[i].wheels[0], ref.wheels[0]);
+        CHECK_EQ(rovers[i].wheels[1], ref.wheels[1]);
+        CHECK_EQ(rovers[i].timeMS, ref.timeMS);
+    }
+
+    printf("%d rovers on %d threads, %u slices stolen\n",
+           TEST_ROVERS, TEST_THREADS, steals);
+    return 0;
+}
@@ -0,0 +1,95 @@
+/**
+ * test_defer.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ *
+ *  Stress test of the ring of requests deferred from interrupts (tsDefer.h).
+ *  A producer thread stands in for interrupts, posting numbered requests as
+ *  fast as it can, while the main thread takes them out the way task scheduler
+ *  does. Every request has to come out exactly once, in order and intact,
+ *  whether the ring runs empty or full.
+ */
+#include "simTest.h"
+#include "taskScheduler/tsDefer.h"
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#define TEST_REQUESTS   1000000
+
+static volatile DeferQueue ring;
+//  Number of times producer found the ring full and had to retry
+static uint32_t full = 0;
+
+/**
+ * Fill request number [n]: its number is spread over service IDs and first
+ * bytes of arguments, the rest of arguments is a pattern derived from it
+ */
+static uint8_t Request(uint32_t n, uint8_t *args)
+{
+    uint8_t argN = 4 + (n % (TS_ARG_INLINE_SIZE - 3));
+
+    memcpy(args, &n, 4);
+    for (uint8_t i = 4; i < argN; i++)
+        args[i] = (uint8_t)(n * 31 + i);
+
+    return argN;
+}
+
+static void* Producer(void *arg)
+{
+    uint8_t args[TS_ARG_INLINE_SIZE];
+
+    (void)arg;
+    for (uint32_t n = 0; n < TEST_REQUESTS; n++)
+    {
+        uint8_t argN = Request(n, args);
+
+        //  Interrupt would drop the request, here it's retried so that the
+        //  consumer can check nothing got lost or duplicated
+        while (!ring.Push((uint8_t)n, (uint8_t)(n >> 8), args, argN))
+        {
+            full++;
+            sched_yield();
+        }
+    }
+
+    return 0;
+}
+
+int main()
+{
+    pthread_t producer;
+    uint8_t args[TS_ARG_INLINE_SIZE];
+    uint32_t empty = 0;
+    _deferItem item;
+
+    CHECK_EQ(pthread_create(&producer, 0, Producer, 0), 0);
+
+    for (uint32_t n = 0; n < TEST_REQUESTS; n++)
+    {
+        while (!ring.Pop(item))
+        {
+            empty++;
+            sched_yield();
+        }
+
+        uint8_t argN = Request(n, args);
+        CHECK_EQ(item.libUID, (uint8_t)n);
+        CHECK_EQ(item.taskID, (uint8_t)(n >> 8));
+        CHECK_EQ(item.argN, argN);
+        CHECK(memcmp(item.args, args, argN) == 0);
+    }
+
+    CHECK_EQ(pthread_join(producer, 0), 0);
+    CHECK(!ring.Pop(item));
+    CHECK_EQ(ring.Count(), 0);
+    //  Ring was used up to its size, requests that didn't fit were counted
+    CHECK(ring.peak <= TS_DEFER_SIZE);
+    CHECK_EQ(ring.overflows, full);
+
+    printf("%d requests, ring full %u times, empty %u times, peak %d\n",
+           TEST_REQUESTS, full, empty, ring.peak);
+    return 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * test_execute.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ *
+ *  Commands received over network are decoded by Platform::Execute. Single
+ *  task has to be scheduled with all of its arguments, no matter how long they
+ *  are (as long as they fit into argument pools), while a batch is scheduled
+ *  either whole or not at all. Task for a module UID out of range of service
+ *  table is dropped
+ */
+#include "simTest.h"
+#include "init/platform.h"
+#include <string.h>
+
+#define TEST_UID        9
+//  Longer than all arguments a batch can carry
+#define TEST_ARGS       (TS_BATCH_ARG_SIZE + 72)
+
+//  More arguments than fit into the large argument pool
+#define TEST_ARGS_BIG   (TS_ARG_LARGE_SIZE + 1)
+
+//  Arguments received by the last calls of the test service
+static uint8_t  received[TEST_ARGS + 1];
+static uint16_t receivedLen = 0;
+static uint16_t calls = 0;
+
+uint32_t Receive(const uint8_t *args, uint16_t argN)
+{
+    memcpy(received + receivedLen, args, argN);
+    receivedLen += argN;
+    calls++;
+
+    return STATUS_OK;
+}
+static const _tsService testServices[] = { { &Receive, 1, 0 } };
+
+//  Build frame with a single task carrying argN bytes of arguments
+static uint16_t TaskFrame(uint8_t *frame, uint16_t argN)
+{
+    uint16_t len = sprintf((char*)frame, "T:%d:0:-5:0:0:%d::", TEST_UID, argN);
+
+    for (uint16_t i = 0; i < argN; i++)
+        frame[len++] = (uint8_t)i;
+
+    return len;
+}
+
+int main()
+{
+    uint8_t frame[TEST_ARGS_BIG + 64];
+    uint16_t len;
+    int err;
+
+    HAL_BOARD_CLOCK_Init();
+    Platform::GetI().InitHW();
+    TaskScheduler::GetP()->SetIdleHook(HAL_TS_Sleep);
+    TS_RegServices(TEST_UID, TS_SERVICES(testServices));
+
+    //  Single task with more arguments than fit into a batch
+    len = TaskFrame(frame, TEST_ARGS);
+    Platform::GetI().Execute(frame, len, &err);
+    CHECK_EQ(err, STATUS_OK);
+    SimRunFor(100000);
+    CHECK_EQ(calls, 1);
+    CHECK_EQ(receivedLen, TEST_ARGS);
+    for (uint16_t i = 0; i < TEST_ARGS; i++)
+        CHECK_EQ(received[i], (uint8_t)i);
+
+    //  Single task claiming more arguments than there are in frame
+    calls = receivedLen = 0;
+    Platform::GetI().Execute(frame, len - 1, &err);
+    CHECK_EQ(err, STATUS_ARG_ERR);
+    SimRunFor(100000);
+    CHECK_EQ(calls, 0);
+
+    //  Single task with arguments no pool can hold is refused, not allocated
+    //  on the free store
+    uint32_t overflows = TS_ArgPool(1).overflows;
+    len = TaskFrame(frame, TEST_ARGS_BIG);
+    Platform::GetI().Execute(frame, len, &err);
+    CHECK_EQ(err, STATUS_PROG_ERR);
+    CHECK_EQ(TS_ArgPool(1).overflows, overflows + 1);
+    SimRunFor(100000);
+    CHECK_EQ(calls, 0);
+    CHECK_EQ(TS_ArgPool(0).used + TS_ArgPool(1).used, 0);
+
+    //  Batch of two tasks, both scheduled
+    len = sprintf((char*)frame, "T:B:2:%d:0:-5:0:0:3::abc:%d:0:-5:0:0:2::de",
+                  TEST_UID, TEST_UID);
+    Platform::GetI().Execute(frame, len, &err);
+    CHECK_EQ(err, STATUS_OK);
+    SimRunFor(100000);
+    CHECK_EQ(calls, 2);
+    CHECK_EQ(receivedLen, 5);
+    CHECK(memcmp(received, "abcde", 5) == 0);
+
+    //  Batch with too many arguments is rejected as a whole
+    calls = receivedLen = 0;
+    len = sprintf((char*)frame, "T:B:2:%d:0:-5:0:0:3::abc:%d:0:-5:0:0:%d::",
+                  TEST_UID, TEST_UID, TS_BATCH_ARG_SIZE);
+    memset(frame + len, 'x', TS_BATCH_ARG_SIZE);
+    len += TS_BATCH_ARG_SIZE;
+    Platform::GetI().Execute(frame, len, &err);
+    CHECK(err != STATUS_OK);
+    SimRunFor(100000);
+    CHECK_EQ(calls, 0);
+
+    //  Task for a module that can't exist is dropped, tasks after it still run
+    len = sprintf((char*)frame, "T:B:2:200:0:-5:0:0:1::a:%d:0:-6:0:0:1::b",
+                  TEST_UID);
+    Platform::GetI().Execute(frame, len, &err);
+    SimRunFor(100000);
+    CHECK_EQ(calls, 1);
+    CHECK_EQ(received[0], 'b');
+
+    printf("single task with %d bytes of arguments scheduled\n", TEST_ARGS);
+    return 0;
+}
@@ -0,0 +1,163 @@
+/**
+ * test_order.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ *
+ *  Order in which tasks are executed has to be the same whichever container
+ *  keeps pending tasks (binary heap or timing wheel). Test runs the same
+ *  pseudo-random workload on the virtual clock, with delays covering every
+ *  level of the timing wheel and its overflow list, and writes the order in
+ *  which tasks ran to a file. Built once with each container, the two files
+ *  have to be identical (compared by a separate test). Each run also checks
+ *  that every task ran in the millisecond it was due in, and that tasks due in
+ *  the same millisecond ran by priority, then in the order they were added.
+ */
+#include "simTest.h"
+
+#define TEST_UID        9
+//  Number of one-shot tasks to run in total, and number kept pending at once
+#define TEST_TASKS      1500
+#define TEST_PENDING    48
+//  Periodic tasks running alongside the one-shot ones
+#define TEST_PERIODIC   3
+//  Longest time (in us of virtual time) the workload may take
+#define TEST_MAX_US     (48ULL * 3600 * 1000000)
+
+struct TaskInfo
+{
+    uint32_t due;
+    uint8_t  prio;
+};
+
+static TaskInfo info[TEST_TASKS];
+static uint16_t created = 0, executed = 0;
+static FILE *out;
+
+//  Last one-shot task that ran, to check the order of the next one
+static bool     anyRun = false;
+static uint32_t lastDue;
+static uint8_t  lastPrio;
+static uint16_t lastID;
+
+/**
+ * Pick a delay (in ms) falling onto a random level of the timing wheel, or
+ * beyond it. Far delays are rare so that the workload finishes in a few hours
+ * of virtual time
+ */
+static uint32_t RandomDelay()
+{
+    uint32_t r = Random() % 100;
+
+    if (r < 40)
+        return 1 + Random() % 63;
+    if (r < 70)
+        return 64 + Random() % (4096 - 64);
+    if (r < 90)
+        return 4096 + Random() % (262144 - 4096);
+    if (r < 98)
+        return 262144 + Random() % (4 * 262144);
+    //  Past the end of the wheel (64^4 ms), into the overflow list
+    return 16777216 + Random() % 1000000;
+}
+
+/**
+ * Add a one-shot task (or a few due at the same time) with random delay and
+ * priority, identified by the order in which they were created
+ */
+static void Spawn()
+{
+    uint32_t delay = RandomDelay();
+    uint8_t same = ((Random() % 8) == 0) ? 3 : 1;
+
+    for (uint8_t i = 0; (i < same) && (created < TEST_TASKS); i++)
+    {
+        uint8_t prio = Random() % 3;
+        uint32_t id = created;
+
+        info[id].due = (uint32_t)msSinceStartup + delay;
+        info[id].prio = prio;
+        created++;
+
+        TaskScheduler::GetI().SyncTaskPer(TEST_UID, 0, -(int64_t)delay, 0, 0,
+                                          prio);
+        TaskScheduler::GetI().AddArg<uint32_t>(id);
+    }
+}
+
+uint32_t OneShot(const uint8_t *args, uint16_t argN)
+{
+    uint32_t id, now = (uint32_t)msSinceStartup;
+
+    CHECK_EQ(argN, sizeof(id));
+    memcpy(&id, args, sizeof(id));
+    CHECK(id < created);
+    fprintf(out, "%u %u\n", now, id);
+
+    //  Ran when due, after tasks due before it or with higher priority
+    CHECK_EQ(now, info[id].due);
+    if (anyRun && (info[id].due == lastDue))
+        CHECK((info[id].prio > lastPrio) ||
+              ((info[id].prio == lastPrio) && (id > lastID)));
+    anyRun = true;
+    lastDue = info[id].due;
+    lastPrio = info[id].prio;
+    lastID = id;
+
+    //  Keep the number of pending tasks within the capacity of the queue
+    executed++;
+    while ((created < TEST_TASKS) && ((created - executed) < TEST_PENDING))
+        Spawn();
+
+    return STATUS_OK;
+}
+
+uint32_t Periodic(const uint8_t *args, uint16_t argN)
+{
+    CHECK_EQ(argN, 1);
+    fprintf(out, "%u p%u\n", (uint32_t)msSinceStartup, args[0]);
+
+    return STATUS_OK;
+}
+
+static const _tsService testServices[] =
+{
+    { &OneShot, 4, 0 },
+    { &Periodic, 1, 0 }
+};
+
+int main(int argc, char *argv[])
+{
+    const int32_t period[TEST_PERIODIC] = { 7, 250, 5000 },
+                  repeats[TEST_PERIODIC] = { 300, 200, 100 };
+
+    CHECK(argc > 1);
+    out = fopen(argv[1], "w");
+    CHECK(out != 0);
+
+    HAL_BOARD_CLOCK_Init();
+    TaskScheduler::GetI().InitHW(1);
+    TaskScheduler::GetI().SetIdleHook(HAL_TS_Sleep);
+    TS_RegServices(TEST_UID, TS_SERVICES(testServices));
+
+    for (uint8_t i = 0; i < TEST_PERIODIC; i++)
+    {
+        TaskScheduler::GetI().SyncTaskPer(TEST_UID, 1, -1, period[i],
+                                          repeats[i]);
+        TaskScheduler::GetI().AddArg<uint8_t>(i);
+    }
+    while (created < TEST_PENDING)
+        Spawn();
+
+    while (!TaskScheduler::GetI().IsEmpty() &&
+           (HAL_SIM_GetTimeUS() < TEST_MAX_US))
+        SimRunFor(1000000);
+
+    fclose(out);
+    CHECK(TaskScheduler::GetI().IsEmpty());
+    CHECK_EQ(executed, TEST_TASKS);
+
+    printf("%d tasks in order over %us\n", TEST_TASKS,
+           (uint32_t)(HAL_SIM_GetTimeUS() / 1000000));
+    return 0;
+}
@@ -0,0 +1,81 @@
+/**
+ * test_profiler.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ *
+ *  Run time of a task whose service yields is the sum of time spent in each of
+ *  its slices. Time the task spends suspended (here with the processor busy in
+ *  idle hook) mustn't be counted into it. Services called only by one-shot
+ *  tasks are profiled as well
+ */
+#include "simTest.h"
+#include "taskScheduler/tsCoroutine.h"
+#include <unistd.h>
+
+#define TEST_UID        9
+#define TEST_PERIOD     100
+#define TEST_RUNS       5
+//  Time (in us of real time) spent in idle hook on every call
+#define TEST_IDLE_US    1000
+
+static Coroutine co;
+
+uint32_t Slices()
+{
+    TS_CO_BEGIN(co);
+    TS_CO_SLEEP(co, 20);
+    TS_CO_SLEEP(co, 20);
+    TS_CO_END(co);
+
+    return STATUS_OK;
+}
+uint32_t OneShot()
+{
+    return STATUS_OK;
+}
+static const _tsService testServices[] = { TS_FUNCTION0(uint32_t, Slices),
+                                           TS_FUNCTION0(uint32_t, OneShot) };
+
+//  Burn real time (measured by cycle counter) while the task is suspended
+static void BusyIdle()
+{
+    usleep(TEST_IDLE_US);
+    HAL_TS_Sleep();
+}
+
+int main()
+{
+    HAL_BOARD_CLOCK_Init();
+    TaskScheduler::GetI().InitHW(1);
+    TaskScheduler::GetI().SetIdleHook(BusyIdle);
+    TS_RegServices(TEST_UID, TS_SERVICES(testServices));
+
+    TaskScheduler::GetI().SyncTaskPer(TEST_UID, 0, -5, TEST_PERIOD, -1);
+    for (uint8_t i = 0; i < TEST_RUNS; i++)
+        TaskScheduler::GetI().SyncTask(TEST_UID, 1, -(i * TEST_PERIOD + 10));
+    SimRunFor((uint64_t)(TEST_RUNS - 1) * TEST_PERIOD * 1000 + 50000);
+
+    const TaskEntry *task = TaskScheduler::GetI().FetchNextTask(true);
+    CHECK(task != 0);
+    CHECK_EQ(task->Perf.taskRuns, TEST_RUNS);
+    //  Each run was suspended for 40ms with idle hook called at least twice,
+    //  but it only ran for a few microseconds
+    CHECK(task->Perf.runTime.max < TEST_IDLE_US);
+
+    //  One profile per service, one-shot tasks are gone from the queue but
+    //  their runs are in the profile of their service
+    const volatile ServiceProfile *prof[2];
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        prof[i] = TaskScheduler::GetI().GetProfile(i);
+        CHECK(prof[i] != 0);
+        CHECK_EQ(prof[i]->libUID, TEST_UID);
+        CHECK_EQ(prof[i]->runs, TEST_RUNS);
+    }
+    CHECK(TaskScheduler::GetI().GetProfile(2) == 0);
+    CHECK(prof[0]->taskID != prof[1]->taskID);
+
+    printf("%d runs, longest %dus\n", TEST_RUNS, (int)task->Perf.runTime.max);
+    return 0;
+}
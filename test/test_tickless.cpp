@@ -0,0 +1,68 @@
+/**
+ * test_tickless.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ *
+ *  Task scheduler in tickless mode (__TS_TICKLESS__): instead of waking up on
+ *  every SysTick, processor sleeps until the wake-up timer expires when the
+ *  next task is due. Tasks have to start on time, and processor has to wake up
+ *  only for them (plus the longest allowed sleep, TS_TICKLESS_MAX_SLEEP).
+ */
+#include "simTest.h"
+
+#if !defined(__TS_TICKLESS__)
+#error Test has to be built with __TS_TICKLESS__
+#endif
+
+#define TEST_UID        9
+#define TEST_PERIOD     7
+#define TEST_RUNS       100
+
+//  Time (in us) at which each run of the periodic task started
+static uint64_t runUS[TEST_RUNS];
+static uint16_t runs = 0;
+
+uint32_t Tick()
+{
+    if (runs < TEST_RUNS)
+        runUS[runs++] = TS_GetTimeUS();
+
+    return STATUS_NO_EVENT;
+}
+static const _tsService testServices[] = { TS_FUNCTION0(uint32_t, Tick) };
+
+int main()
+{
+    HAL_BOARD_CLOCK_Init();
+    TaskScheduler::GetI().InitHW(1);
+    TS_RegServices(TEST_UID, TS_SERVICES(testServices));
+
+    //  Start 5ms from now and repeat every TEST_PERIOD ms
+    uint64_t first = (uint64_t)(msSinceStartup + 5) * 1000;
+    TaskScheduler::GetI().SyncTaskPer(TEST_UID, 0, -5, TEST_PERIOD, TEST_RUNS);
+
+    uint32_t wakeups = HAL_SIM_Stats.wakeups;
+    SimRunFor((uint64_t)(TEST_RUNS + 1) * TEST_PERIOD * 1000 + 5000);
+    wakeups = HAL_SIM_Stats.wakeups - wakeups;
+
+    //  Every run started within the millisecond it was due in
+    CHECK_EQ(runs, TEST_RUNS);
+    for (uint16_t i = 0; i < TEST_RUNS; i++)
+    {
+        uint64_t due = first + (uint64_t)i * TEST_PERIOD * 1000;
+
+        CHECK(runUS[i] >= due);
+        CHECK(runUS[i] < (due + 1000));
+    }
+
+    //  One wake-up per run, and for the longest sleep once the task is done
+    //  (with 1ms SysTick it would be one every millisecond)
+    CHECK(wakeups >= TEST_RUNS);
+    CHECK(wakeups <= (TEST_RUNS + 3));
+
+    printf("%u runs, %u wake-ups in %.3fs\n", runs, wakeups,
+           HAL_SIM_GetTimeUS() / 1e6);
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+/**
+ * test_timebase.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ *
+ *  Microsecond time base of the task scheduler. Like on TM4C1294, it's a 32-bit
+ *  counter of clock cycles extended to 64 bits on its overflow (every ~35s).
+ *  Time has to follow the virtual clock exactly across overflows, including
+ *  when it's read with interrupts disabled while an overflow is pending.
+ */
+#include "simTest.h"
+
+//  Virtual time (in us, since start of time base) of n-th counter overflow
+static uint64_t WrapUS(uint64_t n)
+{
+    uint64_t cycles = n << 32;
+    uint64_t perUS = HAL_SIM_CLOCK / 1000000;
+
+    return (cycles + perUS - 1) / perUS;
+}
+
+static void CheckTime(uint64_t start)
+{
+    CHECK_EQ(HAL_TS_GetTimeUS(), HAL_SIM_GetTimeUS() - start);
+}
+
+int main()
+{
+    HAL_BOARD_CLOCK_Init();
+    HAL_DelayUS(1234);
+    HAL_TS_InitTimeBase();
+    uint64_t start = HAL_SIM_GetTimeUS();
+    CheckTime(start);
+
+    //  Irregular steps through the first few overflows
+    uint64_t last = 0;
+    while ((HAL_SIM_GetTimeUS() - start) < WrapUS(4))
+    {
+        HAL_DelayUS(777777);
+        CheckTime(start);
+        CHECK(HAL_TS_GetTimeUS() > last);
+        last = HAL_TS_GetTimeUS();
+    }
+
+    //  Microseconds around an overflow
+    for (uint64_t n = 5; n < 8; n++)
+    {
+        HAL_DelayUS(WrapUS(n) - 2 - (HAL_SIM_GetTimeUS() - start));
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            CheckTime(start);
+            HAL_DelayUS(1);
+        }
+    }
+
+    //  Overflow while interrupts are disabled stays pending, but time is still
+    //  correct and it's not counted twice once the interrupt is served
+    uint32_t ints = HAL_SIM_Stats.interrupts;
+    HAL_BOARD_InterruptEnable(false);
+    HAL_DelayUS(WrapUS(8) + 10 - (HAL_SIM_GetTimeUS() - start));
+    CheckTime(start);
+    CHECK_EQ(HAL_SIM_Stats.interrupts, ints);
+    HAL_BOARD_InterruptEnable(true);
+    CHECK_EQ(HAL_SIM_Stats.interrupts, ints + 1);
+    CheckTime(start);
+
+    //  Starting time base again doesn't reset it
+    HAL_TS_InitTimeBase();
+    CheckTime(start);
+
+    printf("time base followed virtual clock for %.1fs\n",
+           HAL_TS_GetTimeUS() / 1e6);
+
+    return 0;
+}
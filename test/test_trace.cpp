@@ -0,0 +1,105 @@
+/**
+ * test_trace.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ *
+ *  Runs a few tasks (one of them yielding, one requested from interrupt) with
+ *  kernel trace enabled and writes the trace buffer to a file in the same
+ *  frames Platform sends it in (PLAT_T_TRACE_DUMP). File is then converted by
+ *  tools/traceToJson, which has to find all task runs and interrupts in it.
+ */
+#include "simTest.h"
+#include "taskScheduler/tsCoroutine.h"
+#include "taskScheduler/tsTrace.h"
+
+#if !defined(__TS_TRACE__) || !defined(__TS_TICKLESS__)
+#error Test has to be built with __TS_TRACE__ and __TS_TICKLESS__
+#endif
+
+#define TEST_UID        9
+//  Number of trace records sent in a single frame, as in platform.cpp
+#define TEST_CHUNK      32
+
+static Coroutine co;
+
+uint32_t Tick()
+{
+    return STATUS_OK;
+}
+
+uint32_t Slices()
+{
+    TS_CO_BEGIN(co);
+    TS_CO_SLEEP(co, 3);
+    TS_CO_END(co);
+
+    return STATUS_OK;
+}
+static const _tsService testServices[] =
+{
+    TS_FUNCTION0(uint32_t, Tick),
+    TS_FUNCTION0(uint32_t, Slices)
+};
+
+//  Interrupt requesting a task
+static void RequestISR()
+{
+    TaskScheduler::GetI().SyncTaskISR(TEST_UID, 0);
+}
+
+/**
+ * Write trace buffer of current kernel context, in format of PLAT_T_TRACE_DUMP
+ */
+static void Dump(FILE *out)
+{
+    volatile TraceBuffer &trace = *(KernelContext::Current().trace);
+    uint64_t usNow = TS_GetTimeUS();
+    uint16_t count = trace.Count();
+
+    trace.enabled = false;
+    fprintf(out, "5*:H:%u:%u:%u:%u:%u:%u:\n", count, trace.Lost(),
+            HAL_TS_GetCycles(), HAL_TS_GetCyclesPerUS(),
+            (uint32_t)(usNow / 1000), (uint32_t)(usNow % 1000));
+
+    for (uint16_t i = 0; i < count; i += TEST_CHUNK)
+    {
+        fprintf(out, "5*:%u:", i);
+        for (uint16_t j = i; (j < count) && (j < (i + TEST_CHUNK)); j++)
+        {
+            const volatile _traceRec &rec = trace.At(j);
+
+            fprintf(out, "%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X",
+                    (uint8_t)rec.cycles, (uint8_t)(rec.cycles >> 8),
+                    (uint8_t)(rec.cycles >> 16), (uint8_t)(rec.cycles >> 24),
+                    (uint8_t)rec.PID, (uint8_t)(rec.PID >> 8), rec.type,
+                    rec.libUID, rec.taskID, rec.data);
+        }
+        fprintf(out, ":\n");
+    }
+    trace.enabled = true;
+}
+
+int main(int argc, char *argv[])
+{
+    CHECK(argc > 1);
+    FILE *out = fopen(argv[1], "w");
+    CHECK(out != 0);
+
+    HAL_BOARD_CLOCK_Init();
+    TaskScheduler::GetI().InitHW(1);
+    TaskScheduler::GetI().SetIdleHook(HAL_TS_Sleep);
+    TS_RegServices(TEST_UID, TS_SERVICES(testServices));
+
+    TaskScheduler::GetI().SyncTaskPer(TEST_UID, 0, -2, 5, 20);
+    TaskScheduler::GetI().SyncTaskPer(TEST_UID, 1, -1, 20, 5);
+    SimRunFor(50000);
+    HAL_SIM_RaiseInt(RequestISR);
+    SimRunFor(100000);
+
+    CHECK(KernelContext::Current().trace->Count() > 0);
+    Dump(out);
+    fclose(out);
+
+    return 0;
+}
@@ -0,0 +1,278 @@
+/**
+ * traceToJson.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Vedran Mikov
+ *
+ *  Converts dump of kernel trace buffer (PLAT_T_TRACE_DUMP, see
+ *  taskScheduler/tsTrace.h) into JSON trace event format, which can be opened
+ *  in chrome://tracing or ui.perfetto.dev. Input is the telemetry stream as
+ *  received from the rover, frames other than the trace dump are skipped:
+ *      5*:H:records:lost:cyclesNow:cyclesPerUS:msNow:usFraction:
+ *      5*:index:[cycles(4B)|PID(2B)|type|libUID|taskID|data] x N:
+ *  Task runs are shown as slices on the "Tasks" track, interrupts, task
+ *  requests, events and budget overruns as instant events. Time is converted
+ *  from CPU cycles using the header, which is sampled at the time of the dump,
+ *  so records older than one overflow of the cycle counter (~35s at 120MHz)
+ *  end up with wrong time.
+ *
+ *  Usage: traceToJson [dump.txt [trace.json]]
+ *  Reads from standard input and writes to standard output if files are not
+ *  given.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+
+//  Types of trace records, same as TR_* in tsTrace.h
+#define TR_TASK_START   1
+#define TR_TASK_END     2
+#define TR_SYNC         3
+#define TR_ISR          4
+#define TR_EVENT        5
+#define TR_OVERRUN      6
+
+//  Tracks (threads) events are shown on
+#define TRACK_TASKS     1
+#define TRACK_ISR       2
+
+//  Longest line of input
+#define LINE_MAX_LEN    4096
+//  Length of a single record in the dump, in hex digits
+#define REC_HEX_LEN     20
+
+//  Names of kernel modules, indexed by their *_UID macros
+static const char *moduleName[] = { "ESP", "Radar", "Engines", "MPU",
+                                    "DataStream", "Platform", "EventLog",
+                                    "TaskScheduler", "Storage" };
+
+/**
+ * Reference for converting cycles of records into time, from header frame
+ */
+struct DumpHeader
+{
+    uint32_t cyclesNow;
+    uint32_t cyclesPerUS;
+    double   usNow;
+    bool     valid;
+};
+
+/**
+ * Output state, shared by all dumps in the input
+ */
+struct Output
+{
+    FILE     *out;
+    bool     first;
+    //  True while a task slice is open (start seen, end not yet)
+    bool     taskOpen;
+    uint32_t records;
+    uint32_t tasks;
+    uint32_t interrupts;
+};
+
+static void Module(char *buf, size_t len, uint8_t libUID, uint8_t taskID)
+{
+    if (libUID < (sizeof(moduleName) / sizeof(moduleName[0])))
+        snprintf(buf, len, "%s:%u", moduleName[libUID], taskID);
+    else
+        snprintf(buf, len, "%u:%u", libUID, taskID);
+}
+
+/**
+ * Write a single trace event
+ * @param ph phase of the event (B, E, i)
+ * @param args JSON object with arguments of the event, 0 if none
+ */
+static void Event(Output &o, const char *name, char ph, uint8_t track,
+                  double us, const char *args)
+{
+    fprintf(o.out, "%s\n  {\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,"
+            "\"pid\":1,\"tid\":%u", o.first ? "" : ",", name, ph, us, track);
+    if (ph == 'i')
+        fprintf(o.out, ",\"s\":\"t\"");
+    if (args != 0)
+        fprintf(o.out, ",\"args\":%s", args);
+    fprintf(o.out, "}");
+
+    o.first = false;
+}
+
+static void TrackName(Output &o, uint8_t track, const char *name)
+{
+    fprintf(o.out, "%s\n  {\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+            "\"tid\":%u,\"args\":{\"name\":\"%s\"}}", o.first ? "" : ",",
+            track, name);
+    o.first = false;
+}
+
+/**
+ * Convert a single record into trace event(s)
+ */
+static void Record(Output &o, const DumpHeader &h, const uint8_t *raw)
+{
+    uint32_t cycles = raw[0] | (raw[1] << 8) | (raw[2] << 16)
+                      | ((uint32_t)raw[3] << 24);
+    uint16_t PID = raw[4] | (raw[5] << 8);
+    uint8_t type = raw[6], libUID = raw[7], taskID = raw[8], data = raw[9];
+    //  Difference of cycles is correct even if counter overflowed in between
+    double us = h.usNow - (double)(uint32_t)(h.cyclesNow - cycles)
+                          / h.cyclesPerUS;
+    char name[48], mod[32], args[64];
+
+    Module(mod, sizeof(mod), libUID, taskID);
+    o.records++;
+
+    switch (type)
+    {
+    case TR_TASK_START:
+        //  End of the previous task got lost, close it here
+        if (o.taskOpen)
+            Event(o, "", 'E', TRACK_TASKS, us, 0);
+        snprintf(args, sizeof(args), "{\"PID\":%u}", PID);
+        Event(o, mod, 'B', TRACK_TASKS, us, args);
+        o.taskOpen = true;
+        o.tasks++;
+        break;
+    case TR_TASK_END:
+        //  Start of the task is older than the oldest record
+        if (!o.taskOpen)
+            break;
+        snprintf(args, sizeof(args), "{\"yield\":%u}", data);
+        Event(o, mod, 'E', TRACK_TASKS, us, args);
+        o.taskOpen = false;
+        break;
+    case TR_SYNC:
+        snprintf(name, sizeof(name), "sync %s", mod);
+        snprintf(args, sizeof(args), "{\"PID\":%u,\"deferred\":%u}", PID, data);
+        Event(o, name, 'i', data ? TRACK_ISR : TRACK_TASKS, us, args);
+        break;
+    case TR_ISR:
+        snprintf(name, sizeof(name), "ISR %s", mod);
+        Event(o, name, 'i', TRACK_ISR, us, 0);
+        o.interrupts++;
+        break;
+    case TR_EVENT:
+        snprintf(name, sizeof(name), "event %s", mod);
+        snprintf(args, sizeof(args), "{\"type\":%u}", data);
+        Event(o, name, 'i', TRACK_TASKS, us, args);
+        break;
+    case TR_OVERRUN:
+        snprintf(name, sizeof(name), "overrun %s", mod);
+        snprintf(args, sizeof(args), "{\"PID\":%u,\"caught\":%u}", PID, data);
+        Event(o, name, 'i', TRACK_TASKS, us, args);
+        break;
+    default:
+        break;
+    }
+}
+
+static int HexDigit(char c)
+{
+    if ((c >= '0') && (c <= '9'))
+        return c - '0';
+    if ((c >= 'A') && (c <= 'F'))
+        return c - 'A' + 10;
+    if ((c >= 'a') && (c <= 'f'))
+        return c - 'a' + 10;
+    return -1;
+}
+
+/**
+ * Decode frame with records, given as hex digits up to the closing ':'
+ * @return false if frame is corrupted
+ */
+static bool Records(Output &o, const DumpHeader &h, const char *hex)
+{
+    while (*hex != ':')
+    {
+        uint8_t raw[REC_HEX_LEN / 2];
+
+        for (uint8_t i = 0; i < sizeof(raw); i++)
+        {
+            int hi = HexDigit(hex[2*i]), lo = HexDigit(hex[2*i + 1]);
+
+            if ((hi < 0) || (lo < 0))
+                return false;
+            raw[i] = (uint8_t)((hi << 4) | lo);
+        }
+        Record(o, h, raw);
+        hex += REC_HEX_LEN;
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    FILE *in = stdin;
+    char line[LINE_MAX_LEN];
+    DumpHeader h;
+    Output o;
+
+    memset(&h, 0, sizeof(h));
+    memset(&o, 0, sizeof(o));
+    o.out = stdout;
+    o.first = true;
+
+    if ((argc > 1) && ((in = fopen(argv[1], "r")) == 0))
+    {
+        fprintf(stderr, "Can't open %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    if ((argc > 2) && ((o.out = fopen(argv[2], "w")) == 0))
+    {
+        fprintf(stderr, "Can't open %s\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(o.out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    TrackName(o, TRACK_TASKS, "Tasks");
+    TrackName(o, TRACK_ISR, "Interrupts");
+
+    while (fgets(line, sizeof(line), in) != 0)
+    {
+        //  Frame can come after other data on the same line
+        const char *frame = strstr(line, "5*:");
+        unsigned int records, lost, cyclesNow, cyclesPerUS, msNow, usFrac;
+        int pos = 0;
+
+        if (frame == 0)
+            continue;
+
+        if (sscanf(frame, "5*:H:%u:%u:%u:%u:%u:%u:", &records, &lost,
+                   &cyclesNow, &cyclesPerUS, &msNow, &usFrac) == 6)
+        {
+            //  New dump, task left open in the previous one never ended
+            if (o.taskOpen)
+                Event(o, "", 'E', TRACK_TASKS, h.usNow, 0);
+            o.taskOpen = false;
+
+            h.cyclesNow = cyclesNow;
+            h.cyclesPerUS = (cyclesPerUS > 0) ? cyclesPerUS : 1;
+            h.usNow = (double)msNow * 1000 + usFrac;
+            h.valid = true;
+        }
+        else if (h.valid && (sscanf(frame, "5*:%u:%n", &records, &pos) == 1)
+                 && (pos > 0))
+        {
+            if (!Records(o, h, frame + pos))
+                fprintf(stderr, "Skipping corrupted frame: %s", frame);
+        }
+    }
+
+    if (o.taskOpen)
+        Event(o, "", 'E', TRACK_TASKS, h.usNow, 0);
+    fprintf(o.out, "\n]}\n");
+
+    fprintf(stderr, "%u records: %u task runs, %u interrupts\n", o.records,
+            o.tasks, o.interrupts);
+
+    if (in != stdin)
+        fclose(in);
+    if (o.out != stdout)
+        fclose(o.out);
+
+    return EXIT_SUCCESS;
+}